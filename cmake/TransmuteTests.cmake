@@ -24,6 +24,9 @@ if (TR_BUILD_TESTS)
         ${TR_COMMON_SOURCE}
         ${TR_COMMON_TESTS_SOURCE}
         ${TR_CLIENT_BUILTIN_SCENE_SOURCE}
+        src/renderer/gles/program_binary_cache.cpp
+        src/runtime/sound_cache.cpp
+        src/runtime/sound_decoder.cpp
         tests/runtime.cpp
         tests/math.cpp
     )
@@ -32,6 +35,8 @@ if (TR_BUILD_TESTS)
         ${CMAKE_SOURCE_DIR}/tests
         ${CMAKE_SOURCE_DIR}/thirdparty/headers/node-addon-api/include
     )
+    # The WebGL shadow state tests load EGL at runtime to compare with the real driver.
+    target_link_libraries(TransmuteUnitTests PRIVATE ${CMAKE_DL_LIBS})
 
     # Add tests
     add_test(NAME CommonTests COMMAND TransmuteCommandBuffersBaseTest)
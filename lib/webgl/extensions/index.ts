@@ -4,6 +4,7 @@ import OES_element_index_uint from './oes_element_index_uint';
 import OES_standard_derivatives from './oes_standard_derivatives';
 import OES_texture_float_linear from './oes_texture_float_linear';
 import OVR_multiview2 from './ovr_multiview';
+import KHR_parallel_shader_compile from './khr_parallel_shader_compile';
 // import OCULUS_multiview from './oculus_multiview';
 
 export function getExtension(_gl: WebGLRenderingContext, name: string) {
@@ -20,6 +21,8 @@ export function getExtension(_gl: WebGLRenderingContext, name: string) {
       return new OES_texture_float_linear();
     case 'OVR_multiview2':
       return new OVR_multiview2();
+    case 'KHR_parallel_shader_compile':
+      return new KHR_parallel_shader_compile();
     // TODO: enable OCULUS_multiview?
     // case 'OCULUS_multiview':
     //   return new OCULUS_multiview();
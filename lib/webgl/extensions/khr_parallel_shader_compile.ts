@@ -0,0 +1,3 @@
+export default class KHR_parallel_shader_compile_impl implements KHR_parallel_shader_compile {
+  readonly COMPLETION_STATUS_KHR = 0x91B1;
+}
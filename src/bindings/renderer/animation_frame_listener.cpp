@@ -103,6 +103,9 @@ namespace bindings
                                 {
       auto timeValue = Napi::Number::New(env, request->time);
       delete request;
-      jsCallback.Call({timeValue}); });
+      jsCallback.Call({timeValue});
+
+      // Flush the command buffers which are recorded in this frame.
+      TrClientContextPerProcess::Get()->onAnimationFrameEnd(); });
   }
 }
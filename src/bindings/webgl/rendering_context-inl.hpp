@@ -645,6 +645,7 @@ namespace webgl
     auto jsBuffer = info[1];
     void *bufferData = nullptr;
     size_t bufferSize = 0;
+    vector<float> arrayValues;
     if (jsBuffer.IsDataView() || jsBuffer.IsTypedArray())
     {
       Napi::ArrayBuffer byteBuffer;
@@ -663,18 +664,19 @@ namespace webgl
         byteLength = typedArray.ByteLength();
         byteOffset = typedArray.ByteOffset();
       }
-      auto buffer = Napi::Uint8Array::New(env, byteLength, byteBuffer, byteOffset);
-      bufferData = buffer.Data();
-      bufferSize = buffer.ByteLength();
+      // Refer to the view's bytes in place instead of creating another view object.
+      bufferData = static_cast<uint8_t *>(byteBuffer.Data()) + byteOffset;
+      bufferSize = byteLength;
     }
     else if (jsBuffer.IsArray())
     {
       auto valuesArray = jsBuffer.As<Napi::Array>();
-      auto float32Array = Napi::Float32Array::New(env, valuesArray.Length(), napi_typedarray_type::napi_float32_array);
-      for (uint32_t i = 0; i < valuesArray.Length(); i++)
-        float32Array[i] = valuesArray.Get(i).ToNumber().FloatValue();
-      bufferData = float32Array.Data();
-      bufferSize = float32Array.ByteLength();
+      uint32_t length = valuesArray.Length();
+      arrayValues.resize(length);
+      for (uint32_t i = 0; i < length; i++)
+        arrayValues[i] = valuesArray.Get(i).ToNumber().FloatValue();
+      bufferData = arrayValues.data();
+      bufferSize = length * sizeof(float);
     }
     else if (jsBuffer.IsArrayBuffer())
     {
@@ -738,9 +740,9 @@ namespace webgl
         byteLength = typedArray.ByteLength();
         byteOffset = typedArray.ByteOffset();
       }
-      auto buffer = Napi::Uint8Array::New(env, byteLength, byteBuffer, byteOffset);
-      bufferData = buffer.Data();
-      bufferSize = buffer.ByteLength();
+      // Refer to the view's bytes in place instead of creating another view object.
+      bufferData = static_cast<uint8_t *>(byteBuffer.Data()) + byteOffset;
+      bufferSize = byteLength;
     }
     else if (jsBuffer.IsArrayBuffer())
     {
@@ -1701,67 +1703,63 @@ namespace webgl
   UNIFORM4X_IMPL(i, Int32Value)
 
   /**
-   * This function is used in uniform*v() functions to get a vector of values from the 2nd argument: `Array`, `Int32Array`
-   * and `Float32Array`.
+   * This function is used in uniform*v() and uniformMatrix*fv() functions to get the values from the argument: `Array`,
+   * `Int32Array` and `Float32Array`. The typed array's backing store is returned directly without copying, and the `Array`
+   * is converted into the `storage`.
    *
    * @param env The environment that the Node.js addon is running in.
-   * @param jsValues The 2nd argument of uniform*v() functions.
+   * @param jsValues The argument that contains the values.
    * @param valueTypedArrayType The TypedArray type of the values.
-   * @param n The number of values that should be taken from the 2nd argument.
-   * @returns A vector of values.
+   * @param n The number of values that should be taken from the argument.
+   * @param storage The vector to store the values converted from an `Array`.
+   * @returns A span of the values, which is valid until the `storage` or the typed array is released.
    */
   template <typename ValueType>
-  vector<ValueType> getUniformValuesVector(
+  std::span<const ValueType> getUniformValues(
     Napi::Env env,
     Napi::Value jsValues,
     napi_typedarray_type valueTypedArrayType,
-    size_t n)
+    size_t n,
+    vector<ValueType> &storage)
   {
     if (valueTypedArrayType != napi_float32_array && valueTypedArrayType != napi_int32_array)
       throw WebGLUniformError("TypedArray type should be either napi_float32_array or napi_int32_array.");
 
-    size_t valuesCount;
+    std::span<const ValueType> values;
     if (jsValues.IsArray())
-      valuesCount = jsValues.As<Napi::Array>().Length();
+    {
+      auto array = jsValues.As<Napi::Array>();
+      size_t length = array.Length();
+      storage.resize(length);
+      for (size_t i = 0; i < length; i++)
+      {
+        auto number = array.Get(i).ToNumber();
+        if constexpr (std::is_floating_point_v<ValueType>)
+          storage[i] = number.FloatValue();
+        else
+          storage[i] = number.Int32Value();
+      }
+      values = std::span<const ValueType>(storage.data(), length);
+    }
     else if (jsValues.IsTypedArray())
     {
       auto typedArray = jsValues.As<Napi::TypedArray>();
       if (typedArray.TypedArrayType() != valueTypedArrayType)
         throw WebGLUniformError("value must be correct TypedArray type.");
-      valuesCount = typedArray.ElementLength();
+
+      // Read the backing store in place, the element type is checked above.
+      auto array = jsValues.As<Napi::TypedArrayOf<ValueType>>();
+      values = std::span<const ValueType>(array.Data(), array.ElementLength());
     }
     else
       throw WebGLUniformError("value must be a float array or Float32Array.");
 
-    if (valuesCount < n)
+    if (values.size() < n)
     {
       auto msg = "should take at least " + std::to_string(n) + " values";
       throw WebGLUniformError(msg);
     }
-
-    std::vector<ValueType> data(valuesCount);
-    if (jsValues.IsArray())
-    {
-      auto array = jsValues.As<Napi::Array>();
-      for (size_t i = 0; i < valuesCount; i++)
-        data[i] = array.Get(i).ToNumber();
-    }
-    else
-    {
-      if (valueTypedArrayType == napi_float32_array)
-      {
-        auto array = jsValues.As<Napi::Float32Array>();
-        for (size_t i = 0; i < valuesCount; i++)
-          data[i] = array.Get(i).ToNumber().FloatValue();
-      }
-      else if (valueTypedArrayType == napi_int32_array)
-      {
-        auto array = jsValues.As<Napi::Int32Array>();
-        for (size_t i = 0; i < valuesCount; i++)
-          data[i] = array.Get(i).ToNumber().Int32Value();
-      }
-    }
-    return data;
+    return values;
   }
 
 #define UNIFORMNXV_IMPL(N, X, NAPI_VALUE_TYPE, VALUE_TYPE)                                                          \
@@ -1786,8 +1784,9 @@ namespace webgl
     auto location = Napi::ObjectWrap<WebGLUniformLocation>::Unwrap(info[0].As<Napi::Object>());                     \
     try                                                                                                             \
     {                                                                                                               \
-      auto data = getUniformValuesVector<VALUE_TYPE>(env, info[1], NAPI_VALUE_TYPE, N);                             \
-      glContext_->uniform##N##X##v(location->handle(), data);                                                       \
+      vector<VALUE_TYPE> storage;                                                                                   \
+      auto values = getUniformValues<VALUE_TYPE>(env, info[1], NAPI_VALUE_TYPE, N, storage);                        \
+      glContext_->uniform##N##X##v(location->handle(), values);                                                     \
     }                                                                                                               \
     catch (WebGLUniformError & e)                                                                                   \
     {                                                                                                               \
@@ -1824,10 +1823,11 @@ namespace webgl
     }                                                                                                                   \
     auto location = Napi::ObjectWrap<WebGLUniformLocation>::Unwrap(info[0].As<Napi::Object>());                         \
     bool transpose = info[1].As<Napi::Boolean>().Value();                                                               \
-    Napi::Float32Array matricesArray = info[2].As<Napi::Float32Array>();                                                \
+    Napi::Value jsMatrices = info[2];                                                                                   \
                                                                                                                         \
-    if (N == 4 && matricesArray.Has(WEBGL_PLACEHOLDERS_PLACEHOLDER_ID_KEY))                                             \
+    if (N == 4 && jsMatrices.IsObject() && jsMatrices.As<Napi::Object>().Has(WEBGL_PLACEHOLDERS_PLACEHOLDER_ID_KEY))    \
     {                                                                                                                   \
+      auto matricesArray = jsMatrices.As<Napi::Object>();                                                               \
       auto placeholderIdValue = matricesArray.Get(WEBGL_PLACEHOLDERS_PLACEHOLDER_ID_KEY);                               \
       if (!placeholderIdValue.IsNumber())                                                                               \
       {                                                                                                                 \
@@ -1846,16 +1846,23 @@ namespace webgl
       return env.Undefined();                                                                                           \
     }                                                                                                                   \
                                                                                                                         \
-    size_t length = matricesArray.ElementLength();                                                                      \
-    if (length % (N * N) != 0)                                                                                          \
+    vector<float> storage;                                                                                              \
+    std::span<const float> values;                                                                                      \
+    try                                                                                                                 \
+    {                                                                                                                   \
+      values = getUniformValues<float>(env, jsMatrices, napi_float32_array, 0, storage);                                \
+    }                                                                                                                   \
+    catch (WebGLUniformError & e)                                                                                       \
+    {                                                                                                                   \
+      Napi::TypeError::New(env, e.message("uniformMatrix" #N "fv")).ThrowAsJavaScriptException();                       \
+      return env.Undefined();                                                                                           \
+    }                                                                                                                   \
+    if (values.size() % (N * N) != 0)                                                                                   \
     {                                                                                                                   \
       Napi::TypeError::New(env, "uniformMatrix" #N "fv() takes " #N "x" #N " float elements array.")                    \
         .ThrowAsJavaScriptException();                                                                                  \
       return env.Undefined();                                                                                           \
     }                                                                                                                   \
-    std::vector<float> values(length);                                                                                  \
-    for (size_t i = 0; i < length; i++)                                                                                 \
-      values[i] = matricesArray.Get(i).ToNumber().FloatValue();                                                         \
     glContext_->uniformMatrix##N##fv(location->handle(), transpose, values);                                            \
     return env.Undefined();                                                                                             \
   }
@@ -2352,6 +2359,27 @@ namespace webgl
     return env.Undefined();
   }
 
+  template <typename ObjectType, typename ContextType>
+  Napi::Value WebGLBaseRenderingContext<ObjectType, ContextType>::IsEnabled(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    Napi::HandleScope scope(env);
+
+    if (info.Length() < 1 || !info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "isEnabled() takes 1 argument.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    try
+    {
+      return Napi::Boolean::New(env, glContext_->isEnabled(info[0].ToNumber().Int32Value()));
+    }
+    catch (const std::exception &e)
+    {
+      return env.Undefined();
+    }
+  }
+
   template <typename ObjectType, typename ContextType>
   Napi::Value WebGLBaseRenderingContext<ObjectType, ContextType>::GetParameter(const Napi::CallbackInfo &info)
   {
@@ -2421,6 +2449,13 @@ namespace webgl
     case WEBGL_STENCIL_PASS_DEPTH_FAIL:
     case WEBGL_STENCIL_PASS_DEPTH_PASS:
     case WEBGL_UNPACK_COLORSPACE_CONVERSION_WEBGL:
+    /**
+     * GLuint
+     */
+    case WEBGL_STENCIL_VALUE_MASK:
+    case WEBGL_STENCIL_WRITEMASK:
+    case WEBGL_STENCIL_BACK_VALUE_MASK:
+    case WEBGL_STENCIL_BACK_WRITEMASK:
     {
       value = Napi::Number::New(env, glContext_->getParameter(static_cast<client_graphics::WebGLIntegerParameterName>(pname)));
       break;
@@ -2434,6 +2469,8 @@ namespace webgl
     case WEBGL_DEPTH_WRITEMASK:
     case WEBGL_DITHER:
     case WEBGL_POLYGON_OFFSET_FILL:
+    case WEBGL_SAMPLE_ALPHA_TO_COVERAGE:
+    case WEBGL_SAMPLE_COVERAGE:
     case WEBGL_SAMPLE_COVERAGE_INVERT:
     case WEBGL_SCISSOR_TEST:
     case WEBGL_STENCIL_TEST:
@@ -2443,11 +2480,38 @@ namespace webgl
       value = Napi::Boolean::New(env, glContext_->getParameter(static_cast<client_graphics::WebGLBooleanParameterName>(pname)));
       break;
     }
+    /**
+     * GLboolean[]
+     */
+    case WEBGL_COLOR_WRITEMASK:
+    {
+      auto values = glContext_->getParameter(static_cast<client_graphics::WebGLBooleanArrayParameterName>(pname));
+      auto array = Napi::Array::New(env, values.size());
+      for (size_t i = 0; i < values.size(); i++)
+        array.Set(i, Napi::Boolean::New(env, values[i]));
+      value = array;
+      break;
+    }
+    /**
+     * GLfloat
+     */
+    case WEBGL_DEPTH_CLEAR_VALUE:
+    case WEBGL_LINE_WIDTH:
+    case WEBGL_POLYGON_OFFSET_FACTOR:
+    case WEBGL_POLYGON_OFFSET_UNITS:
+    case WEBGL_SAMPLE_COVERAGE_VALUE:
+    {
+      value = Napi::Number::New(env, glContext_->getParameter(static_cast<client_graphics::WebGLFloatParameterName>(pname)));
+      break;
+    }
     /**
      * GLfloat[]
      */
     case WEBGL_VIEWPORT:
     case WEBGL_SCISSOR_BOX:
+    case WEBGL_BLEND_COLOR:
+    case WEBGL_COLOR_CLEAR_VALUE:
+    case WEBGL_DEPTH_RANGE:
     {
       auto values = glContext_->getParameter(static_cast<client_graphics::WebGLFloatArrayParameterName>(pname));
       auto array = Napi::Float32Array::New(env, values.size());
@@ -784,6 +784,7 @@ namespace webgl
     InstanceMethod("frontFace", &T::FrontFace),                                 \
     InstanceMethod("enable", &T::Enable),                                       \
     InstanceMethod("disable", &T::Disable),                                     \
+    InstanceMethod("isEnabled", &T::IsEnabled),                                 \
     InstanceMethod("getParameter", &T::GetParameter),                           \
     InstanceMethod("getShaderPrecisionFormat", &T::GetShaderPrecisionFormat),   \
     InstanceMethod("getError", &T::GetError),                                   \
@@ -903,6 +904,20 @@ namespace webgl
     case WEBGL2_EXT_MAX_VIEWS_OVR:
       value = Napi::Number::New(env, glContext_->getParameterV2(static_cast<client_graphics::WebGL2IntegerParameterName>(pname)));
       break;
+    case WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT:
+    case WEBGL2_PACK_ROW_LENGTH:
+    case WEBGL2_PACK_SKIP_ROWS:
+    case WEBGL2_PACK_SKIP_PIXELS:
+    case WEBGL2_UNPACK_ROW_LENGTH:
+    case WEBGL2_UNPACK_IMAGE_HEIGHT:
+    case WEBGL2_UNPACK_SKIP_ROWS:
+    case WEBGL2_UNPACK_SKIP_PIXELS:
+    case WEBGL2_UNPACK_SKIP_IMAGES:
+      value = Napi::Number::New(env, glContext_->getParameter(static_cast<client_graphics::WebGLIntegerParameterName>(pname)));
+      break;
+    case WEBGL2_RASTERIZER_DISCARD:
+      value = Napi::Boolean::New(env, glContext_->getParameter(static_cast<client_graphics::WebGLBooleanParameterName>(pname)));
+      break;
     default:
       break;
     }
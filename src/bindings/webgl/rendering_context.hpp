@@ -172,6 +172,7 @@ namespace webgl
     Napi::Value FrontFace(const Napi::CallbackInfo &info);
     Napi::Value Enable(const Napi::CallbackInfo &info);
     Napi::Value Disable(const Napi::CallbackInfo &info);
+    Napi::Value IsEnabled(const Napi::CallbackInfo &info);
     Napi::Value GetParameter(const Napi::CallbackInfo &info);
     Napi::Value GetShaderPrecisionFormat(const Napi::CallbackInfo &info);
     Napi::Value GetError(const Napi::CallbackInfo &info);
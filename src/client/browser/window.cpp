@@ -1,7 +1,6 @@
 #include <client/dom/element.hpp>
 #include <client/dom/document.hpp>
 #include <client/cssom/rules/css_style_rule.hpp>
-#include <client/cssom/selectors/matching.hpp>
 #include <client/cssom/values/computed/context.hpp>
 #include <client/html/html_element.hpp>
 
@@ -41,21 +40,15 @@ namespace browser
     auto htmlElement = dynamic_pointer_cast<dom::HTMLElement>(elementOrTextNode);
     assert(htmlElement != nullptr && "The node must be an HTMLElement.");
 
-    // Update the style from the stylesheets.
-    const auto &stylesheets = elementOrTextNode->getOwnerDocumentChecked().styleSheets();
-    for (auto stylesheet : stylesheets)
-    {
-      for (auto rule : stylesheet->cssRules())
-      {
-        auto styleRule = dynamic_pointer_cast<CSSStyleRule>(rule);
-        if (styleRule != nullptr)
-        {
-          if (selectors::matchesSelectorList(styleRule->selectors(), htmlElement))
-            computedStyle->update(styleRule->style(), context);
-        }
-        // TODO: handle other types of rules, such as `CSSImportRule`, `CSSMediaRule`, etc.
-      }
-    }
+    // Update the style from the matched rules of the stylesheets in order.
+    auto &ownerDocument = elementOrTextNode->getOwnerDocumentChecked();
+    auto &ruleSet = ownerDocument.ruleSet();
+    ruleSet.updateIfNeeded(ownerDocument.styleSheets());
+
+    vector<shared_ptr<CSSStyleRule>> matchedRules;
+    ruleSet.collectMatchingRules(htmlElement, matchedRules);
+    for (auto styleRule : matchedRules)
+      computedStyle->update(styleRule->style(), context);
 
     // Update the style from the element's inline style.
     auto elementStyle = htmlElement->style();
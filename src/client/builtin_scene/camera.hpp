@@ -45,7 +45,12 @@ namespace builtin_scene
   class CameraUpdateSystem : public ecs::System
   {
   public:
-    using ecs::System::System;
+    CameraUpdateSystem()
+        : ecs::System()
+    {
+      // NOTE: It's chained with the render system which is exclusive, thus the chain still runs at the app's thread.
+      declareRead<Camera>();
+    }
 
   public:
     const std::string name() const override
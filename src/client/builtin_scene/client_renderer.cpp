@@ -45,6 +45,11 @@ namespace builtin_scene
                           glContext_->createBuffer(),
                           transparentVao,
                           glContext_->createBuffer());
+
+      // The local bounds of the mesh are used to cull the instances by their world-space bounds.
+      glm::vec3 min, max;
+      if (mesh3d->vertexBuffer().computeBounds(min, max))
+        instancedMesh.setLocalBounds(min, max);
     }
   }
 
@@ -203,7 +208,7 @@ namespace builtin_scene
           instancedMesh.updateRenderQueues(); // Update the render queues for opaque and transparent instances.
 
           auto meshIndicesCount = mesh->indices().size();
-          auto opaqueInstances = instancedMesh.getOpaqueInstancesList();
+          auto &opaqueInstances = instancedMesh.getOpaqueInstancesList();
           if (opaqueInstances.count() > 0)
           {
             glContext.depthMask(true);
@@ -224,7 +229,7 @@ namespace builtin_scene
           /**
            * TODO: does this need to be moved global transparent rendering queue?
            */
-          auto transparentInstances = instancedMesh.getTransparentInstancesList();
+          auto &transparentInstances = instancedMesh.getTransparentInstancesList();
           if (transparentInstances.count() > 0)
           {
             WebGLVertexArrayScope vaoScope(glContext_, transparentInstances.vao);
@@ -415,28 +420,41 @@ namespace builtin_scene
     auto renderer = getResource<Renderer>();
     assert(renderer != nullptr); // The renderer must be valid.
 
+    frustumPlanes_ = nullopt;
+    cullingStats_ = InstanceCullingStats();
+
     auto xrExperience = getResource<WebXRExperience>();
-    if (xrExperience != nullptr) // XR rendering
+    auto xrViewerPose = xrExperience != nullptr ? xrExperience->viewerPose() : nullptr;
+    if (xrViewerPose != nullptr) // XR rendering
     {
-      auto xrViewerPose = xrExperience->viewerPose();
-      if (xrViewerPose != nullptr)
+      auto &views = xrViewerPose->views();
       {
-        auto &views = xrViewerPose->views();
-        if (!xrExperience->multiviewEnabled())
-        {
-          for (auto view : views)
-            render(*renderer, Renderer::XRRenderTarget(view));
-        }
-        else
-        {
-          render(*renderer, Renderer::XRRenderTarget(views));
-        }
-        return;
+        // The instances are culled by the frustum which covers all the views of this frame.
+        vector<glm::mat4> viewProjectionMatrices;
+        for (auto view : views)
+          viewProjectionMatrices.push_back(view->projectionMatrix() * view->transform().inverse().matrix());
+        frustumPlanes_ = frustumPlanesForViews(viewProjectionMatrices);
+      }
+
+      if (!xrExperience->multiviewEnabled())
+      {
+        for (auto view : views)
+          render(*renderer, Renderer::XRRenderTarget(view));
+      }
+      else
+      {
+        render(*renderer, Renderer::XRRenderTarget(views));
       }
     }
+    else
+    {
+      // Fallback to the default rendering
+      render(*renderer, nullopt);
+    }
 
-    // Fallback to the default rendering
-    render(*renderer, nullopt);
+    auto clientContext = TrClientContextPerProcess::Get();
+    if (clientContext != nullptr)
+      clientContext->getPerfFs().setInstanceCulling(cullingStats_.submitted, cullingStats_.culled);
   }
 
   glm::mat4 RenderSystem::getTransformationMatrix(ecs::EntityId id)
@@ -467,7 +485,8 @@ namespace builtin_scene
     return postMat * baseMatrixInWorldSpace;
   }
 
-  void RenderSystem::tryUpdateInstanceDataForInstancedMesh(const Mesh3d &meshComponent)
+  void RenderSystem::tryUpdateInstanceDataForInstancedMesh(const Mesh3d &meshComponent,
+                                                          optional<Renderer::XRRenderTarget> renderTarget)
   {
     if (!meshComponent.isInstancedMesh())
       return;
@@ -520,6 +539,13 @@ namespace builtin_scene
       return hasChanged;
     };
     instancedMesh.iterateInstances(updateInstanceData);
+
+    // Cull the instances once per frame, the right view in the multi-pass rendering shares the culling of the left one.
+    bool isFirstView = renderTarget == nullopt ||
+                       renderTarget->isMultiview() ||
+                       renderTarget->view()->eye() != client_xr::XREye::kRight;
+    if (isFirstView)
+      cullingStats_ += instancedMesh.cullInstances(frustumPlanes_);
   }
 
   void RenderSystem::render(Renderer &renderer, optional<Renderer::XRRenderTarget> renderTarget)
@@ -615,7 +641,7 @@ namespace builtin_scene
     renderer.tryUpdateMeshMaterial3d(meshComponent, materialComponent);
 
     // Update the instance transformation matrix if it's an instanced mesh
-    tryUpdateInstanceDataForInstancedMesh(*meshComponent);
+    tryUpdateInstanceDataForInstancedMesh(*meshComponent, renderTarget);
 
     // Draw
     shared_ptr<Transform> parentTransform = nullptr;
@@ -8,6 +8,7 @@
 
 #include "./ecs-inl.hpp"
 #include "./meshes.hpp"
+#include "./instance_culling.hpp"
 #include "./mesh_material.hpp"
 #include "./transform.hpp"
 #include "./xr.hpp"
@@ -284,11 +285,13 @@ namespace builtin_scene
      */
     glm::mat4 getTransformationMatrix(ecs::EntityId id);
     /**
-     * Update the instance data for the mesh if it's an instanced mesh.
+     * Update the instance data for the mesh if it's an instanced mesh, and cull its instances by the frame's view frustum.
      *
      * @param meshComponent The mesh component to update the instance data with.
+     * @param renderTarget The XR render target.
      */
-    void tryUpdateInstanceDataForInstancedMesh(const Mesh3d &meshComponent);
+    void tryUpdateInstanceDataForInstancedMesh(const Mesh3d &meshComponent,
+                                               std::optional<Renderer::XRRenderTarget> renderTarget);
     /**
      * Render the scene with the given renderer.
      *
@@ -339,5 +342,10 @@ namespace builtin_scene
                     std::shared_ptr<Mesh3d> meshComponent,
                     Renderer &renderer,
                     std::optional<Renderer::XRRenderTarget> renderTarget);
+
+  private:
+    // The planes of the frustum which covers all the views of the current frame, `std::nullopt` if not in XR.
+    std::optional<FrustumPlanes> frustumPlanes_;
+    InstanceCullingStats cullingStats_;
   };
 }
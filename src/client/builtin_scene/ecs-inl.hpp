@@ -66,56 +66,46 @@ namespace builtin_scene::ecs
   template <typename T>
   std::shared_ptr<T> ComponentSet<T>::insert(EntityId entity, std::shared_ptr<T> component)
   {
-    if (entityToIndexMap_.find(entity) != entityToIndexMap_.end())
+    if (contains(entity))
       throw std::runtime_error("Entity already has a component of this type.");
 
-    auto index = size_;
-    entityToIndexMap_[entity] = index;
-    indexToEntityMap_[index] = entity;
-    components_[index] = component;
-    size_ += 1;
+    if (entity >= sparse_.size())
+      sparse_.resize(entity + 1, kInvalidIndex);
+    sparse_[entity] = static_cast<uint32_t>(entities_.size());
+    entities_.push_back(entity);
+    components_.push_back(component);
     return component;
   }
 
   template <typename T>
   void ComponentSet<T>::remove(EntityId entity)
   {
-    if (entityToIndexMap_.find(entity) == entityToIndexMap_.end())
+    if (!contains(entity))
       throw std::runtime_error("Entity does not have a component of this type.");
 
-    size_t indexToRemove = entityToIndexMap_[entity];
-    size_t lastIndex = size_ - 1;
-    components_[indexToRemove] = components_[lastIndex];
+    uint32_t indexToRemove = sparse_[entity];
+    EntityId lastEntity = entities_.back();
+    components_[indexToRemove] = std::move(components_.back());
+    entities_[indexToRemove] = lastEntity;
+    sparse_[lastEntity] = indexToRemove;
 
-    EntityId lastEntity = indexToEntityMap_[lastIndex];
-    entityToIndexMap_[lastEntity] = indexToRemove;
-    indexToEntityMap_[indexToRemove] = lastEntity;
-
-    entityToIndexMap_.erase(entity);
-    indexToEntityMap_.erase(lastIndex);
-    entityToComponentCache_.erase(entity);
-    size_ -= 1;
+    components_.pop_back();
+    entities_.pop_back();
+    sparse_[entity] = kInvalidIndex;
   }
 
   template <typename T>
   std::shared_ptr<T> ComponentSet<T>::get(EntityId entity)
   {
-    auto cachedComponent = entityToComponentCache_[entity];
-    if (!cachedComponent.expired())
-      return cachedComponent.lock();
-
-    if (entityToIndexMap_.find(entity) == entityToIndexMap_.end())
+    if (!contains(entity))
       return nullptr;
-
-    std::shared_ptr<T> component = components_[entityToIndexMap_[entity]];
-    entityToComponentCache_[entity] = component; // TODO: support LRU cache.
-    return component;
+    return components_[sparse_[entity]];
   }
 
   template <typename T>
   void ComponentSet<T>::onEntityDestroyed(EntityId entity)
   {
-    if (entityToIndexMap_.find(entity) != entityToIndexMap_.end())
+    if (contains(entity))
       remove(entity);
   }
 
@@ -126,8 +116,13 @@ namespace builtin_scene::ecs
     if (componentIds_.find(name) != componentIds_.end())
       throw std::runtime_error("Component(" + std::string(name.name()) + ") already registered.");
 
+    if (nextComponentId_ >= MAX_COMPONENT_ID)
+      throw std::runtime_error("Too many components, the max is " + std::to_string(MAX_COMPONENT_ID) + ".");
+
+    auto componentSet = ComponentSet<ComponentType>::Make();
+    componentSet->id_ = nextComponentId_;
     componentIds_.insert({name, nextComponentId_});
-    componentSets_.insert({name, ComponentSet<ComponentType>::Make()});
+    componentSets_.insert({name, componentSet});
     nextComponentId_ += 1;
   }
 
@@ -141,6 +136,35 @@ namespace builtin_scene::ecs
     return it->second;
   }
 
+  template <typename... ComponentTypes>
+  std::shared_ptr<Query<ComponentTypes...>> ComponentsManager::findQuery()
+  {
+    static const std::type_index name = typeid(Query<ComponentTypes...>);
+    auto it = queries_.find(name);
+    if (it == queries_.end())
+      return nullptr;
+    return std::static_pointer_cast<Query<ComponentTypes...>>(it->second);
+  }
+
+  template <typename... ComponentTypes>
+  std::shared_ptr<Query<ComponentTypes...>> ComponentsManager::getOrCreateQuery()
+  {
+    auto query = findQuery<ComponentTypes...>();
+    if (query != nullptr)
+      return query;
+
+    std::array<ComponentId, sizeof...(ComponentTypes)> ids = {getComponentId<ComponentTypes>()...};
+    ComponentMask mask;
+    for (auto id : ids)
+      mask.set(id);
+
+    query = std::make_shared<Query<ComponentTypes...>>(mask, ids);
+    for (auto &archetype : archetypes_)
+      query->tryAddArchetype(archetype.get());
+    queries_.insert({typeid(Query<ComponentTypes...>), query});
+    return query;
+  }
+
   template <typename... ComponentTypeList>
   EntityId App::spawn(ComponentTypeList... components)
   {
@@ -209,6 +233,44 @@ namespace builtin_scene::ecs
     return result;
   }
 
+  template <typename... ComponentTypes, typename Fn>
+  void App::forEach(Fn fn)
+  {
+    std::shared_ptr<Query<ComponentTypes...>> query;
+    {
+      std::shared_lock<std::shared_mutex> lock(mutexForEntities_);
+      query = componentsMgr_.findQuery<ComponentTypes...>();
+    }
+    if (TR_UNLIKELY(query == nullptr))
+    {
+      // The query is created at the first use, the created one is updated by the manager when new archetypes are added.
+      std::unique_lock<std::shared_mutex> lock(mutexForEntities_);
+      query = componentsMgr_.getOrCreateQuery<ComponentTypes...>();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutexForEntities_);
+    query->forEach(fn);
+  }
+
+  template <typename... ComponentTypes, typename Fn>
+  void App::parallelForEach(Fn fn, size_t chunkSize)
+  {
+    TaskPool *pool = taskPool();
+    if (pool == nullptr)
+    {
+      forEach<ComponentTypes...>(fn);
+      return;
+    }
+
+    std::shared_ptr<Query<ComponentTypes...>> query;
+    {
+      std::unique_lock<std::shared_mutex> lock(mutexForEntities_);
+      query = componentsMgr_.getOrCreateQuery<ComponentTypes...>();
+    }
+    std::shared_lock<std::shared_mutex> lock(mutexForEntities_);
+    query->parallelForEach(*pool, chunkSize, fn);
+  }
+
   template <typename ComponentType>
   std::optional<EntityId> App::firstEntity()
   {
@@ -1,3 +1,4 @@
+#include <exception>
 #include "./ecs-inl.hpp"
 
 #ifdef TR_ECS_ENABLE_TIME_PROFILING
@@ -12,9 +13,35 @@ namespace builtin_scene::ecs
   using namespace std::chrono;
 #endif
 
+  bool SystemAccess::conflictsWith(const SystemAccess &other) const
+  {
+    if (!declared_ || !other.declared_)
+      return true;
+
+    for (auto &name : writes_)
+    {
+      if (other.reads_.count(name) > 0 || other.writes_.count(name) > 0)
+        return true;
+    }
+    for (auto &name : other.writes_)
+    {
+      if (reads_.count(name) > 0)
+        return true;
+    }
+    return false;
+  }
+
+  void SystemAccess::merge(const SystemAccess &other)
+  {
+    declared_ = declared_ && other.declared_;
+    reads_.insert(other.reads_.begin(), other.reads_.end());
+    writes_.insert(other.writes_.begin(), other.writes_.end());
+  }
+
   bool ISystemSet::addSystem(std::shared_ptr<System> system)
   {
     systems_.push_back(system);
+    dependenciesDirty_ = true;
     return true;
   }
 
@@ -25,18 +52,256 @@ namespace builtin_scene::ecs
       if ((*it)->id() == id)
       {
         systems_.erase(it);
+        dependenciesDirty_ = true;
         return true;
       }
     }
     return false;
   }
 
-  void ISystemSet::run()
+  void ISystemSet::run(TaskPool *taskPool)
   {
+    if (taskPool != nullptr && systems_.size() > 1)
+    {
+      updateDependencies();
+      if (hasParallelSystems_)
+      {
+        runInParallel(*taskPool);
+        return;
+      }
+    }
+
     for (auto &system : systems_)
       system->runOnce();
   }
 
+  void ISystemSet::runInParallel(TaskPool &taskPool)
+  {
+    size_t count = systems_.size();
+    vector<atomic<size_t>> pendingDependencies(count);
+    for (size_t i = 0; i < count; i++)
+      pendingDependencies[i].store(dependenciesCount_[i], memory_order_relaxed);
+
+    atomic<size_t> finished = 0;
+    mutex mutexForReady;
+    vector<size_t> readyExclusiveSystems;
+    exception_ptr firstError = nullptr;
+
+    // Mark the system as finished, and schedule its dependents which have no pending dependencies.
+    function<void(size_t)> schedule;
+    auto complete = [&](size_t index)
+    {
+      for (auto dependent : dependents_[index])
+      {
+        if (pendingDependencies[dependent].fetch_sub(1, memory_order_acq_rel) == 1)
+          schedule(dependent);
+      }
+      finished.fetch_add(1, memory_order_release);
+    };
+    auto runSystem = [&](size_t index)
+    {
+      try
+      {
+        systems_[index]->runOnce();
+      }
+      catch (...)
+      {
+        lock_guard<mutex> lock(mutexForReady);
+        if (firstError == nullptr)
+          firstError = current_exception();
+      }
+      complete(index);
+    };
+    schedule = [&](size_t index)
+    {
+      if (exclusive_[index])
+      {
+        lock_guard<mutex> lock(mutexForReady);
+        readyExclusiveSystems.push_back(index);
+      }
+      else
+      {
+        taskPool.submit([&runSystem, index]()
+                        { runSystem(index); });
+      }
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+      if (dependenciesCount_[i] == 0)
+        schedule(i);
+    }
+
+    // The exclusive systems run at this thread, and this thread helps to run the parallel systems while waiting.
+    while (finished.load(memory_order_acquire) < count)
+    {
+      optional<size_t> next = nullopt;
+      {
+        lock_guard<mutex> lock(mutexForReady);
+        if (!readyExclusiveSystems.empty())
+        {
+          next = readyExclusiveSystems.front();
+          readyExclusiveSystems.erase(readyExclusiveSystems.begin());
+        }
+      }
+      if (next.has_value())
+        runSystem(next.value());
+      else if (!taskPool.runPendingTask())
+        this_thread::yield();
+    }
+
+    if (firstError != nullptr)
+      rethrow_exception(firstError);
+  }
+
+  void ISystemSet::updateDependencies()
+  {
+    if (!dependenciesDirty_)
+      return;
+
+    size_t count = systems_.size();
+    vector<SystemAccess> accesses;
+    accesses.reserve(count);
+    for (auto &system : systems_)
+      accesses.push_back(system->chainedAccess());
+
+    dependents_.assign(count, {});
+    dependenciesCount_.assign(count, 0);
+    exclusive_.assign(count, false);
+    hasParallelSystems_ = false;
+    for (size_t i = 0; i < count; i++)
+    {
+      exclusive_[i] = !accesses[i].isDeclared();
+      if (!exclusive_[i])
+        hasParallelSystems_ = true;
+
+      // The conflicting systems run in the order of being added.
+      for (size_t j = 0; j < i; j++)
+      {
+        if (accesses[j].conflictsWith(accesses[i]))
+        {
+          dependents_[j].push_back(i);
+          dependenciesCount_[i] += 1;
+        }
+      }
+    }
+    dependenciesDirty_ = false;
+  }
+
+  Archetype::Archetype(ComponentMask mask)
+      : mask_(mask)
+  {
+    for (ComponentId id = 0; id < MAX_COMPONENT_ID; id++)
+    {
+      if (mask_.test(id))
+        componentIds_.push_back(id);
+    }
+  }
+
+  uint32_t Archetype::append(EntityId entity)
+  {
+    uint32_t row = static_cast<uint32_t>(entities_.size());
+    entities_.push_back(entity);
+    for (auto id : componentIds_)
+      columns_[id].push_back(nullptr);
+    return row;
+  }
+
+  optional<EntityId> Archetype::swapRemove(uint32_t row)
+  {
+    assert(row < entities_.size());
+    uint32_t lastRow = static_cast<uint32_t>(entities_.size() - 1);
+    optional<EntityId> moved = nullopt;
+    if (row != lastRow)
+    {
+      entities_[row] = entities_[lastRow];
+      for (auto id : componentIds_)
+        columns_[id][row] = columns_[id][lastRow];
+      moved = entities_[row];
+    }
+    entities_.pop_back();
+    for (auto id : componentIds_)
+      columns_[id].pop_back();
+    return moved;
+  }
+
+  void ComponentsManager::onEntityDestroyed(EntityId entity)
+  {
+    for (auto &pair : componentSets_)
+    {
+      auto componentSet = pair.second;
+      componentSet->onEntityDestroyed(entity);
+    }
+    removeFromArchetype(entity);
+  }
+
+  void ComponentsManager::updateArchetype(EntityId entity, ComponentId componentId, void *component)
+  {
+    if (entity >= entityLocations_.size())
+      entityLocations_.resize(entity + 1);
+
+    EntityLocation &location = entityLocations_[entity];
+    Archetype *source = location.archetype;
+    ComponentMask mask = source != nullptr ? source->mask() : ComponentMask();
+    mask.set(componentId, component != nullptr);
+
+    if (source == nullptr || source->mask() != mask)
+    {
+      Archetype *target = mask.any() ? getOrCreateArchetype(mask) : nullptr;
+      uint32_t row = 0;
+      if (target != nullptr)
+      {
+        row = target->append(entity);
+        // Copy the kept components from the source archetype.
+        if (source != nullptr)
+        {
+          for (auto id : target->componentIds())
+          {
+            if (source->mask().test(id))
+              target->column(id)[row] = source->column(id)[location.row];
+          }
+        }
+      }
+      removeFromArchetype(entity);
+      location = {target, row};
+    }
+
+    if (component != nullptr)
+      location.archetype->column(componentId)[location.row] = component;
+  }
+
+  void ComponentsManager::removeFromArchetype(EntityId entity)
+  {
+    if (entity >= entityLocations_.size())
+      return;
+
+    EntityLocation &location = entityLocations_[entity];
+    if (location.archetype == nullptr)
+      return;
+
+    auto moved = location.archetype->swapRemove(location.row);
+    if (moved.has_value())
+      entityLocations_[moved.value()].row = location.row;
+    location = {};
+  }
+
+  Archetype *ComponentsManager::getOrCreateArchetype(const ComponentMask &mask)
+  {
+    auto it = archetypesByMask_.find(mask);
+    if (it != archetypesByMask_.end())
+      return it->second;
+
+    auto archetype = make_unique<Archetype>(mask);
+    Archetype *archetypeRef = archetype.get();
+    archetypes_.push_back(std::move(archetype));
+    archetypesByMask_.insert({mask, archetypeRef});
+
+    // Update the cached queries to include the new archetype.
+    for (auto &pair : queries_)
+      pair.second->tryAddArchetype(archetypeRef);
+    return archetypeRef;
+  }
+
   bool App::removeEntity(EntityId entity)
   {
     unique_lock<shared_mutex> lock(mutexForEntities_);
@@ -62,6 +327,8 @@ namespace builtin_scene::ecs
     auto systemSet = std::static_pointer_cast<LabeledSystemSet<SchedulerLabel>>(systemSets_[label]);
     systemSet->addSystem(system);
     system->connect(shared_from_this());
+    if (system->chainedAccess().isDeclared())
+      hasParallelSystems_ = true;
     return system->id();
   }
 
@@ -96,13 +363,29 @@ namespace builtin_scene::ecs
     runSystems(SchedulerLabel::kLast);
   }
 
+  void App::enableParallelScheduling(size_t workersCount)
+  {
+    if (taskPoolWorkersCount_.has_value())
+      return;
+    taskPoolWorkersCount_ = workersCount;
+  }
+
+  TaskPool *App::taskPool()
+  {
+    if (!taskPoolWorkersCount_.has_value())
+      return nullptr;
+    call_once(taskPoolCreated_, [this]()
+              { taskPool_ = make_unique<TaskPool>(taskPoolWorkersCount_.value()); });
+    return taskPool_.get();
+  }
+
   void App::runSystems(SchedulerLabel label)
   {
     shared_lock<shared_mutex> lock(mutexForSystems_);
     if (systemSets_.find(label) == systemSets_.end())
       return;
     auto systemSet = systemSets_[label];
-    systemSet->run();
+    systemSet->run(hasParallelSystems_ ? taskPool() : nullptr);
   }
 
   void System::runOnce()
@@ -126,6 +409,14 @@ namespace builtin_scene::ecs
       next_->runOnce();
   }
 
+  SystemAccess System::chainedAccess() const
+  {
+    SystemAccess access = access_;
+    for (auto next = next_; next != nullptr; next = next->next_)
+      access.merge(next->access_);
+    return access;
+  }
+
   void System::connect(shared_ptr<App> app)
   {
     connectedApp_ = app;
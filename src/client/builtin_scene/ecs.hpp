@@ -9,16 +9,26 @@
 #pragma once
 
 #include <assert.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <functional>
+#include <optional>
+#include <set>
 #include <vector>
 #include <unordered_map>
 #include <shared_mutex>
 #include <typeindex>
+#include <utility>
 #include <idgen.hpp>
 #include <common/utility.hpp>
 
+#include "./ecs_task_pool.hpp"
+
 /**
  * Enable the time profiling for the ECS.
  */
@@ -68,6 +78,12 @@ namespace builtin_scene::ecs
 
   constexpr EntityId MAX_ENTITY_ID = 10 * 10000;
   constexpr SystemId MAX_SYSTEM_ID = 1000;
+  constexpr ComponentId MAX_COMPONENT_ID = 64;
+
+  /**
+   * The mask of the component types, each bit is a component Id.
+   */
+  typedef std::bitset<MAX_COMPONENT_ID> ComponentMask;
 
   // Forward declarations.
   class App;
@@ -262,11 +278,25 @@ namespace builtin_scene::ecs
    */
   class IComponentSet
   {
+    friend class ComponentsManager;
+
   public:
     virtual ~IComponentSet() = default;
 
   public:
     virtual void onEntityDestroyed(EntityId entity) = 0;
+
+  public:
+    /**
+     * @returns The Id of the component type of this set.
+     */
+    inline ComponentId id() const
+    {
+      return id_;
+    }
+
+  private:
+    ComponentId id_ = 0;
   };
 
   /**
@@ -353,7 +383,14 @@ namespace builtin_scene::ecs
      */
     inline bool contains(EntityId entity)
     {
-      return entityToIndexMap_.find(entity) != entityToIndexMap_.end();
+      return entity < sparse_.size() && sparse_[entity] != kInvalidIndex;
+    }
+    /**
+     * @returns The number of the components in this set.
+     */
+    inline size_t size() const
+    {
+      return entities_.size();
     }
     /**
      * Replace the component of the given entity with the new component.
@@ -377,11 +414,198 @@ namespace builtin_scene::ecs
     void onEntityDestroyed(EntityId entity) override;
 
   private:
-    std::array<std::shared_ptr<T>, MAX_ENTITY_ID> components_;
-    std::unordered_map<EntityId, size_t> entityToIndexMap_;
-    std::unordered_map<size_t, EntityId> indexToEntityMap_;
-    std::unordered_map<EntityId, std::weak_ptr<T>> entityToComponentCache_;
-    size_t size_ = 0;
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * The components and their entities are packed densely, and the sparse array maps the entity to the dense index, thus the
+     * lookup is an array indexing without hashing.
+     */
+    std::vector<std::shared_ptr<T>> components_;
+    std::vector<EntityId> entities_;
+    std::vector<uint32_t> sparse_;
+  };
+
+  /**
+   * The archetype is the table of the entities which have the same set of component types, the components are stored in the
+   * columns by component type, and the rows are the entities.
+   *
+   * The components are still owned by the `ComponentSet`s, the columns store the raw pointers to them, thus the queries could
+   * iterate the matched entities contiguously without hashing or reference counting.
+   */
+  class Archetype
+  {
+  public:
+    Archetype(ComponentMask mask);
+
+  public:
+    /**
+     * @returns The mask of the component types of this archetype.
+     */
+    inline const ComponentMask &mask() const
+    {
+      return mask_;
+    }
+    /**
+     * @returns The Ids of the component types of this archetype.
+     */
+    inline const std::vector<ComponentId> &componentIds() const
+    {
+      return componentIds_;
+    }
+    /**
+     * @returns The entities of this archetype, it's indexed by row.
+     */
+    inline const std::vector<EntityId> &entities() const
+    {
+      return entities_;
+    }
+    /**
+     * @returns The column of the given component type, it's indexed by row.
+     */
+    inline std::vector<void *> &column(ComponentId id)
+    {
+      return columns_[id];
+    }
+    /**
+     * Append a row for the entity, the columns are filled with null pointers.
+     *
+     * @param entity The entity to append.
+     * @returns The row of the appended entity.
+     */
+    uint32_t append(EntityId entity);
+    /**
+     * Remove the row by swapping the last row into it.
+     *
+     * @param row The row to remove.
+     * @returns The entity which is moved to the removed row, or an empty optional if the last row is removed.
+     */
+    std::optional<EntityId> swapRemove(uint32_t row);
+
+  private:
+    ComponentMask mask_;
+    std::vector<ComponentId> componentIds_;
+    std::vector<EntityId> entities_;
+    std::array<std::vector<void *>, MAX_COMPONENT_ID> columns_;
+  };
+
+  /**
+   * The interface of the cached queries.
+   */
+  class IQuery
+  {
+    friend class ComponentsManager;
+
+  public:
+    virtual ~IQuery() = default;
+
+  protected:
+    IQuery(ComponentMask mask)
+        : mask_(mask)
+    {
+    }
+
+  private:
+    inline void tryAddArchetype(Archetype *archetype)
+    {
+      if ((archetype->mask() & mask_) == mask_)
+        archetypes_.push_back(archetype);
+    }
+
+  protected:
+    ComponentMask mask_;
+    std::vector<Archetype *> archetypes_;
+  };
+
+  /**
+   * The cached query of the entities which have all the given component types.
+   *
+   * The matched archetypes are cached and updated when a new archetype is created, thus the iteration only visits the matched
+   * entities without checking each entity.
+   *
+   * @tparam ComponentTypes The component types to query.
+   */
+  template <typename... ComponentTypes>
+  class Query : public IQuery
+  {
+    friend class ComponentsManager;
+
+  public:
+    Query(ComponentMask mask, std::array<ComponentId, sizeof...(ComponentTypes)> componentIds)
+        : IQuery(mask)
+        , componentIds_(componentIds)
+    {
+    }
+
+  public:
+    /**
+     * Iterate the matched entities with the references to the components.
+     *
+     * @param fn The function to call with the entity and the components.
+     */
+    template <typename Fn>
+    inline void forEach(Fn &fn)
+    {
+      forEach(fn, std::index_sequence_for<ComponentTypes...>{});
+    }
+    /**
+     * @returns The number of the matched entities.
+     */
+    size_t count() const
+    {
+      size_t n = 0;
+      for (auto archetype : archetypes_)
+        n += archetype->entities().size();
+      return n;
+    }
+
+    /**
+     * Iterate the matched entities in chunks on the task pool.
+     *
+     * @param taskPool The task pool to run the chunks.
+     * @param chunkSize The count of the entities in a chunk.
+     * @param fn The function to call with the entity and the components, it must be thread-safe.
+     */
+    template <typename Fn>
+    void parallelForEach(TaskPool &taskPool, size_t chunkSize, Fn &fn)
+    {
+      struct Chunk
+      {
+        Archetype *archetype;
+        size_t begin;
+        size_t end;
+      };
+      std::vector<Chunk> chunks;
+      for (auto archetype : archetypes_)
+      {
+        size_t size = archetype->entities().size();
+        for (size_t begin = 0; begin < size; begin += chunkSize)
+          chunks.push_back({archetype, begin, std::min(begin + chunkSize, size)});
+      }
+      taskPool.parallelFor(chunks.size(), [this, &chunks, &fn](size_t i)
+                           {
+                             auto &chunk = chunks[i];
+                             forEachInRange(chunk.archetype, chunk.begin, chunk.end, fn,
+                                            std::index_sequence_for<ComponentTypes...>{}); });
+    }
+
+  private:
+    template <typename Fn, size_t... I>
+    void forEach(Fn &fn, std::index_sequence<I...> sequence)
+    {
+      for (auto archetype : archetypes_)
+        forEachInRange(archetype, 0, archetype->entities().size(), fn, sequence);
+    }
+    template <typename Fn, size_t... I>
+    void forEachInRange(Archetype *archetype, size_t begin, size_t end, Fn &fn, std::index_sequence<I...>)
+    {
+      const auto &entities = archetype->entities();
+      std::array<void **, sizeof...(I)> columns = {archetype->column(componentIds_[I]).data()...};
+      for (size_t row = begin; row < end; row++)
+        fn(entities[row], *static_cast<ComponentTypes *>(columns[I][row])...);
+    }
+
+  private:
+    std::array<ComponentId, sizeof...(ComponentTypes)> componentIds_;
   };
 
   /**
@@ -424,7 +648,10 @@ namespace builtin_scene::ecs
     template <typename ComponentType>
     inline std::shared_ptr<ComponentType> addComponent(EntityId entity, ComponentType component)
     {
-      return getComponentSet<ComponentType>()->insert(entity, std::make_shared<ComponentType>(component));
+      auto componentSet = getComponentSet<ComponentType>();
+      auto added = componentSet->insert(entity, std::make_shared<ComponentType>(component));
+      updateArchetype(entity, componentSet->id(), added.get());
+      return added;
     }
 
     /**
@@ -439,7 +666,10 @@ namespace builtin_scene::ecs
     template <typename ComponentType, typename... InitialzingArgs>
     inline std::shared_ptr<ComponentType> addComponentWithArgs(EntityId entity, InitialzingArgs... args)
     {
-      return getComponentSet<ComponentType>()->insertWithArgs(entity, args...);
+      auto componentSet = getComponentSet<ComponentType>();
+      auto added = componentSet->insertWithArgs(entity, args...);
+      updateArchetype(entity, componentSet->id(), added.get());
+      return added;
     }
 
     /**
@@ -458,6 +688,7 @@ namespace builtin_scene::ecs
       if (ignoreIfNotExists == true && !componentSet->contains(entity))
         return;
       componentSet->remove(entity);
+      updateArchetype(entity, componentSet->id(), nullptr);
     }
 
     /**
@@ -486,7 +717,10 @@ namespace builtin_scene::ecs
     template <typename ComponentType>
     inline std::shared_ptr<ComponentType> replaceComponent(EntityId entity, ComponentType component)
     {
-      return getComponentSet<ComponentType>()->replace(entity, std::make_shared<ComponentType>(component));
+      auto componentSet = getComponentSet<ComponentType>();
+      auto replaced = componentSet->replace(entity, std::make_shared<ComponentType>(component));
+      updateArchetype(entity, componentSet->id(), replaced.get());
+      return replaced;
     }
 
     /**
@@ -494,14 +728,7 @@ namespace builtin_scene::ecs
      *
      * @param entity The Id of the entity that has been destroyed.
      */
-    inline void onEntityDestroyed(EntityId entity)
-    {
-      for (auto &pair : componentSets_)
-      {
-        auto componentSet = pair.second;
-        componentSet->onEntityDestroyed(entity);
-      }
-    }
+    void onEntityDestroyed(EntityId entity);
 
     /**
      * Get the `ComponentSet` for the given component type.
@@ -519,10 +746,106 @@ namespace builtin_scene::ecs
       return std::static_pointer_cast<ComponentSet<ComponentType>>(it->second);
     }
 
+    /**
+     * Find the cached query of the given component types.
+     *
+     * @tparam ComponentTypes The component types to query.
+     * @returns The cached query, or nullptr if it's not created yet.
+     */
+    template <typename... ComponentTypes>
+    std::shared_ptr<Query<ComponentTypes...>> findQuery();
+    /**
+     * Get the cached query of the given component types, it creates the query if it's not created yet.
+     *
+     * @tparam ComponentTypes The component types to query.
+     * @returns The cached query.
+     */
+    template <typename... ComponentTypes>
+    std::shared_ptr<Query<ComponentTypes...>> getOrCreateQuery();
+
+  private:
+    struct EntityLocation
+    {
+      Archetype *archetype = nullptr;
+      uint32_t row = 0;
+    };
+
+    /**
+     * Move the entity to the archetype which matches its components after a component is added, replaced or removed.
+     *
+     * @param entity The entity whose component is changed.
+     * @param componentId The Id of the changed component type.
+     * @param component The pointer to the added or replaced component, or nullptr if the component is removed.
+     */
+    void updateArchetype(EntityId entity, ComponentId componentId, void *component);
+    void removeFromArchetype(EntityId entity);
+    Archetype *getOrCreateArchetype(const ComponentMask &mask);
+
   private:
     std::unordered_map<ComponentName, ComponentId> componentIds_{};
     std::unordered_map<ComponentName, std::shared_ptr<IComponentSet>> componentSets_{};
     ComponentId nextComponentId_ = 0;
+    std::vector<std::unique_ptr<Archetype>> archetypes_;
+    std::unordered_map<ComponentMask, Archetype *> archetypesByMask_;
+    std::vector<EntityLocation> entityLocations_;
+    std::unordered_map<std::type_index, std::shared_ptr<IQuery>> queries_;
+  };
+
+  /**
+   * The component and resource types which a system reads or writes, it's used by the scheduler to find the systems that could
+   * run in parallel.
+   *
+   * A system without the declared access is exclusive: it conflicts with all other systems and runs at the thread which
+   * updates the app, this is the safe default for the systems that use the graphics context or other thread-affine states.
+   */
+  class SystemAccess
+  {
+  public:
+    /**
+     * Declare the system reads the component or resource of the given type.
+     */
+    template <typename T>
+    inline void addRead()
+    {
+      declared_ = true;
+      reads_.insert(typeid(T));
+    }
+    /**
+     * Declare the system writes the component or resource of the given type.
+     */
+    template <typename T>
+    inline void addWrite()
+    {
+      declared_ = true;
+      writes_.insert(typeid(T));
+    }
+    /**
+     * @returns `true` if the access is declared, otherwise the system is exclusive.
+     */
+    inline bool isDeclared() const
+    {
+      return declared_;
+    }
+    /**
+     * Check if this access conflicts with another one, namely one of them writes a type that the other reads or writes, or
+     * one of them is exclusive.
+     *
+     * @param other The access to check.
+     * @returns `true` if the two accesses conflict.
+     */
+    bool conflictsWith(const SystemAccess &other) const;
+    /**
+     * Merge the access of another system, it's used to compute the access of a chain of systems. The merged access is exclusive
+     * if any of them is exclusive.
+     *
+     * @param other The access to merge.
+     */
+    void merge(const SystemAccess &other);
+
+  private:
+    bool declared_ = false;
+    std::set<std::type_index> reads_;
+    std::set<std::type_index> writes_;
   };
 
   class ISystemSet
@@ -548,12 +871,30 @@ namespace builtin_scene::ecs
     /**
      * Run all systems in the set once.
      *
-     * This method should be called in the main loop of the app.
+     * This method should be called in the main loop of the app. When a task pool is given, the systems are scheduled by their
+     * declared access: the systems that conflict run in the order of being added, and the others run in parallel on the pool.
+     * The exclusive systems always run at the calling thread.
+     *
+     * @param taskPool The task pool to run the systems in parallel, or nullptr to run them sequentially.
      */
-    void run();
+    void run(TaskPool *taskPool = nullptr);
+
+  private:
+    void runInParallel(TaskPool &taskPool);
+    void updateDependencies();
 
   protected:
     std::vector<std::shared_ptr<System>> systems_;
+
+  private:
+    /**
+     * The systems that must finish before the system at the same index, it's updated when the systems are changed.
+     */
+    std::vector<std::vector<size_t>> dependents_;
+    std::vector<size_t> dependenciesCount_;
+    std::vector<bool> exclusive_;
+    bool hasParallelSystems_ = false;
+    bool dependenciesDirty_ = true;
   };
 
   template <typename L>
@@ -615,6 +956,18 @@ namespace builtin_scene::ecs
     template <typename QueryComponentType, typename IncludeComponentType>
     [[nodiscard]] std::vector<std::pair<EntityId, std::shared_ptr<IncludeComponentType>>> queryEntitiesWithComponent(
       std::function<bool(const QueryComponentType &)> filter = nullptr);
+    /**
+     * Iterate all entities which have all the given component types via the cached query, it doesn't allocate the result list
+     * and visits the components without hashing or reference counting.
+     *
+     * NOTE: The entities are visited grouped by archetype rather than in the spawning order, and the function must not call
+     * back into the app, because the entities lock is held during the iteration.
+     *
+     * @tparam ComponentTypes The types of the components to query.
+     * @param fn The function to call with the entity Id and the references to the components.
+     */
+    template <typename... ComponentTypes, typename Fn>
+    void forEach(Fn fn);
     /**
      * Get the first entity with the given component type, or an empty optional if not found.
      *
@@ -766,6 +1119,33 @@ namespace builtin_scene::ecs
      * @param id The Id of the system to remove.
      */
     void removeSystem(SystemId id);
+    /**
+     * Enable the parallel scheduling, the systems with the declared access run in parallel on a work-stealing task pool,
+     * which is also used by the chunked iterations via `parallelForEach()`.
+     *
+     * The pool is created lazily, namely when a system with the declared access is run or the pool is requested, thus an app
+     * whose systems are all exclusive doesn't start the worker threads.
+     *
+     * @param workersCount The count of the worker threads, 0 to use `TaskPool::DefaultWorkersCount()`.
+     */
+    void enableParallelScheduling(size_t workersCount = 0);
+    /**
+     * @returns The task pool of the app which is created at the first call, or nullptr if the parallel scheduling is not
+     * enabled.
+     */
+    TaskPool *taskPool();
+    /**
+     * Iterate all entities which have all the given component types in chunks, the chunks run in parallel on the task pool if
+     * the parallel scheduling is enabled, otherwise it's the same as `forEach()`.
+     *
+     * NOTE: The function must be thread-safe and must not call back into the app.
+     *
+     * @tparam ComponentTypes The types of the components to query.
+     * @param fn The function to call with the entity Id and the references to the components.
+     * @param chunkSize The count of the entities in a chunk.
+     */
+    template <typename... ComponentTypes, typename Fn>
+    void parallelForEach(Fn fn, size_t chunkSize = 256);
 
   protected:
     /**
@@ -791,6 +1171,11 @@ namespace builtin_scene::ecs
     ComponentsManager componentsMgr_;
     std::vector<std::pair<EntityId, std::shared_ptr<Entity>>> entities_;
     std::unordered_map<SchedulerLabel, std::shared_ptr<ISystemSet>> systemSets_{};
+    std::optional<size_t> taskPoolWorkersCount_ = std::nullopt;
+    std::once_flag taskPoolCreated_;
+    std::unique_ptr<TaskPool> taskPool_;
+    // If any system with the declared access is added, the systems are scheduled on the task pool.
+    std::atomic<bool> hasParallelSystems_ = false;
     // mutexes to make the ECS thread-safe.
     std::shared_mutex mutexForEntities_;
     std::shared_mutex mutexForSystems_;
@@ -860,6 +1245,10 @@ namespace builtin_scene::ecs
       next_ = next;
       return next;
     }
+    /**
+     * @returns The access of this system and the systems chained after it.
+     */
+    SystemAccess chainedAccess() const;
 
   protected: // Methods for system implementations.
     /**
@@ -901,6 +1290,58 @@ namespace builtin_scene::ecs
     {
       return connectedApp_->queryEntitiesWithComponent<QueryComponentType, IncludeComponentType>(filter);
     }
+    /**
+     * Iterate all entities which have all the given component types via the cached query.
+     *
+     * @tparam ComponentTypes The types of the components to query.
+     * @param fn The function to call with the entity Id and the references to the components.
+     * @see App::forEach
+     */
+    template <typename... ComponentTypes, typename Fn>
+    inline void forEach(Fn fn)
+    {
+      connectedApp_->forEach<ComponentTypes...>(fn);
+    }
+    /**
+     * Iterate all entities which have all the given component types in chunks on the app's task pool.
+     *
+     * @tparam ComponentTypes The types of the components to query.
+     * @param fn The function to call with the entity Id and the references to the components.
+     * @param chunkSize The count of the entities in a chunk.
+     * @see App::parallelForEach
+     */
+    template <typename... ComponentTypes, typename Fn>
+    inline void parallelForEach(Fn fn, size_t chunkSize = 256)
+    {
+      connectedApp_->parallelForEach<ComponentTypes...>(fn, chunkSize);
+    }
+    /**
+     * @returns The app's task pool, or nullptr if the parallel scheduling is not enabled.
+     */
+    inline TaskPool *taskPool()
+    {
+      return connectedApp_->taskPool();
+    }
+    /**
+     * Declare the system reads the component or resource of the given type, see `SystemAccess`.
+     *
+     * It should be called in the constructor of the system, before it's added to the app.
+     */
+    template <typename T>
+    inline void declareRead()
+    {
+      access_.addRead<T>();
+    }
+    /**
+     * Declare the system writes the component or resource of the given type, see `SystemAccess`.
+     *
+     * It should be called in the constructor of the system, before it's added to the app.
+     */
+    template <typename T>
+    inline void declareWrite()
+    {
+      access_.addWrite<T>();
+    }
     /**
      * Get the first entity with the given component type, or an empty optional if not found.
      *
@@ -1029,6 +1470,7 @@ namespace builtin_scene::ecs
     SystemId id_;
     std::shared_ptr<App> connectedApp_ = nullptr;
     std::shared_ptr<System> next_ = nullptr;
+    SystemAccess access_;
 
   private:
     inline static thread_local TrIdGenerator idGen_ = TrIdGenerator(0, MAX_SYSTEM_ID);
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <string>
+#include <common/debug.hpp>
+
+#include "./ecs_task_pool.hpp"
+
+namespace builtin_scene::ecs
+{
+  using namespace std;
+
+  // The pool and the worker index of the current thread, it's used to push the tasks to the worker's own queue.
+  static thread_local TaskPool *currentPool = nullptr;
+  static thread_local size_t currentWorkerIndex = 0;
+
+  size_t TaskPool::DefaultWorkersCount()
+  {
+    size_t cores = thread::hardware_concurrency();
+    if (cores <= 1)
+      return 1;
+    return min<size_t>(cores - 1, 7);
+  }
+
+  TaskPool::TaskPool(size_t workersCount)
+  {
+    if (workersCount == 0)
+      workersCount = DefaultWorkersCount();
+
+    for (size_t i = 0; i < workersCount; i++)
+      queues_.push_back(make_unique<WorkerQueue>());
+    for (size_t i = 0; i < workersCount; i++)
+      threads_.emplace_back(&TaskPool::workerLoop, this, i);
+  }
+
+  TaskPool::~TaskPool()
+  {
+    {
+      lock_guard<mutex> lock(sleepMutex_);
+      stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto &thread : threads_)
+    {
+      if (thread.joinable())
+        thread.join();
+    }
+  }
+
+  void TaskPool::submit(Task task)
+  {
+    size_t index = currentPool == this
+                     ? currentWorkerIndex
+                     : nextQueue_.fetch_add(1, memory_order_relaxed) % queues_.size();
+
+    // Count the task before pushing it, thus the sleeping workers never miss it.
+    pendingTasks_.fetch_add(1, memory_order_release);
+    {
+      auto &queue = *queues_[index];
+      lock_guard<mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    {
+      lock_guard<mutex> lock(sleepMutex_);
+    }
+    wakeup_.notify_one();
+  }
+
+  bool TaskPool::runPendingTask()
+  {
+    Task task;
+    size_t index = currentPool == this ? currentWorkerIndex : 0;
+    if ((currentPool == this && popTask(index, task)) || stealTask(index, task))
+    {
+      task();
+      return true;
+    }
+    return false;
+  }
+
+  void TaskPool::workerLoop(size_t index)
+  {
+    SET_THREAD_NAME("TrEcsWorker#" + to_string(index));
+    currentPool = this;
+    currentWorkerIndex = index;
+
+    while (true)
+    {
+      Task task;
+      if (popTask(index, task) || stealTask(index, task))
+      {
+        task();
+        continue;
+      }
+
+      unique_lock<mutex> lock(sleepMutex_);
+      wakeup_.wait(lock, [this]()
+                   { return stopping_ || pendingTasks_.load(memory_order_acquire) > 0; });
+      if (stopping_ && pendingTasks_.load(memory_order_acquire) == 0)
+        break;
+    }
+  }
+
+  bool TaskPool::popTask(size_t index, Task &task)
+  {
+    auto &queue = *queues_[index];
+    lock_guard<mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    pendingTasks_.fetch_sub(1, memory_order_relaxed);
+    return true;
+  }
+
+  bool TaskPool::stealTask(size_t thief, Task &task)
+  {
+    for (size_t i = 1; i <= queues_.size(); i++)
+    {
+      auto &queue = *queues_[(thief + i) % queues_.size()];
+      lock_guard<mutex> lock(queue.mutex);
+      if (queue.tasks.empty())
+        continue;
+
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      pendingTasks_.fetch_sub(1, memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace builtin_scene::ecs
+{
+  /**
+   * The work-stealing thread pool to run the systems and the chunked iterations of the ECS.
+   *
+   * Each worker owns a task queue, it pops the tasks from the back of its own queue and steals from the front of the others
+   * when its queue is empty. The thread which waits for the tasks, such as the scheduler or `parallelFor()`, also helps to run
+   * the pending tasks instead of blocking, thus the nested parallel iterations inside a system never deadlock.
+   */
+  class TaskPool
+  {
+  public:
+    using Task = std::function<void()>;
+
+    /**
+     * @returns The default workers count, which leaves a core for the calling thread and is capped to 7 workers.
+     */
+    static size_t DefaultWorkersCount();
+
+  public:
+    /**
+     * Create a new task pool with the given workers count.
+     *
+     * @param workersCount The count of the worker threads, `DefaultWorkersCount()` is used if it's 0.
+     */
+    TaskPool(size_t workersCount = 0);
+    ~TaskPool();
+
+  public:
+    /**
+     * @returns The count of the worker threads.
+     */
+    inline size_t workersCount() const
+    {
+      return threads_.size();
+    }
+    /**
+     * Submit a task to the pool, the task from a worker thread is pushed to the worker's own queue, otherwise the queues are
+     * selected in turn.
+     *
+     * @param task The task to run, it must not throw.
+     */
+    void submit(Task task);
+    /**
+     * Run a pending task at the calling thread if there is any.
+     *
+     * @returns `true` if a task is run, `false` if there are no pending tasks.
+     */
+    bool runPendingTask();
+    /**
+     * Run `fn(index)` for each index in `[0, count)` in parallel, and wait for all of them to finish. The calling thread runs
+     * the first index and helps to run the pending tasks while waiting.
+     *
+     * @param count The count of the indices.
+     * @param fn The function to run for each index, it must be thread-safe and must not throw.
+     */
+    template <typename Fn>
+    void parallelFor(size_t count, Fn &&fn)
+    {
+      if (count == 0)
+        return;
+
+      std::atomic<size_t> remaining = count;
+      for (size_t i = 1; i < count; i++)
+      {
+        submit([&fn, &remaining, i]()
+               {
+                 fn(i);
+                 remaining.fetch_sub(1, std::memory_order_release); });
+      }
+      fn(0);
+      remaining.fetch_sub(1, std::memory_order_release);
+      waitUntil([&remaining]()
+                { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+    /**
+     * Help to run the pending tasks until the given condition is satisfied.
+     *
+     * @param done The condition to stop waiting.
+     */
+    template <typename Done>
+    void waitUntil(Done &&done)
+    {
+      while (!done())
+      {
+        if (!runPendingTask())
+          std::this_thread::yield();
+      }
+    }
+
+  private:
+    struct WorkerQueue
+    {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popTask(size_t index, Task &task);
+    bool stealTask(size_t thief, Task &task);
+
+  private:
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> nextQueue_ = 0;
+    std::atomic<size_t> pendingTasks_ = 0;
+    std::atomic<bool> stopping_ = false;
+    std::mutex sleepMutex_;
+    std::condition_variable wakeup_;
+  };
+}
@@ -0,0 +1,35 @@
+#include "./instance_culling.hpp"
+
+namespace builtin_scene
+{
+  using namespace std;
+
+  bool InstanceBounds::isInFrustum(const glm::vec3 &localMin,
+                                   const glm::vec3 &localMax,
+                                   const glm::mat4 &worldMatrix,
+                                   const FrustumPlanes &frustumPlanes)
+  {
+    if (!box_.has_value() || localMin != localMin_ || localMax != localMax_)
+    {
+      box_.emplace(localMin, localMax, worldMatrix);
+      localMin_ = localMin;
+      localMax_ = localMax;
+      worldMatrix_ = worldMatrix;
+    }
+    else if (worldMatrix != worldMatrix_)
+    {
+      box_->_update(worldMatrix);
+      worldMatrix_ = worldMatrix;
+    }
+    return box_->isInFrustum(frustumPlanes);
+  }
+
+  optional<FrustumPlanes> frustumPlanesForViews(const vector<glm::mat4> &viewProjectionMatrices)
+  {
+    if (viewProjectionMatrices.empty())
+      return nullopt;
+    if (viewProjectionMatrices.size() == 1)
+      return math3d::TrFrustum::GetPlanes(viewProjectionMatrices.front());
+    return math3d::TrFrustum::GetStereoscopicPlanes(viewProjectionMatrices.front(), viewProjectionMatrices.back());
+  }
+}
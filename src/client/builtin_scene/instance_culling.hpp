@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <glm/glm.hpp>
+#include <common/math3d/frustum.hpp>
+#include <common/collision/culling/bounding_box.hpp>
+
+namespace builtin_scene
+{
+  using FrustumPlanes = std::array<math3d::TrPlane, 6>;
+
+  /**
+   * The counts of the instances in the last culling.
+   */
+  struct InstanceCullingStats
+  {
+    // The enabled instances which are in the view frustum and submitted to draw.
+    size_t submitted = 0;
+    // The enabled instances which are out of the view frustum.
+    size_t culled = 0;
+
+    inline InstanceCullingStats &operator+=(const InstanceCullingStats &other)
+    {
+      submitted += other.submitted;
+      culled += other.culled;
+      return *this;
+    }
+  };
+
+  /**
+   * The world-space bounds of an instance for the frustum culling.
+   *
+   * The world-space bounding box is recomputed only when the world matrix or the mesh's local bounds are changed, thus the
+   * instances which are not moved only test the planes.
+   */
+  class InstanceBounds
+  {
+  public:
+    InstanceBounds() = default;
+
+  public:
+    /**
+     * Test if the instance is in the view frustum.
+     *
+     * @param localMin The minimum corner of the mesh's local bounds.
+     * @param localMax The maximum corner of the mesh's local bounds.
+     * @param worldMatrix The world matrix of the instance.
+     * @param frustumPlanes The planes of the view frustum.
+     * @returns Whether the instance intersects or is inside the view frustum.
+     */
+    bool isInFrustum(const glm::vec3 &localMin,
+                     const glm::vec3 &localMax,
+                     const glm::mat4 &worldMatrix,
+                     const FrustumPlanes &frustumPlanes);
+
+  private:
+    std::optional<collision::culling::TrBoundingBox> box_;
+    glm::vec3 localMin_;
+    glm::vec3 localMax_;
+    glm::mat4 worldMatrix_;
+  };
+
+  /**
+   * Get the planes of the view frustum which covers all the given views, the views are expected to be the eyes of a stereo
+   * rig, thus the left and right planes are taken from the first and the last views.
+   *
+   * @param viewProjectionMatrices The view projection matrices of the views.
+   * @returns The frustum planes, or `std::nullopt` if there is no view.
+   */
+  std::optional<FrustumPlanes> frustumPlanesForViews(const std::vector<glm::mat4> &viewProjectionMatrices);
+}
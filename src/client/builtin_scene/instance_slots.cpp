@@ -0,0 +1,62 @@
+#include <algorithm>
+
+#include "./instance_slots.hpp"
+
+namespace builtin_scene
+{
+  using namespace std;
+
+  void InstanceDirtySlots::mark(size_t slot)
+  {
+    if (all_)
+      return;
+    if (slot >= marked_.size())
+      marked_.resize(slot + 1, false);
+    if (marked_[slot])
+      return;
+
+    marked_[slot] = true;
+    slots_.push_back(slot);
+  }
+
+  void InstanceDirtySlots::markAll()
+  {
+    clear();
+    all_ = true;
+  }
+
+  const vector<InstanceSlotRange> &InstanceDirtySlots::takeRanges(size_t count)
+  {
+    ranges_.clear();
+    if (all_)
+    {
+      if (count > 0)
+        ranges_.push_back({0, count});
+      all_ = false;
+      return ranges_;
+    }
+
+    sort(slots_.begin(), slots_.end());
+    for (auto slot : slots_)
+    {
+      marked_[slot] = false;
+      if (slot >= count)
+        continue;
+
+      if (!ranges_.empty() && slot <= ranges_.back().end() + kMaxMergeGap)
+        ranges_.back().count = slot + 1 - ranges_.back().first;
+      else
+        ranges_.push_back({slot, 1});
+    }
+    slots_.clear();
+    return ranges_;
+  }
+
+  void InstanceDirtySlots::clear()
+  {
+    for (auto slot : slots_)
+      marked_[slot] = false;
+    slots_.clear();
+    all_ = false;
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace builtin_scene
+{
+  /**
+   * A contiguous range of the slots in the instance buffer.
+   */
+  struct InstanceSlotRange
+  {
+    size_t first;
+    size_t count;
+
+    inline size_t end() const
+    {
+      return first + count;
+    }
+    inline bool operator==(const InstanceSlotRange &other) const
+    {
+      return first == other.first && count == other.count;
+    }
+  };
+
+  /**
+   * The tracker of the dirty slots of a persistent instance buffer between uploads.
+   *
+   * Each instance owns a stable slot in the buffer, when its data is changed only its slot is marked, then the marked slots are
+   * coalesced into the ranges to upload, thus changing a single instance doesn't re-upload the whole buffer.
+   */
+  class InstanceDirtySlots
+  {
+  public:
+    /**
+     * The maximum count of the clean slots between two dirty slots to be merged into a range, uploading a few clean slots is
+     * cheaper than an extra upload call.
+     */
+    static constexpr size_t kMaxMergeGap = 4;
+
+  public:
+    InstanceDirtySlots() = default;
+
+  public:
+    /**
+     * Mark the slot as dirty, it's a no-op if the slot is already marked.
+     */
+    void mark(size_t slot);
+    /**
+     * Mark all the slots as dirty, it's used when the buffer is reallocated.
+     */
+    void markAll();
+    /**
+     * @returns If there is any dirty slot.
+     */
+    inline bool empty() const
+    {
+      return !all_ && slots_.empty();
+    }
+    /**
+     * Take the dirty ranges within the given count of the slots, and clear the marks.
+     *
+     * @param count The count of the slots in use, the marked slots out of it are dropped.
+     * @returns The sorted and coalesced ranges to upload.
+     */
+    const std::vector<InstanceSlotRange> &takeRanges(size_t count);
+    /**
+     * Clear all the marks.
+     */
+    void clear();
+
+  private:
+    bool all_ = false;
+    std::vector<size_t> slots_;
+    std::vector<bool> marked_;
+    std::vector<InstanceSlotRange> ranges_;
+  };
+}
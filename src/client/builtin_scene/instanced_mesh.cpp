@@ -12,7 +12,7 @@ namespace builtin_scene
     color.g = glm::linearRand(0.0f, 1.0f);
     color.b = glm::linearRand(0.0f, 1.0f);
     color.a = 1.0f;
-    notifyHolders();
+    notifyHolder();
   }
 
   bool Instance::setColor(const glm::vec4 &color, bool &hasChanged)
@@ -24,7 +24,7 @@ namespace builtin_scene
       return false;
 
     data_.color = color;
-    notifyHolders();
+    notifyHolder();
     hasChanged = true;
     return true;
   }
@@ -33,14 +33,14 @@ namespace builtin_scene
   {
     auto &transform = data_.transform;
     transform = glm::translate(transform, glm::vec3(tx, ty, tz));
-    notifyHolders();
+    notifyHolder();
   }
 
   void Instance::scale(float sx, float sy, float sz)
   {
     auto &transform = data_.transform;
     transform = glm::scale(transform, glm::vec3(sx, sy, sz));
-    notifyHolders();
+    notifyHolder();
   }
 
   void Instance::setTransform(const glm::mat4 &transformationMatrix, bool &hasChanged)
@@ -50,7 +50,7 @@ namespace builtin_scene
       return; // Skip if there is no change.
 
     transform = transformationMatrix;
-    notifyHolders();
+    notifyHolder();
     hasChanged = true;
   }
 
@@ -69,7 +69,7 @@ namespace builtin_scene
     data_.texUvOffset = glm::vec2(uvOffset[0], uvOffset[1]);
     data_.texUvScale = glm::vec2(uvScale[0], uvScale[1]);
     data_.texLayerIndex = layerIndex;
-    notifyHolders();
+    notifyHolder();
     hasChanged = true;
   }
 
@@ -78,33 +78,10 @@ namespace builtin_scene
     setTexture({0.0f, 0.0f}, {0.0f, 0.0f}, 0, hasChanged);
   }
 
-  void Instance::addHolder(std::shared_ptr<RenderableInstancesList> holder)
+  void Instance::notifyHolder()
   {
-    // Check if the holder is already added.
-    for (auto &h : holders_)
-    {
-      if (h.lock() == holder)
-        return;
-    }
-
-    // Add the holder.
-    holders_.push_back(holder);
-  }
-
-  void Instance::removeHolder(std::shared_ptr<RenderableInstancesList> holder)
-  {
-    holders_.erase(remove_if(holders_.begin(), holders_.end(), [holder](const weak_ptr<RenderableInstancesList> &h)
-                             { return h.lock() == holder; }),
-                   holders_.end());
-  }
-
-  void Instance::notifyHolders()
-  {
-    for (auto &holder : holders_)
-    {
-      if (auto holderPtr = holder.lock())
-        holderPtr->markAsDirty();
-    }
+    if (holder_ != nullptr)
+      holder_->markSlotAsDirty(slot_);
   }
 
   RenderableInstancesList::RenderableInstancesList(InstanceFilter filter,
@@ -113,113 +90,103 @@ namespace builtin_scene
       : filter(filter)
       , vao(vao)
       , instanceVbo(instanceVbo)
-      , isDirty_(true)
   {
     assert(filter != InstanceFilter::kAll);
   }
 
-  void RenderableInstancesList::update(const InstanceMap &instances, SortingOrder sortingOrder)
+  void RenderableInstancesList::update(SortingOrder sortingOrder)
   {
-    clearInstances(); // Clear the instances first.
+    if (!needsSorting_)
+      return;
+    needsSorting_ = false;
+    if (sortingOrder == SortingOrder::kNone || list_.size() <= 1)
+      return;
 
-    for (auto &[id, instance] : instances)
-    {
-      if (TR_UNLIKELY(instance == nullptr))
-        continue;
-      if (!instance->enabled_)
-        continue;
+    // Sorting the instances by z-index and the sorting order, the stable sorting keeps the slots of the equal instances.
+    stable_sort(list_.begin(), list_.end(), [sortingOrder](const shared_ptr<Instance> &a, const shared_ptr<Instance> &b)
+                {
+                  if (sortingOrder == SortingOrder::kFrontToBack)
+                    return a->zIndex_ < b->zIndex_;
+                  else
+                    return a->zIndex_ > b->zIndex_; });
 
-      if (filter == InstanceFilter::kAll)
-        addInstance(instance);
-      else if (filter == InstanceFilter::kOpaque)
-      {
-        if (instance->isOpaque_)
-          addInstance(instance);
-      }
-      else if (filter == InstanceFilter::kTransparent)
+    // Only the instances which are moved to other slots need to be uploaded.
+    for (size_t slot = 0; slot < list_.size(); slot++)
+    {
+      auto &instance = list_[slot];
+      if (instance->slot_ != slot)
       {
-        if (!instance->isOpaque_)
-          addInstance(instance);
+        instance->slot_ = slot;
+        markSlotAsDirty(slot);
       }
     }
-
-    if (sortingOrder != SortingOrder::kNone && list_.size() > 1)
-    {
-      // Sorting the instances by z-index and the sorting order.
-      sort(list_.begin(), list_.end(), [sortingOrder](const weak_ptr<Instance> &a, const weak_ptr<Instance> &b)
-           {
-             if (auto aPtr = a.lock(); aPtr != nullptr)
-             {
-               if (auto bPtr = b.lock(); bPtr != nullptr)
-               {
-                 if (sortingOrder == SortingOrder::kFrontToBack)
-                   return aPtr->zIndex_ < bPtr->zIndex_;
-                 else if (sortingOrder == SortingOrder::kBackToFront)
-                   return aPtr->zIndex_ > bPtr->zIndex_;
-               }
-             }
-             return false; });
-    }
-    isDirty_ = true;
-  }
-
-  size_t RenderableInstancesList::copyToArrayData(vector<InstanceData> &dst)
-  {
-    size_t len = 0;
-    for (auto &instance : list_)
-    {
-      if (TR_UNLIKELY(instance.expired()))
-        continue;
-      auto instancePtr = instance.lock();
-      if (TR_UNLIKELY(instancePtr == nullptr))
-        continue;
-      dst.push_back(instancePtr->data_);
-      len += 1;
-    }
-    return len * sizeof(InstanceData);
   }
 
   void RenderableInstancesList::beforeInstancedDraw(WebGL2Context &glContext)
   {
-    if (!isDirty_)
+    size_t count = list_.size();
+    if (count == 0 || dirtySlots_.empty())
       return;
 
-    size_t len = 0;
-    vector<InstanceData> array;
-    if ((len = copyToArrayData(array)) > 0)
+    glContext.bindBuffer(WebGLBufferBindingTarget::kArrayBuffer, instanceVbo);
+    if (count > bufferCapacity_)
     {
-      glContext.bindBuffer(WebGLBufferBindingTarget::kArrayBuffer, instanceVbo);
-      glContext.bufferData(WebGLBufferBindingTarget::kArrayBuffer, len, array.data(), WebGLBufferUsage::kDynamicDraw);
+      // Grow the buffer geometrically to avoid reallocating it when adding instances one by one, and the reallocated buffer
+      // needs to be uploaded entirely.
+      bufferCapacity_ = std::max({count, bufferCapacity_ * 2, kMinBufferCapacity});
+      glContext.bufferData(WebGLBufferBindingTarget::kArrayBuffer,
+                           bufferCapacity_ * sizeof(InstanceData),
+                           WebGLBufferUsage::kDynamicDraw);
+      dirtySlots_.markAll();
     }
-    isDirty_ = false;
-  }
 
-  void RenderableInstancesList::afterInstancedDraw(WebGL2Context &glContext)
-  {
+    for (auto &range : dirtySlots_.takeRanges(count))
+    {
+      stagingData_.resize(range.count);
+      for (size_t i = 0; i < range.count; i++)
+        stagingData_[i] = list_[range.first + i]->data_;
+      glContext.bufferSubData(WebGLBufferBindingTarget::kArrayBuffer,
+                              range.first * sizeof(InstanceData),
+                              range.count * sizeof(InstanceData),
+                              stagingData_.data());
+    }
   }
 
-  void RenderableInstancesList::clearInstances()
+  void RenderableInstancesList::afterInstancedDraw(WebGL2Context &glContext)
   {
-    for (auto &instance : list_)
-    {
-      if (TR_UNLIKELY(instance.expired()))
-        continue;
-      auto instancePtr = instance.lock();
-      if (TR_UNLIKELY(instancePtr == nullptr))
-        continue;
-      instancePtr->removeHolder(shared_from_this());
-    }
-    list_.clear();
-    isDirty_ = true;
   }
 
-  void RenderableInstancesList::addInstance(std::shared_ptr<Instance> instance)
+  void RenderableInstancesList::addInstance(shared_ptr<Instance> instance)
   {
     if (TR_UNLIKELY(instance == nullptr))
       return;
+    assert(instance->holder_ == nullptr);
+
+    instance->holder_ = this;
+    instance->slot_ = list_.size();
     list_.push_back(instance);
-    instance->addHolder(shared_from_this());
-    isDirty_ = true;
+    markSlotAsDirty(instance->slot_);
+    markAsNeedsSorting();
+  }
+
+  void RenderableInstancesList::removeInstance(Instance &instance)
+  {
+    assert(instance.holder_ == this);
+    size_t slot = instance.slot_;
+    assert(slot < list_.size() && list_[slot].get() == &instance);
+
+    // Move the last instance into the removed slot to keep the slots contiguous.
+    size_t lastSlot = list_.size() - 1;
+    if (slot != lastSlot)
+    {
+      list_[slot] = list_[lastSlot];
+      list_[slot]->slot_ = slot;
+      markSlotAsDirty(slot);
+      markAsNeedsSorting();
+    }
+    list_.pop_back();
+    instance.holder_ = nullptr;
+    instance.slot_ = 0;
   }
 
   size_t InstancedMeshBase::iterateInstanceAttributes(shared_ptr<WebGLProgram> program,
@@ -282,12 +249,17 @@ namespace builtin_scene
 
   void InstancedMeshBase::iterateInstances(function<bool(ecs::EntityId, Instance &)> callback)
   {
-    shared_lock<shared_mutex> lock(mutex_);
+    // The callback updates the instances and marks their slots in the lists, thus the exclusive lock is required.
+    unique_lock<shared_mutex> lock(mutex_);
     for (auto &[id, instance] : idToInstanceMap_)
     {
-      auto hasChanged = callback(id, *instance);
-      if (hasChanged)
-        markAsDirty();
+      // The changed instance data has been marked by its slot, only the instances to requeue are collected here.
+      callback(id, *instance);
+      if (instance->requeue_)
+      {
+        instance->requeue_ = false;
+        requeuedInstances_.push_back(instance);
+      }
     }
   }
 
@@ -320,17 +292,59 @@ namespace builtin_scene
       throw invalid_argument("The instance with the given entity id already exists.");
 
     auto &instance = idToInstanceMap_[id] = make_shared<Instance>();
-    markAsDirty();
     return *instance;
   }
 
   bool InstancedMeshBase::removeInstance(ecs::EntityId id)
   {
     unique_lock<shared_mutex> lock(mutex_);
-    bool removed = idToInstanceMap_.erase(id) > 0;
-    if (removed)
-      markAsDirty();
-    return removed;
+    auto it = idToInstanceMap_.find(id);
+    if (it == idToInstanceMap_.end())
+      return false;
+
+    // The removed instance is disabled, thus it's not requeued if it's still pending.
+    auto &instance = it->second;
+    instance->enabled_ = false;
+    if (instance->holder_ != nullptr)
+      instance->holder_->removeInstance(*instance);
+    idToInstanceMap_.erase(it);
+    return true;
+  }
+
+  void InstancedMeshBase::setLocalBounds(const glm::vec3 &min, const glm::vec3 &max)
+  {
+    unique_lock<shared_mutex> lock(mutex_);
+    localBounds_ = make_pair(min, max);
+  }
+
+  InstanceCullingStats InstancedMeshBase::cullInstances(const optional<FrustumPlanes> &frustumPlanes)
+  {
+    InstanceCullingStats stats;
+    // The bounds and the culled states of the instances are updated, thus the exclusive lock is required.
+    unique_lock<shared_mutex> lock(mutex_);
+    for (auto &[id, instance] : idToInstanceMap_)
+    {
+      if (!instance->enabled_)
+        continue;
+
+      bool visible = true;
+      if (frustumPlanes.has_value() && localBounds_.has_value())
+      {
+        auto &[localMin, localMax] = localBounds_.value();
+        visible = instance->bounds_.isInFrustum(localMin, localMax, instance->data_.transform, frustumPlanes.value());
+      }
+
+      if (visible)
+        stats.submitted += 1;
+      else
+        stats.culled += 1;
+      if (instance->culled_ == visible)
+      {
+        instance->culled_ = !visible;
+        requeuedInstances_.push_back(instance);
+      }
+    }
+    return stats;
   }
 
   void InstancedMeshBase::setup(shared_ptr<WebGL2Context> glContext,
@@ -349,13 +363,42 @@ namespace builtin_scene
 
   void InstancedMeshBase::updateRenderQueues(bool ignoreDirty)
   {
-    if (!isDirty_ && !ignoreDirty)
+    unique_lock<shared_mutex> lock(mutex_);
+    vector<shared_ptr<Instance>> requeuedInstances;
+    requeuedInstances.swap(requeuedInstances_);
+
+    if (ignoreDirty)
+    {
+      for (auto &[id, instance] : idToInstanceMap_)
+        requeueInstance(instance);
+    }
+    else
+    {
+      for (auto &instance : requeuedInstances)
+        requeueInstance(instance);
+    }
+
+    opaqueInstances_->update();
+    transparentInstances_->update(RenderableInstancesList::SortingOrder::kFrontToBack);
+  }
+
+  void InstancedMeshBase::requeueInstance(shared_ptr<Instance> instance)
+  {
+    RenderableInstancesList *target = nullptr;
+    if (instance->enabled_ && !instance->culled_)
+      target = instance->isOpaque_ ? opaqueInstances_.get() : transparentInstances_.get();
+
+    if (instance->holder_ == target)
+    {
+      // The z-index might be changed.
+      if (target != nullptr)
+        target->markAsNeedsSorting();
       return;
+    }
 
-    shared_lock<shared_mutex> lock(mutex_);
-    opaqueInstances_->update(idToInstanceMap_);
-    transparentInstances_->update(idToInstanceMap_,
-                                  RenderableInstancesList::SortingOrder::kFrontToBack);
-    isDirty_ = false;
+    if (instance->holder_ != nullptr)
+      instance->holder_->removeInstance(*instance);
+    if (target != nullptr)
+      target->addInstance(instance);
   }
 }
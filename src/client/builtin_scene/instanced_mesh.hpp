@@ -2,6 +2,7 @@
 
 #include <concepts>
 #include <unordered_map>
+#include <mutex>
 #include <shared_mutex>
 #include <glm/glm.hpp>
 #include <glm/gtc/random.hpp>
@@ -10,6 +11,8 @@
 #include "./ecs.hpp"
 #include "./meshes/builder.hpp"
 #include "./mesh_base.hpp"
+#include "./instance_slots.hpp"
+#include "./instance_culling.hpp"
 
 namespace builtin_scene
 {
@@ -60,7 +63,7 @@ namespace builtin_scene
     if (PRIV_FIELD != value)                \
     {                                       \
       PRIV_FIELD = value;                   \
-      notifyHolders();                      \
+      requeue_ = true;                      \
       return true;                          \
     }                                       \
     else                                    \
@@ -76,12 +79,8 @@ namespace builtin_scene
 #undef IMPL_SETTER
 
   private:
-    // Add a holder to the instance.
-    void addHolder(std::shared_ptr<RenderableInstancesList> holder);
-    // Remove a holder from the instance.
-    void removeHolder(std::shared_ptr<RenderableInstancesList> holder);
-    // Notify the holders that the instance data is updated.
-    void notifyHolders();
+    // Notify the holder that the instance data is updated, thus only the slot of this instance is uploaded.
+    void notifyHolder();
 
   private:
     InstanceData data_;
@@ -90,7 +89,15 @@ namespace builtin_scene
     uint32_t zIndex_ = 0;
 
   private:
-    std::vector<std::weak_ptr<RenderableInstancesList>> holders_;
+    // The list which holds this instance, the lists are owned by the mesh and outlive its instances.
+    RenderableInstancesList *holder_ = nullptr;
+    // The slot of this instance in the holder's instance buffer.
+    size_t slot_ = 0;
+    // If the instance needs to be moved to another list or re-sorted, it's set when the enabled, opaque or z-index is changed.
+    bool requeue_ = false;
+    // If the instance is out of the view frustum, the culled instance is removed from its list.
+    bool culled_ = false;
+    InstanceBounds bounds_;
   };
 
   enum class InstanceFilter
@@ -101,9 +108,17 @@ namespace builtin_scene
   };
 
   using InstanceMap = std::unordered_map<ecs::EntityId, std::shared_ptr<Instance>>;
-  class RenderableInstancesList : public std::enable_shared_from_this<RenderableInstancesList>
+  /**
+   * The list of the instances to be drawn in a single instanced draw call.
+   *
+   * Each instance in the list owns a stable slot of the persistent instance buffer, the buffer is grown geometrically and only
+   * the dirty slots are uploaded before drawing. Removing an instance moves the last instance into its slot to keep the slots
+   * contiguous, and the sorted lists only upload the instances whose slots are changed by sorting.
+   */
+  class RenderableInstancesList
   {
     friend class Instance;
+    friend class InstancedMeshBase;
 
   public:
     /**
@@ -128,18 +143,17 @@ namespace builtin_scene
     }
     inline bool isDirty() const
     {
-      return isDirty_;
+      return !dirtySlots_.empty() || needsSorting_;
     }
     /**
-     * Update the renderable instances list with the given instances.
+     * Sort the instances if the list is changed since the last update, the instances whose slots are changed are marked as
+     * dirty.
      *
-     * @param instances The instances to update.
      * @param sortingOrder The sorting order of the instances.
      */
-    void update(const InstanceMap &instances, SortingOrder sortingOrder = SortingOrder::kNone);
-    size_t copyToArrayData(vector<InstanceData> &dst);
+    void update(SortingOrder sortingOrder = SortingOrder::kNone);
     /**
-     * Called before the instanced draw.
+     * Called before the instanced draw, it uploads the dirty slots to the instance buffer.
      */
     void beforeInstancedDraw(client_graphics::WebGL2Context &glContext);
     /**
@@ -148,23 +162,37 @@ namespace builtin_scene
     void afterInstancedDraw(client_graphics::WebGL2Context &glContext);
 
   private:
-    // Clear the instances.
-    void clearInstances();
-    // Add an instance to the list.
+    // Add an instance to the end of the list.
     void addInstance(std::shared_ptr<Instance> instance);
-    inline void markAsDirty()
+    // Remove an instance from the list, the last instance is moved into its slot.
+    void removeInstance(Instance &instance);
+    inline void markSlotAsDirty(size_t slot)
+    {
+      dirtySlots_.mark(slot);
+    }
+    inline void markAsNeedsSorting()
     {
-      isDirty_ = true;
+      needsSorting_ = true;
     }
 
   public:
+    /**
+     * The minimum capacity of the instance buffer in slots.
+     */
+    static constexpr size_t kMinBufferCapacity = 64;
+
     InstanceFilter filter;
     std::shared_ptr<client_graphics::WebGLVertexArray> vao;
     std::shared_ptr<client_graphics::WebGLBuffer> instanceVbo;
 
   private:
-    std::vector<std::weak_ptr<Instance>> list_;
-    bool isDirty_ = true;
+    std::vector<std::shared_ptr<Instance>> list_;
+    InstanceDirtySlots dirtySlots_;
+    // The capacity of the allocated instance buffer in slots.
+    size_t bufferCapacity_ = 0;
+    bool needsSorting_ = false;
+    // The reused staging data of the slots to upload.
+    std::vector<InstanceData> stagingData_;
   };
 
   class InstancedMeshBase
@@ -229,6 +257,18 @@ namespace builtin_scene
      * Remove the instance with the given entity id.
      */
     bool removeInstance(ecs::EntityId id);
+    /**
+     * Set the local bounds of the mesh, which are used to compute the world-space bounds of the instances.
+     */
+    void setLocalBounds(const glm::vec3 &min, const glm::vec3 &max);
+    /**
+     * Cull the enabled instances by the view frustum, the instances which become culled or visible are requeued at the next
+     * `updateRenderQueues()`, thus the culled instances are compacted out of the instance buffers.
+     *
+     * @param frustumPlanes The planes of the view frustum, `std::nullopt` means all the instances are visible.
+     * @returns The counts of the submitted and culled instances.
+     */
+    InstanceCullingStats cullInstances(const std::optional<FrustumPlanes> &frustumPlanes);
     inline RenderableInstancesList &getOpaqueInstancesList() const
     {
       return *opaqueInstances_;
@@ -251,17 +291,15 @@ namespace builtin_scene
                std::shared_ptr<client_graphics::WebGLVertexArray> transparentVao,
                std::shared_ptr<client_graphics::WebGLBuffer> transparentInstanceVao);
     /**
-     * Update the internal `idToInstanceMap_` into the opaque and transparent `RenderableInstancesList` the queues.
+     * Move the requeued instances into the opaque and transparent `RenderableInstancesList` queues, and sort the queues.
      *
-     * @param ignoreDirty Whether to ignore the dirty flag, `true` means force update.
+     * @param ignoreDirty Whether to ignore the dirty flag, `true` means requeuing all the instances.
      */
     void updateRenderQueues(bool ignoreDirty = false);
 
   private:
-    inline void markAsDirty()
-    {
-      isDirty_ = true;
-    }
+    // Move the instance into the list it belongs to, it's a no-op if the instance is already there.
+    void requeueInstance(std::shared_ptr<Instance> instance);
 
   protected:
     mutable std::shared_mutex mutex_;
@@ -271,7 +309,9 @@ namespace builtin_scene
 
   private:
     std::weak_ptr<client_graphics::WebGL2Context> glContext_;
-    bool isDirty_ = true;
+    std::optional<std::pair<glm::vec3, glm::vec3>> localBounds_;
+    // The instances whose enabled, opaque or z-index are changed since the last `updateRenderQueues()`.
+    std::vector<std::shared_ptr<Instance>> requeuedInstances_;
   };
 
   /**
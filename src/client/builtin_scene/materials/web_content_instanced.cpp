@@ -76,6 +76,17 @@ namespace builtin_scene::materials
     textureAtlas_->onAfterDraw();
   }
 
+  TextureAtlas::FrameStats WebContentInstancedMaterial::flushTextureUpdates()
+  {
+    if (textureAtlas_ == nullptr)
+      return TextureAtlas::FrameStats();
+
+    textureAtlas_->generateMipmapsIfNeeded();
+    auto stats = textureAtlas_->frameStats();
+    textureAtlas_->resetFrameStats();
+    return stats;
+  }
+
   void WebContentInstancedMaterial::flipTextureByY(bool flip)
   {
     if (flip)
@@ -100,6 +111,7 @@ namespace builtin_scene::materials
       return TextureUpdateStatus::kSkipped; // Just skip when the texture creation is failed.
 
     unsigned char *pixels = nullptr;
+    SkPixmap pixmap;
     int internalformat = WEBGL2_RGBA8;
     WebGLTextureFormat format = WebGLTextureFormat::kRGBA;
     WebGLPixelType pixelType = WebGLPixelType::kUnsignedByte;
@@ -109,7 +121,6 @@ namespace builtin_scene::materials
     if (surface != nullptr)
     {
       SkImageInfo info = surface->imageInfo();
-      SkPixmap pixmap;
       if (surface->peekPixels(&pixmap))
       {
         pixels = (unsigned char *)pixmap.addr();
@@ -148,8 +159,28 @@ namespace builtin_scene::materials
       }
     }
 
-    // Update the texture with the new pixels or the default values.
-    textureAtlas_->updateTexture(*textureRect, pixels, format, pixelType);
+    // Upload the damaged regions only if the pixels are laid out as the texture, otherwise update the whole texture with
+    // the new pixels or the default values.
+    auto &damageTracker = content.textureDamageTracker();
+    if (pixels != nullptr &&
+        pixmap.width() == textureRect->width &&
+        pixmap.height() == textureRect->height &&
+        static_cast<size_t>(pixmap.info().bytesPerPixel()) == TextureAtlas::BytesPerPixel(format, pixelType))
+    {
+      const auto &regions = damageTracker.take(pixmap.width(), pixmap.height());
+      textureAtlas_->updateTextureRegions(*textureRect,
+                                          regions,
+                                          pixels,
+                                          pixmap.rowBytes(),
+                                          pixmap.info().bytesPerPixel(),
+                                          format,
+                                          pixelType);
+    }
+    else
+    {
+      damageTracker.reset();
+      textureAtlas_->updateTexture(*textureRect, pixels, format, pixelType);
+    }
 
     // No matter the texture update is successful or not, we will return the status.
     return TextureUpdateStatus::kSuccess;
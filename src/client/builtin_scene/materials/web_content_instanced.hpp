@@ -65,6 +65,12 @@ namespace builtin_scene::materials
      * @returns The status of the texture update.
      */
     TextureUpdateStatus updateTexture(WebContent &content);
+    /**
+     * Generate the texture atlas' mipmaps once for the updates in this frame, and take the upload counters of this frame.
+     *
+     * @returns The upload counters since the last flush.
+     */
+    TextureAtlas::FrameStats flushTextureUpdates();
 
   public:
     float width() const
@@ -442,6 +442,27 @@ namespace builtin_scene
       return vertices_.size();
     }
 
+    /**
+     * Compute the axis-aligned bounds of the vertices' positions.
+     *
+     * @param min The minimum corner of the bounds.
+     * @param max The maximum corner of the bounds.
+     * @returns `false` if there is no vertex.
+     */
+    bool computeBounds(glm::vec3 &min, glm::vec3 &max) const
+    {
+      if (vertices_.empty())
+        return false;
+
+      min = max = vertices_[0].position;
+      for (auto &vertex : vertices_)
+      {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+      }
+      return true;
+    }
+
     /**
      * Get the stride of the vertex buffer.
      */
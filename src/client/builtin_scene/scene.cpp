@@ -70,6 +70,10 @@ namespace builtin_scene
     addPlugin<WebContentPlugin>();
     addPlugin<WebXRPlugin>();
     addResource(ecs::Resource::Make<Renderer>(glContext_, volumeSize_));
+
+    // The systems run at the scripting thread unless they declare the access, the declared ones and the chunked iterations
+    // run on the task pool, which is created at the first use.
+    enableParallelScheduling();
   }
 
   void Scene::bootstrap()
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "./texture_altas.hpp"
 
 namespace builtin_scene
@@ -6,6 +8,20 @@ namespace builtin_scene
   using namespace glm;
   using namespace client_graphics;
 
+  size_t TextureAtlas::BytesPerPixel(WebGLTextureFormat format, WebGLPixelType pixelType)
+  {
+    size_t channels = format == WebGLTextureFormat::kRGB ? 3 : 4;
+    switch (pixelType)
+    {
+    case WebGLPixelType::kHalfFloat:
+      return channels * 2;
+    case WebGLPixelType::kFloat:
+      return channels * 4;
+    default:
+      return channels;
+    }
+  }
+
   TextureAtlas::TextureAtlas(shared_ptr<WebGL2Context> glContext, WebGLTextureUnit unit, int width, int height)
       : glContext_(glContext)
       , glTexture_(glContext->createTexture())
@@ -126,15 +142,79 @@ namespace builtin_scene
                              format,
                              pixelType,
                              const_cast<unsigned char *>(pixels));
+    glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, nullptr);
 
+    dirtyLayers_ |= 1u << texture.layer;
+    frameStats_.uploadedRegions += 1;
+    if (pixels != nullptr)
+      frameStats_.uploadedBytes += static_cast<size_t>(texture.width) * texture.height * BytesPerPixel(format, pixelType);
+  }
+
+  void TextureAtlas::updateTextureRegions(const Texture &texture,
+                                          const vector<TextureDamageRect> &regions,
+                                          const unsigned char *pixels,
+                                          size_t rowBytes,
+                                          int bytesPerPixel,
+                                          WebGLTextureFormat format,
+                                          WebGLPixelType pixelType)
+  {
+    if (regions.empty() || pixels == nullptr)
+      return;
+
+    auto glContext = glContext_.lock();
+    assert(glContext != nullptr);
+
+    glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, glTexture_);
+    for (const auto &region : regions)
+    {
+      // Pack the region's rows to be tightly aligned, the texture upload doesn't take the source row pitch.
+      size_t regionRowBytes = static_cast<size_t>(region.width) * bytesPerPixel;
+      stagingPixels_.resize(regionRowBytes * region.height);
+      for (int row = 0; row < region.height; row++)
+      {
+        const unsigned char *src = pixels + (region.y + row) * rowBytes + region.x * bytesPerPixel;
+        memcpy(stagingPixels_.data() + row * regionRowBytes, src, regionRowBytes);
+      }
+
+      glContext->texSubImage3D(WebGLTexture3DTarget::kTexture2DArray,
+                               0,
+                               texture.x + region.x,
+                               texture.y + region.y,
+                               texture.layer,
+                               region.width,
+                               region.height,
+                               1,
+                               format,
+                               pixelType,
+                               stagingPixels_.data());
+      frameStats_.uploadedRegions += 1;
+      frameStats_.uploadedBytes += stagingPixels_.size();
+    }
+    glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, nullptr);
+    dirtyLayers_ |= 1u << texture.layer;
+  }
+
+  bool TextureAtlas::generateMipmapsIfNeeded()
+  {
+    if (dirtyLayers_ == 0)
+      return false;
+
+    auto glContext = glContext_.lock();
+    assert(glContext != nullptr);
+
+    glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, glTexture_);
     glContext->generateMipmap(WebGLTextureTarget::kTexture2DArray);
     glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, nullptr);
+    dirtyLayers_ = 0;
+    frameStats_.mipmapGenerations += 1;
+    return true;
   }
 
   void TextureAtlas::onBeforeDraw()
   {
     auto glContext = glContext_.lock();
     assert(glContext != nullptr);
+    generateMipmapsIfNeeded(); // In case of the updates after the last generation.
     glContext->activeTexture(unit_);
     glContext->bindTexture(WebGLTextureTarget::kTexture2DArray, glTexture_);
   }
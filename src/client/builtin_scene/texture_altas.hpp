@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <glm/glm.hpp>
@@ -8,6 +9,8 @@
 #include <client/graphics/webgl_context.hpp>
 #include <idgen.hpp>
 
+#include "./texture_damage.hpp"
+
 namespace builtin_scene
 {
   using Texture = crates::texture_atlas::TextureLayout;
@@ -16,6 +19,23 @@ namespace builtin_scene
     static constexpr int kMaxLayerCount = 8;
     static constexpr int kDefaultSize = 2048;
 
+  public:
+    /**
+     * The counters of the texture uploads since the last `resetFrameStats()`.
+     */
+    struct FrameStats
+    {
+      size_t uploadedBytes = 0;
+      int uploadedRegions = 0;
+      int mipmapGenerations = 0;
+    };
+
+  public:
+    /**
+     * @returns The bytes of each pixel to upload in the given format and pixel type.
+     */
+    static size_t BytesPerPixel(client_graphics::WebGLTextureFormat format, client_graphics::WebGLPixelType pixelType);
+
   public:
     TextureAtlas(std::shared_ptr<client_graphics::WebGL2Context> glContext,
                  client_graphics::WebGLTextureUnit unit = client_graphics::WebGLTextureUnit::kTexture0,
@@ -34,6 +54,36 @@ namespace builtin_scene
                        const unsigned char *pixels,
                        client_graphics::WebGLTextureFormat format = client_graphics::WebGLTextureFormat::kRGBA,
                        client_graphics::WebGLPixelType pixelType = client_graphics::WebGLPixelType::kUnsignedByte);
+    /**
+     * Update the given regions of the texture, the mipmaps are generated at the next `generateMipmapsIfNeeded()`.
+     *
+     * @param texture The texture to update.
+     * @param regions The damaged regions relative to the texture.
+     * @param pixels The pixels of the whole texture.
+     * @param rowBytes The bytes of each row in `pixels`.
+     * @param bytesPerPixel The bytes of each pixel in `pixels`.
+     */
+    void updateTextureRegions(const Texture &texture,
+                              const std::vector<TextureDamageRect> &regions,
+                              const unsigned char *pixels,
+                              size_t rowBytes,
+                              int bytesPerPixel,
+                              client_graphics::WebGLTextureFormat format = client_graphics::WebGLTextureFormat::kRGBA,
+                              client_graphics::WebGLPixelType pixelType = client_graphics::WebGLPixelType::kUnsignedByte);
+    /**
+     * Generate the mipmaps once for all the updates since the last call, it does nothing if there is no update.
+     *
+     * @returns If the mipmaps are generated.
+     */
+    bool generateMipmapsIfNeeded();
+    inline const FrameStats &frameStats() const
+    {
+      return frameStats_;
+    }
+    inline void resetFrameStats()
+    {
+      frameStats_ = FrameStats();
+    }
 
   public:
     void onBeforeDraw();
@@ -46,5 +96,13 @@ namespace builtin_scene
     std::weak_ptr<client_graphics::WebGL2Context> glContext_;
     std::shared_ptr<client_graphics::WebGLTexture> glTexture_;
     std::unique_ptr<crates::texture_atlas::TextureAtlasLayout> handle_;
+    /**
+     * The bits of the layers updated since the last mipmaps generation, `glGenerateMipmap()` always rebuilds all the layers
+     * of a `TEXTURE_2D_ARRAY`, the bits are used to skip the generation when no layer is touched.
+     */
+    uint32_t dirtyLayers_ = 0;
+    FrameStats frameStats_;
+    // The staging buffer to pack a region's rows for uploading, it's reused across the updates.
+    std::vector<unsigned char> stagingPixels_;
   };
 }
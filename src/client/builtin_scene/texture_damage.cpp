@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <climits>
+
+#include "./texture_damage.hpp"
+
+namespace builtin_scene
+{
+  using namespace std;
+
+  namespace
+  {
+    bool intersects(const TextureDamageRect &a, const TextureDamageRect &b)
+    {
+      return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    TextureDamageRect unite(const TextureDamageRect &a, const TextureDamageRect &b)
+    {
+      int left = std::min(a.x, b.x);
+      int top = std::min(a.y, b.y);
+      int right = std::max(a.x + a.width, b.x + b.width);
+      int bottom = std::max(a.y + a.height, b.y + b.height);
+      return {left, top, right - left, bottom - top};
+    }
+  }
+
+  void TextureDamageTracker::addDamage(const TextureDamageRect &rect)
+  {
+    if (fullDamage_ || rect.width <= 0 || rect.height <= 0)
+      return;
+    pending_.push_back(rect);
+  }
+
+  const vector<TextureDamageRect> &TextureDamageTracker::take(int width, int height)
+  {
+    rects_.clear();
+    if (width <= 0 || height <= 0)
+    {
+      pending_.clear();
+      return rects_;
+    }
+
+    if (fullDamage_)
+    {
+      rects_.push_back({0, 0, width, height});
+      fullDamage_ = false;
+      pending_.clear();
+      return rects_;
+    }
+
+    for (const auto &rect : pending_)
+    {
+      int left = std::max(rect.x, 0);
+      int top = std::max(rect.y, 0);
+      int right = std::min(rect.x + rect.width, width);
+      int bottom = std::min(rect.y + rect.height, height);
+      if (right > left && bottom > top)
+        rects_.push_back({left, top, right - left, bottom - top});
+    }
+    pending_.clear();
+
+    uniteOverlappedRects();
+    while (rects_.size() > kMaxDamageRects)
+      mergeClosestRects();
+    return rects_;
+  }
+
+  void TextureDamageTracker::reset()
+  {
+    pending_.clear();
+    rects_.clear();
+    fullDamage_ = true;
+  }
+
+  void TextureDamageTracker::uniteOverlappedRects()
+  {
+    // Unite the overlapped rects until none is overlapped, thus no pixel is uploaded twice.
+    bool united = true;
+    while (united)
+    {
+      united = false;
+      for (size_t i = 0; i < rects_.size() && !united; i++)
+      {
+        for (size_t j = i + 1; j < rects_.size(); j++)
+        {
+          if (intersects(rects_[i], rects_[j]))
+          {
+            rects_[i] = unite(rects_[i], rects_[j]);
+            rects_.erase(rects_.begin() + j);
+            united = true;
+            break;
+          }
+        }
+      }
+    }
+    sort(rects_.begin(), rects_.end(), [](const auto &a, const auto &b)
+         { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+  }
+
+  void TextureDamageTracker::mergeClosestRects()
+  {
+    // The rects are sorted by `y`, merge the adjacent pair whose union adds the least pixels.
+    size_t closest = 0;
+    size_t closestCost = SIZE_MAX;
+    for (size_t i = 0; i + 1 < rects_.size(); i++)
+    {
+      size_t cost = unite(rects_[i], rects_[i + 1]).area() - rects_[i].area() - rects_[i + 1].area();
+      if (cost < closestCost)
+      {
+        closest = i;
+        closestCost = cost;
+      }
+    }
+
+    rects_[closest] = unite(rects_[closest], rects_[closest + 1]);
+    rects_.erase(rects_.begin() + closest + 1);
+    // The union might overlap others.
+    uniteOverlappedRects();
+  }
+}
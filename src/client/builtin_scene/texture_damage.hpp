@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace builtin_scene
+{
+  /**
+   * A rectangle of the damaged pixels, in pixels and relative to the top-left of the content.
+   */
+  struct TextureDamageRect
+  {
+    int x;
+    int y;
+    int width;
+    int height;
+
+    inline size_t area() const
+    {
+      return static_cast<size_t>(width) * height;
+    }
+    inline bool operator==(const TextureDamageRect &other) const
+    {
+      return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+  };
+
+  /**
+   * The tracker of the damaged regions of the content's pixels between texture uploads.
+   *
+   * The painting records the bounds of what it draws, then the upload takes the recorded rects, thus only the repainted
+   * regions are uploaded to the texture atlas without comparing the pixels.
+   */
+  class TextureDamageTracker
+  {
+  public:
+    /**
+     * The maximum number of the damaged rects to return, the closest rects are merged when there are more.
+     */
+    static constexpr size_t kMaxDamageRects = 4;
+
+  public:
+    TextureDamageTracker() = default;
+
+  public:
+    /**
+     * Record a damaged rect in pixels, the empty rect is ignored.
+     *
+     * @param rect The painted bounds in pixels.
+     */
+    void addDamage(const TextureDamageRect &rect);
+    /**
+     * Take the damaged rects since the last take, the rects are clipped by the content size and the overlapped rects are
+     * united.
+     *
+     * It returns the full rect if the tracker is reset.
+     *
+     * @param width The width of the content in pixels.
+     * @param height The height of the content in pixels.
+     * @returns The damaged rects, it's empty if nothing is painted.
+     */
+    const std::vector<TextureDamageRect> &take(int width, int height);
+    /**
+     * Mark the whole content as damaged, it's used when the texture is moved in the atlas or the content is cleared.
+     */
+    void reset();
+    /**
+     * @returns If there is any damage to upload.
+     */
+    inline bool hasDamage() const
+    {
+      return fullDamage_ || !pending_.empty();
+    }
+
+  private:
+    void uniteOverlappedRects();
+    void mergeClosestRects();
+
+  private:
+    std::vector<TextureDamageRect> pending_;
+    std::vector<TextureDamageRect> rects_;
+    bool fullDamage_ = true;
+  };
+}
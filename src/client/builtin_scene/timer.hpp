@@ -43,7 +43,12 @@ namespace builtin_scene
   class TimerSystem : public ecs::System
   {
   public:
-    using ecs::System::System;
+    TimerSystem()
+        : ecs::System()
+    {
+      // It only updates the timer, thus it could run in parallel with the systems that don't use the timer.
+      declareWrite<Timer>();
+    }
 
   public:
     const std::string name() const override
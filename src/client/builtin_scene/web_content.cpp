@@ -183,10 +183,18 @@ namespace builtin_scene
       }
     }
 
-    // Mark the content as dirty if setting a new style.
+    // Mark the content as dirty and drop the shaped paragraph if setting a new style.
+    resetParagraphCache();
     setDirty(true);
   }
 
+  void WebContent::addDamage(const SkRect &rect)
+  {
+    // The canvas is translated by the texture pad, see `canvas()`.
+    SkIRect bounds = rect.makeOffset(texture_pad_, texture_pad_).roundOut();
+    texture_damage_tracker_.addDamage({bounds.x(), bounds.y(), bounds.width(), bounds.height()});
+  }
+
   // TODO(yorkie): consider the change of the device pixel ratio.
   bool WebContent::needsResize(float w, float h) const
   {
@@ -207,6 +215,7 @@ namespace builtin_scene
       {
         textureAtlas.removeTexture(*texture_);
         texture_ = nullptr;
+        texture_damage_tracker_.reset();
       }
       return nullptr;
     }
@@ -214,15 +223,46 @@ namespace builtin_scene
     float w = physicalWidth();
     float h = physicalHeight();
 
+    auto lastTexture = texture_;
     if (texture_ == nullptr)
       texture_ = textureAtlas.addTexture(w, h, true);
     else
       texture_ = textureAtlas.resizeTexture(texture_, w, h, true);
 
+    // The new texture region has nothing uploaded, thus the next upload must be the full content.
+    if (texture_ != lastTexture)
+      texture_damage_tracker_.reset();
+
     assert(texture_ != nullptr && "The texture must be valid.");
     return texture_;
   }
 
+  skia::textlayout::Paragraph &WebContent::layoutParagraph(const string &text, SkScalar layoutWidth)
+  {
+    auto &cache = paragraph_cache_;
+    if (cache.paragraph == nullptr || cache.text != text)
+    {
+      auto style = paragraphStyle();
+      auto paragraphBuilder = skia::textlayout::ParagraphBuilder::make(style,
+                                                                       TrClientContextPerProcess::Get()->getFontCacheManager());
+      paragraphBuilder->pushStyle(style.getTextStyle());
+      paragraphBuilder->addText(text.c_str(), text.size());
+      paragraphBuilder->pop();
+
+      cache.paragraph = paragraphBuilder->Build();
+      cache.text = text;
+      cache.layoutWidth = -1.0f;
+    }
+
+    // Laying out again in a new width only breaks the lines, Skia reuses the shaping results of the paragraph.
+    if (cache.layoutWidth != layoutWidth)
+    {
+      cache.paragraph->layout(layoutWidth);
+      cache.layoutWidth = layoutWidth;
+    }
+    return *cache.paragraph;
+  }
+
   skia::textlayout::TextStyle WebContent::textStyle() const
   {
     const WebContentTextStyle &sourceTextStyle = content_style_.textStyle;
@@ -300,4 +340,13 @@ namespace builtin_scene
     newParagraphStyle.setTextHeightBehavior(content_style_.textHeightBehavior);
     return newParagraphStyle;
   }
+
+  void WebContentContext::flushRasterStats()
+  {
+    auto clientContext = TrClientContextPerProcess::Get();
+    if (clientContext != nullptr)
+      clientContext->getPerfFs().setWebContentRaster(rasterDuration_, rasterContents_);
+    rasterDuration_ = 0.0;
+    rasterContents_ = 0;
+  }
 }
@@ -14,6 +14,7 @@
 
 #include "./ecs-inl.hpp"
 #include "./texture_altas.hpp"
+#include "./texture_damage.hpp"
 
 namespace builtin_scene
 {
@@ -94,6 +95,36 @@ namespace builtin_scene
     bool applyRoundingHack;
   };
 
+  /**
+   * The cache of the shaped paragraph of a text content, it's dropped when it's copied because the paragraph is not copyable.
+   */
+  class WebContentParagraphCache
+  {
+  public:
+    WebContentParagraphCache() = default;
+    WebContentParagraphCache(const WebContentParagraphCache &)
+    {
+    }
+    WebContentParagraphCache &operator=(const WebContentParagraphCache &)
+    {
+      reset();
+      return *this;
+    }
+
+  public:
+    inline void reset()
+    {
+      paragraph = nullptr;
+      text.clear();
+      layoutWidth = -1.0f;
+    }
+
+  public:
+    std::unique_ptr<skia::textlayout::Paragraph> paragraph;
+    std::string text;
+    SkScalar layoutWidth = -1.0f;
+  };
+
   class WebContent : public ecs::Component
   {
     friend class web_renderer::RenderBackgroundSystem;
@@ -189,6 +220,26 @@ namespace builtin_scene
      * @returns The texture or `nullptr` if the texture is not used.
      */
     std::shared_ptr<Texture> resizeOrInitTexture(TextureAtlas &textureAtlas);
+    /**
+     * The tracker of the damaged regions since the last texture upload, it's reset when the texture is moved in the atlas.
+     */
+    inline TextureDamageTracker &textureDamageTracker()
+    {
+      return texture_damage_tracker_;
+    }
+    /**
+     * Record the bounds which are painted at the canvas, thus only the painted regions are uploaded to the texture.
+     *
+     * @param rect The painted bounds in the canvas coordinates.
+     */
+    void addDamage(const SkRect &rect);
+    /**
+     * Record the whole content as painted, it's used when the canvas is cleared.
+     */
+    inline void addFullDamage()
+    {
+      texture_damage_tracker_.reset();
+    }
     inline void setEnabled(bool enabled)
     {
       enabled_ = enabled;
@@ -239,6 +290,29 @@ namespace builtin_scene
       is_dirty_ = dirty;
     }
 
+    /**
+     * Get the paragraph of the text laid out in the given width.
+     *
+     * The shaped paragraph is cached by the text until the style is changed, thus the text measuring in layout is reused by
+     * the painting, and only the lines are broken again when the width is changed.
+     *
+     * @param text The text content.
+     * @param layoutWidth The width to lay out the paragraph.
+     * @returns The laid out paragraph, which is valid until the next call or the cache is reset.
+     */
+    skia::textlayout::Paragraph &layoutParagraph(const std::string &text, SkScalar layoutWidth);
+    /**
+     * @returns The paragraph laid out by the last `layoutParagraph()` call, or nullptr if the cache is reset.
+     */
+    inline skia::textlayout::Paragraph *cachedParagraph() const
+    {
+      return paragraph_cache_.paragraph.get();
+    }
+    inline void resetParagraphCache()
+    {
+      paragraph_cache_.reset();
+    }
+
   public:
     skia::textlayout::TextStyle textStyle() const;
     skia::textlayout::StrutStyle structStyle() const;
@@ -254,6 +328,8 @@ namespace builtin_scene
     glm::vec4 background_color_;
 
     std::shared_ptr<Texture> texture_;
+    TextureDamageTracker texture_damage_tracker_;
+    WebContentParagraphCache paragraph_cache_;
     float device_pixel_ratio_ = 1.0f;
     int texture_pad_ = 2;
     bool enabled_ = true;
@@ -272,9 +348,23 @@ namespace builtin_scene
     {
       return instancedMeshEntity_;
     }
+    /**
+     * Add the duration in milliseconds and the count of the rasterized contents of a render system in this frame.
+     */
+    inline void addRasterStats(double duration, int contents)
+    {
+      rasterDuration_ += duration;
+      rasterContents_ += contents;
+    }
+    /**
+     * Report the raster stats of this frame to the performance values, and reset them for the next frame.
+     */
+    void flushRasterStats();
 
   private:
     ecs::EntityId instancedMeshEntity_;
+    double rasterDuration_ = 0.0;
+    int rasterContents_ = 0;
   };
 
   /**
@@ -301,10 +391,32 @@ namespace builtin_scene
       using ecs::System::System;
 
     public:
-      void onExecute() override final;
+      void onExecute() override;
 
     protected:
+      /**
+       * Prepare the dirty content at the scripting thread before rendering, such as shaping the text which uses the shared font
+       * collection.
+       *
+       * @returns `false` to skip rendering the content in this frame.
+       */
+      virtual bool prepare(ecs::EntityId entity, WebContent &content)
+      {
+        return true;
+      }
+      /**
+       * Render the dirty content, it runs on the app's task pool when `rasterInParallel()` returns true, thus it must only write
+       * to the given content and its own canvas.
+       */
       virtual void render(ecs::EntityId entity, WebContent &content) = 0;
+      /**
+       * @returns If the contents are rasterized in parallel, each content owns its `SkSurface` thus the raster jobs are
+       *          independent.
+       */
+      virtual bool rasterInParallel() const
+      {
+        return true;
+      }
 
     protected:
       /**
@@ -316,11 +428,7 @@ namespace builtin_scene
       template <typename ComponentType>
       std::shared_ptr<ComponentType> getInstancedMeshComponent()
       {
-        if (webContentCtx_ == nullptr)
-          webContentCtx_ = getResource<WebContentContext>();
-        assert(webContentCtx_ != nullptr && "The WebContentContext must be valid.");
-
-        auto entity = webContentCtx_->instancedMeshEntity();
+        auto entity = webContentContext()->instancedMeshEntity();
         return getComponent<ComponentType>(entity);
       }
       /**
@@ -336,9 +444,18 @@ namespace builtin_scene
         assert(component != nullptr && "The instanced mesh component must be valid.");
         return *component;
       }
+      const std::shared_ptr<WebContentContext> &webContentContext()
+      {
+        if (webContentCtx_ == nullptr)
+          webContentCtx_ = getResource<WebContentContext>();
+        assert(webContentCtx_ != nullptr && "The WebContentContext must be valid.");
+        return webContentCtx_;
+      }
 
     private:
       std::shared_ptr<WebContentContext> webContentCtx_;
+      // The dirty contents to render in this frame, it's reused across frames to avoid the allocations.
+      std::vector<std::pair<ecs::EntityId, WebContent *>> dirtyContents_;
     };
 
     /**
@@ -400,6 +517,7 @@ namespace builtin_scene
       }
 
     private:
+      bool prepare(ecs::EntityId entity, WebContent &content) override;
       void render(ecs::EntityId entity, WebContent &content) override;
 
     private:
@@ -407,8 +525,6 @@ namespace builtin_scene
 
     private:
       TrClientContextPerProcess *clientContext_;
-      sk_sp<skia::textlayout::FontCollection> fontCollection_;
-      std::unique_ptr<skia::textlayout::ParagraphBuilder> paragraphBuilder_;
     };
 
     class UpdateTextureSystem final : public RenderBaseSystem
@@ -421,9 +537,16 @@ namespace builtin_scene
       {
         return "web_render.UpdateTextureSystem";
       }
+      void onExecute() override;
 
     public:
       void render(ecs::EntityId entity, WebContent &content) override;
+
+    protected:
+      bool rasterInParallel() const override
+      {
+        return false; // The texture uploads use the GL context at the scripting thread.
+      }
     };
   }
 
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <optional>
 #include <assert.h>
 #include <skia/include/core/SkCanvas.h>
@@ -47,15 +49,49 @@ namespace builtin_scene::web_renderer
       Transform::FromXYZ(0.0f, 0.0f, 0.0f));
   }
 
+  // The minimum count of the dirty contents to rasterize on the task pool, the fewer ones are rasterized at the scripting thread
+  // because the scheduling costs more than the raster.
+  constexpr size_t kMinParallelRasterContents = 4;
+
   void RenderBaseSystem::onExecute()
   {
-    auto list = queryEntitiesWithComponent<WebContent>([](const WebContent &content) -> bool
-                                                       { return content.canvas() != nullptr && content.isDirty(); });
-    if (list.size() == 0)
+    dirtyContents_.clear();
+    forEach<WebContent>([this](ecs::EntityId entity, WebContent &content)
+                        {
+                          if (content.canvas() != nullptr && content.isDirty())
+                            dirtyContents_.push_back({entity, &content}); });
+    if (dirtyContents_.size() == 0)
+      return;
+
+    // Prepare out of the iteration, because the preparing reads other components from the app.
+    auto last = remove_if(dirtyContents_.begin(), dirtyContents_.end(), [this](const auto &item)
+                          { return !prepare(item.first, *item.second); });
+    dirtyContents_.erase(last, dirtyContents_.end());
+    if (dirtyContents_.size() == 0)
+      return;
+
+    if (!rasterInParallel())
+    {
+      for (auto &item : dirtyContents_)
+        render(item.first, *item.second);
       return;
+    }
 
-    for (auto &item : list)
-      render(item.first, *item.second);
+    // Each content owns its surface, thus the contents are rasterized in parallel and joined before the texture uploads.
+    auto rasterStart = chrono::steady_clock::now();
+    auto pool = dirtyContents_.size() >= kMinParallelRasterContents ? taskPool() : nullptr;
+    if (pool != nullptr)
+    {
+      pool->parallelFor(dirtyContents_.size(), [this](size_t i)
+                        { render(dirtyContents_[i].first, *dirtyContents_[i].second); });
+    }
+    else
+    {
+      for (auto &item : dirtyContents_)
+        render(item.first, *item.second);
+    }
+    auto rasterDuration = chrono::duration<double, milli>(chrono::steady_clock::now() - rasterStart);
+    webContentContext()->addRasterStats(rasterDuration.count(), static_cast<int>(dirtyContents_.size()));
   }
 
   optional<SkPaint> drawBackground(SkCanvas *canvas,
@@ -321,6 +357,7 @@ namespace builtin_scene::web_renderer
 
     auto canvas = content.canvas();
     canvas->clear(SK_ColorTRANSPARENT);
+    content.addFullDamage();
 
     float top = 0.0f;
     float left = 0.0f;
@@ -387,6 +424,7 @@ namespace builtin_scene::web_renderer
                             SkSamplingOptions(),
                             nullptr,
                             SkCanvas::kStrict_SrcRectConstraint);
+      content.addDamage(dstRect);
     }
     canvas->restore();
     content.setTextureUsing(true);
@@ -395,28 +433,30 @@ namespace builtin_scene::web_renderer
   RenderTextSystem::RenderTextSystem()
       : RenderBaseSystem()
       , clientContext_(TrClientContextPerProcess::Get())
-      , fontCollection_(clientContext_->getFontCacheManager())
-      , paragraphBuilder_(nullptr)
   {
   }
 
-  void RenderTextSystem::render(ecs::EntityId entity, WebContent &content)
+  bool RenderTextSystem::prepare(ecs::EntityId entity, WebContent &content)
   {
     auto textComponent = getComponent<Text2d>(entity);
     if (textComponent == nullptr)
-      return;
-
-    string &text = textComponent->content;
-    auto paragraphStyle = content.paragraphStyle();
-    auto paragraphBuilder = ParagraphBuilder::make(paragraphStyle, fontCollection_);
-    paragraphBuilder->pushStyle(paragraphStyle.getTextStyle());
-    paragraphBuilder->addText(text.c_str(), text.size());
-    paragraphBuilder->pop();
+      return false;
 
+    // Reuse the paragraph shaped in the text measuring of layout, the shaping uses the shared font collection thus it's done
+    // before the parallel painting.
     auto layoutWidth = round(getLayoutWidthForText(content)) + 1.0f;
-    auto paragraph = paragraphBuilder->Build();
-    paragraph->layout(layoutWidth);
+    content.layoutParagraph(textComponent->content, layoutWidth);
+    return true;
+  }
+
+  void RenderTextSystem::render(ecs::EntityId entity, WebContent &content)
+  {
+    auto paragraph = content.cachedParagraph();
+    if (paragraph == nullptr)
+      return;
+
     paragraph->paint(content.canvas(), 0.0f, 0.0f);
+    content.addDamage(SkRect::MakeWH(paragraph->getMaxWidth(), paragraph->getHeight()));
     content.setTextureUsing(true);
   }
 
@@ -426,6 +466,25 @@ namespace builtin_scene::web_renderer
     return fragment->contentWidth();
   }
 
+  void UpdateTextureSystem::onExecute()
+  {
+    RenderBaseSystem::onExecute();
+    webContentContext()->flushRasterStats();
+
+    auto material3d = getInstancedMeshComponent<MeshMaterial3d>();
+    if (material3d == nullptr)
+      return;
+    auto webContentMaterial = material3d->material<materials::WebContentInstancedMaterial>();
+    if (webContentMaterial == nullptr)
+      return;
+
+    // Generate the mipmaps once after all the contents are uploaded in this frame.
+    auto stats = webContentMaterial->flushTextureUpdates();
+    auto clientContext = TrClientContextPerProcess::Get();
+    if (clientContext != nullptr)
+      clientContext->getPerfFs().setTextureUploads(stats.uploadedBytes, stats.mipmapGenerations);
+  }
+
   void UpdateTextureSystem::render(ecs::EntityId entity, WebContent &content)
   {
     auto material3d = getInstancedMeshComponent<MeshMaterial3d>();
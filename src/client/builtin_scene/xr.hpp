@@ -137,7 +137,13 @@ namespace builtin_scene
 
   class WebXRCollisionBoxSystem : public ecs::System
   {
-    using ecs::System::System;
+  public:
+    WebXRCollisionBoxSystem()
+        : ecs::System()
+    {
+      // It updates the collision box via the session's shared zone, and no graphics context is used.
+      declareWrite<WebXRExperience>();
+    }
 
   public:
     const std::string name() const override
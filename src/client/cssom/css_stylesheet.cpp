@@ -16,6 +16,7 @@ namespace client_cssom
   void CSSStyleSheet::deleteRule(CSSRuleIndex index)
   {
     cssRules_->erase(cssRules_->begin() + index);
+    version_ += 1;
   }
 
   CSSRuleIndex CSSStyleSheet::insertRule(const string &ruleText, CSSRuleIndex index)
@@ -34,5 +35,6 @@ namespace client_cssom
     auto &cssRules = stylesheet.rules();
     for (auto cssRule : cssRules)
       cssRules_->insert(*cssRule);
+    version_ += 1;
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <optional>
 
@@ -29,6 +30,13 @@ namespace client_cssom
     {
       return ownerRule_.lock();
     }
+    /**
+     * @returns The version of the rules, it's increased at each mutation of the rules.
+     */
+    inline uint64_t version() const
+    {
+      return version_;
+    }
 
   public:
     void deleteRule(CSSRuleIndex index);
@@ -40,5 +48,6 @@ namespace client_cssom
     CSSStyleSheetInit init_;
     std::unique_ptr<CSSRuleList> cssRules_;
     std::weak_ptr<rules::CSSImportRule> ownerRule_;
+    uint64_t version_ = 0;
   };
 }
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cctype>
+#include "./selectors/matching.hpp"
+#include "./rule_set.hpp"
+
+namespace client_cssom
+{
+  using namespace std;
+  using namespace crates;
+
+  static string toLowerCase(const string &s)
+  {
+    string lower = s;
+    transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c)
+              { return tolower(c); });
+    return lower;
+  }
+
+  RuleSet::StyleRecalcScope::StyleRecalcScope(RuleSet &ruleSet)
+      : ruleSet_(ruleSet)
+  {
+    ruleSet_.filter_.emplace();
+  }
+
+  RuleSet::StyleRecalcScope::~StyleRecalcScope()
+  {
+    ruleSet_.filter_.reset();
+  }
+
+  void RuleSet::updateIfNeeded(const vector<shared_ptr<CSSStyleSheet>> &styleSheets)
+  {
+    if (!invalidated_ && !isStale(styleSheets))
+      return;
+
+    clear();
+    size_t position = 0;
+    for (auto styleSheet : styleSheets)
+    {
+      const auto &cssRules = styleSheet->cssRules();
+      for (auto rule : cssRules)
+      {
+        auto styleRule = dynamic_pointer_cast<rules::CSSStyleRule>(rule);
+        if (styleRule != nullptr)
+          addRule(styleRule, position);
+        // TODO: handle other types of rules, such as `CSSImportRule`, `CSSMediaRule`, etc.
+        position += 1;
+      }
+      builtSheets_.push_back({styleSheet, styleSheet->version()});
+    }
+    invalidated_ = false;
+  }
+
+  void RuleSet::collectMatchingRules(shared_ptr<dom::HTMLElement> element,
+                                     vector<shared_ptr<rules::CSSStyleRule>> &matchedRules)
+  {
+    assert(element != nullptr);
+    if (filter_.has_value())
+      filter_->setupParentStack(element->getParentNodeAs<dom::HTMLElement>());
+
+    candidates_.clear();
+    if (!element->id.empty())
+    {
+      auto it = idRules_.find(element->id);
+      if (it != idRules_.end())
+        collectFromBucket(it->second, element, candidates_);
+    }
+    for (const auto &className : element->classList())
+    {
+      auto it = classRules_.find(className);
+      if (it != classRules_.end())
+        collectFromBucket(it->second, element, candidates_);
+    }
+    {
+      auto it = tagRules_.find(toLowerCase(element->tagName));
+      if (it != tagRules_.end())
+        collectFromBucket(it->second, element, candidates_);
+    }
+    collectFromBucket(universalRules_, element, candidates_);
+
+    // Apply in the source order, and a rule is matched once even if more than one of its selectors match.
+    sort(candidates_.begin(), candidates_.end(), [](const RuleData *a, const RuleData *b)
+         { return a->position < b->position; });
+    const RuleData *last = nullptr;
+    for (auto ruleData : candidates_)
+    {
+      if (last != nullptr && last->position == ruleData->position)
+        continue;
+      matchedRules.push_back(ruleData->rule);
+      last = ruleData;
+    }
+  }
+
+  void RuleSet::clear()
+  {
+    idRules_.clear();
+    classRules_.clear();
+    tagRules_.clear();
+    universalRules_.clear();
+    invalidationSet_.clear();
+    builtSheets_.clear();
+    selectorsCount_ = 0;
+  }
+
+  void RuleSet::addRule(shared_ptr<rules::CSSStyleRule> rule, size_t position)
+  {
+    for (const auto &selector : rule->selectors())
+    {
+      if (selector.components().empty())
+        continue;
+
+      RuleData ruleData{rule, &selector, position, selectors::collectAncestorHashes(selector)};
+      invalidationSet_.addSelector(selector);
+      selectorsCount_ += 1;
+
+      // Pick the most selective key in the rightmost compound: id > class > tag name.
+      const css2::selectors::Component *idComponent = nullptr;
+      const css2::selectors::Component *classComponent = nullptr;
+      const css2::selectors::Component *tagComponent = nullptr;
+      for (const auto &component : selector.components())
+      {
+        if (component.isCombinator())
+          break;
+        if (component.isId() && idComponent == nullptr)
+          idComponent = &component;
+        else if (component.isClass() && classComponent == nullptr)
+          classComponent = &component;
+        else if (component.isLocalName() && tagComponent == nullptr)
+          tagComponent = &component;
+      }
+
+      if (idComponent != nullptr)
+        idRules_[idComponent->id()].push_back(ruleData);
+      else if (classComponent != nullptr)
+        classRules_[classComponent->name()].push_back(ruleData);
+      else if (tagComponent != nullptr)
+        tagRules_[toLowerCase(tagComponent->name())].push_back(ruleData);
+      else
+        universalRules_.push_back(ruleData);
+    }
+  }
+
+  void RuleSet::collectFromBucket(const vector<RuleData> &bucket,
+                                  shared_ptr<dom::HTMLElement> element,
+                                  vector<const RuleData *> &candidates)
+  {
+    selectors::MatchingContext context;
+    for (const auto &ruleData : bucket)
+    {
+      if (filter_.has_value() && filter_->fastRejectSelector(ruleData.ancestorHashes))
+        continue;
+      if (selectors::matchesSelector(*ruleData.selector, element, context))
+        candidates.push_back(&ruleData);
+    }
+  }
+
+  bool RuleSet::isStale(const vector<shared_ptr<CSSStyleSheet>> &styleSheets) const
+  {
+    if (styleSheets.size() != builtSheets_.size())
+      return true;
+    for (size_t i = 0; i < styleSheets.size(); i++)
+    {
+      const auto &[styleSheet, version] = builtSheets_[i];
+      if (styleSheet != styleSheets[i] || styleSheet->version() != version)
+        return true;
+    }
+    return false;
+  }
+}
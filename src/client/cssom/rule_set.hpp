@@ -0,0 +1,119 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <crates/bindings.hpp>
+#include <client/html/html_element.hpp>
+
+#include "./css_stylesheet.hpp"
+#include "./rules/css_style_rule.hpp"
+#include "./selectors/invalidation_set.hpp"
+#include "./selectors/selector_filter.hpp"
+
+namespace client_cssom
+{
+  /**
+   * A selector of a style rule in the rule set, the `position` is the source order of the rule among all the stylesheets,
+   * which is used to apply the matched rules in order.
+   */
+  struct RuleData
+  {
+    std::shared_ptr<rules::CSSStyleRule> rule;
+    const crates::css2::selectors::Selector *selector;
+    size_t position;
+    selectors::AncestorHashes ancestorHashes;
+  };
+
+  /**
+   * The rule set indexes the style rules of the document's stylesheets by the rightmost compound of each selector, namely the
+   * key which the element to style must have: the id, a class, the tag name or none of them (universal). Thus resolving an
+   * element's style only matches the rules in the buckets of its id, classes and tag name instead of scanning every rule.
+   *
+   * The rule set is rebuilt lazily when the stylesheets are changed.
+   */
+  class RuleSet
+  {
+  public:
+    /**
+     * Enables the selector filter for the style recalculation in the scope, which expects the elements are resolved in the
+     * tree order, the filter is reset when the scope exits.
+     */
+    class StyleRecalcScope
+    {
+    public:
+      StyleRecalcScope(RuleSet &ruleSet);
+      ~StyleRecalcScope();
+
+    private:
+      RuleSet &ruleSet_;
+    };
+
+  public:
+    RuleSet() = default;
+
+  public:
+    /**
+     * Rebuild the rule set if it's invalidated or the given stylesheets are changed.
+     *
+     * @param styleSheets The stylesheets of the document.
+     */
+    void updateIfNeeded(const std::vector<std::shared_ptr<CSSStyleSheet>> &styleSheets);
+    /**
+     * Collect the style rules which match the given element in the source order, each rule is collected at most once.
+     *
+     * @param element The element to match.
+     * @param matchedRules The output list of the matched rules.
+     */
+    void collectMatchingRules(std::shared_ptr<dom::HTMLElement> element,
+                              std::vector<std::shared_ptr<rules::CSSStyleRule>> &matchedRules);
+    /**
+     * Mark the rule set to be rebuilt at the next `updateIfNeeded()`.
+     */
+    inline void invalidate()
+    {
+      invalidated_ = true;
+    }
+    /**
+     * @returns The identifiers which the indexed selectors depend on, it's valid after `updateIfNeeded()`.
+     */
+    inline const selectors::InvalidationSet &invalidationSet() const
+    {
+      return invalidationSet_;
+    }
+    /**
+     * @returns The count of the indexed selectors.
+     */
+    inline size_t size() const
+    {
+      return selectorsCount_;
+    }
+
+  private:
+    void clear();
+    void addRule(std::shared_ptr<rules::CSSStyleRule> rule, size_t position);
+    void collectFromBucket(const std::vector<RuleData> &bucket,
+                           std::shared_ptr<dom::HTMLElement> element,
+                           std::vector<const RuleData *> &candidates);
+    bool isStale(const std::vector<std::shared_ptr<CSSStyleSheet>> &styleSheets) const;
+
+  private:
+    using RuleBuckets = std::unordered_map<std::string, std::vector<RuleData>>;
+
+    RuleBuckets idRules_;
+    RuleBuckets classRules_;
+    RuleBuckets tagRules_;
+    std::vector<RuleData> universalRules_;
+    selectors::InvalidationSet invalidationSet_;
+    size_t selectorsCount_ = 0;
+    bool invalidated_ = true;
+    /**
+     * The stylesheets and their versions when the rule set is built, which are used to detect the changes of the sheets.
+     */
+    std::vector<std::pair<std::shared_ptr<CSSStyleSheet>, uint64_t>> builtSheets_;
+    std::optional<selectors::SelectorFilter> filter_;
+    std::vector<const RuleData *> candidates_;
+  };
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cctype>
+#include "./invalidation_set.hpp"
+
+namespace client_cssom::selectors
+{
+  using namespace std;
+  using namespace crates;
+
+  static string toLowerCase(const string &s)
+  {
+    string lower = s;
+    transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c)
+              { return tolower(c); });
+    return lower;
+  }
+
+  void InvalidationSet::addSelector(const css2::selectors::Selector &selector)
+  {
+    uint8_t flags = kInvalidateSelf;
+    bool subjectHasKey = false;
+
+    for (const auto &component : selector.components())
+    {
+      if (component.isCombinator())
+      {
+        if (component.combinator == css2::selectors::Combinator::kChild ||
+            component.combinator == css2::selectors::Combinator::kDescendant)
+          flags = kInvalidateSubtree;
+        continue;
+      }
+
+      bool isSubject = flags == kInvalidateSelf;
+      if (component.isId())
+        ids_[component.id()] |= flags;
+      else if (component.isClass())
+        classes_[component.name()] |= flags;
+      else if (component.isLocalName())
+        tagNames_[toLowerCase(component.name())] |= flags;
+      else if (component.isPseudoClass())
+      {
+        actionStateFlags_ = static_cast<InvalidationFlags>(actionStateFlags_ | flags);
+        continue;
+      }
+      else
+        continue;
+
+      if (isSubject)
+        subjectHasKey = true;
+    }
+
+    if (!subjectHasKey)
+      hasUniversalSubject_ = true;
+  }
+
+  void InvalidationSet::addSelectorList(const css2::selectors::SelectorList &selectors)
+  {
+    for (const auto &selector : selectors)
+      addSelector(selector);
+  }
+
+  void InvalidationSet::clear()
+  {
+    ids_.clear();
+    classes_.clear();
+    tagNames_.clear();
+    actionStateFlags_ = kInvalidateNone;
+    hasUniversalSubject_ = false;
+  }
+
+  InvalidationFlags InvalidationSet::flagsForId(const string &id) const
+  {
+    return FindFlags(ids_, id);
+  }
+
+  InvalidationFlags InvalidationSet::flagsForClass(const string &className) const
+  {
+    return FindFlags(classes_, className);
+  }
+
+  InvalidationFlags InvalidationSet::flagsForTagName(const string &tagName) const
+  {
+    return FindFlags(tagNames_, toLowerCase(tagName));
+  }
+
+  InvalidationFlags InvalidationSet::flagsForElement(const dom::Element &element) const
+  {
+    uint8_t flags = hasUniversalSubject_ ? kInvalidateSelf : kInvalidateNone;
+    flags |= flagsForTagName(element.tagName);
+    if (!element.id.empty())
+      flags |= flagsForId(element.id);
+    for (const auto &className : element.classList())
+      flags |= flagsForClass(className);
+    return static_cast<InvalidationFlags>(flags);
+  }
+
+  InvalidationFlags InvalidationSet::FindFlags(const FlagsMap &map, const string &key)
+  {
+    auto it = map.find(key);
+    if (it == map.end())
+      return kInvalidateNone;
+    return static_cast<InvalidationFlags>(it->second);
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <crates/bindings.hpp>
+#include <client/dom/element.hpp>
+
+namespace client_cssom::selectors
+{
+  /**
+   * The flags to describe which elements are affected when an identifier of an element is changed.
+   */
+  enum InvalidationFlags : uint8_t
+  {
+    kInvalidateNone = 0,
+    /**
+     * The identifier is in the rightmost compound of a selector, thus only the element itself is affected.
+     */
+    kInvalidateSelf = 1 << 0,
+    /**
+     * The identifier is in an ancestor compound of a selector, e.g. `.dark` in `.dark span`, thus the descendants of the
+     * element are affected.
+     */
+    kInvalidateSubtree = 1 << 1,
+  };
+
+  /**
+   * The invalidation set records the identifiers (ids, classes and tag names) which the selectors depend on, it's used to
+   * find the elements whose styles are affected by a mutation or a stylesheet change instead of restyling all the elements.
+   *
+   * NOTE: The selectors model has no attribute selectors, and the sibling combinators are matched against the element itself
+   * by the matcher, thus the identifiers after a sibling combinator are treated as the element's own identifiers.
+   */
+  class InvalidationSet
+  {
+  public:
+    InvalidationSet() = default;
+
+  public:
+    /**
+     * Record the identifiers of the given selector.
+     *
+     * @param selector The selector to add.
+     */
+    void addSelector(const crates::css2::selectors::Selector &selector);
+    /**
+     * Record the identifiers of all the selectors in the list.
+     *
+     * @param selectors The selector list to add.
+     */
+    void addSelectorList(const crates::css2::selectors::SelectorList &selectors);
+    void clear();
+
+    InvalidationFlags flagsForId(const std::string &id) const;
+    InvalidationFlags flagsForClass(const std::string &className) const;
+    InvalidationFlags flagsForTagName(const std::string &tagName) const;
+    /**
+     * @returns The union of the flags of the element's id, classes and tag name, and `kInvalidateSelf` if there is any
+     *          selector with an universal subject.
+     */
+    InvalidationFlags flagsForElement(const dom::Element &element) const;
+    /**
+     * @returns The flags when the action state of an element is changed, such as `:hover` and `:focus`.
+     */
+    inline InvalidationFlags flagsForActionState() const
+    {
+      return actionStateFlags_;
+    }
+    /**
+     * @returns If there is a selector without any id, class or tag name in its rightmost compound, such as `*` or `:hover`,
+     *          which could match any element.
+     */
+    inline bool hasUniversalSubject() const
+    {
+      return hasUniversalSubject_;
+    }
+    inline bool empty() const
+    {
+      return ids_.empty() && classes_.empty() && tagNames_.empty() && actionStateFlags_ == kInvalidateNone &&
+             !hasUniversalSubject_;
+    }
+
+  private:
+    using FlagsMap = std::unordered_map<std::string, uint8_t>;
+    static InvalidationFlags FindFlags(const FlagsMap &map, const std::string &key);
+
+  private:
+    FlagsMap ids_;
+    FlagsMap classes_;
+    FlagsMap tagNames_;
+    InvalidationFlags actionStateFlags_ = kInvalidateNone;
+    bool hasUniversalSubject_ = false;
+  };
+}
@@ -0,0 +1,147 @@
+#include <cctype>
+#include "./selector_filter.hpp"
+
+namespace client_cssom::selectors
+{
+  using namespace std;
+  using namespace crates;
+
+  // The salts to distinguish the identifiers of the different types with the same name, e.g. `div` and `.div`.
+  constexpr uint32_t kTagNameSalt = 13;
+  constexpr uint32_t kIdSalt = 17;
+  constexpr uint32_t kClassSalt = 19;
+
+  // FNV-1a hash of the name with the salt, 0 is reserved for the unused slot.
+  static uint32_t identifierHash(uint32_t salt, const string &name, bool lowercase = false)
+  {
+    uint32_t hash = 2166136261u ^ salt;
+    for (char c : name)
+    {
+      hash ^= static_cast<uint8_t>(lowercase ? tolower(static_cast<unsigned char>(c)) : c);
+      hash *= 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+  }
+
+  AncestorHashes collectAncestorHashes(const css2::selectors::Selector &selector)
+  {
+    AncestorHashes hashes = {0};
+    size_t count = 0;
+    bool inAncestors = false;
+
+    for (const auto &component : selector.components())
+    {
+      if (count >= kMaxAncestorHashes)
+        break;
+
+      if (component.isCombinator())
+      {
+        if (component.combinator != css2::selectors::Combinator::kChild &&
+            component.combinator != css2::selectors::Combinator::kDescendant)
+          break;
+        inAncestors = true;
+        continue;
+      }
+      if (!inAncestors) // The rightmost compound is matched against the element itself.
+        continue;
+
+      if (component.isLocalName())
+        hashes[count++] = identifierHash(kTagNameSalt, component.name(), true);
+      else if (component.isId())
+        hashes[count++] = identifierHash(kIdSalt, component.id());
+      else if (component.isClass())
+        hashes[count++] = identifierHash(kClassSalt, component.name());
+    }
+    return hashes;
+  }
+
+  SelectorFilter::SelectorFilter()
+  {
+    counters_.fill(0);
+  }
+
+  void SelectorFilter::setupParentStack(shared_ptr<dom::HTMLElement> parent)
+  {
+    // Walk up from the parent until an element in the stack is reached, the stack is always an ancestor chain.
+    vector<shared_ptr<dom::HTMLElement>> missingAncestors;
+    for (auto node = parent; node != nullptr; node = node->getParentNodeAs<dom::HTMLElement>())
+    {
+      while (!parentStack_.empty() && parentStack_.back().depth > node->depth())
+        popParent();
+      if (!parentStack_.empty() && parentStack_.back().element == node)
+        break;
+      if (!parentStack_.empty() && parentStack_.back().depth == node->depth())
+        popParent();
+      missingAncestors.push_back(node);
+    }
+    if (parent == nullptr || (!missingAncestors.empty() && missingAncestors.back()->getParentNodeAs<dom::HTMLElement>() == nullptr))
+    {
+      // The chain reaches the root, thus the remaining frames are not ancestors.
+      while (!parentStack_.empty())
+        popParent();
+    }
+
+    for (auto it = missingAncestors.rbegin(); it != missingAncestors.rend(); it++)
+      pushParent(*it);
+  }
+
+  bool SelectorFilter::fastRejectSelector(const AncestorHashes &hashes) const
+  {
+    for (auto hash : hashes)
+    {
+      if (hash == 0)
+        break;
+      if (!mayContain(hash))
+        return true;
+    }
+    return false;
+  }
+
+  void SelectorFilter::reset()
+  {
+    parentStack_.clear();
+    parentHashes_.clear();
+    counters_.fill(0);
+  }
+
+  void SelectorFilter::pushParent(shared_ptr<dom::HTMLElement> parent)
+  {
+    size_t hashesBegin = parentHashes_.size();
+    collectElementHashes(*parent, parentHashes_);
+    for (size_t i = hashesBegin; i < parentHashes_.size(); i++)
+    {
+      uint32_t hash = parentHashes_[i];
+      for (uint32_t key : {hash & kKeyMask, (hash >> kKeyBits) & kKeyMask})
+      {
+        if (counters_[key] != UINT8_MAX) // Saturated counters are never decreased.
+          counters_[key] += 1;
+      }
+    }
+    parentStack_.push_back({parent, parent->depth(), hashesBegin});
+  }
+
+  void SelectorFilter::popParent()
+  {
+    auto &frame = parentStack_.back();
+    for (size_t i = frame.hashesBegin; i < parentHashes_.size(); i++)
+    {
+      uint32_t hash = parentHashes_[i];
+      for (uint32_t key : {hash & kKeyMask, (hash >> kKeyBits) & kKeyMask})
+      {
+        if (counters_[key] != UINT8_MAX)
+          counters_[key] -= 1;
+      }
+    }
+    parentHashes_.resize(frame.hashesBegin);
+    parentStack_.pop_back();
+  }
+
+  void SelectorFilter::collectElementHashes(const dom::HTMLElement &element, vector<uint32_t> &hashes) const
+  {
+    hashes.push_back(identifierHash(kTagNameSalt, element.tagName, true));
+    if (!element.id.empty())
+      hashes.push_back(identifierHash(kIdSalt, element.id));
+    for (const auto &className : element.classList())
+      hashes.push_back(identifierHash(kClassSalt, className));
+  }
+}
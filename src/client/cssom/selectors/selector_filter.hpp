@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <crates/bindings.hpp>
+#include <client/html/html_element.hpp>
+
+namespace client_cssom::selectors
+{
+  /**
+   * The max count of the ancestor identifier hashes to be checked for a selector, the rest are skipped because the fast reject
+   * already filters out most of the rules with a few hashes.
+   */
+  constexpr size_t kMaxAncestorHashes = 4;
+
+  /**
+   * The hashes of the identifiers (tag, id and classes) which must be present in the ancestors of the matched element, an
+   * unused slot is 0.
+   */
+  using AncestorHashes = std::array<uint32_t, kMaxAncestorHashes>;
+
+  /**
+   * Collect the identifier hashes of the compounds which are matched against the ancestors, namely the compounds after the
+   * child or descendant combinators. It stops at the first sibling or other combinator.
+   *
+   * @param selector The selector to collect.
+   * @returns The hashes of the ancestor identifiers.
+   */
+  AncestorHashes collectAncestorHashes(const crates::css2::selectors::Selector &selector);
+
+  /**
+   * The selector filter is a counting bloom filter of the identifiers of the ancestors of the element to style, it's used to
+   * reject the rules with the descendant or child combinators quickly, e.g. `.sidebar a` is rejected for the elements without
+   * an ancestor of the class `sidebar`.
+   *
+   * It keeps a stack of the ancestors, and the stack is synchronized with the element's parent via `setupParentStack()`. It's
+   * amortized O(1) for the pre-order traversal, where the stack is only pushed and popped by one level at most times.
+   *
+   * NOTE: The filter snapshots the identifiers of the ancestors when they are pushed, thus it must be reset when the DOM is
+   * changed, it's expected to be used in the scope of a style recalculation.
+   */
+  class SelectorFilter
+  {
+  public:
+    SelectorFilter();
+
+  public:
+    /**
+     * Synchronize the ancestors stack to the given parent element.
+     *
+     * @param parent The parent element of the element to style, or nullptr if the element has no parent element.
+     */
+    void setupParentStack(std::shared_ptr<dom::HTMLElement> parent);
+    /**
+     * Check if the selector could be rejected because one of its ancestor identifiers is absent in the ancestors.
+     *
+     * @param hashes The ancestor hashes of the selector.
+     * @returns `true` if the selector never matches, `false` if it might match.
+     */
+    bool fastRejectSelector(const AncestorHashes &hashes) const;
+    /**
+     * Clear the ancestors stack and the filter.
+     */
+    void reset();
+
+  private:
+    void pushParent(std::shared_ptr<dom::HTMLElement> parent);
+    void popParent();
+    void collectElementHashes(const dom::HTMLElement &element, std::vector<uint32_t> &hashes) const;
+    inline bool mayContain(uint32_t hash) const
+    {
+      return counters_[hash & kKeyMask] != 0 && counters_[(hash >> kKeyBits) & kKeyMask] != 0;
+    }
+
+  private:
+    static constexpr uint32_t kKeyBits = 12;
+    static constexpr uint32_t kKeyMask = (1 << kKeyBits) - 1;
+
+    struct ParentStackFrame
+    {
+      std::shared_ptr<dom::HTMLElement> element;
+      uint32_t depth;
+      size_t hashesBegin;
+    };
+
+    std::array<uint8_t, 1 << kKeyBits> counters_;
+    std::vector<ParentStackFrame> parentStack_;
+    std::vector<uint32_t> parentHashes_;
+  };
+}
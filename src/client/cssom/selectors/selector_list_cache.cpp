@@ -0,0 +1,41 @@
+#include "./selector_list_cache.hpp"
+
+namespace client_cssom::selectors
+{
+  using namespace std;
+  using namespace crates;
+
+  SelectorListCache::SelectorListCache(size_t capacity)
+      : capacity_(capacity == 0 ? 1 : capacity)
+  {
+  }
+
+  shared_ptr<const css2::selectors::SelectorList> SelectorListCache::get(const string &selectors)
+  {
+    auto it = map_.find(selectors);
+    if (it != map_.end())
+    {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+
+    auto parsed = css2::parsing::parseSelectors(selectors);
+    if (parsed == nullopt)
+      return nullptr; // The invalid selectors are not cached, they are expected to be rare.
+
+    if (entries_.size() >= capacity_)
+    {
+      map_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(selectors, make_shared<const css2::selectors::SelectorList>(parsed.value()));
+    map_[selectors] = entries_.begin();
+    return entries_.front().second;
+  }
+
+  void SelectorListCache::clear()
+  {
+    entries_.clear();
+    map_.clear();
+  }
+}
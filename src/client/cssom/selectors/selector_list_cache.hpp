@@ -0,0 +1,44 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <crates/bindings.hpp>
+
+namespace client_cssom::selectors
+{
+  /**
+   * The LRU cache of the parsed selector lists by the selectors text, which is used by `querySelector()` and the similar
+   * APIs to skip the parser for the hot selectors.
+   */
+  class SelectorListCache
+  {
+  public:
+    static constexpr size_t kDefaultCapacity = 128;
+
+  public:
+    SelectorListCache(size_t capacity = kDefaultCapacity);
+
+  public:
+    /**
+     * Get the parsed selector list of the given text, it parses and caches the list if it's not in the cache.
+     *
+     * @param selectors The selectors text.
+     * @returns The parsed selector list, or nullptr if the text is not a valid selector list.
+     */
+    std::shared_ptr<const crates::css2::selectors::SelectorList> get(const std::string &selectors);
+    inline size_t size() const
+    {
+      return entries_.size();
+    }
+    void clear();
+
+  private:
+    using Entry = std::pair<std::string, std::shared_ptr<const crates::css2::selectors::SelectorList>>;
+
+    size_t capacity_;
+    std::list<Entry> entries_; // The most recently used entry is at the front.
+    std::unordered_map<std::string, std::list<Entry>::iterator> map_;
+  };
+}
@@ -52,4 +52,19 @@ namespace client_cssom
     }
     return false;
   }
+
+  size_t StyleCache::resetDescendantStyles(shared_ptr<dom::Node> node)
+  {
+    if (TR_UNLIKELY(node == nullptr))
+      return 0;
+
+    size_t count = 0;
+    for (auto childNode : node->childNodes)
+    {
+      if (resetStyle(childNode))
+        count += 1;
+      count += resetDescendantStyles(childNode);
+    }
+    return count;
+  }
 }
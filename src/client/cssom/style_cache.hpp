@@ -17,6 +17,13 @@ namespace client_cssom
     std::shared_ptr<ComputedStyle> createStyle(std::shared_ptr<dom::Node> elementOrTextNode,
                                                bool useElementStyle = true);
     bool resetStyle(std::shared_ptr<dom::Node> elementOrTextNode);
+    /**
+     * Reset the styles of the descendants of the given node, the node's own style is kept.
+     *
+     * @param node The root node of the subtree.
+     * @returns The count of the reset styles.
+     */
+    size_t resetDescendantStyles(std::shared_ptr<dom::Node> node);
 
     inline void invalidateCache()
     {
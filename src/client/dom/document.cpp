@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <client/per_process.hpp>
 #include <client/builtin_scene/ecs-inl.hpp>
@@ -97,8 +98,7 @@ namespace dom
     }
 
     // Clear list and maps.
-    all_elements_list_.clear();
-    element_map_by_id_.clear();
+    elements_index_.clear();
 
     // Update the element list and maps.
     auto initElementsCache = [this](shared_ptr<Node> childNode)
@@ -141,24 +141,30 @@ namespace dom
 
   shared_ptr<Element> Document::getElementById(const string &id)
   {
-    auto it = element_map_by_id_.find(id);
-    if (it != element_map_by_id_.end())
-      return it->second;
-    else
-      return nullptr;
+    return elements_index_.getElementById(id);
   }
 
   std::vector<shared_ptr<Element>> Document::getElementsByClassName(const string &className)
   {
+    // The argument is a space-separated list of classes, the elements must have all of them.
+    std::vector<string> classNames;
+    for (const auto &name : DOMTokenList(className))
+    {
+      if (!name.empty())
+        classNames.push_back(name);
+    }
+    if (classNames.empty())
+      return {};
+    if (classNames.size() == 1)
+      return elements_index_.getElementsByClassName(classNames[0]);
+
     std::vector<shared_ptr<Element>> elements;
-    for (auto element : all_elements_list_)
+    for (auto element : elements_index_.getElementsByClassName(classNames[0]))
     {
-      if (element->hasAttribute("class"))
-      {
-        auto classes = element->getAttribute("class");
-        if (classes.find(className) != std::string::npos)
-          elements.push_back(element);
-      }
+      const auto &classList = element->classList();
+      if (all_of(classNames.begin(), classNames.end(), [&classList](const string &name)
+                 { return classList.contains(name); }))
+        elements.push_back(element);
     }
     return elements;
   }
@@ -166,7 +172,7 @@ namespace dom
   vector<shared_ptr<Element>> Document::getElementsByName(const string &name)
   {
     vector<shared_ptr<Element>> elements;
-    for (auto element : all_elements_list_)
+    for (auto element : elements_index_.all())
     {
       if (element->hasAttribute("name"))
       {
@@ -180,27 +186,20 @@ namespace dom
 
   vector<shared_ptr<Element>> Document::getElementsByTagName(const string &tagName)
   {
-    vector<shared_ptr<Element>> elements;
-    for (auto element : all_elements_list_)
-    {
-      if (element->is(tagName))
-        elements.push_back(element);
-    }
-    return elements;
+    return elements_index_.getElementsByTagName(tagName);
   }
 
   shared_ptr<Element> Document::querySelector(const string &selectors)
   {
-    auto s = crates::css2::parsing::parseSelectors(selectors);
-    if (s == nullopt)
+    auto selectorList = selector_list_cache_.get(selectors);
+    if (selectorList == nullptr)
       throw runtime_error("Failed to parse the CSS selectors: " + selectors);
 
-    auto selectorList = s.value();
-    for (const auto &element : all_elements_list_)
+    for (const auto &element : querySelectorCandidates(*selectorList))
     {
       if (!Node::Is<HTMLElement>(element))
         continue;
-      if (client_cssom::selectors::matchesSelectorList(selectorList, Node::As<HTMLElement>(element)))
+      if (client_cssom::selectors::matchesSelectorList(*selectorList, Node::As<HTMLElement>(element)))
         return element;
     }
     return nullptr;
@@ -208,29 +207,84 @@ namespace dom
 
   NodeList<Element> Document::querySelectorAll(const string &selectors)
   {
-    auto s = crates::css2::parsing::parseSelectors(selectors);
-    if (s == nullopt)
+    auto selectorList = selector_list_cache_.get(selectors);
+    if (selectorList == nullptr)
       throw runtime_error("Failed to parse the CSS selectors: " + selectors);
 
     NodeList<Element> elements(false);
-    auto selectorList = s.value();
-    for (auto element : all_elements_list_)
+    for (const auto &element : querySelectorCandidates(*selectorList))
     {
       if (!Node::Is<HTMLElement>(element))
         continue;
-      if (client_cssom::selectors::matchesSelectorList(selectorList, Node::As<HTMLElement>(element)))
+      if (client_cssom::selectors::matchesSelectorList(*selectorList, Node::As<HTMLElement>(element)))
         elements.push_back(element);
     }
     return elements;
   }
 
+  const ElementsIndex::ElementList &Document::querySelectorCandidates(const crates::css2::selectors::SelectorList &selectors)
+  {
+    // Only a single selector is narrowed down, the list of selectors scans all the elements to keep the results in order.
+    auto it = selectors.begin();
+    if (it == selectors.end() || std::next(it) != selectors.end())
+      return elements_index_.all();
+
+    // Use the most selective key in the rightmost compound: id > class > tag name.
+    const crates::css2::selectors::Component *classComponent = nullptr;
+    const crates::css2::selectors::Component *tagComponent = nullptr;
+    for (const auto &component : it->components())
+    {
+      if (component.isCombinator())
+        break;
+      if (component.isId())
+        return elements_index_.getElementsById(component.id());
+      if (component.isClass() && classComponent == nullptr)
+        classComponent = &component;
+      else if (component.isLocalName() && tagComponent == nullptr)
+        tagComponent = &component;
+    }
+    if (classComponent != nullptr)
+      return elements_index_.getElementsByClassName(classComponent->name());
+    if (tagComponent != nullptr)
+      return elements_index_.getElementsByTagName(tagComponent->name());
+    return elements_index_.all();
+  }
+
   void Document::appendStyleSheet(shared_ptr<client_cssom::CSSStyleSheet> sheet)
   {
     stylesheets_.push_back(sheet);
-    style_cache_.invalidateCache();
+    invalidateStylesForSheet(*sheet);
+    rule_set_.invalidate();
     onStyleSheetsDidChange();
   }
 
+  void Document::invalidateStylesForSheet(const client_cssom::CSSStyleSheet &sheet)
+  {
+    client_cssom::selectors::InvalidationSet invalidationSet;
+    for (auto rule : sheet.cssRules())
+    {
+      auto styleRule = dynamic_pointer_cast<client_cssom::rules::CSSStyleRule>(rule);
+      if (styleRule != nullptr)
+        invalidationSet.addSelectorList(styleRule->selectors());
+    }
+    if (invalidationSet.empty())
+      return;
+    if (invalidationSet.hasUniversalSubject())
+    {
+      style_cache_.invalidateCache();
+      return;
+    }
+
+    for (auto element : elements_index_.all())
+    {
+      auto flags = invalidationSet.flagsForElement(*element);
+      if (flags & client_cssom::selectors::kInvalidateSelf)
+        style_cache_.resetStyle(element);
+      if (flags & client_cssom::selectors::kInvalidateSubtree)
+        style_cache_.resetDescendantStyles(element);
+    }
+  }
+
   void Document::onNodeAdded(const std::shared_ptr<Node> node, bool fast_insert, bool recursive)
   {
     if (TR_UNLIKELY(node == nullptr))
@@ -238,28 +292,8 @@ namespace dom
 
     if (node->isElement())
     {
-      shared_ptr<Element> element = Node::As<Element>(node);
-
-      // Fast inserting elements into the list without checking for duplicates.
-      // FIXME(yorkie): At initialization, we can ensure that the elements are unique.
-      if (fast_insert)
-      {
-        all_elements_list_.push_back(element);
-      }
-      else
-      {
-        // Check if element is already in the list to avoid duplicates
-        auto it = std::find(all_elements_list_.begin(), all_elements_list_.end(), element);
-        if (it == all_elements_list_.end())
-        {
-          // If not, add it to the all elements list
-          all_elements_list_.push_back(element);
-        }
-      }
-
-      // Add the element to the element map by id
-      if (!element->id.empty())
-        element_map_by_id_[element->id] = element;
+      // The index checks the duplicates in O(1), thus the fast inserting is the same as the normal one.
+      elements_index_.add(Node::As<Element>(node));
     }
 
     if (recursive)
@@ -277,16 +311,7 @@ namespace dom
 
     if (node->isElement())
     {
-      shared_ptr<Element> element = Node::As<Element>(node);
-
-      // Remove the element from the all elements list
-      auto it = std::remove(all_elements_list_.begin(), all_elements_list_.end(), element);
-      if (it != all_elements_list_.end())
-        all_elements_list_.erase(it, all_elements_list_.end());
-
-      // Remove the element from the element map by id
-      if (!element->id.empty())
-        element_map_by_id_.erase(element->id);
+      elements_index_.remove(Node::As<Element>(node));
     }
 
     if (recursive)
@@ -297,6 +322,18 @@ namespace dom
     }
   }
 
+  void Document::onElementIdChanged(shared_ptr<Element> element, const string &oldId, const string &newId)
+  {
+    elements_index_.updateId(element, oldId, newId);
+  }
+
+  void Document::onElementClassesChanged(shared_ptr<Element> element,
+                                         const DOMTokenList &oldClassList,
+                                         const DOMTokenList &newClassList)
+  {
+    elements_index_.updateClasses(element, oldClassList, newClassList);
+  }
+
   void Document::openInternal()
   {
     // Connect the window and document before opening this document.
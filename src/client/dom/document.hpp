@@ -9,6 +9,8 @@
 #include <client/browser/window.hpp>
 #include <client/builtin_scene/scene.hpp>
 #include <client/cssom/css_stylesheet.hpp>
+#include <client/cssom/rule_set.hpp>
+#include <client/cssom/selectors/selector_list_cache.hpp>
 #include <client/cssom/style_cache.hpp>
 #include <client/layout/layout_view.hpp>
 #include <client/html/html_head_element.hpp>
@@ -17,6 +19,7 @@
 #include "./node.hpp"
 #include "./node_list.hpp"
 #include "./element.hpp"
+#include "./elements_index.hpp"
 #include "./text.hpp"
 #include "./document_fragment.hpp"
 
@@ -94,10 +97,22 @@ namespace dom
   protected:
     virtual void onDocumentOpened() {};
     virtual void onStyleSheetsDidChange() {};
+    /**
+     * Reset the cached styles of the elements which could be matched by the selectors of the added or removed stylesheet,
+     * and the descendants of the elements matched by the ancestor compounds of the selectors.
+     */
+    void invalidateStylesForSheet(const client_cssom::CSSStyleSheet &sheet);
     void onNodeAdded(const std::shared_ptr<Node>, bool fast_insert, bool recursive);
     void onNodeRemoved(const std::shared_ptr<Node>, bool recursive);
+    // Update the indexes when the id or classes of an indexed element are changed.
+    void onElementIdChanged(std::shared_ptr<Element>, const std::string &oldId, const std::string &newId);
+    void onElementClassesChanged(std::shared_ptr<Element>,
+                                 const DOMTokenList &oldClassList,
+                                 const DOMTokenList &newClassList);
 
   private:
+    // Returns the elements which could match the selectors by the indexes, it's all the elements if not narrowed down.
+    const ElementsIndex::ElementList &querySelectorCandidates(const crates::css2::selectors::SelectorList &selectors);
     bool isDocument() const override final
     {
       return true;
@@ -155,6 +170,15 @@ namespace dom
     {
       return style_cache_;
     }
+    /**
+     * Get the rule set which indexes the style rules of the document's stylesheets.
+     *
+     * TODO: Will be moved to the `DocumentOrShadowRoot` interface.
+     */
+    inline client_cssom::RuleSet &ruleSet()
+    {
+      return rule_set_;
+    }
 
   public:
     /**
@@ -198,8 +222,8 @@ namespace dom
     std::shared_ptr<pugi::xml_document> doc_internal_;
     std::shared_ptr<HTMLHeadElement> head_element_;
     std::shared_ptr<HTMLBodyElement> body_element_;
-    std::vector<std::shared_ptr<Element>> all_elements_list_;
-    std::map<string, std::shared_ptr<Element>> element_map_by_id_;
+    ElementsIndex elements_index_;
+    client_cssom::selectors::SelectorListCache selector_list_cache_;
 
   private:
     bool is_source_loaded_ = false;
@@ -209,6 +233,7 @@ namespace dom
     std::shared_ptr<DocumentTimeline> timeline_;
     std::vector<std::shared_ptr<client_cssom::CSSStyleSheet>> stylesheets_;
     client_cssom::StyleCache style_cache_;
+    client_cssom::RuleSet rule_set_;
   };
 
   class XMLDocument : public Document
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <functional>
 #include <client/per_process.hpp>
 #include <client/builtin_scene/scene.hpp>
@@ -36,17 +37,41 @@ namespace dom
     auto layoutView = document_->layoutView();
     if (root != nullptr)
     {
-      // Compute each element's styles.
-      auto adoptStyleForElement = [this](shared_ptr<HTMLElement> element)
+      // Compute each element's styles, the elements are visited in the tree order thus the selector filter is enabled.
+      int recalcElements = 0;
+      auto recalcStart = chrono::steady_clock::now();
       {
-        element->adoptStyle(document_->defaultView()->getComputedStyle(element));
-        return true;
-      };
-      auto adoptStyleForText = [this](shared_ptr<Text> textNode)
-      {
-        textNode->adoptStyle(document_->defaultView()->getComputedStyle(textNode));
-      };
-      traverseElementOrTextNode(root, adoptStyleForElement, adoptStyleForText, TreverseOrder::PreOrder);
+        client_cssom::RuleSet::StyleRecalcScope recalcScope(document_->ruleSet());
+        auto &styleCache = document_->styleCache();
+        auto adoptStyleForElement = [this, &styleCache, &recalcElements](shared_ptr<HTMLElement> element)
+        {
+          bool isRecomputed = styleCache.findStyle(element) == nullptr;
+          const auto &newStyle = document_->defaultView()->getComputedStyle(element);
+          if (isRecomputed)
+          {
+            // The children inherit from this element's style, thus reset them to recompute if the style is changed.
+            if (!element->hasAdoptedStyle() ||
+                client_cssom::ComputedStyle::ComputeDifference(element->adoptedStyleRef(), newStyle) !=
+                  client_cssom::ComputedStyle::kEqual)
+            {
+              for (auto childNode : element->childNodes)
+                styleCache.resetStyle(childNode);
+            }
+            recalcElements += 1;
+          }
+          element->adoptStyle(newStyle);
+          return true;
+        };
+        auto adoptStyleForText = [this](shared_ptr<Text> textNode)
+        {
+          textNode->adoptStyle(document_->defaultView()->getComputedStyle(textNode));
+        };
+        traverseElementOrTextNode(root, adoptStyleForElement, adoptStyleForText, TreverseOrder::PreOrder);
+      }
+      auto recalcDuration = chrono::duration<double, milli>(chrono::steady_clock::now() - recalcStart);
+      auto clientContext = TrClientContextPerProcess::Get();
+      if (clientContext != nullptr)
+        clientContext->getPerfFs().setStyleRecalc(recalcDuration.count(), recalcElements);
 
       // Compute the layout from the root element.
       // TODO(yorkie): compute the layout from the root?
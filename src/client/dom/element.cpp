@@ -203,11 +203,13 @@ namespace dom
 
   void Element::attributeChangedCallback(const string &name, const string &oldValue, const string &newValue)
   {
-    markAsDirty();
-
     if (name == "id")
     {
       id = newValue;
+      auto ownerDocument = getOwnerDocumentReference();
+      if (ownerDocument != nullptr)
+        ownerDocument->onElementIdChanged(getPtr<Element>(), oldValue, newValue);
+      invalidateStyleForIdChange(oldValue, newValue);
       return;
     }
 
@@ -215,19 +217,46 @@ namespace dom
     {
       auto onClassListChanged = [this](const DOMTokenList &list)
       {
+        DOMTokenList oldClassList(getAttribute("class"));
         setAttribute("class", list.value(), false /* mute */);
+        auto ownerDocument = getOwnerDocumentReference();
+        if (ownerDocument != nullptr)
+          ownerDocument->onElementClassesChanged(getPtr<Element>(), oldClassList, list);
+        invalidateStyleForClassChange(oldClassList, list);
         classListChangedCallback(list);
       };
+      DOMTokenList oldClassList(oldValue);
       classList_ = DOMTokenList(newValue, {}, onClassListChanged);
+      auto ownerDocument = getOwnerDocumentReference();
+      if (ownerDocument != nullptr)
+        ownerDocument->onElementClassesChanged(getPtr<Element>(), oldClassList, classList_);
+      invalidateStyleForClassChange(oldClassList, classList_);
+      return;
     }
+
+    markAsDirty();
   }
 
   void Element::classListChangedCallback(const DOMTokenList &newClassList)
   {
-    markAsDirty();
   }
 
   void Element::actionStateChangedCallback()
+  {
+    invalidateStyleForActionStateChange();
+  }
+
+  void Element::invalidateStyleForIdChange(const string &oldId, const string &newId)
+  {
+    markAsDirty();
+  }
+
+  void Element::invalidateStyleForClassChange(const DOMTokenList &oldClassList, const DOMTokenList &newClassList)
+  {
+    markAsDirty();
+  }
+
+  void Element::invalidateStyleForActionStateChange()
   {
     markAsDirty();
   }
@@ -284,6 +284,24 @@ namespace dom
     virtual void styleAdoptedCallback();
 
   protected:
+    /**
+     * Invalidate the style when the element's id is changed, it marks the element as dirty by default.
+     *
+     * @param oldId The old id of the element.
+     * @param newId The new id of the element.
+     */
+    virtual void invalidateStyleForIdChange(const std::string &oldId, const std::string &newId);
+    /**
+     * Invalidate the style when the element's classes are changed, it marks the element as dirty by default.
+     *
+     * @param oldClassList The class list before the change.
+     * @param newClassList The class list after the change.
+     */
+    virtual void invalidateStyleForClassChange(const DOMTokenList &oldClassList, const DOMTokenList &newClassList);
+    /**
+     * Invalidate the style when the element's action state is changed, it marks the element as dirty by default.
+     */
+    virtual void invalidateStyleForActionStateChange();
     // Initialize the CSS boxes of the element.
     void initCSSBoxes();
     // Set the CSS boxes of the element from the current display style.
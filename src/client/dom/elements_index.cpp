@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cctype>
+
+#include "./element.hpp"
+#include "./elements_index.hpp"
+
+namespace dom
+{
+  using namespace std;
+
+  static string toUpperCase(const string &s)
+  {
+    string upper = s;
+    transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c)
+              { return toupper(c); });
+    return upper;
+  }
+
+  bool ElementsIndex::contains(const Element &element) const
+  {
+    return seqs_.find(element.uid) != seqs_.end();
+  }
+
+  bool ElementsIndex::add(shared_ptr<Element> element)
+  {
+    if (TR_UNLIKELY(element == nullptr) || contains(*element))
+      return false;
+
+    uint64_t seq = nextSeq_++;
+    seqs_[element->uid] = seq;
+    elements_.push_back(element); // The new element always has the largest sequence number.
+
+    if (!element->id.empty())
+      insertToBucket(idBuckets_, element->id, element, seq);
+    for (const auto &className : element->classList())
+      insertToBucket(classBuckets_, className, element, seq);
+    insertToBucket(tagNameBuckets_, toUpperCase(element->tagName), element, seq);
+    return true;
+  }
+
+  bool ElementsIndex::remove(shared_ptr<Element> element)
+  {
+    if (TR_UNLIKELY(element == nullptr))
+      return false;
+
+    auto it = seqs_.find(element->uid);
+    if (it == seqs_.end())
+      return false;
+
+    uint64_t seq = it->second;
+    if (!element->id.empty())
+      removeFromBucket(idBuckets_, element->id, element, seq);
+    for (const auto &className : element->classList())
+      removeFromBucket(classBuckets_, className, element, seq);
+    removeFromBucket(tagNameBuckets_, toUpperCase(element->tagName), element, seq);
+    removeFrom(elements_, element, seq);
+    seqs_.erase(it);
+    return true;
+  }
+
+  void ElementsIndex::clear()
+  {
+    elements_.clear();
+    idBuckets_.clear();
+    classBuckets_.clear();
+    tagNameBuckets_.clear();
+    seqs_.clear();
+  }
+
+  void ElementsIndex::updateId(shared_ptr<Element> element, const string &oldId, const string &newId)
+  {
+    auto it = seqs_.find(element->uid);
+    if (it == seqs_.end() || oldId == newId)
+      return;
+
+    if (!oldId.empty())
+      removeFromBucket(idBuckets_, oldId, element, it->second);
+    if (!newId.empty())
+      insertToBucket(idBuckets_, newId, element, it->second);
+  }
+
+  void ElementsIndex::updateClasses(shared_ptr<Element> element,
+                                    const DOMTokenList &oldClassList,
+                                    const DOMTokenList &newClassList)
+  {
+    auto it = seqs_.find(element->uid);
+    if (it == seqs_.end())
+      return;
+
+    for (const auto &className : oldClassList)
+    {
+      if (!newClassList.contains(className))
+        removeFromBucket(classBuckets_, className, element, it->second);
+    }
+    for (const auto &className : newClassList)
+    {
+      if (!oldClassList.contains(className))
+        insertToBucket(classBuckets_, className, element, it->second);
+    }
+  }
+
+  shared_ptr<Element> ElementsIndex::getElementById(const string &id) const
+  {
+    const auto &list = getElementsById(id);
+    return list.empty() ? nullptr : list.front();
+  }
+
+  const ElementsIndex::ElementList &ElementsIndex::getElementsById(const string &id) const
+  {
+    return FindBucket(idBuckets_, id);
+  }
+
+  const ElementsIndex::ElementList &ElementsIndex::getElementsByClassName(const string &className) const
+  {
+    return FindBucket(classBuckets_, className);
+  }
+
+  const ElementsIndex::ElementList &ElementsIndex::getElementsByTagName(const string &tagName) const
+  {
+    return FindBucket(tagNameBuckets_, toUpperCase(tagName));
+  }
+
+  void ElementsIndex::insertTo(ElementList &list, shared_ptr<Element> element, uint64_t seq)
+  {
+    auto it = lower_bound(list.begin(), list.end(), seq, [this](const shared_ptr<Element> &a, uint64_t b)
+                          { return seqs_.at(a->uid) < b; });
+    if (it != list.end() && *it == element) // The duplicated token, e.g. `class="foo foo"`.
+      return;
+    list.insert(it, element);
+  }
+
+  void ElementsIndex::removeFrom(ElementList &list, const shared_ptr<Element> &element, uint64_t seq)
+  {
+    auto it = lower_bound(list.begin(), list.end(), seq, [this](const shared_ptr<Element> &a, uint64_t b)
+                          { return seqs_.at(a->uid) < b; });
+    if (it != list.end() && *it == element)
+      list.erase(it);
+  }
+
+  void ElementsIndex::insertToBucket(Buckets &buckets, const string &key, shared_ptr<Element> element, uint64_t seq)
+  {
+    insertTo(buckets[key], element, seq);
+  }
+
+  void ElementsIndex::removeFromBucket(Buckets &buckets, const string &key, const shared_ptr<Element> &element, uint64_t seq)
+  {
+    auto it = buckets.find(key);
+    if (it == buckets.end())
+      return;
+
+    removeFrom(it->second, element, seq);
+    if (it->second.empty())
+      buckets.erase(it);
+  }
+
+  const ElementsIndex::ElementList &ElementsIndex::FindBucket(const Buckets &buckets, const string &key)
+  {
+    static const ElementList empty;
+    auto it = buckets.find(key);
+    return it == buckets.end() ? empty : it->second;
+  }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./dom_token_list.hpp"
+
+namespace dom
+{
+  class Element;
+
+  /**
+   * The live indexes of the elements in a document: the list of all elements, and the id, class and tag name to elements
+   * maps, which are updated on the tree mutations and the `id` or `class` attribute changes.
+   *
+   * Each element is assigned an increasing sequence number when it's added, the list and every bucket are kept in the order
+   * of the sequence numbers, thus the results are in the same order as scanning the list of all elements.
+   */
+  class ElementsIndex
+  {
+  public:
+    using ElementList = std::vector<std::shared_ptr<Element>>;
+
+  public:
+    ElementsIndex() = default;
+
+  public:
+    /**
+     * @returns The list of all the indexed elements.
+     */
+    inline const ElementList &all() const
+    {
+      return elements_;
+    }
+    /**
+     * @returns If the element is indexed.
+     */
+    bool contains(const Element &element) const;
+    /**
+     * Add the element to the indexes by its current id, classes and tag name.
+     *
+     * @param element The element to add.
+     * @returns `false` if the element is already indexed.
+     */
+    bool add(std::shared_ptr<Element> element);
+    /**
+     * Remove the element from the indexes.
+     *
+     * @param element The element to remove.
+     * @returns `false` if the element is not indexed.
+     */
+    bool remove(std::shared_ptr<Element> element);
+    void clear();
+    /**
+     * Update the id index when the element's id is changed, it does nothing if the element is not indexed.
+     */
+    void updateId(std::shared_ptr<Element> element, const std::string &oldId, const std::string &newId);
+    /**
+     * Update the class index when the element's classes are changed, it does nothing if the element is not indexed.
+     */
+    void updateClasses(std::shared_ptr<Element> element, const DOMTokenList &oldClassList, const DOMTokenList &newClassList);
+
+  public:
+    /**
+     * @returns The first indexed element with the given id, or nullptr if not found.
+     */
+    std::shared_ptr<Element> getElementById(const std::string &id) const;
+    /**
+     * @returns The indexed elements with the given id.
+     */
+    const ElementList &getElementsById(const std::string &id) const;
+    /**
+     * @returns The indexed elements with the given class name.
+     */
+    const ElementList &getElementsByClassName(const std::string &className) const;
+    /**
+     * @returns The indexed elements with the given tag name, which is case-insensitive.
+     */
+    const ElementList &getElementsByTagName(const std::string &tagName) const;
+
+  private:
+    using Buckets = std::unordered_map<std::string, ElementList>;
+
+    void insertTo(ElementList &list, std::shared_ptr<Element> element, uint64_t seq);
+    void removeFrom(ElementList &list, const std::shared_ptr<Element> &element, uint64_t seq);
+    void insertToBucket(Buckets &buckets, const std::string &key, std::shared_ptr<Element> element, uint64_t seq);
+    void removeFromBucket(Buckets &buckets, const std::string &key, const std::shared_ptr<Element> &element, uint64_t seq);
+    static const ElementList &FindBucket(const Buckets &buckets, const std::string &key);
+
+  private:
+    ElementList elements_;
+    Buckets idBuckets_;
+    Buckets classBuckets_;
+    Buckets tagNameBuckets_;
+    /**
+     * The sequence number of each indexed element by the element's uid.
+     */
+    std::unordered_map<uint32_t, uint64_t> seqs_;
+    uint64_t nextSeq_ = 0;
+  };
+}
@@ -63,6 +63,10 @@ bool TrClientEntry::parseConfig(string &configJson)
   clientContext->eventChanPort = document["eventChanPort"].GetUint();
   clientContext->mediaChanPort = document["mediaChanPort"].GetUint();
   clientContext->commandBufferChanPort = document["commandBufferChanPort"].GetUint();
+  if (document.HasMember("commandBufferChanType") && document["commandBufferChanType"].IsInt())
+    clientContext->commandBufferChanType = (ipc::TrChannelType)document["commandBufferChanType"].GetInt();
+  if (document.HasMember("commandBufferChanZoneDirectory") && document["commandBufferChanZoneDirectory"].IsString())
+    clientContext->commandBufferChanZoneDirectory = document["commandBufferChanZoneDirectory"].GetString();
 
   // Global settings
   if (document.HasMember("applicationCacheDirectory"))
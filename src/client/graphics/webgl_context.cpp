@@ -47,6 +47,7 @@ namespace client_graphics
   WebGLContext::WebGLContext(ContextAttributes &attrs, bool isWebGL2)
       : contextAttributes(attrs)
       , isWebGL2_(isWebGL2)
+      , shadowState_(isWebGL2)
   {
     clientContext_ = TrClientContextPerProcess::Get();
     assert(clientContext_ != nullptr);
@@ -84,6 +85,9 @@ namespace client_graphics
     version = resp->version;
     renderer = resp->renderer;
     delete resp;
+
+    shadowState_.resetViewport(viewport_.x(), viewport_.y(), viewport_.width(), viewport_.height());
+    shadowState_.setMaxCombinedTextureImageUnits(maxCombinedTextureImageUnits);
   }
 
   WebGLContext::~WebGLContext()
@@ -109,46 +113,20 @@ namespace client_graphics
     program->markDeleted();
   }
 
-  class LinkProgramException : public std::runtime_error
-  {
-  public:
-    LinkProgramException(WebGLProgram &program, const std::string &detail)
-        : std::runtime_error(getMessage(program, detail))
-    {
-    }
-
-  private:
-    std::string getMessage(WebGLProgram &program, const std::string &detail)
-    {
-      return "Failed to link program(" + std::to_string(program.id) + "): " + detail;
-    }
-  };
-
-  void WebGLContext::linkProgram(std::shared_ptr<WebGLProgram> program)
+  /**
+   * It applies the response of `linkProgram()` to the client-side program object.
+   */
+  static void ApplyLinkProgramResponse(WebGLProgram &program, LinkProgramCommandBufferResponse *resp, bool isWebGL2)
   {
-    if (program == nullptr || !program->isValid())
+    program.resetLinkResult();
+    program.setLinkPending(false);
+    if (resp == nullptr || !resp->success)
       return;
 
-    auto req = LinkProgramCommandBufferRequest(program->id);
-    if (!sendCommandBufferRequest(req, true))
-      throw LinkProgramException(*program, "Failed to send the command buffer.");
-
-    auto resp = recvCommandBufferResponse<LinkProgramCommandBufferResponse>(COMMAND_BUFFER_LINK_PROGRAM_RES);
-    if (resp == nullptr)
-    {
-      string msg = "Failed to link program(" + to_string(program->id) + "): timeout.";
-      throw LinkProgramException(*program, "Timeout.");
-    }
-    if (!resp->success)
-    {
-      delete resp;
-      throw LinkProgramException(*program, "Not successful.");
-    }
-
     /**
      * Mark the program as linked.
      */
-    program->setLinkStatus(true);
+    program.setLinkStatus(true);
 
     /**
      * Update the program's active attributes and uniforms.
@@ -156,17 +134,17 @@ namespace client_graphics
     {
       int index = 0;
       for (auto &activeInfo : resp->activeAttribs)
-        program->setActiveAttrib(index++, activeInfo);
+        program.setActiveAttrib(index++, activeInfo);
       index = 0;
       for (auto &activeInfo : resp->activeUniforms)
-        program->setActiveUniform(index++, activeInfo);
+        program.setActiveUniform(index++, activeInfo);
     }
 
     /**
      * Update the program's attribute locations.
      */
     for (auto &attribLocation : resp->attribLocations)
-      program->setAttribLocation(attribLocation.name, attribLocation.location);
+      program.setAttribLocation(attribLocation.name, attribLocation.location);
 
     /**
      * See https://developer.mozilla.org/en-US/docs/Web/API/WebGLRenderingContext/getUniformLocation#name
@@ -203,15 +181,15 @@ namespace client_graphics
        */
       if (size == 1 && !endsWithArray)
       {
-        program->setUniformLocation(name, location);
+        program.setUniformLocation(name, location);
       }
       else if (endsWithArray)
       {
         auto arrayName = name.substr(0, endedAt);
-        program->setUniformLocation(arrayName, location);
-        program->setUniformLocation(name, location);
+        program.setUniformLocation(arrayName, location);
+        program.setUniformLocation(name, location);
         for (int i = 1; i < size; i++)
-          program->setUniformLocation(arrayName + "[" + std::to_string(i) + "]", location + i);
+          program.setUniformLocation(arrayName + "[" + std::to_string(i) + "]", location + i);
       }
       else
       {
@@ -220,15 +198,56 @@ namespace client_graphics
       }
     }
 
-    if (isWebGL2_ == true)
+    if (isWebGL2)
     {
       /**
        * Save the uniform block indices to the program object
        */
       for (auto &uniformBlock : resp->uniformBlocks)
-        program->setUniformBlockIndex(uniformBlock.name, uniformBlock.index);
+        program.setUniformBlockIndex(uniformBlock.name, uniformBlock.index);
+    }
+  }
+
+  void WebGLContext::linkProgram(std::shared_ptr<WebGLProgram> program)
+  {
+    if (program == nullptr || !program->isValid())
+      return;
+
+    // Wait for the previous link of this program to keep the results in order.
+    waitForProgramLink(program);
+
+    auto req = LinkProgramCommandBufferRequest(program->id);
+    if (!sendCommandBufferRequest(req, true))
+    {
+      ApplyLinkProgramResponse(*program, nullptr, isWebGL2_);
+      return;
+    }
+
+    /**
+     * The response is not waited here, it's received when the link result is first needed or a later response is received,
+     * thus the scripts could continue to compile and link other programs while the renderer is linking this one.
+     */
+    program->setLinkPending(true);
+    bool isWebGL2 = isWebGL2_;
+    clientContext_->expectCommandBufferResponse(COMMAND_BUFFER_LINK_PROGRAM_RES,
+                                                [program, isWebGL2](TrCommandBufferResponse *resp)
+                                                {
+                                                  auto linkResp = dynamic_cast<LinkProgramCommandBufferResponse *>(resp);
+                                                  ApplyLinkProgramResponse(*program, linkResp, isWebGL2);
+                                                });
+  }
+
+  void WebGLContext::waitForProgramLink(std::shared_ptr<WebGLProgram> program)
+  {
+    while (program->isLinkPending())
+    {
+      if (!clientContext_->dispatchExpectedCommandBufferResponse(1000))
+      {
+        // No response is expected anymore, mark it as failed to avoid waiting forever.
+        ApplyLinkProgramResponse(*program, nullptr, isWebGL2_);
+        break;
+      }
     }
-    delete resp;
   }
 
   void WebGLContext::useProgram(std::shared_ptr<WebGLProgram> program)
@@ -247,11 +266,36 @@ namespace client_graphics
   int WebGLContext::getProgramParameter(std::shared_ptr<WebGLProgram> program, int pname)
   {
     /**
-     * The following parameters are carried when linkProgram() is responded, thus we could return them from the client-side
-     * `WebGLProgram` object directly.
+     * The following parameters are answered from the client-side `WebGLProgram` object directly without a round trip.
+     */
+    switch (pname)
+    {
+    case WEBGL_COMPLETION_STATUS_KHR:
+      // Receive the responses which have arrived without blocking, see KHR_parallel_shader_compile.
+      if (program->isLinkPending())
+        clientContext_->pollExpectedCommandBufferResponses();
+      return static_cast<int>(!program->isLinkPending());
+    case WEBGL_DELETE_STATUS:
+      return static_cast<int>(program->isDeleted());
+    case WEBGL_ATTACHED_SHADERS:
+      return program->getAttachedShadersCount();
+    default:
+      break;
+    }
+
+    /**
+     * The following parameters are carried when linkProgram() is responded.
      */
+    waitForProgramLink(program);
     if (pname == WEBGL_LINK_STATUS)
       return static_cast<int>(program->getLinkStatus());
+    if (program->getLinkStatus())
+    {
+      if (pname == WEBGL_ACTIVE_ATTRIBUTES)
+        return program->getActiveAttribsCount();
+      if (pname == WEBGL_ACTIVE_UNIFORMS)
+        return program->getActiveUniformsCount();
+    }
 
     /**
      * Send a command buffer request and wait for the response if not hit the above conditions.
@@ -268,6 +312,11 @@ namespace client_graphics
 
   std::string WebGLContext::getProgramInfoLog(std::shared_ptr<WebGLProgram> program)
   {
+    // The log is unchanged until the program is linked again.
+    waitForProgramLink(program);
+    if (program->getInfoLog().has_value())
+      return program->getInfoLog().value();
+
     auto req = GetProgramInfoLogCommandBufferRequest(program->id);
     sendCommandBufferRequest(req, true);
 
@@ -276,6 +325,7 @@ namespace client_graphics
     {
       std::string log(resp->infoLog);
       delete resp;
+      program->setInfoLog(log);
       return log;
     }
     else
@@ -309,18 +359,21 @@ namespace client_graphics
   {
     auto req = CompileShaderCommandBufferRequest(shader->id);
     sendCommandBufferRequest(req);
+    shader->resetCompileResult();
   }
 
   void WebGLContext::attachShader(std::shared_ptr<WebGLProgram> program, std::shared_ptr<WebGLShader> shader)
   {
     auto req = AttachShaderCommandBufferRequest(program->id, shader->id);
     sendCommandBufferRequest(req);
+    program->setShaderAttached(shader->id, true);
   }
 
   void WebGLContext::detachShader(std::shared_ptr<WebGLProgram> program, std::shared_ptr<WebGLShader> shader)
   {
     auto req = DetachShaderCommandBufferRequest(program->id, shader->id);
     sendCommandBufferRequest(req);
+    program->setShaderAttached(shader->id, false);
   }
 
   std::string WebGLContext::getShaderSource(std::shared_ptr<WebGLShader> shader)
@@ -343,6 +396,24 @@ namespace client_graphics
 
   int WebGLContext::getShaderParameter(std::shared_ptr<WebGLShader> shader, int pname)
   {
+    switch (pname)
+    {
+    case WEBGL_SHADER_TYPE:
+      return static_cast<int>(shader->type);
+    case WEBGL_DELETE_STATUS:
+      return static_cast<int>(shader->isDeleted());
+    case WEBGL_COMPLETION_STATUS_KHR:
+      // The renderer compiles the shaders in the order of the commands, thus the compile is always completed when a later
+      // query is answered.
+      return 1;
+    case WEBGL_COMPILE_STATUS:
+      if (shader->compileStatus.has_value())
+        return static_cast<int>(shader->compileStatus.value());
+      break;
+    default:
+      break;
+    }
+
     auto req = GetShaderParamCommandBufferRequest(shader->id, pname);
     sendCommandBufferRequest(req, true);
 
@@ -351,6 +422,8 @@ namespace client_graphics
     {
       int value = resp->value;
       delete resp;
+      if (pname == WEBGL_COMPILE_STATUS)
+        shader->compileStatus = value != 0;
       return value;
     }
     else
@@ -361,6 +434,9 @@ namespace client_graphics
 
   std::string WebGLContext::getShaderInfoLog(std::shared_ptr<WebGLShader> shader)
   {
+    if (shader->infoLog.has_value())
+      return shader->infoLog.value();
+
     auto req = GetShaderInfoLogCommandBufferRequest(shader->id);
     sendCommandBufferRequest(req, true);
 
@@ -369,6 +445,7 @@ namespace client_graphics
     {
       std::string log(resp->infoLog);
       delete resp;
+      shader->infoLog = log;
       return log;
     }
     else
@@ -425,13 +502,18 @@ namespace client_graphics
     auto req = BufferDataCommandBufferRequest(static_cast<uint32_t>(target),
                                               srcSize,
                                               srcData,
-                                              static_cast<uint32_t>(usage));
+                                              static_cast<uint32_t>(usage),
+                                              clientContext_->getCommandBufferPayloadPool());
     sendCommandBufferRequest(req);
   }
 
   void WebGLContext::bufferSubData(WebGLBufferBindingTarget target, int offset, size_t size, void *data)
   {
-    auto req = BufferSubDataCommandBufferRequest(static_cast<uint32_t>(target), offset, size, data);
+    auto req = BufferSubDataCommandBufferRequest(static_cast<uint32_t>(target),
+                                                 offset,
+                                                 size,
+                                                 data,
+                                                 clientContext_->getCommandBufferPayloadPool());
     sendCommandBufferRequest(req);
   }
 
@@ -625,16 +707,16 @@ namespace client_graphics
         pixelsToUse = pixels;
       }
 
-      if (unpackFlipY_ || unpackAlignment_)
+      if (shadowState_.unpackFlipY() || shadowState_.unpackAlignment())
       {
         unsigned char *unpacked = unpackPixels(type, format, req.width, req.height, pixelsToUse);
         if (TR_UNLIKELY(unpacked == nullptr))
           throw std::runtime_error("Failed to unpack pixels, the source data is null.");
-        req.setPixels(unpacked, false);
+        req.setPixels(unpacked, false, clientContext_->getCommandBufferPayloadPool());
       }
       else
       {
-        req.setPixels(pixelsToUse, false);
+        req.setPixels(pixelsToUse, false, clientContext_->getCommandBufferPayloadPool());
       }
     }
     sendCommandBufferRequest(req);
@@ -663,7 +745,7 @@ namespace client_graphics
     unsigned char *unpacked = nullptr;
     if (
       pixels != nullptr &&
-      (unpackFlipY_ || unpackPremultiplyAlpha_))
+      (shadowState_.unpackFlipY() || shadowState_.unpackPremultiplyAlpha()))
     {
       unpacked = unpackPixels(type,
                               format,
@@ -672,11 +754,11 @@ namespace client_graphics
                               pixels);
       if (TR_UNLIKELY(unpacked == nullptr))
         throw std::runtime_error("Failed to unpack pixels, the source data is null.");
-      req.setPixels(unpacked, false);
+      req.setPixels(unpacked, false, clientContext_->getCommandBufferPayloadPool());
     }
     else
     {
-      req.setPixels(pixels, false);
+      req.setPixels(pixels, false, clientContext_->getCommandBufferPayloadPool());
     }
     sendCommandBufferRequest(req);
   }
@@ -753,6 +835,7 @@ namespace client_graphics
   {
     auto req = ActiveTextureCommandBufferRequest(static_cast<uint32_t>(texture));
     sendCommandBufferRequest(req);
+    shadowState_.activeTexture(static_cast<int>(texture));
   }
 
   void WebGLContext::generateMipmap(WebGLTextureTarget target)
@@ -781,6 +864,7 @@ namespace client_graphics
 
   std::optional<WebGLActiveInfo> WebGLContext::getActiveAttrib(std::shared_ptr<WebGLProgram> program, unsigned int index)
   {
+    waitForProgramLink(program);
     if (program->hasActiveAttrib(index))
       return program->getActiveAttrib(index);
     else
@@ -789,6 +873,7 @@ namespace client_graphics
 
   std::optional<WebGLActiveInfo> WebGLContext::getActiveUniform(std::shared_ptr<WebGLProgram> program, unsigned int index)
   {
+    waitForProgramLink(program);
     if (program->hasActiveUniform(index))
       return program->getActiveUniform(index);
     else
@@ -797,6 +882,7 @@ namespace client_graphics
 
   std::optional<int> WebGLContext::getAttribLocation(std::shared_ptr<WebGLProgram> program, const std::string &name)
   {
+    waitForProgramLink(program);
     if (program->hasAttribLocation(name))
       return program->getAttribLocation(name);
     else
@@ -806,6 +892,7 @@ namespace client_graphics
   std::optional<WebGLUniformLocation> WebGLContext::getUniformLocation(std::shared_ptr<WebGLProgram> program,
                                                                        const std::string &name)
   {
+    waitForProgramLink(program);
     if (program->hasUniformLocation(name))
       return program->getUniformLocation(name);
     else
@@ -818,9 +905,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform1fv(WebGLUniformLocation location, const std::vector<float> value)
+  void WebGLContext::uniform1fv(WebGLUniformLocation location, std::span<const float> values)
   {
-    auto req = Uniform1fvCommandBufferRequest(location.index, value);
+    auto req = Uniform1fvCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -830,9 +917,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform1iv(WebGLUniformLocation location, const std::vector<int> value)
+  void WebGLContext::uniform1iv(WebGLUniformLocation location, std::span<const int> values)
   {
-    auto req = Uniform1ivCommandBufferRequest(location.index, value);
+    auto req = Uniform1ivCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -842,9 +929,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform2fv(WebGLUniformLocation location, const std::vector<float> value)
+  void WebGLContext::uniform2fv(WebGLUniformLocation location, std::span<const float> values)
   {
-    auto req = Uniform2fvCommandBufferRequest(location.index, value);
+    auto req = Uniform2fvCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -854,9 +941,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform2iv(WebGLUniformLocation location, const std::vector<int> value)
+  void WebGLContext::uniform2iv(WebGLUniformLocation location, std::span<const int> values)
   {
-    auto req = Uniform2ivCommandBufferRequest(location.index, value);
+    auto req = Uniform2ivCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -866,9 +953,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform3fv(WebGLUniformLocation location, const std::vector<float> value)
+  void WebGLContext::uniform3fv(WebGLUniformLocation location, std::span<const float> values)
   {
-    auto req = Uniform3fvCommandBufferRequest(location.index, value);
+    auto req = Uniform3fvCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -878,9 +965,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform3iv(WebGLUniformLocation location, const std::vector<int> value)
+  void WebGLContext::uniform3iv(WebGLUniformLocation location, std::span<const int> values)
   {
-    auto req = Uniform3ivCommandBufferRequest(location.index, value);
+    auto req = Uniform3ivCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -890,9 +977,9 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform4fv(WebGLUniformLocation location, const std::vector<float> value)
+  void WebGLContext::uniform4fv(WebGLUniformLocation location, std::span<const float> values)
   {
-    auto req = Uniform4fvCommandBufferRequest(location.index, value);
+    auto req = Uniform4fvCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
@@ -902,20 +989,18 @@ namespace client_graphics
     sendCommandBufferRequest(req);
   }
 
-  void WebGLContext::uniform4iv(WebGLUniformLocation location, const std::vector<int> value)
+  void WebGLContext::uniform4iv(WebGLUniformLocation location, std::span<const int> values)
   {
-    auto req = Uniform4ivCommandBufferRequest(location.index, value);
+    auto req = Uniform4ivCommandBufferRequest(location.index, values);
     sendCommandBufferRequest(req);
   }
 
   void WebGLContext::uniformMatrix2fv(WebGLUniformLocation location, bool transpose, glm::mat2 m)
   {
-    std::vector<float> values = {
-      m[0][0], m[0][1], m[1][0], m[1][1]};
-    uniformMatrix2fv(location, transpose, values);
+    uniformMatrix2fv(location, transpose, std::span<const float>(&m[0][0], 4)); // The columns are stored contiguously.
   }
 
-  void WebGLContext::uniformMatrix2fv(WebGLUniformLocation location, bool transpose, std::vector<float> values)
+  void WebGLContext::uniformMatrix2fv(WebGLUniformLocation location, bool transpose, std::span<const float> values)
   {
     if (values.size() % 4 != 0)
       throw std::runtime_error("Invalid matrix size, expected 4 but got " + std::to_string(values.size()));
@@ -931,16 +1016,10 @@ namespace client_graphics
 
   void WebGLContext::uniformMatrix3fv(WebGLUniformLocation location, bool transpose, glm::mat3 m)
   {
-    // clang-format off
-    std::vector<float> values = {
-      m[0][0], m[0][1], m[0][2],
-      m[1][0], m[1][1], m[1][2],
-      m[2][0], m[2][1], m[2][2]};
-    // clang-format on
-    uniformMatrix3fv(location, transpose, values);
+    uniformMatrix3fv(location, transpose, std::span<const float>(&m[0][0], 9));
   }
 
-  void WebGLContext::uniformMatrix3fv(WebGLUniformLocation location, bool transpose, std::vector<float> values)
+  void WebGLContext::uniformMatrix3fv(WebGLUniformLocation location, bool transpose, std::span<const float> values)
   {
     if (values.size() % 9 != 0)
       throw std::runtime_error("Invalid matrix size, expected 9 but got " + std::to_string(values.size()));
@@ -956,17 +1035,10 @@ namespace client_graphics
 
   void WebGLContext::uniformMatrix4fv(WebGLUniformLocation location, bool transpose, glm::mat4 m)
   {
-    // clang-format off
-    std::vector<float> values = {
-      m[0][0], m[0][1], m[0][2], m[0][3],
-      m[1][0], m[1][1], m[1][2], m[1][3],
-      m[2][0], m[2][1], m[2][2], m[2][3],
-      m[3][0], m[3][1], m[3][2], m[3][3]};
-    // clang-format on
-    uniformMatrix4fv(location, transpose, values);
+    uniformMatrix4fv(location, transpose, std::span<const float>(&m[0][0], 16));
   }
 
-  void WebGLContext::uniformMatrix4fv(WebGLUniformLocation location, bool transpose, std::vector<float> values)
+  void WebGLContext::uniformMatrix4fv(WebGLUniformLocation location, bool transpose, std::span<const float> values)
   {
     UniformMatrix4fvCommandBufferRequest req(location.index, transpose);
     auto locationName = location.name;
@@ -1040,9 +1112,7 @@ namespace client_graphics
       if (length % 16 != 0)
         throw std::runtime_error("uniformMatrix4fv() must take 16x float elements array but accept " + std::to_string(length) + ".");
 
-      req.values.resize(length);
-      auto valuesSrc = values.data();
-      std::copy(valuesSrc, valuesSrc + length, req.values.begin());
+      req.values.assign(values.begin(), values.end());
     }
     sendCommandBufferRequest(req);
   }
@@ -1074,25 +1144,30 @@ namespace client_graphics
   {
     auto req = HintCommandBufferRequest(static_cast<int>(target), static_cast<uint32_t>(mode));
     sendCommandBufferRequest(req);
+    shadowState_.hint(static_cast<int>(target), static_cast<int>(mode));
   }
 
   void WebGLContext::lineWidth(float width)
   {
     auto req = LineWidthCommandBufferRequest(width);
     sendCommandBufferRequest(req);
+    shadowState_.lineWidth(width);
   }
 
   void WebGLContext::pixelStorei(WebGLPixelStorageParameterName pname, int param)
   {
-    if (pname == WebGLPixelStorageParameterName::kUnpackFlipY)
-      unpackFlipY_ = param;
-    else if (pname == WebGLPixelStorageParameterName::kUnpackPremultiplyAlpha)
-      unpackPremultiplyAlpha_ = param;
-    else if (pname == WebGLPixelStorageParameterName::kUnpackColorspaceConversion)
+    shadowState_.pixelStorei(static_cast<int>(pname), param);
+
+    /**
+     * The flip-y, premultiply-alpha and colorspace conversion are applied at the client-side when unpacking the pixels,
+     * thus only the shadow state is updated for them.
+     */
+    if (pname == WebGLPixelStorageParameterName::kUnpackColorspaceConversion)
     {
       // TODO: implement this.
     }
-    else
+    else if (pname != WebGLPixelStorageParameterName::kUnpackFlipY &&
+             pname != WebGLPixelStorageParameterName::kUnpackPremultiplyAlpha)
     {
       auto req = PixelStoreiCommandBufferRequest(static_cast<uint32_t>(pname), param);
       sendCommandBufferRequest(req);
@@ -1103,6 +1178,7 @@ namespace client_graphics
   {
     auto req = PolygonOffsetCommandBufferRequest(factor, units);
     sendCommandBufferRequest(req);
+    shadowState_.polygonOffset(factor, units);
   }
 
   void WebGLContext::viewport(int x, int y, size_t width, size_t height)
@@ -1119,33 +1195,35 @@ namespace client_graphics
       sendCommandBufferRequest(req);
       viewport_.set(width, height, x, y);
     }
+    shadowState_.viewport(x, y, width, height);
   }
 
   void WebGLContext::scissor(int x, int y, size_t width, size_t height)
   {
     auto req = SetScissorCommandBufferRequest(x, y, width, height);
     sendCommandBufferRequest(req);
+    shadowState_.scissor(x, y, width, height);
   }
 
   void WebGLContext::clearColor(float red, float green, float blue, float alpha)
   {
     // auto req = ClearColorCommandBufferRequest(red, green, blue, alpha);
     // sendCommandBufferRequest(req);
-    clearColor_ = glm::vec4(red, green, blue, alpha);
+    shadowState_.clearColor(red, green, blue, alpha);
   }
 
   void WebGLContext::clearDepth(float depth)
   {
     // auto req = ClearDepthCommandBufferRequest(depth);
     // sendCommandBufferRequest(req);
-    clearDepth_ = depth;
+    shadowState_.clearDepth(depth);
   }
 
   void WebGLContext::clearStencil(int s)
   {
     // auto req = ClearStencilCommandBufferRequest(s);
     // sendCommandBufferRequest(req);
-    clearStencil_ = s;
+    shadowState_.clearStencil(s);
   }
 
   void WebGLContext::clear(int mask)
@@ -1158,30 +1236,35 @@ namespace client_graphics
   {
     auto req = DepthMaskCommandBufferRequest(flag);
     sendCommandBufferRequest(req);
+    shadowState_.depthMask(flag);
   }
 
   void WebGLContext::depthFunc(int func)
   {
     auto req = DepthFuncCommandBufferRequest(func);
     sendCommandBufferRequest(req);
+    shadowState_.depthFunc(func);
   }
 
   void WebGLContext::depthRange(float zNear, float zFar)
   {
     auto req = DepthRangeCommandBufferRequest(zNear, zFar);
     sendCommandBufferRequest(req);
+    shadowState_.depthRange(zNear, zFar);
   }
 
   void WebGLContext::stencilFunc(int func, int ref, unsigned int mask)
   {
     auto req = StencilFuncCommandBufferRequest(func, ref, mask);
     sendCommandBufferRequest(req);
+    shadowState_.stencilFuncSeparate(WEBGL_FRONT_AND_BACK, func);
   }
 
   void WebGLContext::stencilFuncSeparate(int face, int func, int ref, unsigned int mask)
   {
     auto req = StencilFuncSeparateCommandBufferRequest(face, func, ref, mask);
     sendCommandBufferRequest(req);
+    shadowState_.stencilFuncSeparate(face, func);
   }
 
   void WebGLContext::stencilMask(unsigned int mask)
@@ -1200,77 +1283,110 @@ namespace client_graphics
   {
     auto req = StencilOpCommandBufferRequest(fail, zfail, zpass);
     sendCommandBufferRequest(req);
+    shadowState_.stencilOpSeparate(WEBGL_FRONT_AND_BACK, fail, zfail, zpass);
   }
 
   void WebGLContext::stencilOpSeparate(int face, int fail, int zfail, int zpass)
   {
     auto req = StencilOpSeparateCommandBufferRequest(face, fail, zfail, zpass);
     sendCommandBufferRequest(req);
+    shadowState_.stencilOpSeparate(face, fail, zfail, zpass);
   }
 
   void WebGLContext::blendColor(float red, float green, float blue, float alpha)
   {
     auto req = BlendColorCommandBufferRequest(red, green, blue, alpha);
     sendCommandBufferRequest(req);
-    blendColor_ = glm::vec4(red, green, blue, alpha);
+    shadowState_.blendColor(red, green, blue, alpha);
   }
 
   void WebGLContext::blendEquation(int mode)
   {
     auto req = BlendEquationCommandBufferRequest(mode);
     sendCommandBufferRequest(req);
+    shadowState_.blendEquationSeparate(mode, mode);
   }
 
   void WebGLContext::blendEquationSeparate(int modeRGB, int modeAlpha)
   {
     auto req = BlendEquationSeparateCommandBufferRequest(modeRGB, modeAlpha);
     sendCommandBufferRequest(req);
+    shadowState_.blendEquationSeparate(modeRGB, modeAlpha);
   }
 
   void WebGLContext::blendFunc(int sfactor, int dfactor)
   {
     auto req = BlendFuncCommandBufferRequest(sfactor, dfactor);
     sendCommandBufferRequest(req);
+    shadowState_.blendFuncSeparate(sfactor, dfactor, sfactor, dfactor);
   }
 
   void WebGLContext::blendFuncSeparate(int srcRGB, int dstRGB, int srcAlpha, int dstAlpha)
   {
     auto req = BlendFuncSeparateCommandBufferRequest(srcRGB, dstRGB, srcAlpha, dstAlpha);
     sendCommandBufferRequest(req);
+    shadowState_.blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
   }
 
   void WebGLContext::colorMask(bool red, bool green, bool blue, bool alpha)
   {
     auto req = ColorMaskCommandBufferRequest(red, green, blue, alpha);
     sendCommandBufferRequest(req);
+    shadowState_.colorMask(red, green, blue, alpha);
   }
 
   void WebGLContext::cullFace(int mode)
   {
     auto req = CullFaceCommandBufferRequest(mode);
     sendCommandBufferRequest(req);
+    shadowState_.cullFace(mode);
   }
 
   void WebGLContext::frontFace(int mode)
   {
     auto req = FrontFaceCommandBufferRequest(mode);
     sendCommandBufferRequest(req);
+    shadowState_.frontFace(mode);
   }
 
   void WebGLContext::enable(int cap)
   {
     auto req = EnableCommandBufferRequest(cap);
     sendCommandBufferRequest(req);
+    shadowState_.setCapability(cap, true);
   }
 
   void WebGLContext::disable(int cap)
   {
     auto req = DisableCommandBufferRequest(cap);
     sendCommandBufferRequest(req);
+    shadowState_.setCapability(cap, false);
+  }
+
+  bool WebGLContext::isEnabled(int cap)
+  {
+    auto enabled = shadowState_.isEnabled(cap);
+    if (enabled.has_value())
+      return enabled.value();
+
+    // `glIsEnabled()` and `glGetBooleanv()` are the same for the capabilities.
+    auto req = GetBooleanvCommandBufferRequest(static_cast<uint32_t>(cap));
+    sendCommandBufferRequest(req, true);
+
+    auto resp = recvCommandBufferResponse<GetBooleanvCommandBufferResponse>(COMMAND_BUFFER_GET_BOOLEANV_RES);
+    if (resp == nullptr)
+      throw std::runtime_error("Failed to check if the capability(" + std::to_string(cap) + ") is enabled: timeout.");
+    auto v = resp->value;
+    delete resp;
+    return v;
   }
 
   bool WebGLContext::getParameter(WebGLBooleanParameterName pname)
   {
+    auto shadowed = shadowState_.getBoolean(static_cast<int>(pname));
+    if (shadowed.has_value())
+      return shadowed.value();
+
     auto req = GetBooleanvCommandBufferRequest(static_cast<uint32_t>(pname));
     sendCommandBufferRequest(req, true);
 
@@ -1285,30 +1401,36 @@ namespace client_graphics
     return v;
   }
 
+  std::vector<bool> WebGLContext::getParameter(WebGLBooleanArrayParameterName pname)
+  {
+    auto shadowed = shadowState_.getBooleanv(static_cast<int>(pname));
+    assert(shadowed.has_value() && "The boolean array parameters are all shadowed.");
+    return std::vector<bool>(shadowed->begin(), shadowed->end());
+  }
+
   float WebGLContext::getParameter(WebGLFloatParameterName pname)
   {
-    NOT_IMPLEMENTED();
+    auto shadowed = shadowState_.getFloat(static_cast<int>(pname));
+    if (shadowed.has_value())
+      return shadowed.value();
+
+    auto req = GetFloatvCommandBufferRequest(static_cast<uint32_t>(pname));
+    sendCommandBufferRequest(req, true);
+
+    auto resp = recvCommandBufferResponse<GetFloatvCommandBufferResponse>(COMMAND_BUFFER_GET_FLOATV_RES);
+    if (resp == nullptr)
+      throw std::runtime_error("Failed to get float parameter: timeout.");
+
+    float v = resp->value;
+    delete resp;
+    return v;
   }
 
   std::vector<float> WebGLContext::getParameter(WebGLFloatArrayParameterName pname)
   {
-    if (pname == WebGLFloatArrayParameterName::kViewport)
-    {
-      return {
-        static_cast<float>(viewport_.x()),
-        static_cast<float>(viewport_.y()),
-        static_cast<float>(viewport_.width()),
-        static_cast<float>(viewport_.height())};
-    }
-    else if (pname == WebGLFloatArrayParameterName::kScissorBox)
-    {
-      return {
-        static_cast<float>(0),
-        static_cast<float>(0),
-        static_cast<float>(viewport_.width()),
-        static_cast<float>(viewport_.height())};
-    }
-    assert(false);
+    auto shadowed = shadowState_.getFloatv(static_cast<int>(pname));
+    assert(shadowed.has_value() && "The float array parameters are all shadowed.");
+    return shadowed.value();
   }
 
   int WebGLContext::getParameter(WebGLIntegerParameterName pname)
@@ -1337,6 +1459,13 @@ namespace client_graphics
     else if (pname == WebGLIntegerParameterName::kMaxVertexUniformVectors)
       return maxVertexUniformVectors;
 
+    /**
+     * The following parameters are mirrored at the client-side when they are set.
+     */
+    auto shadowed = shadowState_.getInteger(static_cast<int>(pname));
+    if (shadowed.has_value())
+      return shadowed.value();
+
     auto req = GetIntegervCommandBufferRequest(static_cast<uint32_t>(pname));
     sendCommandBufferRequest(req, true);
 
@@ -1424,7 +1553,8 @@ namespace client_graphics
     if (resp == nullptr)
       throw std::runtime_error("Failed to get supported extensions: timeout.");
 
-    std::vector<std::string> extensionsList;
+    // KHR_parallel_shader_compile is implemented at the client-side by the deferred link responses.
+    std::vector<std::string> extensionsList = {"KHR_parallel_shader_compile"};
     for (size_t i = 0; i < resp->extensions.size(); i++)
     {
       // remove GL_ prefix
@@ -1642,7 +1772,8 @@ namespace client_graphics
     auto req = BufferDataCommandBufferRequest(static_cast<uint32_t>(target),
                                               srcSize,
                                               srcData,
-                                              static_cast<uint32_t>(usage));
+                                              static_cast<uint32_t>(usage),
+                                              clientContext_->getCommandBufferPayloadPool());
     sendCommandBufferRequest(req);
   }
 
@@ -1654,7 +1785,11 @@ namespace client_graphics
                                     std::optional<int> length)
   {
     // TODO: implement the srcOffset and length
-    auto req = BufferSubDataCommandBufferRequest(static_cast<uint32_t>(target), dstByteOffset, srcSize, srcData);
+    auto req = BufferSubDataCommandBufferRequest(static_cast<uint32_t>(target),
+                                                 dstByteOffset,
+                                                 srcSize,
+                                                 srcData,
+                                                 clientContext_->getCommandBufferPayloadPool());
     sendCommandBufferRequest(req);
   }
 
@@ -1935,6 +2070,8 @@ namespace client_graphics
 
   int WebGL2Context::getUniformBlockIndex(std::shared_ptr<WebGLProgram> program, const std::string &uniformBlockName)
   {
+    if (program != nullptr)
+      waitForProgramLink(program);
     if (program == nullptr || !program->isValid() || !program->hasUniformBlockIndex(uniformBlockName))
       return -1;
     else
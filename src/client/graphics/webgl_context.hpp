@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <span>
 
 #include <glm/glm.hpp>
 #include <common/utility.hpp>
@@ -14,6 +15,7 @@
 #include "./webgl_program.hpp"
 #include "./webgl_shader.hpp"
 #include "./webgl_shader_precision_format.hpp"
+#include "./webgl_shadow_state.hpp"
 #include "./webgl_buffer.hpp"
 #include "./webgl_framebuffer.hpp"
 #include "./webgl_renderbuffer.hpp"
@@ -85,6 +87,8 @@ namespace client_graphics
     kDepthWrite = WEBGL_DEPTH_WRITEMASK,
     kDither = WEBGL_DITHER,
     kPolygonOffsetFill = WEBGL_POLYGON_OFFSET_FILL,
+    kSampleAlphaToCoverage = WEBGL_SAMPLE_ALPHA_TO_COVERAGE,
+    kSampleCoverage = WEBGL_SAMPLE_COVERAGE,
     kSampleCoverageInvert = WEBGL_SAMPLE_COVERAGE_INVERT,
     kScissorTest = WEBGL_SCISSOR_TEST,
     kStencilTest = WEBGL_STENCIL_TEST,
@@ -92,15 +96,27 @@ namespace client_graphics
     kUnpackPremultiplyAlpha = WEBGL_UNPACK_PREMULTIPLY_ALPHA_WEBGL,
   };
 
+  enum class WebGLBooleanArrayParameterName
+  {
+    kColorWritemask = WEBGL_COLOR_WRITEMASK,
+  };
+
   enum class WebGLFloatParameterName
   {
-    // TODO: Add more
+    kDepthClearValue = WEBGL_DEPTH_CLEAR_VALUE,
+    kLineWidth = WEBGL_LINE_WIDTH,
+    kPolygonOffsetFactor = WEBGL_POLYGON_OFFSET_FACTOR,
+    kPolygonOffsetUnits = WEBGL_POLYGON_OFFSET_UNITS,
+    kSampleCoverageValue = WEBGL_SAMPLE_COVERAGE_VALUE,
   };
 
   enum class WebGLFloatArrayParameterName
   {
     kViewport = WEBGL_VIEWPORT,
     kScissorBox = WEBGL_SCISSOR_BOX,
+    kBlendColor = WEBGL_BLEND_COLOR,
+    kColorClearValue = WEBGL_COLOR_CLEAR_VALUE,
+    kDepthRange = WEBGL_DEPTH_RANGE,
   };
 
   enum class WebGLIntegerParameterName
@@ -145,6 +161,7 @@ namespace client_graphics
     kStencilBackValueMask = WEBGL_STENCIL_BACK_VALUE_MASK,
     kStencilBackWriteMask = WEBGL_STENCIL_BACK_WRITEMASK,
     kStencilBits = WEBGL_STENCIL_BITS,
+    kStencilClearValue = WEBGL_STENCIL_CLEAR_VALUE,
     kStencilFail = WEBGL_STENCIL_FAIL,
     kStencilFunc = WEBGL_STENCIL_FUNC,
     kStencilPassDepthFail = WEBGL_STENCIL_PASS_DEPTH_FAIL,
@@ -279,6 +296,9 @@ namespace client_graphics
      * It links a given `WebGLProgram`, completing the process of preparing the GPU code for the program's fragment and
      * vertex shaders.
      *
+     * The link is not waited at this call, the response is received when the link result is first needed, and
+     * `COMPLETION_STATUS_KHR` could be used to check if it's received without blocking.
+     *
      * @param program The WebGLProgram object to link.
      */
     void linkProgram(std::shared_ptr<WebGLProgram> program);
@@ -403,29 +423,29 @@ namespace client_graphics
     std::optional<int> getAttribLocation(std::shared_ptr<WebGLProgram> program, const std::string &name);
     std::optional<WebGLUniformLocation> getUniformLocation(std::shared_ptr<WebGLProgram> program, const std::string &name);
     void uniform1f(WebGLUniformLocation location, float v0);
-    void uniform1fv(WebGLUniformLocation location, const std::vector<float> value);
+    void uniform1fv(WebGLUniformLocation location, std::span<const float> values);
     void uniform1i(WebGLUniformLocation location, int v0);
-    void uniform1iv(WebGLUniformLocation location, const std::vector<int> value);
+    void uniform1iv(WebGLUniformLocation location, std::span<const int> values);
     void uniform2f(WebGLUniformLocation location, float v0, float v1);
-    void uniform2fv(WebGLUniformLocation location, const std::vector<float> value);
+    void uniform2fv(WebGLUniformLocation location, std::span<const float> values);
     void uniform2i(WebGLUniformLocation location, int v0, int v1);
-    void uniform2iv(WebGLUniformLocation location, const std::vector<int> value);
+    void uniform2iv(WebGLUniformLocation location, std::span<const int> values);
     void uniform3f(WebGLUniformLocation location, float v0, float v1, float v2);
-    void uniform3fv(WebGLUniformLocation location, const std::vector<float> value);
+    void uniform3fv(WebGLUniformLocation location, std::span<const float> values);
     void uniform3i(WebGLUniformLocation location, int v0, int v1, int v2);
-    void uniform3iv(WebGLUniformLocation location, const std::vector<int> value);
+    void uniform3iv(WebGLUniformLocation location, std::span<const int> values);
     void uniform4f(WebGLUniformLocation location, float v0, float v1, float v2, float v3);
-    void uniform4fv(WebGLUniformLocation location, const std::vector<float> value);
+    void uniform4fv(WebGLUniformLocation location, std::span<const float> values);
     void uniform4i(WebGLUniformLocation location, int v0, int v1, int v2, int v3);
-    void uniform4iv(WebGLUniformLocation location, const std::vector<int> value);
+    void uniform4iv(WebGLUniformLocation location, std::span<const int> values);
     void uniformMatrix2fv(WebGLUniformLocation location, bool transpose, glm::mat2 m);
-    void uniformMatrix2fv(WebGLUniformLocation location, bool transpose, std::vector<float> values);
+    void uniformMatrix2fv(WebGLUniformLocation location, bool transpose, std::span<const float> values);
     void uniformMatrix2fv(WebGLUniformLocation location, bool transpose, MatrixComputationGraph &graphToValues);
     void uniformMatrix3fv(WebGLUniformLocation location, bool transpose, glm::mat3 m);
-    void uniformMatrix3fv(WebGLUniformLocation location, bool transpose, std::vector<float> values);
+    void uniformMatrix3fv(WebGLUniformLocation location, bool transpose, std::span<const float> values);
     void uniformMatrix3fv(WebGLUniformLocation location, bool transpose, MatrixComputationGraph &graphToValues);
     void uniformMatrix4fv(WebGLUniformLocation location, bool transpose, glm::mat4 m);
-    void uniformMatrix4fv(WebGLUniformLocation location, bool transpose, std::vector<float> values);
+    void uniformMatrix4fv(WebGLUniformLocation location, bool transpose, std::span<const float> values);
     void uniformMatrix4fv(WebGLUniformLocation location, bool transpose, MatrixComputationGraph &graphToValues);
     void drawArrays(WebGLDrawMode mode, int first, int count);
     void drawElements(WebGLDrawMode mode, int count, int type, int offset);
@@ -458,11 +478,21 @@ namespace client_graphics
     void frontFace(int mode);
     void enable(int cap);
     void disable(int cap);
+    /**
+     * @param cap The capability to test.
+     * @returns If the capability is enabled.
+     */
+    bool isEnabled(int cap);
     /**
      * @param pname The parameter name that returns a boolean value.
      * @returns The boolean value for the parameter name.
      */
     bool getParameter(WebGLBooleanParameterName pname);
+    /**
+     * @param pname The parameter name that returns a boolean array value.
+     * @returns The boolean array value for the parameter name.
+     */
+    std::vector<bool> getParameter(WebGLBooleanArrayParameterName pname);
     /**
      * @param pname The parameter name that returns a float value.
      * @returns The float value for the parameter name.
@@ -598,6 +628,13 @@ namespace client_graphics
       assert(response->type == responseType);
       return dynamic_cast<R *>(response);
     }
+    /**
+     * It waits for the pending response of `linkProgram()` of the given program, it's called when the link result is needed,
+     * such as the active information, the locations and the link status.
+     *
+     * @param program The program to wait for.
+     */
+    void waitForProgramLink(std::shared_ptr<WebGLProgram> program);
 
     bool sendFlushCommand(std::shared_ptr<client_xr::XRSession> session);
     /**
@@ -658,12 +695,13 @@ namespace client_graphics
 
       // Compute the row stride
       int rowStride = width * pixelSize;
-      if ((rowStride % unpackAlignment_) != 0)
-        rowStride += unpackAlignment_ - (rowStride % unpackAlignment_);
+      int unpackAlignment = shadowState_.unpackAlignment();
+      if ((rowStride % unpackAlignment) != 0)
+        rowStride += unpackAlignment - (rowStride % unpackAlignment);
 
       int imageSize = rowStride * height;
       unsigned char *unpacked = new unsigned char[imageSize];
-      if (unpackFlipY_)
+      if (shadowState_.unpackFlipY())
       {
         for (int i = 0, j = height - 1; j >= 0; ++i, --j)
         {
@@ -682,7 +720,7 @@ namespace client_graphics
       }
 
       if (
-        unpackPremultiplyAlpha_ &&
+        shadowState_.unpackPremultiplyAlpha() &&
         (format == WebGLTextureFormat::kLuminanceAlpha || format == WebGLTextureFormat::kRGBA))
       {
         for (int row = 0; row < height; ++row)
@@ -779,16 +817,10 @@ namespace client_graphics
     std::optional<std::vector<std::string>> supportedExtensions_ = std::nullopt;
     bool isWebGL2_ = false;
     bool isContextLost_ = false;
-    bool unpackFlipY_ = false;
-    bool unpackPremultiplyAlpha_ = false;
-    glm::vec4 clearColor_ = {0.0f, 0.0f, 0.0f, 1.0f};
-    float clearDepth_ = 1.0f;
-    int clearStencil_ = 0;
-    glm::vec4 blendColor_ = {0.0f, 0.0f, 0.0f, 1.0f};
     /**
-     * TODO: Read the value from the host
+     * The GL state mirrored at the client-side to answer the queries without a round trip.
      */
-    uint32_t unpackAlignment_ = 4;
+    WebGLShadowState shadowState_;
 
   private:
     // XR-compatible field
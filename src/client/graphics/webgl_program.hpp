@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <set>
 #include "common/command_buffers/details/program.hpp"
 #include "./webgl_object.hpp"
 #include "./webgl_active_info.hpp"
@@ -33,6 +35,86 @@ namespace client_graphics
     {
       return linkStatus_;
     }
+    /**
+     * It marks the program as being linked, the link status and the active information are updated when the response of
+     * `linkProgram()` is received.
+     *
+     * @param linkPending If the program is being linked.
+     */
+    void setLinkPending(bool linkPending)
+    {
+      linkPending_ = linkPending;
+    }
+    /**
+     * @returns If the response of the last `linkProgram()` is not received yet.
+     */
+    bool isLinkPending()
+    {
+      return linkPending_;
+    }
+    /**
+     * It clears the link status and the information of the last link, it's called before applying a new link result.
+     */
+    void resetLinkResult()
+    {
+      linkStatus_ = false;
+      activeAttribs_.clear();
+      activeUniforms_.clear();
+      attribLocations_.clear();
+      uniformLocations_.clear();
+      uniformBlockIndices_.clear();
+      infoLog_ = std::nullopt;
+    }
+    /**
+     * @returns The count of the active attributes.
+     */
+    int getActiveAttribsCount()
+    {
+      return static_cast<int>(activeAttribs_.size());
+    }
+    /**
+     * @returns The count of the active uniforms.
+     */
+    int getActiveUniformsCount()
+    {
+      return static_cast<int>(activeUniforms_.size());
+    }
+    /**
+     * It records the shader is attached to or detached from the program.
+     *
+     * @param shaderId The id of the shader.
+     * @param attached If the shader is attached.
+     */
+    void setShaderAttached(uint32_t shaderId, bool attached)
+    {
+      if (attached)
+        attachedShaders_.insert(shaderId);
+      else
+        attachedShaders_.erase(shaderId);
+    }
+    /**
+     * @returns The count of the attached shaders.
+     */
+    int getAttachedShadersCount()
+    {
+      return static_cast<int>(attachedShaders_.size());
+    }
+    /**
+     * It caches the information log of the last link, it's unchanged until the program is linked again.
+     *
+     * @param infoLog The information log.
+     */
+    void setInfoLog(const std::string &infoLog)
+    {
+      infoLog_ = infoLog;
+    }
+    /**
+     * @returns The cached information log, or `std::nullopt` if it's not fetched since the last link.
+     */
+    const std::optional<std::string> &getInfoLog()
+    {
+      return infoLog_;
+    }
     /**
      * @returns The active attribute information at the given index.
      */
@@ -201,6 +283,9 @@ namespace client_graphics
 
   private:
     bool linkStatus_ = false;
+    bool linkPending_ = false;
+    std::set<uint32_t> attachedShaders_;
+    std::optional<std::string> infoLog_;
     std::map<int, WebGLActiveInfo> activeAttribs_;
     std::map<int, WebGLActiveInfo> activeUniforms_;
     std::map<std::string, int> attribLocations_;
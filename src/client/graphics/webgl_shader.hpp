@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <string>
 #include "common/command_buffers/details/program.hpp"
 #include "./webgl_object.hpp"
 
@@ -21,7 +23,23 @@ namespace client_graphics
     {
     }
 
+  public:
+    /**
+     * It clears the cached compile result, it's called when the shader is compiled again.
+     */
+    void resetCompileResult()
+    {
+      compileStatus = std::nullopt;
+      infoLog = std::nullopt;
+    }
+
   public:
     WebGLShaderType type;
+    /**
+     * The compile status and the information log of the last compile, they are fetched from the renderer at the first query
+     * and unchanged until the shader is compiled again.
+     */
+    std::optional<bool> compileStatus;
+    std::optional<std::string> infoLog;
   };
 }
@@ -0,0 +1,510 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <common/command_buffers/webgl_constants.hpp>
+
+namespace client_graphics
+{
+  /**
+   * The `WebGLShadowState` class mirrors the GL state which is cheap to track at the client-side: the capabilities, the blend,
+   * depth and stencil functions, the color mask, the rasterization, the viewport and scissor box, the active texture unit and
+   * the pixel store. Then `getParameter()` and `isEnabled()` for them are answered without a round trip to the renderer.
+   *
+   * The setters are called with the arguments of the GL commands sent to the renderer, and the arguments that the GL rejects
+   * with an error are ignored to keep the state identical. A query returns `std::nullopt` if the parameter is not shadowed,
+   * such as the stencil reference and masks whose answers are clamped by the bits of the current framebuffer, the caller
+   * should ask the renderer for them.
+   */
+  class WebGLShadowState
+  {
+  public:
+    WebGLShadowState(bool isWebGL2 = false)
+        : isWebGL2_(isWebGL2)
+    {
+    }
+
+  public:
+    /**
+     * It sets the initial viewport and scissor box, which are the size of the drawing buffer.
+     */
+    void resetViewport(int x, int y, int width, int height)
+    {
+      viewport_ = {x, y, width, height};
+      scissorBox_ = {x, y, width, height};
+    }
+    /**
+     * It sets the maximum texture units, which is used to validate `activeTexture()`.
+     */
+    void setMaxCombinedTextureImageUnits(int units)
+    {
+      maxCombinedTextureImageUnits_ = units;
+    }
+
+  public: // setters
+    /**
+     * It updates a capability via `enable()` or `disable()`.
+     *
+     * @returns false if the capability is not known.
+     */
+    bool setCapability(int cap, bool enabled)
+    {
+      auto capability = CapabilityOf(*this, cap);
+      if (capability == nullptr)
+        return false;
+      *capability = enabled;
+      return true;
+    }
+    void blendColor(float red, float green, float blue, float alpha)
+    {
+      blendColor_ = {clampColor(red), clampColor(green), clampColor(blue), clampColor(alpha)};
+    }
+    void blendEquationSeparate(int modeRGB, int modeAlpha)
+    {
+      if (!IsBlendEquation(modeRGB) || !IsBlendEquation(modeAlpha))
+        return;
+      blendEquationRgb_ = modeRGB;
+      blendEquationAlpha_ = modeAlpha;
+    }
+    void blendFuncSeparate(int srcRGB, int dstRGB, int srcAlpha, int dstAlpha)
+    {
+      if (!IsBlendFactor(srcRGB) || !IsBlendFactor(dstRGB) || !IsBlendFactor(srcAlpha) || !IsBlendFactor(dstAlpha))
+        return;
+      blendSrcRgb_ = srcRGB;
+      blendDstRgb_ = dstRGB;
+      blendSrcAlpha_ = srcAlpha;
+      blendDstAlpha_ = dstAlpha;
+    }
+    void depthFunc(int func)
+    {
+      if (IsCompareFunc(func))
+        depthFunc_ = func;
+    }
+    void depthMask(bool flag)
+    {
+      depthMask_ = flag;
+    }
+    void depthRange(float zNear, float zFar)
+    {
+      depthRange_ = {std::clamp(zNear, 0.0f, 1.0f), std::clamp(zFar, 0.0f, 1.0f)};
+    }
+    void stencilFuncSeparate(int face, int func)
+    {
+      if (!IsFace(face) || !IsCompareFunc(func))
+        return;
+      if (face != WEBGL_BACK)
+        stencilFunc_ = func;
+      if (face != WEBGL_FRONT)
+        stencilBackFunc_ = func;
+    }
+    void stencilOpSeparate(int face, int fail, int zfail, int zpass)
+    {
+      if (!IsFace(face) || !IsStencilOp(fail) || !IsStencilOp(zfail) || !IsStencilOp(zpass))
+        return;
+      if (face != WEBGL_BACK)
+        stencilOp_ = {fail, zfail, zpass};
+      if (face != WEBGL_FRONT)
+        stencilBackOp_ = {fail, zfail, zpass};
+    }
+    void colorMask(bool red, bool green, bool blue, bool alpha)
+    {
+      colorMask_ = {red, green, blue, alpha};
+    }
+    void cullFace(int mode)
+    {
+      if (IsFace(mode))
+        cullFaceMode_ = mode;
+    }
+    void frontFace(int mode)
+    {
+      if (mode == WEBGL_CW || mode == WEBGL_CCW)
+        frontFace_ = mode;
+    }
+    void lineWidth(float width)
+    {
+      if (width > 0.0f)
+        lineWidth_ = width;
+    }
+    void polygonOffset(float factor, float units)
+    {
+      polygonOffsetFactor_ = factor;
+      polygonOffsetUnits_ = units;
+    }
+    void hint(int target, int mode)
+    {
+      if (mode != WEBGL_FASTEST && mode != WEBGL_NICEST && mode != WEBGL_DONT_CARE)
+        return;
+      if (target == WEBGL_GENERATE_MIPMAP_HINT)
+        generateMipmapHint_ = mode;
+      else if (target == WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT && isWebGL2_)
+        fragmentShaderDerivativeHint_ = mode;
+    }
+    void activeTexture(int texture)
+    {
+      if (texture >= WEBGL_TEXTURE0 && texture < WEBGL_TEXTURE0 + maxCombinedTextureImageUnits_)
+        activeTexture_ = texture;
+    }
+    void viewport(int x, int y, int width, int height)
+    {
+      if (width >= 0 && height >= 0)
+        viewport_ = {x, y, width, height};
+    }
+    void scissor(int x, int y, int width, int height)
+    {
+      if (width >= 0 && height >= 0)
+        scissorBox_ = {x, y, width, height};
+    }
+    void clearColor(float red, float green, float blue, float alpha)
+    {
+      clearColor_ = {clampColor(red), clampColor(green), clampColor(blue), clampColor(alpha)};
+    }
+    void clearDepth(float depth)
+    {
+      clearDepth_ = std::clamp(depth, 0.0f, 1.0f);
+    }
+    void clearStencil(int s)
+    {
+      clearStencil_ = s;
+    }
+    /**
+     * It updates a pixel storage parameter via `pixelStorei()`.
+     *
+     * @returns false if the parameter is not known or the value is rejected.
+     */
+    bool pixelStorei(int pname, int param)
+    {
+      switch (pname)
+      {
+      case WEBGL_PACK_ALIGNMENT:
+      case WEBGL_UNPACK_ALIGNMENT:
+        if (param != 1 && param != 2 && param != 4 && param != 8)
+          return false;
+        (pname == WEBGL_PACK_ALIGNMENT ? packAlignment_ : unpackAlignment_) = param;
+        return true;
+      case WEBGL_UNPACK_FLIP_Y_WEBGL:
+        unpackFlipY_ = param != 0;
+        return true;
+      case WEBGL_UNPACK_PREMULTIPLY_ALPHA_WEBGL:
+        unpackPremultiplyAlpha_ = param != 0;
+        return true;
+      case WEBGL_UNPACK_COLORSPACE_CONVERSION_WEBGL:
+        if (param != WEBGL_NONE && param != WEBGL_BROWSER_DEFAULT_WEBGL)
+          return false;
+        unpackColorspaceConversion_ = param;
+        return true;
+      default:
+        break;
+      }
+
+      auto value = Webgl2PixelStoreOf(*this, pname);
+      if (value == nullptr || param < 0)
+        return false;
+      *value = param;
+      return true;
+    }
+
+  public: // queries
+    std::optional<bool> isEnabled(int cap) const
+    {
+      auto capability = CapabilityOf(*this, cap);
+      if (capability == nullptr)
+        return std::nullopt;
+      return *capability;
+    }
+    std::optional<bool> getBoolean(int pname) const
+    {
+      switch (pname)
+      {
+      case WEBGL_DEPTH_WRITEMASK:
+        return depthMask_;
+      case WEBGL_UNPACK_FLIP_Y_WEBGL:
+        return unpackFlipY_;
+      case WEBGL_UNPACK_PREMULTIPLY_ALPHA_WEBGL:
+        return unpackPremultiplyAlpha_;
+      default:
+        // The capabilities are also queried via `getParameter()`.
+        return isEnabled(pname);
+      }
+    }
+    std::optional<std::array<bool, 4>> getBooleanv(int pname) const
+    {
+      if (pname == WEBGL_COLOR_WRITEMASK)
+        return colorMask_;
+      return std::nullopt;
+    }
+    std::optional<int> getInteger(int pname) const
+    {
+      switch (pname)
+      {
+      case WEBGL_ACTIVE_TEXTURE:
+        return activeTexture_;
+      case WEBGL_BLEND_EQUATION_RGB:
+        return blendEquationRgb_;
+      case WEBGL_BLEND_EQUATION_ALPHA:
+        return blendEquationAlpha_;
+      case WEBGL_BLEND_SRC_RGB:
+        return blendSrcRgb_;
+      case WEBGL_BLEND_DST_RGB:
+        return blendDstRgb_;
+      case WEBGL_BLEND_SRC_ALPHA:
+        return blendSrcAlpha_;
+      case WEBGL_BLEND_DST_ALPHA:
+        return blendDstAlpha_;
+      case WEBGL_DEPTH_FUNC:
+        return depthFunc_;
+      case WEBGL_STENCIL_FUNC:
+        return stencilFunc_;
+      case WEBGL_STENCIL_FAIL:
+        return stencilOp_[0];
+      case WEBGL_STENCIL_PASS_DEPTH_FAIL:
+        return stencilOp_[1];
+      case WEBGL_STENCIL_PASS_DEPTH_PASS:
+        return stencilOp_[2];
+      case WEBGL_STENCIL_BACK_FUNC:
+        return stencilBackFunc_;
+      case WEBGL_STENCIL_BACK_FAIL:
+        return stencilBackOp_[0];
+      case WEBGL_STENCIL_BACK_PASS_DEPTH_FAIL:
+        return stencilBackOp_[1];
+      case WEBGL_STENCIL_BACK_PASS_DEPTH_PASS:
+        return stencilBackOp_[2];
+      case WEBGL_STENCIL_CLEAR_VALUE:
+        return clearStencil_;
+      case WEBGL_CULL_FACE_MODE:
+        return cullFaceMode_;
+      case WEBGL_FRONT_FACE:
+        return frontFace_;
+      case WEBGL_GENERATE_MIPMAP_HINT:
+        return generateMipmapHint_;
+      case WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT:
+        if (!isWebGL2_)
+          return std::nullopt;
+        return fragmentShaderDerivativeHint_;
+      case WEBGL_PACK_ALIGNMENT:
+        return packAlignment_;
+      case WEBGL_UNPACK_ALIGNMENT:
+        return unpackAlignment_;
+      case WEBGL_UNPACK_COLORSPACE_CONVERSION_WEBGL:
+        return unpackColorspaceConversion_;
+      default:
+        break;
+      }
+
+      auto value = Webgl2PixelStoreOf(*this, pname);
+      if (value == nullptr)
+        return std::nullopt;
+      return *value;
+    }
+    std::optional<float> getFloat(int pname) const
+    {
+      switch (pname)
+      {
+      case WEBGL_DEPTH_CLEAR_VALUE:
+        return clearDepth_;
+      case WEBGL_LINE_WIDTH:
+        return lineWidth_;
+      case WEBGL_POLYGON_OFFSET_FACTOR:
+        return polygonOffsetFactor_;
+      case WEBGL_POLYGON_OFFSET_UNITS:
+        return polygonOffsetUnits_;
+      default:
+        return std::nullopt;
+      }
+    }
+    std::optional<std::vector<float>> getFloatv(int pname) const
+    {
+      switch (pname)
+      {
+      case WEBGL_VIEWPORT:
+        return std::vector<float>(viewport_.begin(), viewport_.end());
+      case WEBGL_SCISSOR_BOX:
+        return std::vector<float>(scissorBox_.begin(), scissorBox_.end());
+      case WEBGL_BLEND_COLOR:
+        return std::vector<float>(blendColor_.begin(), blendColor_.end());
+      case WEBGL_COLOR_CLEAR_VALUE:
+        return std::vector<float>(clearColor_.begin(), clearColor_.end());
+      case WEBGL_DEPTH_RANGE:
+        return std::vector<float>(depthRange_.begin(), depthRange_.end());
+      default:
+        return std::nullopt;
+      }
+    }
+
+  public:
+    inline bool unpackFlipY() const
+    {
+      return unpackFlipY_;
+    }
+    inline bool unpackPremultiplyAlpha() const
+    {
+      return unpackPremultiplyAlpha_;
+    }
+    inline int unpackAlignment() const
+    {
+      return unpackAlignment_;
+    }
+    inline const std::array<int, 4> &viewport() const
+    {
+      return viewport_;
+    }
+
+  private:
+    static bool IsBlendEquation(int mode)
+    {
+      return mode == WEBGL_FUNC_ADD || mode == WEBGL_FUNC_SUBTRACT || mode == WEBGL_FUNC_REVERSE_SUBTRACT ||
+             mode == WEBGL2_MIN || mode == WEBGL2_MAX;
+    }
+    static bool IsBlendFactor(int factor)
+    {
+      return factor == WEBGL_ZERO || factor == WEBGL_ONE ||
+             (factor >= WEBGL_SRC_COLOR && factor <= WEBGL_SRC_ALPHA_SATURATE) ||
+             (factor >= WEBGL_CONSTANT_COLOR && factor <= WEBGL_ONE_MINUS_CONSTANT_ALPHA);
+    }
+    static bool IsCompareFunc(int func)
+    {
+      return func >= WEBGL_NEVER && func <= WEBGL_ALWAYS;
+    }
+    static bool IsStencilOp(int op)
+    {
+      return op == WEBGL_ZERO || op == WEBGL_KEEP || op == WEBGL_REPLACE || op == WEBGL_INCR || op == WEBGL_DECR ||
+             op == WEBGL_INVERT || op == WEBGL_INCR_WRAP || op == WEBGL_DECR_WRAP;
+    }
+    static bool IsFace(int face)
+    {
+      return face == WEBGL_FRONT || face == WEBGL_BACK || face == WEBGL_FRONT_AND_BACK;
+    }
+
+    // The blend and clear colors are clamped in WebGL 1.0 only.
+    inline float clampColor(float value) const
+    {
+      return isWebGL2_ ? value : std::clamp(value, 0.0f, 1.0f);
+    }
+    // The lookups are shared by the setters and the const queries, thus `Self` is either const or not.
+    template <typename Self>
+    static auto CapabilityOf(Self &self, int cap) -> decltype(&self.blend_)
+    {
+      switch (cap)
+      {
+      case WEBGL_BLEND:
+        return &self.blend_;
+      case WEBGL_CULL_FACE:
+        return &self.cullFace_;
+      case WEBGL_DEPTH_TEST:
+        return &self.depthTest_;
+      case WEBGL_DITHER:
+        return &self.dither_;
+      case WEBGL_POLYGON_OFFSET_FILL:
+        return &self.polygonOffsetFill_;
+      case WEBGL_SAMPLE_ALPHA_TO_COVERAGE:
+        return &self.sampleAlphaToCoverage_;
+      case WEBGL_SAMPLE_COVERAGE:
+        return &self.sampleCoverage_;
+      case WEBGL_SCISSOR_TEST:
+        return &self.scissorTest_;
+      case WEBGL_STENCIL_TEST:
+        return &self.stencilTest_;
+      case WEBGL2_RASTERIZER_DISCARD:
+        return self.isWebGL2_ ? &self.rasterizerDiscard_ : nullptr;
+      default:
+        return nullptr;
+      }
+    }
+    template <typename Self>
+    static auto Webgl2PixelStoreOf(Self &self, int pname) -> decltype(&self.packRowLength_)
+    {
+      if (!self.isWebGL2_)
+        return nullptr;
+      switch (pname)
+      {
+      case WEBGL2_PACK_ROW_LENGTH:
+        return &self.packRowLength_;
+      case WEBGL2_PACK_SKIP_ROWS:
+        return &self.packSkipRows_;
+      case WEBGL2_PACK_SKIP_PIXELS:
+        return &self.packSkipPixels_;
+      case WEBGL2_UNPACK_ROW_LENGTH:
+        return &self.unpackRowLength_;
+      case WEBGL2_UNPACK_IMAGE_HEIGHT:
+        return &self.unpackImageHeight_;
+      case WEBGL2_UNPACK_SKIP_ROWS:
+        return &self.unpackSkipRows_;
+      case WEBGL2_UNPACK_SKIP_PIXELS:
+        return &self.unpackSkipPixels_;
+      case WEBGL2_UNPACK_SKIP_IMAGES:
+        return &self.unpackSkipImages_;
+      default:
+        return nullptr;
+      }
+    }
+
+  private:
+    bool isWebGL2_;
+    int maxCombinedTextureImageUnits_ = 8;
+
+    // Capabilities
+    bool blend_ = false;
+    bool cullFace_ = false;
+    bool depthTest_ = false;
+    bool dither_ = true;
+    bool polygonOffsetFill_ = false;
+    bool sampleAlphaToCoverage_ = false;
+    bool sampleCoverage_ = false;
+    bool scissorTest_ = false;
+    bool stencilTest_ = false;
+    bool rasterizerDiscard_ = false;
+
+    // Blend
+    std::array<float, 4> blendColor_ = {0.0f, 0.0f, 0.0f, 0.0f};
+    int blendEquationRgb_ = WEBGL_FUNC_ADD;
+    int blendEquationAlpha_ = WEBGL_FUNC_ADD;
+    int blendSrcRgb_ = WEBGL_ONE;
+    int blendDstRgb_ = WEBGL_ZERO;
+    int blendSrcAlpha_ = WEBGL_ONE;
+    int blendDstAlpha_ = WEBGL_ZERO;
+
+    // Depth and stencil, the stencil operations are in the order of fail, zfail and zpass.
+    int depthFunc_ = WEBGL_LESS;
+    bool depthMask_ = true;
+    std::array<float, 2> depthRange_ = {0.0f, 1.0f};
+    int stencilFunc_ = WEBGL_ALWAYS;
+    int stencilBackFunc_ = WEBGL_ALWAYS;
+    std::array<int, 3> stencilOp_ = {WEBGL_KEEP, WEBGL_KEEP, WEBGL_KEEP};
+    std::array<int, 3> stencilBackOp_ = {WEBGL_KEEP, WEBGL_KEEP, WEBGL_KEEP};
+
+    // Rasterization and output
+    std::array<bool, 4> colorMask_ = {true, true, true, true};
+    int cullFaceMode_ = WEBGL_BACK;
+    int frontFace_ = WEBGL_CCW;
+    float lineWidth_ = 1.0f;
+    float polygonOffsetFactor_ = 0.0f;
+    float polygonOffsetUnits_ = 0.0f;
+    int generateMipmapHint_ = WEBGL_DONT_CARE;
+    int fragmentShaderDerivativeHint_ = WEBGL_DONT_CARE;
+    std::array<int, 4> viewport_ = {0, 0, 0, 0};
+    std::array<int, 4> scissorBox_ = {0, 0, 0, 0};
+    int activeTexture_ = WEBGL_TEXTURE0;
+
+    // Clear values
+    std::array<float, 4> clearColor_ = {0.0f, 0.0f, 0.0f, 0.0f};
+    float clearDepth_ = 1.0f;
+    int clearStencil_ = 0;
+
+    // Pixel store
+    int packAlignment_ = 4;
+    int unpackAlignment_ = 4;
+    bool unpackFlipY_ = false;
+    bool unpackPremultiplyAlpha_ = false;
+    int unpackColorspaceConversion_ = WEBGL_BROWSER_DEFAULT_WEBGL;
+    int packRowLength_ = 0;
+    int packSkipRows_ = 0;
+    int packSkipPixels_ = 0;
+    int unpackRowLength_ = 0;
+    int unpackImageHeight_ = 0;
+    int unpackSkipRows_ = 0;
+    int unpackSkipPixels_ = 0;
+    int unpackSkipImages_ = 0;
+  };
+}
@@ -151,4 +151,82 @@ namespace dom
     if (document != nullptr)
       document->styleCache().resetStyle(getPtr<HTMLElement>());
   }
+
+  void HTMLElement::invalidateStyleForIdChange(const string &oldId, const string &newId)
+  {
+    auto invalidationSet = this->invalidationSet();
+    if (invalidationSet == nullptr)
+    {
+      markAsDirty();
+      return;
+    }
+
+    uint8_t flags = client_cssom::selectors::kInvalidateNone;
+    if (!oldId.empty())
+      flags |= invalidationSet->flagsForId(oldId);
+    if (!newId.empty())
+      flags |= invalidationSet->flagsForId(newId);
+    invalidateStyleWithFlags(flags);
+  }
+
+  void HTMLElement::invalidateStyleForClassChange(const DOMTokenList &oldClassList, const DOMTokenList &newClassList)
+  {
+    auto invalidationSet = this->invalidationSet();
+    if (invalidationSet == nullptr)
+    {
+      markAsDirty();
+      return;
+    }
+
+    // Only the added or removed classes could change the matched rules.
+    uint8_t flags = client_cssom::selectors::kInvalidateNone;
+    for (const auto &className : oldClassList)
+    {
+      if (!newClassList.contains(className))
+        flags |= invalidationSet->flagsForClass(className);
+    }
+    for (const auto &className : newClassList)
+    {
+      if (!oldClassList.contains(className))
+        flags |= invalidationSet->flagsForClass(className);
+    }
+    invalidateStyleWithFlags(flags);
+  }
+
+  void HTMLElement::invalidateStyleForActionStateChange()
+  {
+    auto invalidationSet = this->invalidationSet();
+    if (invalidationSet == nullptr)
+    {
+      markAsDirty();
+      return;
+    }
+    invalidateStyleWithFlags(invalidationSet->flagsForActionState());
+  }
+
+  void HTMLElement::invalidateStyleWithFlags(uint8_t flags)
+  {
+    if (flags & client_cssom::selectors::kInvalidateSelf)
+      markAsDirty();
+    else if (flags & client_cssom::selectors::kInvalidateSubtree)
+      Element::markAsDirty(); // Only the descendants are affected, thus keep the style of this element.
+
+    if (flags & client_cssom::selectors::kInvalidateSubtree)
+    {
+      auto document = getOwnerDocumentReference();
+      if (document != nullptr)
+        document->styleCache().resetDescendantStyles(getPtr<HTMLElement>());
+    }
+  }
+
+  const client_cssom::selectors::InvalidationSet *HTMLElement::invalidationSet()
+  {
+    auto document = getOwnerDocumentReference();
+    if (document == nullptr)
+      return nullptr;
+
+    auto &ruleSet = document->ruleSet();
+    ruleSet.updateIfNeeded(document->styleSheets());
+    return &ruleSet.invalidationSet();
+  }
 }
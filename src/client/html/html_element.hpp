@@ -7,6 +7,7 @@
 #include <client/builtin_scene/scene.hpp>
 #include <client/cssom/css_style_declaration.hpp>
 #include <client/cssom/box_offset.hpp>
+#include <client/cssom/selectors/invalidation_set.hpp>
 #include <client/dom/element.hpp>
 
 namespace dom
@@ -60,6 +61,9 @@ namespace dom
 
   protected:
     void markAsDirty() override;
+    void invalidateStyleForIdChange(const std::string &oldId, const std::string &newId) override;
+    void invalidateStyleForClassChange(const DOMTokenList &oldClassList, const DOMTokenList &newClassList) override;
+    void invalidateStyleForActionStateChange() override;
 
   private:
     bool isHTMLElement() const override final
@@ -67,6 +71,10 @@ namespace dom
       return true;
     }
     void invalidateStyleCache();
+    // Invalidate the style of this element and its descendants by the flags from the document's rule set.
+    void invalidateStyleWithFlags(uint8_t flags);
+    // Returns the invalidation set of the owner document's rule set, or nullptr if the element is not in a document.
+    const client_cssom::selectors::InvalidationSet *invalidationSet();
 
   public:
     HTMLElementDirection dir = HTMLElementDirection::LTR;
@@ -1,10 +1,5 @@
 #include <iostream>
 #include <optional>
-#include <skia/include/codec/SkCodec.h>
-#include <skia/include/codec/SkPngDecoder.h>
-#include <skia/include/codec/SkJpegDecoder.h>
-#include <skia/include/codec/SkWebpDecoder.h>
-#include <skia/include/codec/SkGifDecoder.h>
 #include <common/image/image_processor.hpp>
 #include <crates/bindings.hpp>
 #include <client/per_process.hpp>
@@ -15,6 +10,7 @@
 #include <client/layout/layout_image.hpp>
 
 #include "./html_image_element.hpp"
+#include "./image_decoder.hpp"
 
 namespace dom
 {
@@ -22,6 +18,18 @@ namespace dom
   using namespace builtin_scene;
   using namespace crates::layout2::styles;
 
+  HTMLImageElement::~HTMLImageElement()
+  {
+    if (load_async_handle_ != nullptr)
+    {
+      // The handle is released after it's closed by the loop, and no more loading is run after the element is destroyed.
+      load_async_handle_->data = nullptr;
+      uv_close(reinterpret_cast<uv_handle_t *>(load_async_handle_), [](uv_handle_t *handle)
+               { delete reinterpret_cast<uv_async_t *>(handle); });
+      load_async_handle_ = nullptr;
+    }
+  }
+
   void HTMLImageElement::createdCallback(bool from_scripting)
   {
     HTMLElement::createdCallback(from_scripting);
@@ -40,10 +48,16 @@ namespace dom
     HTMLElement::connectedCallback();
     sk_bitmap_ = make_shared<SkBitmap>();
 
-    load_async_handle_.data = this;
-    uv_async_init(TrClientContextPerProcess::Get()->getScriptingEventLoop(), &load_async_handle_, [](uv_async_t *handle)
+    // The element might be connected again, the handle is initialized once.
+    if (load_async_handle_ != nullptr)
+      return;
+    load_async_handle_ = new uv_async_t;
+    load_async_handle_->data = this;
+    uv_async_init(TrClientContextPerProcess::Get()->getScriptingEventLoop(), load_async_handle_, [](uv_async_t *handle)
                   {
                     auto imageElement = static_cast<HTMLImageElement *>(handle->data);
+                    if (imageElement == nullptr)
+                      return;
                     auto imageSrc = imageElement->getSrc();
                     imageElement->fetchImage(imageSrc); });
   }
@@ -107,12 +121,12 @@ namespace dom
   {
     if (is_src_image_loading ||
         is_src_image_loaded_ ||
-        TR_UNLIKELY(load_async_handle_.data != this))
+        TR_UNLIKELY(load_async_handle_ == nullptr))
       return;
 
     // Schedule the image loading on the scripting thread.
     is_src_image_loading = true;
-    uv_async_send(&load_async_handle_);
+    uv_async_send(load_async_handle_);
   }
 
   void HTMLImageElement::fetchImage(const string &src)
@@ -135,153 +149,90 @@ namespace dom
     browsingContext->fetchImageResource(src, responseCallback);
   }
 
-  bool HTMLImageElement::decodeImage(SkBitmap &bitmap)
+  void HTMLImageElement::setVisibleInViewport(bool visible)
   {
-    static constexpr const SkCodecs::Decoder decoders[] = {
-      SkPngDecoder::Decoder(),
-      SkJpegDecoder::Decoder(),
-      SkWebpDecoder::Decoder(),
-      SkGifDecoder::Decoder()};
-
-    if (is_src_image_decoded_)
-      return true;
-
-    sk_sp<SkData> imageData = SkData::MakeWithoutCopy(image_data_->data(), image_data_->size());
-    unique_ptr<SkCodec> codec = SkCodec::MakeFromData(imageData, decoders);
-    if (codec)
-    {
-      try
-      {
-        SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType);
-        int max_size = std::max(info.width(), info.height());
-        if (max_size > transmute::ImageProcessor::DEFAULT_MAX_IMAGE_SIZE)
-        {
-          // We need to constrain the image size to avoid the huge memory usage, for example, if there are 20 images,
-          // each image is 4096x4096, the total size will be 20 * 4096 * 4096 * 4 = 20 * 64MB ~ 1.28GB, which is too
-          // much for a single application.
-          //
-          // In Web standard, no guarantee that the image size is less than a certain size, in JSAR, we do downsample
-          // the oversized image to fit the maximum allowed size to avoid the huge memory usage for the
-          // back-compatibility.
-          //
-          // TODO(yorkie): support tweaking or disabling for different platforms?
-          int original_width = info.width();
-          int original_height = info.height();
-          float scale = std::min(
-            static_cast<float>(transmute::ImageProcessor::DEFAULT_MAX_IMAGE_SIZE) / original_width,
-            static_cast<float>(transmute::ImageProcessor::DEFAULT_MAX_IMAGE_SIZE) / original_height);
-          int scaled_width = static_cast<int>(original_width * scale);
-          int scaled_height = static_cast<int>(original_height * scale);
-          SkImageInfo scaled_info = info.makeWH(scaled_width, scaled_height);
-
-          // Allocate the scaled bitmap with the scaled image info.
-          SkBitmap scaled_bitmap;
-          scaled_bitmap.allocPixels(scaled_info);
-
-          // Call `getPixels()` first to check if the current codec supports scaling.
-          auto r = codec->getPixels(scaled_info, scaled_bitmap.getPixels(), scaled_bitmap.rowBytes());
-          if (r == SkCodec::kSuccess)
-          {
-            // Returns the scaled bitmap if the scaling is successful.
-            bitmap = scaled_bitmap;
-          }
-          else if (r == SkCodec::kInvalidScale)
-          {
-            // `InvalidScale` means the codec does not support scaling, so we need to do the scaling after decoding
-            // the original pixels.
-            SkBitmap original_bitmap;
-            original_bitmap.allocPixels(info);
-            const SkPixmap &original_pixmap = original_bitmap.pixmap();
-
-            // Decoding the original image pixels.
-            r = codec->getPixels(original_pixmap);
-            if (r != SkCodec::kSuccess)
-              throw runtime_error("Could not decode the original image data.");
-
-            // Use linear filtering to scale the original pixmap to the scaled bitmap.
-            if (original_pixmap.scalePixels(scaled_bitmap.pixmap(),
-                                            SkSamplingOptions(SkFilterMode::kLinear)))
-            {
-              bitmap = scaled_bitmap;
-            }
-            else
-            {
-              // FIXME(yorkie): should use `original_bitmap` as the fallback?
-              throw runtime_error("Could not scale a valid bitmap.");
-            }
-          }
-        }
-        else
-        {
-          // No need to scale if the image size is within the maximum allowed size.
-          bitmap.allocPixels(info);
-          auto r = codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes());
-          if (r != SkCodec::kSuccess)
-            throw runtime_error(SkCodec::ResultToString(r));
-        }
-        is_src_image_decoded_ = true;
-      }
-      catch (const exception &e)
-      {
-        cerr << "Failed to decode the image: " << e.what() << endl
-             << "    size: " << image_data_->size() << endl
-             << "    data: " << (image_data_->data() != nullptr ? "valid" : "(empty)") << endl;
-        is_src_image_decoded_ = false;
-      }
-    }
-    else
-    {
-      cerr << "Failed to create the image codec, url: " << getSrc() << endl;
-      is_src_image_decoded_ = false;
-    }
+    if (is_visible_in_viewport_.exchange(visible) == visible || !visible)
+      return;
 
-    // Release the image data when the decoding has completed or errored.
-    image_data_->clear();
-    image_data_.reset();
-    return is_src_image_decoded_;
+    auto decoder = pending_decoder_.load();
+    if (decoder == nullptr)
+      return;
+
+    // The pending decoding is owned by the scripting thread, thus the priority is changed at the decoder's loop.
+    auto weakThis = getWeakPtr<HTMLImageElement>();
+    decoder->post([weakThis]()
+                  {
+                    auto imageElement = weakThis.lock();
+                    if (imageElement != nullptr)
+                      imageElement->prioritizeDecoding(); });
   }
 
-  void HTMLImageElement::decodeImageAsync(const SkBitmap &bitmap)
+  void HTMLImageElement::prioritizeDecoding()
   {
-    auto work = [](uv_work_t *handle)
+    auto decoder = pending_decoder_.load();
+    if (decoder == nullptr || decoding_src_.empty() || !is_visible_in_viewport_)
+      return;
+    decoder->prioritize(decoding_src_, transmute::ImageProcessor::DEFAULT_MAX_IMAGE_SIZE, ImageDecodePriority::kVisible);
+  }
+
+  void HTMLImageElement::decodeImageAsync()
+  {
+    auto src = getSrc();
+    decoding_src_ = src;
+
+    // Move the image data to the decoder, it's released when the decoding has completed or errored.
+    auto imageData = make_shared<const vector<char>>(std::move(image_data_.value()));
+    image_data_.reset();
+
+    auto weakThis = getWeakPtr<HTMLImageElement>();
+    auto callback = [weakThis, src](sk_sp<SkImage> image)
     {
-      if (handle != nullptr && handle->data != nullptr)
+      auto context = TrClientContextPerProcess::Get();
+      auto stats = context->getImageDecoder().stats();
+      context->getPerfFs().setImageDecodes(stats.cacheHits, stats.cacheMisses, stats.coalesced);
+
+      auto imageElement = weakThis.lock();
+      if (imageElement == nullptr)
+        return;
+      if (imageElement->decoding_src_ == src)
       {
-        auto imageElement = static_cast<HTMLImageElement *>(handle->data);
-        imageElement->decodeImage(*imageElement->sk_bitmap_);
+        imageElement->decoding_src_.clear();
+        imageElement->pending_decoder_ = nullptr;
       }
-    };
-    auto afterWork = [](uv_work_t *handle, int status)
-    {
-      if (handle != nullptr && handle->data != nullptr)
+      // Ignore the decoded image if the source has been changed.
+      if (imageElement->getSrc() != src)
+        return;
+
+      if (image != nullptr)
       {
-        auto imageElement = static_cast<HTMLImageElement *>(handle->data);
-        if (imageElement->is_src_image_decoded_)
-        {
-          imageElement->onImageDecoded(*imageElement->sk_bitmap_);
-
-          // Mark the image is completed.
-          imageElement->complete = true;
-          imageElement->dispatchEvent(DOMEventType::Load);
-        }
-        else
-        {
-          imageElement->dispatchEvent(DOMEventType::Error);
-          // TODO(yorkie): paint a placeholder image.
-        }
+        imageElement->onImageDecoded(image);
+
+        // Mark the image is completed.
+        imageElement->complete = true;
+        imageElement->dispatchEvent(DOMEventType::Load);
       }
       else
       {
-        assert(false);
+        imageElement->dispatchEvent(DOMEventType::Error);
+        // TODO(yorkie): paint a placeholder image.
       }
     };
 
-    // Schedule the image decoding on the scripting thread.
-    decode_work_handle_.data = this;
-    uv_queue_work(TrClientContextPerProcess::Get()->getScriptingEventLoop(),
-                  &decode_work_handle_,
-                  work,
-                  afterWork);
+    // Schedule the image decoding on the decoder's threads, the callback is called on the scripting thread.
+    auto &decoder = TrClientContextPerProcess::Get()->getImageDecoder();
+    pending_decoder_ = &decoder;
+    decoder.decode(src, imageData, transmute::ImageProcessor::DEFAULT_MAX_IMAGE_SIZE, decodingPriority(), callback);
+  }
+
+  ImageDecodePriority HTMLImageElement::decodingPriority() const
+  {
+    // The images which are not in the document are not painted, such as the ones used by canvas or WebGL textures.
+    if (!connected)
+      return ImageDecodePriority::kLow;
+    // The lazy images are loaded only when they are visible in the viewport.
+    if (is_visible_in_viewport_ || loading_ == LoadingHint::kLoadingLazy)
+      return ImageDecodePriority::kVisible;
+    return ImageDecodePriority::kNormal;
   }
 
   void HTMLImageElement::onImageDataReady()
@@ -311,16 +262,27 @@ namespace dom
     assert(sk_bitmap_ != nullptr && "The image bitmap is not created yet.");
 
     // TODO(yorkie): support `decoding` options.
-    decodeImageAsync(*sk_bitmap_);
+    decodeImageAsync();
   }
 
-  void HTMLImageElement::onImageDecoded(const SkBitmap &bitmap)
+  void HTMLImageElement::onImageDecoded(sk_sp<SkImage> image)
   {
+    // The bitmap shares the pixels with the decoded image which may be shared with other elements, thus a new bitmap is
+    // created instead of writing to the current one.
+    auto bitmap = make_shared<SkBitmap>();
+    if (!image->asLegacyBitmap(bitmap.get()))
+    {
+      dispatchEvent(DOMEventType::Error);
+      return;
+    }
+    sk_bitmap_ = bitmap;
+    is_src_image_decoded_ = true;
+
     // Use natural width and height if the width and height are not set.
     if (!width_.has_value())
-      width_ = bitmap.width();
+      width_ = bitmap->width();
     if (!height_.has_value())
-      height_ = bitmap.height();
+      height_ = bitmap->height();
 
     if (!connected)
       return;
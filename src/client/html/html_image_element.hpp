@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <skia/include/core/SkImage.h>
 #include <skia/include/core/SkBitmap.h>
@@ -7,10 +8,13 @@
 #include <client/dom/geometry/dom_rect.hpp>
 
 #include "./html_element.hpp"
+#include "./image_decode_scheduler.hpp"
 #include "../canvas/image_source.hpp"
 
 namespace dom
 {
+  class ImageDecoder;
+
   class HTMLImageElement final : public HTMLElement,
                                  public canvas::ImageSource
   {
@@ -45,6 +49,7 @@ namespace dom
         , canvas::ImageSource()
     {
     }
+    ~HTMLImageElement();
 
   public:
     void createdCallback(bool from_scripting) override;
@@ -101,13 +106,20 @@ namespace dom
      */
     void loadImageAsync();
 
+    /**
+     * Update if the image is visible in the viewport, the pending decoding of a visible image is moved ahead of the others.
+     * It could be called from the non-scripting thread, the priority is changed at the scripting thread via the decoder.
+     */
+    void setVisibleInViewport(bool visible);
+
   private:
     void fetchImage(const std::string &src);
-    bool decodeImage(SkBitmap &);
-    void decodeImageAsync(const SkBitmap &bitmap);
+    void decodeImageAsync();
+    void prioritizeDecoding();
+    ImageDecodePriority decodingPriority() const;
 
     void onImageDataReady();
-    void onImageDecoded(const SkBitmap &bitmap);
+    void onImageDecoded(sk_sp<SkImage> image);
     void onSizeDidChange();
 
     // Validate if the current size is valid to create bitmap.
@@ -192,8 +204,13 @@ namespace dom
     }
 
   private:
-    uv_async_t load_async_handle_;
-    uv_work_t decode_work_handle_;
+    // The handle is allocated at the heap, because it's released after it's closed by the loop.
+    uv_async_t *load_async_handle_ = nullptr;
+    std::atomic<bool> is_visible_in_viewport_ = false;
+    // The URL of the pending decoding.
+    std::string decoding_src_;
+    // The decoder of the pending decoding, it's used to change the priority from the non-scripting thread.
+    std::atomic<ImageDecoder *> pending_decoder_ = nullptr;
 
     std::optional<int> width_;
     std::optional<int> height_;
@@ -56,11 +56,11 @@ namespace dom
     {
       auto &styleSheets = ownerDocument->stylesheets_;
       styleSheets.erase(std::remove(styleSheets.begin(), styleSheets.end(), styleSheet_), styleSheets.end());
-      styleSheet_.reset();
 
-      // Invalidate the cache after removing the stylesheet
-      // TODO: Just remove the cache for this sheet?
-      ownerDocument->style_cache_.invalidateCache();
+      // Invalidate the styles which could be matched by the removed stylesheet.
+      ownerDocument->invalidateStylesForSheet(*styleSheet_);
+      ownerDocument->rule_set_.invalidate();
+      styleSheet_.reset();
     }
   }
 
@@ -90,6 +90,7 @@ namespace dom
     styleSheet_ = sheet;
     auto &document = getOwnerDocumentChecked();
     document.stylesheets_.push_back(sheet);
-    document.style_cache_.invalidateCache();
+    document.invalidateStylesForSheet(*sheet);
+    document.rule_set_.invalidate();
   }
 }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dom
+{
+  /**
+   * The process-wide memory cache of the decoded images, which is keyed by the URL and the target size, thus the downscaled
+   * variants of an image are cached separately.
+   *
+   * The least recently used images are evicted when the total bytes exceed the budget, an evicted image is still alive while
+   * any element references it. It's templated on the decoded image type which should be a nullable reference, such as
+   * `sk_sp<SkImage>`, and it's thread-safe.
+   */
+  template <typename Image>
+  class ImageDecodeCache
+  {
+  public:
+    /**
+     * The default budget of the images, which holds about 16 images of 1024x1024 RGBA pixels.
+     */
+    static constexpr size_t kDefaultBudgetBytes = 64 * 1024 * 1024;
+
+    struct Stats
+    {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t evictions = 0;
+    };
+
+  public:
+    ImageDecodeCache(size_t budgetBytes = kDefaultBudgetBytes)
+        : budgetBytes_(budgetBytes)
+    {
+    }
+
+  public:
+    /**
+     * Find the image of the given key, and mark it as the most recently used.
+     *
+     * @returns The image, or a null image if the key is missed.
+     */
+    Image find(const std::string &key)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(key);
+      if (it == entries_.end())
+      {
+        stats_.misses += 1;
+        return Image();
+      }
+      lru_.splice(lru_.begin(), lru_, it->second.position);
+      stats_.hits += 1;
+      return it->second.image;
+    }
+    /**
+     * Insert the image of the given key, it replaces the existing entry and evicts the least recently used images if needed.
+     * The image larger than the budget is not inserted.
+     *
+     * @param bytes The bytes of the image pixels.
+     */
+    void insert(const std::string &key, Image image, size_t bytes)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (bytes > budgetBytes_)
+        return;
+
+      auto it = entries_.find(key);
+      if (it != entries_.end())
+      {
+        totalBytes_ -= it->second.bytes;
+        lru_.erase(it->second.position);
+        entries_.erase(it);
+      }
+      while (totalBytes_ + bytes > budgetBytes_ && !lru_.empty())
+      {
+        auto last = entries_.find(lru_.back());
+        totalBytes_ -= last->second.bytes;
+        entries_.erase(last);
+        lru_.pop_back();
+        stats_.evictions += 1;
+      }
+
+      lru_.push_front(key);
+      entries_[key] = Entry{std::move(image), bytes, lru_.begin()};
+      totalBytes_ += bytes;
+    }
+
+  public:
+    size_t size()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return entries_.size();
+    }
+    size_t totalBytes()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return totalBytes_;
+    }
+    Stats stats()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return stats_;
+    }
+
+  private:
+    struct Entry
+    {
+      Image image;
+      size_t bytes;
+      std::list<std::string>::iterator position;
+    };
+
+  private:
+    size_t budgetBytes_;
+    size_t totalBytes_ = 0;
+    // The keys from the most recently used to the least recently used.
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, Entry> entries_;
+    Stats stats_;
+    std::mutex mutex_;
+  };
+}
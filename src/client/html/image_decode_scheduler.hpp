@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dom
+{
+  /**
+   * The priority of an image decoding, the higher ones are decoded first.
+   */
+  enum class ImageDecodePriority
+  {
+    // The images which are not in the document, such as `new Image()`.
+    kLow = 0,
+    // The images in the document which are not known to be visible yet.
+    kNormal = 1,
+    // The images which are visible in the viewport.
+    kVisible = 2,
+  };
+
+  /**
+   * The scheduler which decodes the images at its own worker threads instead of the libuv's threadpool, which is shared with
+   * the file system and the DNS operations.
+   *
+   * The jobs are picked by the priority, then by the scheduling order. The jobs of the same key, namely the same URL and the
+   * target size, are coalesced: when a job is queued or running, scheduling the same key only appends the callback and raises
+   * the priority, thus the image is decoded once for all the elements sharing it.
+   *
+   * It's templated on the decoded image type to keep the scheduling independent of the codecs. The callbacks are called at the
+   * worker thread.
+   */
+  template <typename Image>
+  class ImageDecodeScheduler
+  {
+  public:
+    using DecodeFunction = std::function<Image()>;
+    using Callback = std::function<void(const Image &)>;
+
+    struct Stats
+    {
+      size_t scheduled = 0;
+      size_t coalesced = 0;
+      size_t decoded = 0;
+    };
+
+  public:
+    /**
+     * Create the scheduler with the given count of the worker threads.
+     */
+    ImageDecodeScheduler(size_t threadsCount)
+    {
+      threadsCount = std::max<size_t>(threadsCount, 1);
+      for (size_t i = 0; i < threadsCount; i++)
+        workers_.emplace_back([this]()
+                              { work(); });
+    }
+    /**
+     * It waits for the running jobs, and drops the queued ones without calling their callbacks.
+     */
+    ~ImageDecodeScheduler()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      condition_.notify_all();
+      for (auto &worker : workers_)
+        worker.join();
+    }
+
+  public:
+    /**
+     * Schedule to decode an image.
+     *
+     * @param key The key to coalesce the jobs, such as the URL and the target size.
+     * @param priority The priority of the job.
+     * @param decode The function to decode the image, which is ignored if the job is coalesced.
+     * @param callback The callback to receive the decoded image.
+     * @returns `true` if the job is coalesced into a queued or running one.
+     */
+    bool schedule(const std::string &key, ImageDecodePriority priority, DecodeFunction decode, Callback callback)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.scheduled += 1;
+
+      auto it = jobs_.find(key);
+      if (it != jobs_.end())
+      {
+        auto job = it->second;
+        job->callbacks.push_back(std::move(callback));
+        raisePriorityLocked(job, priority);
+        stats_.coalesced += 1;
+        return true;
+      }
+
+      auto job = std::make_shared<Job>();
+      job->key = key;
+      job->priority = priority;
+      job->sequence = nextSequence_++;
+      job->decode = std::move(decode);
+      job->callbacks.push_back(std::move(callback));
+      jobs_[key] = job;
+      queue_.insert(job);
+      condition_.notify_one();
+      return false;
+    }
+    /**
+     * Raise the priority of the queued job of the given key, such as when the image becomes visible. It does nothing if the
+     * job is not queued or its priority is higher.
+     */
+    void prioritize(const std::string &key, ImageDecodePriority priority)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = jobs_.find(key);
+      if (it != jobs_.end())
+        raisePriorityLocked(it->second, priority);
+    }
+
+  public:
+    Stats stats()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return stats_;
+    }
+    /**
+     * @returns The count of the queued and running jobs.
+     */
+    size_t pendingJobs()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return jobs_.size();
+    }
+
+  private:
+    struct Job
+    {
+      std::string key;
+      ImageDecodePriority priority;
+      uint64_t sequence;
+      DecodeFunction decode;
+      std::vector<Callback> callbacks;
+      bool running = false;
+    };
+    struct JobOrder
+    {
+      bool operator()(const std::shared_ptr<Job> &a, const std::shared_ptr<Job> &b) const
+      {
+        if (a->priority != b->priority)
+          return a->priority > b->priority;
+        return a->sequence < b->sequence;
+      }
+    };
+
+    void raisePriorityLocked(std::shared_ptr<Job> job, ImageDecodePriority priority)
+    {
+      if (job->running || priority <= job->priority)
+        return;
+      // The order of the queue depends on the priority, thus the job is reinserted.
+      queue_.erase(job);
+      job->priority = priority;
+      queue_.insert(job);
+    }
+
+    void work()
+    {
+      while (true)
+      {
+        std::shared_ptr<Job> job;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          condition_.wait(lock, [this]()
+                          { return stopping_ || !queue_.empty(); });
+          if (stopping_)
+            return;
+          job = *queue_.begin();
+          queue_.erase(queue_.begin());
+          job->running = true;
+        }
+
+        Image image = job->decode();
+
+        std::vector<Callback> callbacks;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          // The callbacks appended while decoding are taken here, and the later scheduling of the key starts a new job.
+          callbacks = std::move(job->callbacks);
+          jobs_.erase(job->key);
+          stats_.decoded += 1;
+        }
+        for (auto &callback : callbacks)
+          callback(image);
+      }
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::unordered_map<std::string, std::shared_ptr<Job>> jobs_;
+    std::set<std::shared_ptr<Job>, JobOrder> queue_;
+    uint64_t nextSequence_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+    std::vector<std::thread> workers_;
+  };
+}
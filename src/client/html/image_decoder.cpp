@@ -0,0 +1,208 @@
+#include <iostream>
+#include <skia/include/codec/SkCodec.h>
+#include <skia/include/codec/SkPngDecoder.h>
+#include <skia/include/codec/SkJpegDecoder.h>
+#include <skia/include/codec/SkWebpDecoder.h>
+#include <skia/include/codec/SkGifDecoder.h>
+#include <skia/include/core/SkBitmap.h>
+
+#include "./image_decoder.hpp"
+
+namespace dom
+{
+  using namespace std;
+
+  string ImageDecoder::MakeKey(const string &url, int maxSize)
+  {
+    return url + "@" + to_string(maxSize);
+  }
+
+  sk_sp<SkImage> ImageDecoder::Decode(const vector<char> &data, int maxSize)
+  {
+    static constexpr const SkCodecs::Decoder decoders[] = {
+      SkPngDecoder::Decoder(),
+      SkJpegDecoder::Decoder(),
+      SkWebpDecoder::Decoder(),
+      SkGifDecoder::Decoder()};
+
+    sk_sp<SkData> imageData = SkData::MakeWithoutCopy(data.data(), data.size());
+    unique_ptr<SkCodec> codec = SkCodec::MakeFromData(imageData, decoders);
+    if (codec == nullptr)
+    {
+      cerr << "Failed to create the image codec, size: " << data.size() << endl;
+      return nullptr;
+    }
+
+    SkBitmap bitmap;
+    try
+    {
+      SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType);
+      if (std::max(info.width(), info.height()) > maxSize)
+      {
+        // We need to constrain the image size to avoid the huge memory usage, for example, if there are 20 images,
+        // each image is 4096x4096, the total size will be 20 * 4096 * 4096 * 4 = 20 * 64MB ~ 1.28GB, which is too
+        // much for a single application.
+        //
+        // In Web standard, no guarantee that the image size is less than a certain size, in JSAR, we do downsample
+        // the oversized image to fit the maximum allowed size to avoid the huge memory usage for the
+        // back-compatibility.
+        //
+        // TODO(yorkie): support tweaking or disabling for different platforms?
+        int original_width = info.width();
+        int original_height = info.height();
+        float scale = std::min(static_cast<float>(maxSize) / original_width,
+                               static_cast<float>(maxSize) / original_height);
+        int scaled_width = static_cast<int>(original_width * scale);
+        int scaled_height = static_cast<int>(original_height * scale);
+        SkImageInfo scaled_info = info.makeWH(scaled_width, scaled_height);
+
+        // Allocate the scaled bitmap with the scaled image info.
+        SkBitmap scaled_bitmap;
+        scaled_bitmap.allocPixels(scaled_info);
+
+        // Call `getPixels()` first to check if the current codec supports scaling.
+        auto r = codec->getPixels(scaled_info, scaled_bitmap.getPixels(), scaled_bitmap.rowBytes());
+        if (r == SkCodec::kSuccess)
+        {
+          // Returns the scaled bitmap if the scaling is successful.
+          bitmap = scaled_bitmap;
+        }
+        else if (r == SkCodec::kInvalidScale)
+        {
+          // `InvalidScale` means the codec does not support scaling, so we need to do the scaling after decoding
+          // the original pixels.
+          SkBitmap original_bitmap;
+          original_bitmap.allocPixels(info);
+          const SkPixmap &original_pixmap = original_bitmap.pixmap();
+
+          // Decoding the original image pixels.
+          r = codec->getPixels(original_pixmap);
+          if (r != SkCodec::kSuccess)
+            throw runtime_error("Could not decode the original image data.");
+
+          // Use linear filtering to scale the original pixmap to the scaled bitmap.
+          if (original_pixmap.scalePixels(scaled_bitmap.pixmap(),
+                                          SkSamplingOptions(SkFilterMode::kLinear)))
+          {
+            bitmap = scaled_bitmap;
+          }
+          else
+          {
+            // FIXME(yorkie): should use `original_bitmap` as the fallback?
+            throw runtime_error("Could not scale a valid bitmap.");
+          }
+        }
+        else
+        {
+          throw runtime_error(SkCodec::ResultToString(r));
+        }
+      }
+      else
+      {
+        // No need to scale if the image size is within the maximum allowed size.
+        bitmap.allocPixels(info);
+        auto r = codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes());
+        if (r != SkCodec::kSuccess)
+          throw runtime_error(SkCodec::ResultToString(r));
+      }
+    }
+    catch (const exception &e)
+    {
+      cerr << "Failed to decode the image: " << e.what() << endl
+           << "    size: " << data.size() << endl;
+      return nullptr;
+    }
+
+    // The immutable bitmap is shared by the image without copying, and it's safe to be read from any thread.
+    bitmap.setImmutable();
+    return SkImages::RasterFromBitmap(bitmap);
+  }
+
+  ImageDecoder::ImageDecoder(uv_loop_t *loop, size_t threadsCount)
+      : completion_handle_(new uv_async_t)
+      , scheduler_(std::make_unique<ImageDecodeScheduler<sk_sp<SkImage>>>(threadsCount))
+  {
+    completion_handle_->data = this;
+    uv_async_init(loop, completion_handle_, [](uv_async_t *handle)
+                  {
+                    auto decoder = static_cast<ImageDecoder *>(handle->data);
+                    if (decoder != nullptr)
+                      decoder->runPostedTasks(); });
+  }
+
+  ImageDecoder::~ImageDecoder()
+  {
+    scheduler_.reset();
+
+    // The handle is released after it's closed by the loop, and no more tasks are run after the decoder is destroyed.
+    completion_handle_->data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t *>(completion_handle_), [](uv_handle_t *handle)
+             { delete reinterpret_cast<uv_async_t *>(handle); });
+  }
+
+  void ImageDecoder::decode(const string &url, shared_ptr<const vector<char>> data, int maxSize,
+                            ImageDecodePriority priority, Callback callback)
+  {
+    auto key = MakeKey(url, maxSize);
+    auto cached = cache_.find(key);
+    if (cached != nullptr)
+    {
+      // The cached image is also returned asynchronously to keep the order of the events as the decoded ones.
+      post([callback, cached]()
+           { callback(cached); });
+      return;
+    }
+
+    auto decodeFn = [this, key, data, maxSize]() -> sk_sp<SkImage>
+    {
+      auto image = Decode(*data, maxSize);
+      if (image != nullptr)
+        cache_.insert(key, image, image->imageInfo().computeMinByteSize());
+      return image;
+    };
+    auto callbackFn = [this, callback](const sk_sp<SkImage> &image)
+    {
+      post([callback, image]()
+           { callback(image); });
+    };
+    scheduler_->schedule(key, priority, decodeFn, callbackFn);
+  }
+
+  void ImageDecoder::prioritize(const string &url, int maxSize, ImageDecodePriority priority)
+  {
+    scheduler_->prioritize(MakeKey(url, maxSize), priority);
+  }
+
+  ImageDecoder::Stats ImageDecoder::stats()
+  {
+    auto cacheStats = cache_.stats();
+    auto schedulerStats = scheduler_->stats();
+
+    Stats stats;
+    stats.cacheHits = cacheStats.hits;
+    stats.cacheMisses = cacheStats.misses;
+    stats.coalesced = schedulerStats.coalesced;
+    stats.decoded = schedulerStats.decoded;
+    return stats;
+  }
+
+  void ImageDecoder::post(function<void()> task)
+  {
+    {
+      lock_guard<mutex> lock(posted_tasks_mutex_);
+      posted_tasks_.push_back(std::move(task));
+    }
+    uv_async_send(completion_handle_);
+  }
+
+  void ImageDecoder::runPostedTasks()
+  {
+    vector<function<void()>> tasks;
+    {
+      lock_guard<mutex> lock(posted_tasks_mutex_);
+      tasks.swap(posted_tasks_);
+    }
+    for (auto &task : tasks)
+      task();
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <skia/include/core/SkImage.h>
+#include <node/uv.h>
+
+#include "./image_decode_cache.hpp"
+#include "./image_decode_scheduler.hpp"
+
+namespace dom
+{
+  /**
+   * The process-wide image decoder for the `HTMLImageElement`s, it decodes the images at the worker threads of the
+   * `ImageDecodeScheduler` and caches the decoded images in the `ImageDecodeCache`, then the callbacks are called at the
+   * scripting thread.
+   *
+   * The decoded images are immutable, thus an image is shared by the elements of the same URL without copying the pixels.
+   */
+  class ImageDecoder final
+  {
+  public:
+    using Callback = std::function<void(sk_sp<SkImage>)>;
+
+    /**
+     * The count of the decoding threads, 2 threads keep a visible image from waiting for a large one while leaving the
+     * cores to the scripting and rendering.
+     */
+    static constexpr size_t kDefaultThreadsCount = 2;
+
+    struct Stats
+    {
+      size_t cacheHits = 0;
+      size_t cacheMisses = 0;
+      size_t coalesced = 0;
+      size_t decoded = 0;
+    };
+
+  public:
+    /**
+     * Make the key of the decoded image, the images of the same URL but different target sizes are different.
+     *
+     * @param url The URL of the image.
+     * @param maxSize The maximum width and height of the decoded image.
+     */
+    static std::string MakeKey(const std::string &url, int maxSize);
+    /**
+     * Decode the image synchronously, the image larger than `maxSize` is downscaled to fit it.
+     *
+     * @returns The decoded immutable image, or `nullptr` if the data could not be decoded.
+     */
+    static sk_sp<SkImage> Decode(const std::vector<char> &data, int maxSize);
+
+  public:
+    /**
+     * Create the decoder whose callbacks are called at the given loop, it must be created at the thread of the loop.
+     */
+    ImageDecoder(uv_loop_t *loop, size_t threadsCount = kDefaultThreadsCount);
+    ~ImageDecoder();
+
+  public:
+    /**
+     * Decode the image data of the given URL, or return the cached image asynchronously.
+     *
+     * @param url The URL of the image, which is used as the cache key with the maximum size.
+     * @param data The encoded image data.
+     * @param maxSize The maximum width and height of the decoded image.
+     * @param priority The priority to schedule the decoding.
+     * @param callback The callback called at the loop thread with the decoded image, or `nullptr` on failure.
+     */
+    void decode(const std::string &url, std::shared_ptr<const std::vector<char>> data, int maxSize,
+                ImageDecodePriority priority, Callback callback);
+    /**
+     * Raise the priority of the pending decoding, it could be called from any thread.
+     */
+    void prioritize(const std::string &url, int maxSize, ImageDecodePriority priority);
+    /**
+     * Run the task at the loop thread, it could be called from any thread.
+     */
+    void post(std::function<void()> task);
+    Stats stats();
+
+  private:
+    void runPostedTasks();
+
+  private:
+    uv_async_t *completion_handle_;
+    std::mutex posted_tasks_mutex_;
+    std::vector<std::function<void()>> posted_tasks_;
+    ImageDecodeCache<sk_sp<SkImage>> cache_;
+    // The scheduler is reset at first in the destructor to join the workers which post the tasks.
+    std::unique_ptr<ImageDecodeScheduler<sk_sp<SkImage>>> scheduler_;
+  };
+}
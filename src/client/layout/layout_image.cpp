@@ -134,8 +134,10 @@ namespace client_layout
     }
 
     bool shouldVisible = fragment.visibleInViewport(viewRef().viewport);
+    auto &imageElement = Node::AsChecked<dom::HTMLImageElement>(node());
+    imageElement.setVisibleInViewport(shouldVisible);
     if (shouldVisible)
-      Node::AsChecked<dom::HTMLImageElement>(node()).loadImageAsync();
+      imageElement.loadImageAsync();
 
     setVisible(shouldVisible);
   }
@@ -73,21 +73,15 @@ namespace client_layout
     if (textContent.size() == 0)
       return ConstraintSpace::Zero();
 
-    auto paragraphStyle = webContentComponent->paragraphStyle();
-    auto paragraphBuilder = ParagraphBuilder::make(paragraphStyle,
-                                                   TrClientContextPerProcess::Get()->getFontCacheManager());
-    paragraphBuilder->pushStyle(paragraphStyle.getTextStyle());
-    paragraphBuilder->addText(textContent.c_str(), textContent.size());
-    paragraphBuilder->pop();
-
-    auto paragraph = paragraphBuilder->Build();
-    paragraph->layout(maxWidth > 0
-                        ? maxWidth + 1.0f // Add a small margin to avoid rounding issues
-                        : numeric_limits<float>::infinity());
+    // The shaped paragraph is cached in the web content, and it's reused by the text painting.
+    auto &paragraph = webContentComponent->layoutParagraph(textContent,
+                                                           maxWidth > 0
+                                                             ? maxWidth + 1.0f // Add a small margin to avoid rounding issues
+                                                             : numeric_limits<float>::infinity());
 
     // Use longest line width and height as the constraint space.
-    return ConstraintSpace(paragraph->getLongestLine(),
-                           paragraph->getHeight());
+    return ConstraintSpace(paragraph.getLongestLine(),
+                           paragraph.getHeight());
   }
 
   void LayoutText::textDidChange()
@@ -96,6 +90,11 @@ namespace client_layout
     transformed_text_ = transformAndSecureText(plainText());
     is_text_content_dirty_ = true;
 
+    // Drop the paragraph of the old text before measuring the new one.
+    auto webContentComponent = getSceneComponent<WebContent>();
+    if (webContentComponent != nullptr)
+      webContentComponent->resetParagraphCache();
+
     formattingContext().setIsEmpty(isEmptyText());
     adjustTextContentSize(parent()->fragment());
 
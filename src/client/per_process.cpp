@@ -12,6 +12,7 @@
 #include "./browser/window.hpp"
 #include "./builtin_scene/scene.hpp"
 #include "./dom/dom_scripting.hpp"
+#include "./html/image_decoder.hpp"
 #include "./graphics/webgl_context.hpp"
 #include "./media/media_player.hpp"
 #include "./media/audio_player.hpp"
@@ -296,6 +297,31 @@ TrClientPerformanceFileSystem::TrClientPerformanceFileSystem(std::string &cacheD
   fps = makeValue<int>("fps", 0);
   frameDuration = makeValue<double>("frame_duration", 0.0);
   longFrames = makeValue<int>("long_frames", 0);
+  for (size_t i = 1; i < static_cast<size_t>(TrCommandBufferFlushReason::Count); i++)
+  {
+    auto name = string("cmdbuf_flush_") + flushReasonToStr(static_cast<TrCommandBufferFlushReason>(i));
+    commandBufferFlushes[i] = makeValue<int>(name.c_str(), 0);
+  }
+  styleRecalcDuration = makeValue<double>("style_recalc_duration", 0.0);
+  styleRecalcElements = makeValue<int>("style_recalc_elements", 0);
+  textureUploadBytes = makeValue<int>("texture_upload_bytes", 0);
+  textureMipmapGenerations = makeValue<int>("texture_mipmap_generations", 0);
+  webContentRasterDuration = makeValue<double>("web_content_raster_duration", 0.0);
+  webContentRasterContents = makeValue<int>("web_content_raster_contents", 0);
+  imageDecodeCacheHits = makeValue<int>("image_decode_cache_hits", 0);
+  imageDecodeCacheMisses = makeValue<int>("image_decode_cache_misses", 0);
+  imageDecodeCoalesced = makeValue<int>("image_decode_coalesced", 0);
+  instancesSubmitted = makeValue<int>("instances_submitted", 0);
+  instancesCulled = makeValue<int>("instances_culled", 0);
+}
+
+void TrClientPerformanceFileSystem::setCommandBufferFlushes(const TrCommandBufferFlushStats &stats)
+{
+  for (size_t i = 1; i < static_cast<size_t>(TrCommandBufferFlushReason::Count); i++)
+  {
+    if (commandBufferFlushes[i] != nullptr)
+      commandBufferFlushes[i]->set(static_cast<int>(stats.get(static_cast<TrCommandBufferFlushReason>(i))));
+  }
 }
 
 static bool GetBooleanEnv(const char *name, bool default_value = false)
@@ -403,6 +429,14 @@ void TrClientContextPerProcess::preload()
   fontCacheManager = std::make_unique<font::FontCacheManager>();
 }
 
+::dom::ImageDecoder &TrClientContextPerProcess::getImageDecoder()
+{
+  assert(isInScriptingThread() && "The image decoder must be created at the scripting thread.");
+  if (imageDecoder == nullptr)
+    imageDecoder = std::make_unique<::dom::ImageDecoder>(scriptingEventLoop);
+  return *imageDecoder;
+}
+
 void TrClientContextPerProcess::start()
 {
   string pid = to_string(getpid());
@@ -445,6 +479,27 @@ void TrClientContextPerProcess::start()
     // Create sender & receiver for commandbuffer chan.
     commandBufferChanSender = new TrCommandBufferSender(commandBufferChanClient);
     commandBufferChanReceiver = new TrCommandBufferReceiver(commandBufferChanClient);
+
+    // Write the requests into the shared memory ring if the renderer selects it, the ring is created by the renderer before
+    // this process is spawned.
+    if (commandBufferChanType == ipc::TR_CHANNEL_TYPE_SHM)
+    {
+      string ringFilename = commandBufferChanZoneDirectory + "/" + to_string(id);
+      commandBufferChanRing = make_shared<ipc::TrShmRingBuffer>(ringFilename, TrZoneType::Client);
+      if (!commandBufferChanRing->isValid())
+      {
+        // The renderer reads the requests from the ring only, thus falling back to the socket would hang the content.
+        DEBUG(LOG_TAG_ERROR, "ClientContext(%d) failed to open the command buffer ring: %s", id, ringFilename.c_str());
+        exit(1);
+      }
+      commandBufferChanSender->attachSharedMemoryRing(commandBufferChanRing);
+
+      // The payload pool is optional, the large payloads are inlined to the requests if it's not available.
+      string poolFilename = commandBufferChanZoneDirectory + "/" + to_string(id) + ".payload";
+      commandBufferPayloadPool = make_shared<ipc::TrShmBlockPool>(poolFilename, TrZoneType::Client);
+      if (!commandBufferPayloadPool->isValid())
+        commandBufferPayloadPool = nullptr;
+    }
   }
 
   // XR device initialization
@@ -493,6 +548,7 @@ void TrClientContextPerProcess::print()
   fprintf(stdout, "ClientContext(%d) eventChanPort=%d\n", id, eventChanPort);
   fprintf(stdout, "ClientContext(%d) mediaChanPort=%d\n", id, mediaChanPort);
   fprintf(stdout, "ClientContext(%d) commandBufferChanPort=%d\n", id, commandBufferChanPort);
+  fprintf(stdout, "ClientContext(%d) commandBufferChanType=%d\n", id, static_cast<int>(commandBufferChanType));
 
   if (xrDeviceInit.enabled == true)
   {
@@ -629,9 +685,65 @@ bool TrClientContextPerProcess::sendCommandBufferRequest(TrCommandBufferBase &co
 
 TrCommandBufferResponse *TrClientContextPerProcess::recvCommandBufferResponse(int timeout)
 {
+  // The expected responses are in front of the response to receive, thus dispatch them first.
+  while (!expectedCommandBufferResponses.empty())
+    dispatchExpectedCommandBufferResponse(timeout);
   return commandBufferChanReceiver->recvCommandBufferResponse(timeout);
 }
 
+void TrClientContextPerProcess::expectCommandBufferResponse(CommandBufferType responseType,
+                                                            function<void(TrCommandBufferResponse *)> callback)
+{
+  expectedCommandBufferResponses.push_back({responseType, callback});
+}
+
+bool TrClientContextPerProcess::pollExpectedCommandBufferResponses()
+{
+  while (!expectedCommandBufferResponses.empty())
+  {
+    if (!commandBufferChanReceiver->hasPendingResponse())
+      return false;
+    dispatchExpectedCommandBufferResponse(1000);
+  }
+  return true;
+}
+
+bool TrClientContextPerProcess::dispatchExpectedCommandBufferResponse(int timeout)
+{
+  if (expectedCommandBufferResponses.empty())
+    return false;
+
+  auto [responseType, callback] = std::move(expectedCommandBufferResponses.front());
+  expectedCommandBufferResponses.pop_front();
+
+  auto response = commandBufferChanReceiver->recvCommandBufferResponse(timeout);
+  if (response != nullptr && response->type != responseType)
+  {
+    DEBUG(LOG_TAG_CONTENT, "Received an unexpected command buffer response(%d), expected %d.",
+          response->type, responseType);
+    delete response;
+    response = nullptr;
+  }
+  callback(response);
+  if (response != nullptr)
+    delete response;
+  return true;
+}
+
+void TrClientContextPerProcess::onAnimationFrameEnd()
+{
+  if (TR_UNLIKELY(commandBufferChanSender == nullptr))
+    return;
+  commandBufferChanSender->flushAtAnimationFrameEnd();
+  reportCommandBufferFlushStats();
+}
+
+void TrClientContextPerProcess::reportCommandBufferFlushStats()
+{
+  if (commandBufferChanSender != nullptr && perfFs != nullptr)
+    perfFs->setCommandBufferFlushes(commandBufferChanSender->getFlushStats());
+}
+
 void TrClientContextPerProcess::onListenMediaEvent(media_comm::TrMediaCommandMessage &eventMessage)
 {
   auto messageType = eventMessage.getType();
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -123,11 +125,73 @@ public:
   {
     longFrames->set(value);
   }
+  void setCommandBufferFlushes(const commandbuffers::TrCommandBufferFlushStats &stats);
+  inline void setStyleRecalc(double duration, int elements)
+  {
+    styleRecalcDuration->set(duration);
+    styleRecalcElements->set(elements);
+  }
+  inline void setTextureUploads(size_t bytes, int mipmapGenerations)
+  {
+    textureUploadBytes->set(static_cast<int>(bytes));
+    textureMipmapGenerations->set(mipmapGenerations);
+  }
+  inline void setWebContentRaster(double duration, int contents)
+  {
+    webContentRasterDuration->set(duration);
+    webContentRasterContents->set(contents);
+  }
+  inline void setImageDecodes(size_t cacheHits, size_t cacheMisses, size_t coalesced)
+  {
+    imageDecodeCacheHits->set(static_cast<int>(cacheHits));
+    imageDecodeCacheMisses->set(static_cast<int>(cacheMisses));
+    imageDecodeCoalesced->set(static_cast<int>(coalesced));
+  }
+  inline void setInstanceCulling(size_t submitted, size_t culled)
+  {
+    instancesSubmitted->set(static_cast<int>(submitted));
+    instancesCulled->set(static_cast<int>(culled));
+  }
 
 public:
   std::unique_ptr<analytics::PerformanceValue<int>> fps;
   std::unique_ptr<analytics::PerformanceValue<double>> frameDuration;
   std::unique_ptr<analytics::PerformanceValue<int>> longFrames;
+  /**
+   * The flush counters of the command buffer requests by reason, which are named as `cmdbuf_flush_<reason>`.
+   */
+  std::unique_ptr<analytics::PerformanceValue<int>>
+    commandBufferFlushes[static_cast<size_t>(commandbuffers::TrCommandBufferFlushReason::Count)];
+  /**
+   * The duration in milliseconds of the last style recalculation of the document, and the count of the elements whose styles
+   * are recomputed in it.
+   */
+  std::unique_ptr<analytics::PerformanceValue<double>> styleRecalcDuration;
+  std::unique_ptr<analytics::PerformanceValue<int>> styleRecalcElements;
+  /**
+   * The bytes uploaded to the Web content's texture atlas in the last frame, and the count of the mipmaps generations.
+   */
+  std::unique_ptr<analytics::PerformanceValue<int>> textureUploadBytes;
+  std::unique_ptr<analytics::PerformanceValue<int>> textureMipmapGenerations;
+  /**
+   * The wall time in milliseconds to rasterize the dirty Web contents in the last frame, and the count of the rasterized
+   * contents, the contents are rasterized in parallel on the scene's task pool.
+   */
+  std::unique_ptr<analytics::PerformanceValue<double>> webContentRasterDuration;
+  std::unique_ptr<analytics::PerformanceValue<int>> webContentRasterContents;
+  /**
+   * The hits and misses of the decoded images cache, and the count of the image decodings which are coalesced into a pending
+   * decoding of the same image.
+   */
+  std::unique_ptr<analytics::PerformanceValue<int>> imageDecodeCacheHits;
+  std::unique_ptr<analytics::PerformanceValue<int>> imageDecodeCacheMisses;
+  std::unique_ptr<analytics::PerformanceValue<int>> imageDecodeCoalesced;
+  /**
+   * The count of the builtin scene's instances which are submitted to draw in the last frame, and the count of the instances
+   * which are culled by the view frustum.
+   */
+  std::unique_ptr<analytics::PerformanceValue<int>> instancesSubmitted;
+  std::unique_ptr<analytics::PerformanceValue<int>> instancesCulled;
 };
 
 enum class TrClientContextEventType
@@ -312,6 +376,45 @@ public: // commandbuffer methods
    * @returns The new instance of the command buffer response, or nullptr if no response received or timeout.
    */
   TrCommandBufferResponse *recvCommandBufferResponse(int timeout);
+  /**
+   * Expect a command buffer response of the request that has been sent, the response is not waited at the call, it's
+   * dispatched to the callback when it's polled or when a later response is received, because the responses arrive in the
+   * order of the requests.
+   *
+   * @param responseType The type of the expected response.
+   * @param callback The callback to receive the response, the response is deleted after the callback returns, and it's
+   *                 nullptr if the response is not received in time.
+   */
+  void expectCommandBufferResponse(CommandBufferType responseType, function<void(TrCommandBufferResponse *)> callback);
+  /**
+   * Dispatch the expected command buffer responses that have been received without blocking.
+   *
+   * @returns true if all the expected responses are dispatched.
+   */
+  bool pollExpectedCommandBufferResponses();
+  /**
+   * Wait for the first expected command buffer response and dispatch it.
+   *
+   * @param timeout The time in milliseconds to wait for the response.
+   * @returns false if there is no expected response.
+   */
+  bool dispatchExpectedCommandBufferResponse(int timeout);
+  /**
+   * It's called when the animation frame callbacks are finished, the pending command buffer requests of this frame are
+   * flushed, and the flush counters are updated.
+   */
+  void onAnimationFrameEnd();
+  /**
+   * Update the command buffer flush counters to the performance file system.
+   */
+  void reportCommandBufferFlushStats();
+  /**
+   * @returns The shared memory pool to write the large command buffer payloads into, or nullptr if it's not available.
+   */
+  inline ipc::TrShmBlockPool *getCommandBufferPayloadPool()
+  {
+    return commandBufferPayloadPool.get();
+  }
 
 public: // WebXR methods
   inline shared_ptr<client_xr::XRDeviceClient> getXRDeviceClient()
@@ -435,6 +538,10 @@ public:
   {
     return *perfFs;
   }
+  /**
+   * @returns the image decoder which is created at the first call, it must be called at the scripting thread.
+   */
+  dom::ImageDecoder &getImageDecoder();
 
 private:
   void onListenMediaEvent(media_comm::TrMediaCommandMessage &eventMessage);
@@ -459,6 +566,8 @@ public:
   uint32_t eventChanPort;
   uint32_t mediaChanPort;
   uint32_t commandBufferChanPort;
+  ipc::TrChannelType commandBufferChanType = ipc::TR_CHANNEL_TYPE_SOCKET;
+  string commandBufferChanZoneDirectory;
   xr::TrDeviceInit xrDeviceInit;
   uint64_t startedAt;
   /**
@@ -490,6 +599,12 @@ private: // command buffer fields
   TrOneShotClient<TrCommandBufferMessage> *commandBufferChanClient = nullptr;
   TrCommandBufferSender *commandBufferChanSender = nullptr;
   TrCommandBufferReceiver *commandBufferChanReceiver = nullptr;
+  shared_ptr<ipc::TrShmRingBuffer> commandBufferChanRing = nullptr;
+  shared_ptr<ipc::TrShmBlockPool> commandBufferPayloadPool = nullptr;
+  /**
+   * The responses expected by `expectCommandBufferResponse()` in the order of the requests.
+   */
+  deque<pair<CommandBufferType, function<void(TrCommandBufferResponse *)>>> expectedCommandBufferResponses;
 
 private: // xr fields
   shared_ptr<client_xr::XRDeviceClient> xrDeviceClient = nullptr;
@@ -515,6 +630,7 @@ private: // other fields
   std::optional<std::thread::id> scriptingThreadId = std::nullopt;
   unique_ptr<font::FontCacheManager> fontCacheManager = nullptr;
   unique_ptr<TrClientPerformanceFileSystem> perfFs = nullptr;
+  unique_ptr<dom::ImageDecoder> imageDecoder;
 
 private:
   static TrClientContextPerProcess *s_Instance;
@@ -104,7 +104,9 @@ namespace client_xr
       throw std::runtime_error(msg);
     }
     auto req = session->createEndFrameCommand(frameRequest);
-    return glContext->sendCommandBufferRequestDirectly(req);
+    bool sent = glContext->sendCommandBufferRequestDirectly(req);
+    clientContext_->reportCommandBufferFlushStats();
+    return sent;
   }
 
   TrViewport XRDeviceClient::getViewport(uint32_t viewIndex)
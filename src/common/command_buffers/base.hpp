@@ -1,6 +1,7 @@
 #pragma once
 
 #include "./shared.hpp"
+#include "./object_pool.hpp"
 #include "../xr/types.hpp"
 
 namespace commandbuffers
@@ -45,6 +46,46 @@ namespace commandbuffers
       commandBuffer->deserialize(message);
       return commandBuffer;
     }
+    /**
+     * Create a command buffer from an `TrCommandBufferMessage` instance in the given object pool, the returned instance is
+     * still deleted via `delete`, and its memory goes back to the pool.
+     *
+     * @tparam T The command buffer type of the instance to be created.
+     * @param message The message to create the command buffer instance.
+     * @param pool The object pool to allocate the instance.
+     * @returns The created command buffer instance.
+     */
+    template <typename T>
+    static T *CreateFromMessage(TrCommandBufferMessage &message, TrCommandBufferObjectPool *pool)
+    {
+      T *commandBuffer = new (pool) T(message.getReferenceFromBase<T>());
+      commandBuffer->deserialize(message);
+      return commandBuffer;
+    }
+
+  public:
+    /**
+     * The command buffer objects are allocated with a header to be recycled to their pool at `delete`, see
+     * `TrCommandBufferObjectPool`.
+     */
+    static void *operator new(size_t size)
+    {
+      return TrCommandBufferObjectPool::AllocateFromHeap(size);
+    }
+    static void *operator new(size_t size, TrCommandBufferObjectPool *pool)
+    {
+      return pool == nullptr
+               ? TrCommandBufferObjectPool::AllocateFromHeap(size)
+               : pool->allocate(size);
+    }
+    static void operator delete(void *ptr)
+    {
+      TrCommandBufferObjectPool::Deallocate(ptr);
+    }
+    static void operator delete(void *ptr, TrCommandBufferObjectPool *)
+    {
+      TrCommandBufferObjectPool::Deallocate(ptr);
+    }
 
   public:
     TrCommandBufferBase()
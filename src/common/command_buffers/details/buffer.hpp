@@ -57,7 +57,15 @@ namespace commandbuffers
   {
   public:
     BufferDataCommandBufferRequest() = delete;
-    BufferDataCommandBufferRequest(uint32_t target, uint32_t srcSize, void *srcData, uint32_t usage)
+    /**
+     * @param payloadPool If provided and the data is large enough, the data will be written into the shared memory pool, then
+     * the receiver reads it in place instead of copying it through the channel.
+     */
+    BufferDataCommandBufferRequest(uint32_t target,
+                                   uint32_t srcSize,
+                                   void *srcData,
+                                   uint32_t usage,
+                                   ipc::TrShmBlockPool *payloadPool = nullptr)
         : TrCommandBufferSimpleRequest()
         , target(target)
         , dataSize(srcSize)
@@ -69,6 +77,15 @@ namespace commandbuffers
       }
       else if (srcSize > 0)
       {
+        if (payloadPool != nullptr && srcSize >= payloadPool->payloadThreshold())
+        {
+          sharedPayload = payloadPool->allocate(srcSize);
+          if (sharedPayload.isValid())
+          {
+            memcpy(payloadPool->data(sharedPayload), srcData, srcSize);
+            return;
+          }
+        }
         data = malloc(srcSize);
         if (data != nullptr)
           memcpy(data, srcData, srcSize);
@@ -78,7 +95,8 @@ namespace commandbuffers
     {
       if (data != nullptr)
       {
-        free(data);
+        if (sharedPayloadBlock == nullptr)
+          free(data);
         data = nullptr;
       }
     }
@@ -87,11 +105,24 @@ namespace commandbuffers
     TrCommandBufferMessage *serialize() override
     {
       auto message = new TrCommandBufferMessage(type, size, this);
-      message->addRawSegment(dataSize, data);
+      if (!sharedPayload.isValid())
+        message->addRawSegment(dataSize, data);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
     {
+      data = nullptr;
+      if (sharedPayload.isValid())
+      {
+        if (message.payloadPool != nullptr)
+          sharedPayloadBlock = message.payloadPool->acquire(sharedPayload);
+        if (sharedPayloadBlock != nullptr)
+          data = sharedPayloadBlock->data();
+        else
+          dataSize = 0;
+        return;
+      }
+
       auto dataSegment = message.getSegment(0);
       auto dataSize = dataSegment->getSize();
       data = malloc(dataSize);
@@ -103,6 +134,11 @@ namespace commandbuffers
     uint32_t dataSize;
     void *data = nullptr;
     uint32_t usage;
+    ipc::TrShmBlockRef sharedPayload;
+    /**
+     * The acquired shared payload at the receiver side, the pages are released when this request is destroyed.
+     */
+    std::shared_ptr<ipc::TrShmBlock> sharedPayloadBlock = nullptr;
   };
 
   class BufferSubDataCommandBufferRequest final
@@ -110,12 +146,29 @@ namespace commandbuffers
   {
   public:
     BufferSubDataCommandBufferRequest() = delete;
-    BufferSubDataCommandBufferRequest(uint32_t target, uint32_t offset, uint32_t srcSize, void *srcData)
+    /**
+     * @param payloadPool If provided and the data is large enough, the data will be written into the shared memory pool.
+     */
+    BufferSubDataCommandBufferRequest(uint32_t target,
+                                      uint32_t offset,
+                                      uint32_t srcSize,
+                                      void *srcData,
+                                      ipc::TrShmBlockPool *payloadPool = nullptr)
         : TrCommandBufferSimpleRequest()
         , target(target)
         , offset(offset)
         , dataSize(srcSize)
+        , data(nullptr)
     {
+      if (payloadPool != nullptr && srcSize >= payloadPool->payloadThreshold())
+      {
+        sharedPayload = payloadPool->allocate(srcSize);
+        if (sharedPayload.isValid())
+        {
+          memcpy(payloadPool->data(sharedPayload), srcData, srcSize);
+          return;
+        }
+      }
       data = malloc(srcSize);
       if (data != nullptr)
         memcpy(data, srcData, srcSize);
@@ -124,7 +177,8 @@ namespace commandbuffers
     {
       if (data != nullptr)
       {
-        free(data);
+        if (sharedPayloadBlock == nullptr)
+          free(data);
         data = nullptr;
       }
     }
@@ -133,11 +187,24 @@ namespace commandbuffers
     TrCommandBufferMessage *serialize() override
     {
       auto message = new TrCommandBufferMessage(type, size, this);
-      message->addRawSegment(dataSize, data);
+      if (!sharedPayload.isValid())
+        message->addRawSegment(dataSize, data);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
     {
+      data = nullptr;
+      if (sharedPayload.isValid())
+      {
+        if (message.payloadPool != nullptr)
+          sharedPayloadBlock = message.payloadPool->acquire(sharedPayload);
+        if (sharedPayloadBlock != nullptr)
+          data = sharedPayloadBlock->data();
+        else
+          dataSize = 0;
+        return;
+      }
+
       auto dataSegment = message.getSegment(0);
       auto dataSize = dataSegment->getSize();
       data = malloc(dataSize);
@@ -149,6 +216,11 @@ namespace commandbuffers
     uint32_t offset;
     uint32_t dataSize;
     void *data;
+    ipc::TrShmBlockRef sharedPayload;
+    /**
+     * The acquired shared payload at the receiver side, the pages are released when this request is destroyed.
+     */
+    std::shared_ptr<ipc::TrShmBlock> sharedPayloadBlock = nullptr;
   };
 
   class CreateFramebufferCommandBufferRequest final
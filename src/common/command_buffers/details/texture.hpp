@@ -66,6 +66,7 @@ namespace commandbuffers
         , level(that.level)
         , format(that.format)
         , pixelType(that.pixelType)
+        , sharedPayload(that.sharedPayload)
     {
     }
     virtual ~TextureImageNDCommandBufferRequest()
@@ -114,8 +115,10 @@ namespace commandbuffers
      *
      * @param srcPixels the source pixels data.
      * @param copyPixels if true the pixels data will be copied to this object, otherwise just use the pointer to send.
+     * @param payloadPool if provided and the pixels data is large enough, the pixels data will be written into the shared memory
+     *                    pool regardless of `copyPixels`, then the receiver reads it in place.
      */
-    void setPixels(void *srcPixels, bool copyPixels = true)
+    void setPixels(void *srcPixels, bool copyPixels = true, ipc::TrShmBlockPool *payloadPool = nullptr)
     {
       if (srcPixels == nullptr)
       {
@@ -126,6 +129,17 @@ namespace commandbuffers
         pixelsByteLength = computePixelsByteLength();
         if (pixelsByteLength > 0)
         {
+          if (payloadPool != nullptr && pixelsByteLength >= payloadPool->payloadThreshold())
+          {
+            sharedPayload = payloadPool->allocate(pixelsByteLength);
+            if (sharedPayload.isValid())
+            {
+              pixels = payloadPool->data(sharedPayload);
+              ownPixelsMemory = false;
+              memcpy(pixels, srcPixels, pixelsByteLength);
+              return;
+            }
+          }
           if (copyPixels)
           {
             pixels = malloc(pixelsByteLength);
@@ -151,13 +165,26 @@ namespace commandbuffers
     TrCommandBufferMessage *serialize() override final
     {
       auto message = new TrCommandBufferMessage(type, size, this);
-      if (pixels != nullptr && pixelsByteLength > 0)
+      if (pixels != nullptr && pixelsByteLength > 0 && !sharedPayload.isValid())
         message->addRawSegment(pixelsByteLength, pixels);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override final
     {
       assert(pixels == nullptr);
+      if (sharedPayload.isValid())
+      {
+        if (message.payloadPool != nullptr)
+          sharedPayloadBlock = message.payloadPool->acquire(sharedPayload);
+        if (sharedPayloadBlock != nullptr)
+        {
+          pixels = sharedPayloadBlock->data();
+          pixelsByteLength = sharedPayloadBlock->size();
+          ownPixelsMemory = false;
+        }
+        return;
+      }
+
       auto pixelsSegment = message.getSegment(0);
       if (pixelsSegment != nullptr)
       {
@@ -178,6 +205,7 @@ namespace commandbuffers
         free(pixels);
       pixels = nullptr;
       pixelsByteLength = 0;
+      sharedPayloadBlock = nullptr;
     }
 
   public:
@@ -188,6 +216,11 @@ namespace commandbuffers
     bool ownPixelsMemory = false; // if true the pixels memory will be managed by this object.
     void *pixels = nullptr;
     size_t pixelsByteLength = 0;
+    ipc::TrShmBlockRef sharedPayload;
+    /**
+     * The acquired shared payload at the receiver side, the pages are released when this request is destroyed.
+     */
+    std::shared_ptr<ipc::TrShmBlock> sharedPayloadBlock = nullptr;
   };
 
   class TextureImage2DCommandBufferRequest final
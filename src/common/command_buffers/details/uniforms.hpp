@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "../shared.hpp"
 #include "../base.hpp"
 #include "../webgl_placeholders.hpp"
@@ -40,6 +42,16 @@ namespace commandbuffers
     bool multiview;
   };
 
+  /**
+   * Add the uniform values to the message as a segment which refers to the request's memory, the message is encoded by the
+   * sender before the request is released, thus it skips the copying into a temporary segment.
+   */
+  template <typename T>
+  inline void addValuesSegment(TrCommandBufferMessage *message, std::vector<T> &values)
+  {
+    message->addRawSegment(values.size() * sizeof(T), values.data());
+  }
+
   class UniformBlockBindingCommandBufferRequest final
       : public TrCommandBufferSimpleRequest<UniformBlockBindingCommandBufferRequest,
                                             COMMAND_BUFFER_UNIFORM_BLOCK_BINDING_REQ>
@@ -81,10 +93,10 @@ namespace commandbuffers
   {
   public:
     Uniform1fvCommandBufferRequest() = delete;
-    Uniform1fvCommandBufferRequest(uint32_t location, const std::vector<float> &values)
+    Uniform1fvCommandBufferRequest(uint32_t location, std::span<const float> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform1fvCommandBufferRequest(Uniform1fvCommandBufferRequest &that)
@@ -98,7 +110,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 0)
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -135,10 +147,10 @@ namespace commandbuffers
   {
   public:
     Uniform1ivCommandBufferRequest() = delete;
-    Uniform1ivCommandBufferRequest(uint32_t location, const std::vector<int> &values)
+    Uniform1ivCommandBufferRequest(uint32_t location, std::span<const int> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform1ivCommandBufferRequest(Uniform1ivCommandBufferRequest &that)
@@ -152,7 +164,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 0)
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -191,10 +203,10 @@ namespace commandbuffers
   {
   public:
     Uniform2fvCommandBufferRequest() = delete;
-    Uniform2fvCommandBufferRequest(uint32_t location, const std::vector<float> &values)
+    Uniform2fvCommandBufferRequest(uint32_t location, std::span<const float> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform2fvCommandBufferRequest(Uniform2fvCommandBufferRequest &that)
@@ -208,7 +220,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 1 && values.size() % 2 == 0) // Check the value size is 2x
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -247,10 +259,10 @@ namespace commandbuffers
   {
   public:
     Uniform2ivCommandBufferRequest() = delete;
-    Uniform2ivCommandBufferRequest(uint32_t location, const std::vector<int> &values)
+    Uniform2ivCommandBufferRequest(uint32_t location, std::span<const int> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform2ivCommandBufferRequest(Uniform2ivCommandBufferRequest &that)
@@ -264,7 +276,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 1 && values.size() % 2 == 0) // Check the value size is 2x
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -305,10 +317,10 @@ namespace commandbuffers
   {
   public:
     Uniform3fvCommandBufferRequest() = delete;
-    Uniform3fvCommandBufferRequest(uint32_t location, const std::vector<float> &values)
+    Uniform3fvCommandBufferRequest(uint32_t location, std::span<const float> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform3fvCommandBufferRequest(Uniform3fvCommandBufferRequest &that)
@@ -322,7 +334,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 2 && values.size() % 3 == 0) // Check the value size is 3x
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -363,10 +375,10 @@ namespace commandbuffers
   {
   public:
     Uniform3ivCommandBufferRequest() = delete;
-    Uniform3ivCommandBufferRequest(uint32_t location, const std::vector<int> &values)
+    Uniform3ivCommandBufferRequest(uint32_t location, std::span<const int> values)
         : TrCommandBufferSimpleRequest()
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
     Uniform3ivCommandBufferRequest(Uniform3ivCommandBufferRequest &that)
@@ -380,7 +392,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 2 && values.size() % 3 == 0) // Check the value size is 3x
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override
@@ -436,10 +448,10 @@ namespace commandbuffers
         , location(that.location)
     {
     }
-    Uniform4xvCommandBufferRequest(CommandBufferType type, uint32_t location, const std::vector<Tv> &values)
+    Uniform4xvCommandBufferRequest(CommandBufferType type, uint32_t location, std::span<const Tv> values)
         : TrCommandBufferRequest(type, sizeof(Tb))
         , location(location)
-        , values(values)
+        , values(values.begin(), values.end())
     {
     }
 
@@ -448,7 +460,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > 3 && values.size() % 4 == 0) // Check the value size is 4x
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override final
@@ -478,7 +490,7 @@ namespace commandbuffers
   {
   public:
     using Uniform4xvCommandBufferRequest::Uniform4xvCommandBufferRequest;
-    Uniform4fvCommandBufferRequest(uint32_t location, const std::vector<float> &values)
+    Uniform4fvCommandBufferRequest(uint32_t location, std::span<const float> values)
         : Uniform4xvCommandBufferRequest(COMMAND_BUFFER_UNIFORM4FV_REQ, location, values)
     {
     }
@@ -501,7 +513,7 @@ namespace commandbuffers
     using Uniform4xvCommandBufferRequest::Uniform4xvCommandBufferRequest;
 
   public:
-    Uniform4ivCommandBufferRequest(uint32_t location, const std::vector<int> &values)
+    Uniform4ivCommandBufferRequest(uint32_t location, std::span<const int> values)
         : Uniform4xvCommandBufferRequest(COMMAND_BUFFER_UNIFORM4IV_REQ, location, values)
     {
     }
@@ -543,7 +555,7 @@ namespace commandbuffers
     {
       auto message = new TrCommandBufferMessage(type, size, this);
       if (values.size() > matrixSize - 1 && values.size() % matrixSize == 0) // Check the value size is Nx
-        message->addVecSegment(values);
+        addValuesSegment(message, values);
       return message;
     }
     void deserialize(TrCommandBufferMessage &message) override final
@@ -568,10 +580,10 @@ namespace commandbuffers
         : UniformMatrixNfvCommandBufferRequest(that)
     {
     }
-    UniformMatrix2fvCommandBufferRequest(uint32_t location, bool transpose, const std::vector<float> &values)
+    UniformMatrix2fvCommandBufferRequest(uint32_t location, bool transpose, std::span<const float> values)
         : UniformMatrixNfvCommandBufferRequest(COMMAND_BUFFER_UNIFORM_MATRIX2FV_REQ, location, transpose)
     {
-      this->values = values;
+      this->values.assign(values.begin(), values.end());
     }
   };
 
@@ -583,10 +595,10 @@ namespace commandbuffers
         : UniformMatrixNfvCommandBufferRequest(that)
     {
     }
-    UniformMatrix3fvCommandBufferRequest(uint32_t location, bool transpose, const std::vector<float> &values)
+    UniformMatrix3fvCommandBufferRequest(uint32_t location, bool transpose, std::span<const float> values)
         : UniformMatrixNfvCommandBufferRequest(COMMAND_BUFFER_UNIFORM_MATRIX3FV_REQ, location, transpose)
     {
-      this->values = values;
+      this->values.assign(values.begin(), values.end());
     }
   };
 
@@ -602,10 +614,10 @@ namespace commandbuffers
         : UniformMatrixNfvCommandBufferRequest(COMMAND_BUFFER_UNIFORM_MATRIX4FV_REQ, location, transpose)
     {
     }
-    UniformMatrix4fvCommandBufferRequest(uint32_t location, bool transpose, const std::vector<float> &values)
+    UniformMatrix4fvCommandBufferRequest(uint32_t location, bool transpose, std::span<const float> values)
         : UniformMatrixNfvCommandBufferRequest(COMMAND_BUFFER_UNIFORM_MATRIX4FV_REQ, location, transpose)
     {
-      this->values = values;
+      this->values.assign(values.begin(), values.end());
     }
     UniformMatrix4fvCommandBufferRequest(uint32_t location, bool transpose, MatrixComputationGraph computationGraph4values)
         : UniformMatrixNfvCommandBufferRequest(COMMAND_BUFFER_UNIFORM_MATRIX4FV_REQ, location, transpose)
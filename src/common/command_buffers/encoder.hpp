@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+#include <sys/uio.h>
+
+#include "./shared.hpp"
+
+namespace commandbuffers
+{
+  /**
+   * The encoder serializes the command buffer messages into a list of reusable chunks in their final wire layout, then the
+   * sender flushes the whole chunks at once without re-allocating or copying the encoded bytes.
+   *
+   * Each message is bump-allocated in the current chunk, a new chunk is appended when the current one is full, and a message
+   * larger than the chunk size gets a dedicated chunk. After `reset()`, the regular chunks are kept for the next batch and the
+   * oversized ones are freed.
+   */
+  class TrCommandBufferEncoder
+  {
+  public:
+    static constexpr size_t DefaultChunkSize = 64 * 1024; // 64KB
+    static constexpr size_t MaxRetainedChunks = 16;
+
+  private:
+    struct Chunk
+    {
+      char *data;
+      size_t capacity;
+      size_t used;
+    };
+
+  public:
+    TrCommandBufferEncoder(size_t chunkSize = DefaultChunkSize)
+        : chunkSize(chunkSize)
+    {
+    }
+    TrCommandBufferEncoder(const TrCommandBufferEncoder &) = delete;
+    TrCommandBufferEncoder &operator=(const TrCommandBufferEncoder &) = delete;
+    ~TrCommandBufferEncoder()
+    {
+      for (auto &chunk : chunks)
+        free(chunk.data);
+      chunks.clear();
+    }
+
+  public:
+    /**
+     * Encode the message at the end of the current batch.
+     *
+     * @param message The message to encode.
+     * @returns If the message is encoded, false if the allocation failed.
+     */
+    template <typename MessageType>
+    bool encode(MessageType &message)
+    {
+      size_t size = message.computeSerializedSize();
+      char *dest = allocate(size);
+      if (TR_UNLIKELY(dest == nullptr))
+        return false;
+      message.serializeTo(dest);
+      encodedCount += 1;
+      return true;
+    }
+    /**
+     * Allocate `size` bytes at the end of the current batch.
+     *
+     * @returns The pointer to write, or nullptr if the allocation failed.
+     */
+    char *allocate(size_t size)
+    {
+      if (activeChunks > 0)
+      {
+        auto &current = chunks[activeChunks - 1];
+        if (current.capacity - current.used >= size)
+        {
+          char *dest = current.data + current.used;
+          current.used += size;
+          encodedBytes += size;
+          return dest;
+        }
+      }
+
+      Chunk *next = nextChunk(size);
+      if (TR_UNLIKELY(next == nullptr))
+        return nullptr;
+      next->used = size;
+      encodedBytes += size;
+      return next->data;
+    }
+    /**
+     * Drop the encoded bytes and keep the regular chunks for reusing.
+     */
+    void reset()
+    {
+      for (size_t i = 0; i < chunks.size();)
+      {
+        auto &chunk = chunks[i];
+        if (chunk.capacity != chunkSize || i >= MaxRetainedChunks)
+        {
+          free(chunk.data);
+          chunks.erase(chunks.begin() + i);
+          continue;
+        }
+        chunk.used = 0;
+        i++;
+      }
+      activeChunks = 0;
+      encodedBytes = 0;
+      encodedCount = 0;
+    }
+    /**
+     * Fill the `iovec` list with the encoded chunks, it's used for `writev()`.
+     *
+     * @param iov The list to be filled, it's cleared first.
+     */
+    void fillIovecs(std::vector<struct iovec> &iov)
+    {
+      iov.clear();
+      for (size_t i = 0; i < activeChunks; i++)
+      {
+        if (chunks[i].used > 0)
+          iov.push_back({chunks[i].data, chunks[i].used});
+      }
+    }
+    /**
+     * Call the `callback` with each encoded chunk in order.
+     */
+    template <typename Callback>
+    bool forEachChunk(Callback callback)
+    {
+      for (size_t i = 0; i < activeChunks; i++)
+      {
+        if (chunks[i].used > 0 && !callback(chunks[i].data, chunks[i].used))
+          return false;
+      }
+      return true;
+    }
+    /**
+     * @returns If there is nothing encoded.
+     */
+    inline bool empty()
+    {
+      return encodedBytes == 0;
+    }
+    /**
+     * @returns The total bytes encoded in the current batch.
+     */
+    inline size_t size()
+    {
+      return encodedBytes;
+    }
+    /**
+     * @returns The count of the messages encoded in the current batch.
+     */
+    inline size_t count()
+    {
+      return encodedCount;
+    }
+
+  private:
+    Chunk *nextChunk(size_t size)
+    {
+      // Reuse the retained chunk if it fits, or it will be replaced by an oversized one at this position.
+      if (activeChunks < chunks.size() && chunks[activeChunks].capacity >= size)
+        return &chunks[activeChunks++];
+
+      size_t capacity = size > chunkSize ? size : chunkSize;
+      char *data = (char *)malloc(capacity);
+      if (TR_UNLIKELY(data == nullptr))
+        return nullptr;
+      chunks.insert(chunks.begin() + activeChunks, Chunk{data, capacity, 0});
+      return &chunks[activeChunks++];
+    }
+
+  private:
+    size_t chunkSize;
+    std::vector<Chunk> chunks;
+    size_t activeChunks = 0;
+    size_t encodedBytes = 0;
+    size_t encodedCount = 0;
+  };
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "./shared.hpp"
+
+namespace commandbuffers
+{
+  /**
+   * The reason why the pending command buffer requests are flushed.
+   */
+  enum class TrCommandBufferFlushReason : uint8_t
+  {
+    None = 0,
+    Explicit,          // The caller requires the flush, e.g. `gl.flush()` or the context creation.
+    AnimationFrameEnd, // The `requestAnimationFrame` callbacks of this frame are finished.
+    XRFrameEnd,        // The XR frame end marker is sent.
+    ResponseQuery,     // A synchronous query that waits for the `*_RES` response.
+    ByteWatermark,     // The pending bytes reach the watermark.
+    CountWatermark,    // The pending requests reach the watermark when it's not driven by frames.
+    Timeout,           // The pending requests are too old when it's not driven by frames.
+    Count,
+  };
+
+  inline const char *flushReasonToStr(TrCommandBufferFlushReason reason)
+  {
+    switch (reason)
+    {
+    case TrCommandBufferFlushReason::Explicit:
+      return "explicit";
+    case TrCommandBufferFlushReason::AnimationFrameEnd:
+      return "animation_frame_end";
+    case TrCommandBufferFlushReason::XRFrameEnd:
+      return "xrframe_end";
+    case TrCommandBufferFlushReason::ResponseQuery:
+      return "response_query";
+    case TrCommandBufferFlushReason::ByteWatermark:
+      return "byte_watermark";
+    case TrCommandBufferFlushReason::CountWatermark:
+      return "count_watermark";
+    case TrCommandBufferFlushReason::Timeout:
+      return "timeout";
+    default:
+      return "none";
+    }
+  }
+
+  /**
+   * Check if the request type expects a `*_RES` response, the caller is going to wait for it synchronously.
+   */
+  inline bool expectsCommandBufferResponse(CommandBufferType type)
+  {
+    switch (type)
+    {
+#define XX(commandType, responseType) case COMMAND_BUFFER_##commandType##_REQ:
+      TR_COMMAND_BUFFER_RESPONSES_MAP(XX)
+#undef XX
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * The counters of the flushes by reason.
+   */
+  class TrCommandBufferFlushStats
+  {
+  public:
+    inline void increment(TrCommandBufferFlushReason reason)
+    {
+      counts[static_cast<size_t>(reason)] += 1;
+    }
+    inline uint64_t get(TrCommandBufferFlushReason reason) const
+    {
+      return counts[static_cast<size_t>(reason)];
+    }
+    uint64_t total() const
+    {
+      uint64_t sum = 0;
+      for (size_t i = 1; i < static_cast<size_t>(TrCommandBufferFlushReason::Count); i++)
+        sum += counts[i];
+      return sum;
+    }
+
+  private:
+    uint64_t counts[static_cast<size_t>(TrCommandBufferFlushReason::Count)] = {0};
+  };
+
+  /**
+   * The state of the pending requests which is used by the flush policy to make the decision.
+   */
+  struct TrCommandBufferPendingState
+  {
+    size_t bytes;
+    size_t count;
+    std::chrono::steady_clock::time_point now;
+    std::chrono::steady_clock::time_point lastFlushTime;
+  };
+
+  /**
+   * The flush policy decides when the pending requests of `TrCommandBufferSender` should be sent, it's pluggable via
+   * `TrCommandBufferSender::setFlushPolicy()`.
+   */
+  class TrCommandBufferFlushPolicy
+  {
+  public:
+    virtual ~TrCommandBufferFlushPolicy() = default;
+
+  public:
+    /**
+     * It's called after a request is enqueued.
+     *
+     * @param type The type of the enqueued request.
+     * @param state The state of the pending requests including the enqueued one.
+     * @returns The reason to flush now, or `TrCommandBufferFlushReason::None` to keep pending.
+     */
+    virtual TrCommandBufferFlushReason onEnqueued(CommandBufferType type, const TrCommandBufferPendingState &state) = 0;
+    /**
+     * It's called after the pending requests are flushed for the given reason.
+     */
+    virtual void onFlushed(TrCommandBufferFlushReason reason, std::chrono::steady_clock::time_point now)
+    {
+    }
+  };
+
+  /**
+   * The default flush policy, the requests are flushed at the frame boundaries and for the synchronous queries, and the byte
+   * watermark bounds the memory and the latency of the big frames.
+   *
+   * When there are no frame end markers recently, e.g. the script is loading the resources outside of frames, it falls back to
+   * the count and time based flushing to keep the requests moving.
+   */
+  class TrCommandBufferAdaptiveFlushPolicy : public TrCommandBufferFlushPolicy
+  {
+  public:
+    struct Options
+    {
+      size_t maxPendingBytes = 512 * 1024;
+      size_t maxPendingCountWithoutFrames = 1000;
+      std::chrono::milliseconds maxLatencyWithoutFrames = std::chrono::milliseconds(8);
+      /**
+       * The requests are considered to be driven by frames if a frame end is observed in this duration.
+       */
+      std::chrono::milliseconds frameDrivenWindow = std::chrono::milliseconds(100);
+    };
+
+  public:
+    TrCommandBufferAdaptiveFlushPolicy()
+        : TrCommandBufferAdaptiveFlushPolicy(Options())
+    {
+    }
+    TrCommandBufferAdaptiveFlushPolicy(Options options)
+        : options(options)
+    {
+    }
+
+  public:
+    TrCommandBufferFlushReason onEnqueued(CommandBufferType type, const TrCommandBufferPendingState &state) override
+    {
+      if (type == COMMAND_BUFFER_XRFRAME_END_REQ)
+        return TrCommandBufferFlushReason::XRFrameEnd;
+      if (expectsCommandBufferResponse(type))
+        return TrCommandBufferFlushReason::ResponseQuery;
+      if (state.bytes >= options.maxPendingBytes)
+        return TrCommandBufferFlushReason::ByteWatermark;
+
+      if (isFrameDriven(state.now))
+        return TrCommandBufferFlushReason::None;
+      if (state.count >= options.maxPendingCountWithoutFrames)
+        return TrCommandBufferFlushReason::CountWatermark;
+      if (state.now - state.lastFlushTime >= options.maxLatencyWithoutFrames)
+        return TrCommandBufferFlushReason::Timeout;
+      return TrCommandBufferFlushReason::None;
+    }
+    void onFlushed(TrCommandBufferFlushReason reason, std::chrono::steady_clock::time_point now) override
+    {
+      if (reason == TrCommandBufferFlushReason::AnimationFrameEnd ||
+          reason == TrCommandBufferFlushReason::XRFrameEnd)
+      {
+        lastFrameEndTime = now;
+        hasFrameEnd = true;
+      }
+    }
+
+  private:
+    inline bool isFrameDriven(std::chrono::steady_clock::time_point now)
+    {
+      return hasFrameEnd && now - lastFrameEndTime < options.frameDrivenWindow;
+    }
+
+  private:
+    Options options;
+    bool hasFrameEnd = false;
+    std::chrono::steady_clock::time_point lastFrameEndTime;
+  };
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace commandbuffers
+{
+  /**
+   * The object pool to allocate the command buffer objects at the receiver side.
+   *
+   * Each block is prefixed with a header that records its owner pool, thus the objects could be deleted as usual via `delete`
+   * at any thread, and the memory is recycled to the pool instead of being freed. The blocks are grouped by the size classes
+   * of 64 bytes, and the objects larger than the max size class are allocated from the heap directly.
+   *
+   * The allocation must only be made from a single thread (the receiver thread), and the recycling could be made from any
+   * thread: the recycled blocks are pushed to a lock-free stack, and the allocator takes the whole stack back when its local
+   * free list is empty, thus it's free of the ABA problem.
+   *
+   * The pool is reference-counted by the owner and the living objects, it's destroyed when the owner calls `release()` and all
+   * the objects are deleted.
+   */
+  class TrCommandBufferObjectPool
+  {
+  public:
+    static constexpr size_t SizeClassGranularity = 64;
+    static constexpr size_t SizeClassesCount = 16; // Up to 1KB
+
+  private:
+    struct alignas(16) BlockHeader
+    {
+      TrCommandBufferObjectPool *pool;
+      uint32_t sizeClass;
+    };
+    struct FreeBlock
+    {
+      FreeBlock *next;
+    };
+    struct SizeClass
+    {
+      FreeBlock *localFree = nullptr;
+      std::atomic<FreeBlock *> recycled = nullptr;
+    };
+
+  public:
+    /**
+     * Create a new pool, the caller owns a reference and must call `release()` when it doesn't allocate anymore.
+     */
+    static TrCommandBufferObjectPool *Make()
+    {
+      return new TrCommandBufferObjectPool();
+    }
+    /**
+     * Allocate a block from the heap directly, it's used for the objects which are not created by a pool.
+     */
+    static void *AllocateFromHeap(size_t size)
+    {
+      auto header = reinterpret_cast<BlockHeader *>(malloc(sizeof(BlockHeader) + size));
+      if (header == nullptr)
+        throw std::bad_alloc();
+      header->pool = nullptr;
+      header->sizeClass = 0;
+      return header + 1;
+    }
+    /**
+     * Deallocate a block which is allocated by `allocate()` or `AllocateFromHeap()`, it could be called at any thread.
+     */
+    static void Deallocate(void *ptr)
+    {
+      if (ptr == nullptr)
+        return;
+      auto header = reinterpret_cast<BlockHeader *>(ptr) - 1;
+      auto pool = header->pool;
+      if (pool == nullptr)
+        free(header);
+      else
+        pool->recycle(header);
+    }
+
+  private:
+    TrCommandBufferObjectPool() = default;
+    ~TrCommandBufferObjectPool()
+    {
+      for (auto &sizeClass : sizeClasses)
+      {
+        freeList(sizeClass.localFree);
+        freeList(sizeClass.recycled.exchange(nullptr));
+      }
+    }
+
+  public:
+    /**
+     * Allocate a block with at least `size` bytes.
+     *
+     * NOTE: This method must only be called from the owner thread.
+     */
+    void *allocate(size_t size)
+    {
+      size_t index = (sizeof(BlockHeader) + size - 1) / SizeClassGranularity;
+      if (index >= SizeClassesCount)
+        return AllocateFromHeap(size);
+
+      auto &sizeClass = sizeClasses[index];
+      if (sizeClass.localFree == nullptr)
+        sizeClass.localFree = sizeClass.recycled.exchange(nullptr, std::memory_order_acquire);
+
+      void *block;
+      if (sizeClass.localFree != nullptr)
+      {
+        block = sizeClass.localFree;
+        sizeClass.localFree = sizeClass.localFree->next;
+      }
+      else
+      {
+        block = malloc((index + 1) * SizeClassGranularity);
+        if (block == nullptr)
+          throw std::bad_alloc();
+        heapAllocations.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      refs.fetch_add(1, std::memory_order_relaxed);
+      auto header = reinterpret_cast<BlockHeader *>(block);
+      header->pool = this;
+      header->sizeClass = static_cast<uint32_t>(index);
+      return header + 1;
+    }
+    /**
+     * Drop the owner's reference, the pool is destroyed when there are no living objects.
+     */
+    void release()
+    {
+      unref();
+    }
+    /**
+     * @returns The count of the blocks allocated from the heap, it stops growing once the pool is warmed up.
+     */
+    inline size_t getHeapAllocations()
+    {
+      return heapAllocations.load(std::memory_order_relaxed);
+    }
+
+  private:
+    void recycle(BlockHeader *header)
+    {
+      auto &sizeClass = sizeClasses[header->sizeClass];
+      auto block = reinterpret_cast<FreeBlock *>(header);
+      block->next = sizeClass.recycled.load(std::memory_order_relaxed);
+      while (!sizeClass.recycled.compare_exchange_weak(block->next, block,
+                                                       std::memory_order_release,
+                                                       std::memory_order_relaxed))
+        ;
+      unref();
+    }
+    void unref()
+    {
+      if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+    static void freeList(FreeBlock *block)
+    {
+      while (block != nullptr)
+      {
+        auto next = block->next;
+        free(block);
+        block = next;
+      }
+    }
+
+  private:
+    std::atomic<size_t> refs = 1;
+    std::atomic<size_t> heapAllocations = 0;
+    SizeClass sizeClasses[SizeClassesCount];
+  };
+}
@@ -7,17 +7,21 @@ namespace commandbuffers
   TrCommandBufferBase *TrCommandBufferReceiver::recvCommandBufferRequest(int timeout)
   {
     TrCommandBufferMessage message;
-    if (!message.deserialize(this, timeout))
+    bool received = sharedMemoryRing != nullptr
+                      ? message.deserialize(*sharedMemoryRing, timeout, ringPartialMessage)
+                      : message.deserialize(this, timeout);
+    if (!received)
       return nullptr;
+    message.payloadPool = payloadPool;
 
     TrCommandBufferBase *req = nullptr;
     switch (message.type)
     {
-#define XX(commandType, requestType)                                    \
-  case COMMAND_BUFFER_##commandType##_REQ:                              \
-  {                                                                     \
-    req = TrCommandBufferBase::CreateFromMessage<requestType>(message); \
-    break;                                                              \
+#define XX(commandType, requestType)                                                  \
+  case COMMAND_BUFFER_##commandType##_REQ:                                            \
+  {                                                                                   \
+    req = TrCommandBufferBase::CreateFromMessage<requestType>(message, requestsPool); \
+    break;                                                                            \
   }
       TR_COMMAND_BUFFER_REQUESTS_MAP(XX)
 #undef XX
@@ -51,4 +55,32 @@ namespace commandbuffers
     }
     return resp;
   }
+
+  bool TrCommandBufferReceiver::hasPendingResponse()
+  {
+    int fd = getFd();
+    if (fd < 0)
+      return false;
+
+    struct pollfd fds[1];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    return poll(fds, 1, 0) > 0 && (fds[0].revents & POLLIN);
+  }
+
+  bool TrCommandBufferReceiver::waitForRequestsByChannel()
+  {
+    if (sharedMemoryRing == nullptr)
+      return true;
+
+    int fd = getFd();
+    if (fd >= 0)
+    {
+      char wakeBytes[64];
+      while (::recv(fd, wakeBytes, sizeof(wakeBytes), MSG_DONTWAIT) > 0)
+      {
+      }
+    }
+    return sharedMemoryRing->requestWakeByChannel();
+  }
 }
@@ -10,10 +10,14 @@ namespace commandbuffers
   public:
     TrCommandBufferReceiver(ipc::TrOneShotClient<TrCommandBufferMessage> *client)
         : ipc::TrChannelReceiver<TrCommandBufferMessage>(client)
+        , requestsPool(TrCommandBufferObjectPool::Make())
     {
     }
     ~TrCommandBufferReceiver()
     {
+      // The pool is destroyed after the last request is deleted.
+      requestsPool->release();
+      requestsPool = nullptr;
     }
 
   public:
@@ -22,6 +26,58 @@ namespace commandbuffers
     // It will return an allocated command buffer request object, the caller must manage its lifetime.
     [[nodiscard]] TrCommandBufferBase *recvCommandBufferRequest(int timeout = 0);
     [[nodiscard]] TrCommandBufferResponse *recvCommandBufferResponse(int timeout = 0);
+    /**
+     * Check if a response is ready to be received from the channel without blocking, then the caller could receive it with
+     * a timeout safely, because the rest of the message is arriving.
+     *
+     * @returns true if the channel is readable.
+     */
+    bool hasPendingResponse();
+    /**
+     * Prepare to wait for the requests at a reactor which watches the channel's socket.
+     *
+     * When the shared memory ring is attached, the wake bytes sent by the peer's `TrCommandBufferSender` are discarded, and the
+     * peer is asked to send another one at the next writing. Otherwise, the requests arrive at the socket directly.
+     *
+     * @returns `false` if the requests arrived while preparing, then the caller should receive them instead of waiting.
+     */
+    bool waitForRequestsByChannel();
+    /**
+     * Attach a shared memory ring to this receiver, then the requests will be read from the ring instead of the socket.
+     *
+     * @param ring The shared memory ring which is written by the peer's `TrCommandBufferSender`.
+     */
+    inline void attachSharedMemoryRing(std::shared_ptr<ipc::TrShmRingBuffer> ring)
+    {
+      if (ring != nullptr && ring->isValid())
+      {
+        sharedMemoryRing = ring;
+        ringPartialMessage.reset();
+      }
+    }
+    /**
+     * Attach a shared memory pool to this receiver, it's used to resolve the large payloads (buffer data and texture pixels)
+     * that the peer writes into the pool instead of the command buffer channel.
+     *
+     * @param pool The shared memory pool which is created by the server side.
+     */
+    inline void attachPayloadPool(std::shared_ptr<ipc::TrShmBlockPool> pool)
+    {
+      if (pool != nullptr && pool->isValid())
+        payloadPool = pool;
+    }
+
+  private:
+    std::shared_ptr<ipc::TrShmRingBuffer> sharedMemoryRing = nullptr;
+    /**
+     * The request which is partially read from the ring, it's resumed at the next receiving instead of waiting for the rest.
+     */
+    ipc::TrShmRingPartialMessage ringPartialMessage;
+    std::shared_ptr<ipc::TrShmBlockPool> payloadPool = nullptr;
+    /**
+     * The received requests are allocated in this pool to avoid the heap allocation for each request.
+     */
+    TrCommandBufferObjectPool *requestsPool = nullptr;
 
     friend class TrCommandBufferMessage;
   };
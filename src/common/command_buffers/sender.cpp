@@ -27,20 +27,19 @@ namespace commandbuffers
       return false;
     }
 
-    void *data = nullptr;
-    size_t size = 0;
-    auto success = message->serialize(&data, &size);
+    // Serialize the message into the encoder directly, it's sent at the next flush.
+    auto r = encoder.encode(*message);
     delete message;
-    if (!success)
-    {
-      assert(data == nullptr); // !success means allocation failure.
-      return false;
-    }
 
-    assert(data != nullptr && size > 0);
-    auto r = enqueue(data, size);
-    if (forceFlush || needFlush())
-      flush();
+    TrCommandBufferPendingState state = {encoder.size(),
+                                         encoder.count(),
+                                         std::chrono::steady_clock::now(),
+                                         lastFlushTime};
+    auto reason = flushPolicy->onEnqueued(req.type, state);
+    if (reason == TrCommandBufferFlushReason::None && forceFlush)
+      reason = TrCommandBufferFlushReason::Explicit;
+    if (reason != TrCommandBufferFlushReason::None)
+      flush(reason);
     return r;
   }
 
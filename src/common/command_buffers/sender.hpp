@@ -2,6 +2,8 @@
 
 #include "./shared.hpp"
 #include "./base.hpp"
+#include "./encoder.hpp"
+#include "./flush_policy.hpp"
 
 namespace commandbuffers
 {
@@ -10,6 +12,8 @@ namespace commandbuffers
   public:
     TrCommandBufferSender(ipc::TrOneShotClient<TrCommandBufferMessage> *client)
         : ipc::TrChannelSender<TrCommandBufferMessage>(client)
+        , flushPolicy(std::make_unique<TrCommandBufferAdaptiveFlushPolicy>())
+        , lastFlushTime(std::chrono::steady_clock::now())
     {
     }
     ~TrCommandBufferSender()
@@ -19,55 +23,86 @@ namespace commandbuffers
   public:
     bool sendCommandBufferRequest(TrCommandBufferBase &req, bool forceFlush = false);
     bool sendCommandBufferResponse(TrCommandBufferResponse &res);
+    /**
+     * Attach a shared memory ring to this sender, then the flushed requests will be written into the ring instead of the socket,
+     * the responses are still sent via the socket.
+     *
+     * @param ring The shared memory ring which is created by the renderer.
+     */
+    inline void attachSharedMemoryRing(std::shared_ptr<ipc::TrShmRingBuffer> ring)
+    {
+      if (ring != nullptr && ring->isValid())
+        sharedMemoryRing = ring;
+    }
 
-  private:
-    inline bool needFlush()
+    /**
+     * Replace the flush policy which decides when the pending requests are sent.
+     *
+     * @param policy The new flush policy, it's ignored if nullptr.
+     */
+    inline void setFlushPolicy(std::unique_ptr<TrCommandBufferFlushPolicy> policy)
     {
-      if (pendingBuffersCount > 1000)
-        return true;
-      auto now = std::chrono::steady_clock::now();
-      auto durationInMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastFlushTime).count();
-      return durationInMs >= 8;
+      if (policy != nullptr)
+        flushPolicy = std::move(policy);
     }
-    bool enqueue(void *data, size_t size)
+    /**
+     * Flush the pending requests at the end of an animation frame, it does nothing if there are no pending requests.
+     *
+     * @returns If the pending requests are sent.
+     */
+    inline bool flushAtAnimationFrameEnd()
     {
-      assert(data != nullptr && size > 0);
-      if (bufferToSend == nullptr)
-      {
-        bufferToSend = data;
-        bufferSize = size;
-      }
-      else
-      {
-        bufferToSend = realloc(bufferToSend, bufferSize + size);
-        if (TR_UNLIKELY(bufferToSend == nullptr))
-          return false;
-        memcpy((char *)bufferToSend + bufferSize, data, size);
-        bufferSize += size;
-        free(data);
-      }
-      pendingBuffersCount += 1;
-      return true;
+      if (encoder.empty())
+        return false;
+      return flush(TrCommandBufferFlushReason::AnimationFrameEnd);
     }
-    bool flush()
+    /**
+     * @returns The counters of the flushes by reason.
+     */
+    inline const TrCommandBufferFlushStats &getFlushStats()
     {
-      pendingBuffersCount = 0;
-      lastFlushTime = std::chrono::steady_clock::now();
+      return flushStats;
+    }
 
-      if (TR_UNLIKELY(bufferToSend == nullptr))
+  private:
+    bool flush(TrCommandBufferFlushReason reason)
+    {
+      lastFlushTime = std::chrono::steady_clock::now();
+      if (TR_UNLIKELY(encoder.empty()))
         return false;
 
-      auto r = sendRaw(bufferToSend, bufferSize);
-      free(bufferToSend);
-      bufferToSend = nullptr;
-      bufferSize = 0;
+      bool r;
+      if (sharedMemoryRing != nullptr)
+      {
+        r = encoder.forEachChunk([this](const char *data, size_t size)
+                                 { return sharedMemoryRing->write(data, size); });
+        // The receiver might be waiting at the host's reactor which watches the socket, thus a byte is sent to wake it.
+        if (r && sharedMemoryRing->takeWakeByChannelRequest())
+        {
+          static const uint8_t wakeByte = 1;
+          sendRaw(&wakeByte, sizeof(wakeByte));
+        }
+      }
+      else
+      {
+        encoder.fillIovecs(iovecsToSend);
+        r = sendRawv(iovecsToSend.data(), iovecsToSend.size());
+      }
+      encoder.reset();
+      flushStats.increment(reason);
+      flushPolicy->onFlushed(reason, lastFlushTime);
       return r;
     }
 
   private:
-    void *bufferToSend = nullptr;
-    size_t bufferSize = 0;
-    int pendingBuffersCount = 0;
+    /**
+     * The pending requests are encoded into the reusable chunks, and sent at once when flushing.
+     */
+    TrCommandBufferEncoder encoder;
+    std::vector<struct iovec> iovecsToSend;
+    std::unique_ptr<TrCommandBufferFlushPolicy> flushPolicy;
+    TrCommandBufferFlushStats flushStats;
     std::chrono::time_point<std::chrono::steady_clock> lastFlushTime;
+    std::shared_ptr<ipc::TrShmRingBuffer> sharedMemoryRing = nullptr;
   };
 }
@@ -5,6 +5,7 @@
 #include "idgen.hpp"
 #include "common/ipc.hpp"
 #include "common/ipc_message.hpp"
+#include "common/ipc_shm_pool.hpp"
 #include "common/ipc_serializable.hpp"
 
 #include "./macros.hpp"
@@ -273,5 +274,12 @@ namespace commandbuffers
         : TrIpcMessage(type, size, base)
     {
     }
+
+  public:
+    /**
+     * The shared memory pool to resolve the large payloads at the receiver side, it's set by the receiver before the request is
+     * deserialized, and it's nullptr when the payloads are always inlined.
+     */
+    std::shared_ptr<ipc::TrShmBlockPool> payloadPool = nullptr;
   };
 }
@@ -283,7 +283,7 @@ const int WEBGL_STENCIL_PASS_DEPTH_PASS = 0x0B96;
 /**
  * Passed to `getParameter` to get the reference value used for stencil tests.
  */
-const int WEBGL_STENCIL_REF = 0x0B98;
+const int WEBGL_STENCIL_REF = 0x0B97;
 
 const int WEBGL_STENCIL_VALUE_MASK = 0x0B93;
 const int WEBGL_STENCIL_WRITEMASK = 0x0B98;
@@ -1137,6 +1137,11 @@ const int WEBGL2_EXT_FRAMEBUFFER_INCOMPLETE_VIEW_TARGETS_OVR = 0x9633;
 const int WEBGL2_TEXTURE_MAX_ANISOTROPY_EXT = 0x84FE;
 const int WEBGL2_MAX_TEXTURE_MAX_ANISOTROPY_EXT = 0x84FF;
 
+/**
+ * KHR_parallel_shader_compile
+ */
+const int WEBGL_COMPLETION_STATUS_KHR = 0x91B1;
+
 // Introduced by JSAR
 
 /**
@@ -9,6 +9,7 @@
 #include <functional>
 
 #include <assert.h>
+#include <limits.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -17,6 +18,7 @@
 #include <sys/socket.h>
 #include <sys/poll.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -182,6 +184,49 @@ namespace ipc
       assert(bytesSent == size); // The bytes to be sent is expected to be the specific `size`.
       return true;
     }
+    /**
+     * Send the buffers in order via a single `writev()` call, the partial writes are continued from the unsent position.
+     *
+     * NOTE: The `iov` list is modified in place to track the progress.
+     *
+     * @param iov The buffers to send.
+     * @param iovcnt The count of the buffers.
+     * @returns If all the buffers are sent.
+     */
+    bool sendRawv(struct iovec *iov, int iovcnt)
+    {
+      if (fd == -1 || client == nullptr || client->invalid())
+        return false;
+
+      while (iovcnt > 0)
+      {
+        int count = iovcnt > IOV_MAX ? IOV_MAX : iovcnt;
+        ssize_t sent = ::writev(fd, iov, count);
+        if (sent == -1)
+        {
+          if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            continue;
+          if (errno == ECONNRESET || errno == EPIPE)
+            client->invalid(true);
+          DEBUG(LOG_TAG_IPC, "Failed to send data(buffers=%d): %s", iovcnt, strerror(errno));
+          return false;
+        }
+
+        // Skip the sent buffers and adjust the partially sent one.
+        while (iovcnt > 0 && sent >= (ssize_t)iov->iov_len)
+        {
+          sent -= iov->iov_len;
+          iov++;
+          iovcnt--;
+        }
+        if (sent > 0)
+        {
+          iov->iov_base = (char *)iov->iov_base + sent;
+          iov->iov_len -= sent;
+        }
+      }
+      return true;
+    }
 
   private:
     int fd;
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <vector>
 #include <string>
 #include <assert.h>
 
 #include "idgen.hpp"
 #include "./ipc.hpp"
+#include "./ipc_shm_ring.hpp"
 
 using namespace std;
 
@@ -17,6 +19,12 @@ namespace ipc
   class TrIpcMessageSegment
   {
   public:
+    TrIpcMessageSegment()
+        : size(0)
+        , data(nullptr)
+        , ownMemory(false)
+    {
+    }
     TrIpcMessageSegment(size_t size, void *data, bool ownMemory = true)
         : size(size)
         , ownMemory(ownMemory)
@@ -49,6 +57,27 @@ namespace ipc
     }
 
   public:
+    /**
+     * It resets this segment to the given data, the data is copied only if `ownMemory` is true, otherwise this segment is
+     * a view of the data which must outlive this segment.
+     */
+    void reset(size_t size, void *data, bool ownMemory)
+    {
+      if (this->ownMemory && this->data != nullptr)
+        delete[] this->data;
+
+      this->size = size;
+      this->ownMemory = ownMemory;
+      if (ownMemory)
+      {
+        this->data = new char[size];
+        memcpy(this->data, data, size);
+      }
+      else
+      {
+        this->data = (char *)data;
+      }
+    }
     inline size_t getSize()
     {
       return size;
@@ -84,6 +113,31 @@ namespace ipc
     bool ownMemory = true;
   };
 
+  /**
+   * The message which is partially read from the shared memory ring, it's kept by the consumer between the reads, thus the
+   * consumer could return when the rest bytes are not written yet, and resume the message at the next read.
+   */
+  struct TrShmRingPartialMessage
+  {
+    static constexpr size_t HeaderSize = sizeof(int16_t) + sizeof(size_t); // magic + content size
+
+    char header[HeaderSize];
+    size_t headerBytes = 0;
+    std::vector<char> content;
+    size_t contentBytes = 0;
+
+    inline bool empty() const
+    {
+      return headerBytes == 0;
+    }
+    inline void reset()
+    {
+      headerBytes = 0;
+      content.clear();
+      contentBytes = 0;
+    }
+  };
+
   template <typename MessageType, typename MessageEnum>
   class TrIpcMessage
   {
@@ -112,16 +166,20 @@ namespace ipc
     {
       if (usage == USAGE_DESERIALIZE)
       {
-        if (base != nullptr)
-        {
+        if (base != nullptr && base != inlineBase)
           free(base);
-          base = nullptr;
-        }
+        base = nullptr;
       }
 
       for (auto segment : segments)
         delete segment;
       segments.clear();
+
+      // The decoded segments are views into the ring, thus the ring is consumed only when this message is gone.
+      if (pendingRing != nullptr)
+        pendingRing->consume(pendingRingBytes);
+      if (pendingPartial != nullptr)
+        pendingPartial->reset();
     }
 
   public:
@@ -150,6 +208,9 @@ namespace ipc
     }
     TrIpcMessageSegment *getSegment(size_t index)
     {
+      if (index < inlineSegmentsCount)
+        return &inlineSegments[index];
+      index -= inlineSegmentsCount;
       if (index >= segments.size())
         return nullptr;
       else
@@ -157,7 +218,7 @@ namespace ipc
     }
     size_t getSegmentCount()
     {
-      return segments.size();
+      return inlineSegmentsCount + segments.size();
     }
 
     /**
@@ -169,30 +230,40 @@ namespace ipc
      */
     bool serialize(void **outData, size_t *outSize)
     {
-      usage = USAGE_SERIALIZE;
-
-      size_t segmentsLength = 0;
-      for (auto &segment : segments)
-        segmentsLength += (sizeof(segment->size) + segment->size); // size + data
-      size_t contentSize =
-        sizeof(type) +     // type
-        sizeof(uint32_t) + // id
-        sizeof(size_t) +   // segments length
-        sizeof(size_t) +   // segments count
-        segmentsLength +   // segments
-        sizeof(size_t) +   // base size
-        baseSize;          // base
-
-      int16_t magic = TR_IPC_MESSAGE_MAGIC;
-      size_t bufferSize =
-        sizeof(magic) +       // magic
-        sizeof(contentSize) + // content size
-        contentSize;          // content
-
+      size_t bufferSize = computeSerializedSize();
       char *buffer = (char *)malloc(bufferSize);
       if (buffer == nullptr)
         return false; // out of memory
 
+      serializeTo(buffer);
+      *outData = buffer;
+      *outSize = bufferSize;
+      return true;
+    }
+    /**
+     * @returns the bytes of the serialized message, which is the size that `serializeTo()` requires.
+     */
+    size_t computeSerializedSize()
+    {
+      return sizeof(int16_t) + // magic
+             sizeof(size_t) +  // content size
+             computeContentSize();
+    }
+    /**
+     * It serializes this message into the given buffer in the wire layout, the caller must make sure the buffer has at least
+     * `computeSerializedSize()` bytes.
+     *
+     * @param buffer the destination buffer.
+     * @returns the bytes written.
+     */
+    size_t serializeTo(char *buffer)
+    {
+      usage = USAGE_SERIALIZE;
+
+      size_t segmentsLength = computeSegmentsLength();
+      size_t contentSize = computeContentSize();
+      int16_t magic = TR_IPC_MESSAGE_MAGIC;
+
       size_t offset = 0;
       // Write header
       offset = writeTo(buffer, offset, &magic);
@@ -203,11 +274,12 @@ namespace ipc
       offset = writeTo(buffer, offset, &id, sizeof(id));
 
       // Write segments
-      size_t segmentsCount = segments.size();
+      size_t segmentsCount = getSegmentCount();
       offset = writeTo(buffer, offset, &segmentsLength, sizeof(segmentsLength));
       offset = writeTo(buffer, offset, &segmentsCount, sizeof(size_t));
-      for (auto &segment : segments)
+      for (size_t i = 0; i < segmentsCount; i++)
       {
+        auto segment = getSegment(i);
         offset = writeTo(buffer, offset, &segment->size, sizeof(segment->size));
         offset = writeTo(buffer, offset, segment->data, segment->size);
       }
@@ -215,11 +287,8 @@ namespace ipc
       // Write base
       offset = writeTo(buffer, offset, &baseSize, sizeof(baseSize));
       offset = writeTo(buffer, offset, base, baseSize);
-      assert(offset == bufferSize);
-
-      *outData = buffer;
-      *outSize = bufferSize;
-      return true;
+      assert(offset == sizeof(magic) + sizeof(contentSize) + contentSize);
+      return offset;
     }
 
 #define STATIC_BUFFER_SIZE 1024 // 1KB
@@ -271,6 +340,98 @@ namespace ipc
       return res;
     }
 
+    /**
+     * It deserializes a message from the shared memory ring, the content is decoded in place when the whole message is
+     * contiguous in the ring, otherwise the ready bytes are copied into `partial` and the message is resumed at the next call.
+     *
+     * It never waits longer than `recvTimeout` in total, even if a message has been partially read, thus a stalled producer
+     * can't block the consumer.
+     *
+     * @param ring the shared memory ring to read from.
+     * @param recvTimeout the timeout in milliseconds to wait for the data, a negative value means waiting forever.
+     * @param partial the partially read message, it must be kept by the caller for the same ring.
+     * @returns true if a message is deserialized.
+     *
+     * NOTE: The segments are not copied, they refer to the ring or `partial` until this message is destroyed, thus the
+     * message must be destroyed before the next read from the same ring.
+     */
+    bool deserialize(TrShmRingBuffer &ring, int recvTimeout, TrShmRingPartialMessage &partial)
+    {
+      usage = USAGE_DESERIALIZE; // mark as deserialized
+      assert(base == nullptr);
+      constexpr size_t HeaderSize = TrShmRingPartialMessage::HeaderSize;
+
+      auto deadline = chrono::steady_clock::now() + chrono::milliseconds(recvTimeout);
+      auto waitForMore = [&ring, recvTimeout, &deadline]() -> bool
+      {
+        if (recvTimeout < 0)
+          return ring.waitForData(-1);
+        auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+        return remaining > 0 && ring.waitForData(static_cast<int>(remaining));
+      };
+      if (ring.readableBytes() == 0 && !ring.waitForData(recvTimeout))
+        return false;
+
+      if (partial.empty())
+      {
+        // Decode in place if the whole message is ready and contiguous.
+        const char *headerInRing = ring.peek(HeaderSize);
+        if (headerInRing != nullptr)
+        {
+          int16_t magic;
+          size_t contentSize;
+          memcpy(&magic, headerInRing, sizeof(magic));
+          memcpy(&contentSize, headerInRing + sizeof(magic), sizeof(contentSize));
+          if (magic == TR_IPC_MESSAGE_MAGIC)
+          {
+            const char *messageInRing = ring.peek(HeaderSize + contentSize);
+            if (messageInRing != nullptr)
+            {
+              bool res = deserializeContent(const_cast<char *>(messageInRing + HeaderSize), contentSize, false);
+              pendingRing = &ring;
+              pendingRingBytes = HeaderSize + contentSize;
+              return res;
+            }
+          }
+        }
+      }
+
+      // Otherwise, the message is read piece by piece into the partial message.
+      while (true)
+      {
+        if (partial.headerBytes < HeaderSize)
+        {
+          partial.headerBytes += ring.tryRead(partial.header + partial.headerBytes, HeaderSize - partial.headerBytes);
+          if (partial.headerBytes == HeaderSize)
+          {
+            int16_t magic;
+            size_t contentSize;
+            memcpy(&magic, partial.header, sizeof(magic));
+            memcpy(&contentSize, partial.header + sizeof(magic), sizeof(contentSize));
+            if (magic != TR_IPC_MESSAGE_MAGIC)
+            {
+              partial.reset();
+              return false;
+            }
+            partial.content.resize(contentSize);
+          }
+        }
+        if (partial.headerBytes == HeaderSize)
+        {
+          partial.contentBytes += ring.tryRead(partial.content.data() + partial.contentBytes,
+                                               partial.content.size() - partial.contentBytes);
+          if (partial.contentBytes == partial.content.size())
+          {
+            bool res = deserializeContent(partial.content.data(), partial.content.size(), false);
+            pendingPartial = &partial;
+            return res;
+          }
+        }
+        if (ring.isClosed() || !waitForMore())
+          return false;
+      }
+    }
+
     bool deserialize(char *buffer, size_t size)
     {
       size_t offset = 0;
@@ -285,7 +446,15 @@ namespace ipc
       return deserializeContent(buffer + offset, contentSize);
     }
 
-    bool deserializeContent(char *contentBuffer, size_t contentSize)
+    /**
+     * It deserializes the message content.
+     *
+     * @param contentBuffer the content buffer.
+     * @param contentSize the size of the content buffer.
+     * @param copySegments if false, the segments refer to `contentBuffer` which must outlive this message.
+     * @returns true if the content is deserialized.
+     */
+    bool deserializeContent(char *contentBuffer, size_t contentSize, bool copySegments = true)
     {
       size_t offset = 0;
       offset = readFrom(contentBuffer, offset, &type);
@@ -299,16 +468,16 @@ namespace ipc
       {
         size_t cSize;
         offset = readFrom(contentBuffer, offset, &cSize);
-        void *cData = malloc(cSize);
-        offset = readFrom(contentBuffer, offset, cData, cSize);
-        if (cData != nullptr)
-        {
-          segments.push_back(new TrIpcMessageSegment(cSize, cData));
-          free(cData);
-        }
+        // The first segments are stored inline to avoid the heap allocation for each message.
+        if (inlineSegmentsCount < InlineSegmentsCount)
+          inlineSegments[inlineSegmentsCount++].reset(cSize, contentBuffer + offset, copySegments);
+        else
+          segments.push_back(new TrIpcMessageSegment(cSize, contentBuffer + offset, copySegments));
+        offset += cSize;
       }
       offset = readFrom(contentBuffer, offset, &baseSize);
-      base = malloc(baseSize);
+      // The small base is stored inline to avoid the heap allocation for each message.
+      base = baseSize <= InlineBaseSize ? inlineBase : malloc(baseSize);
       offset = readFrom(contentBuffer, offset, base, baseSize);
 
       assert(offset == contentSize); // check if all content is read
@@ -343,6 +512,26 @@ namespace ipc
     }
 
   private:
+    size_t computeSegmentsLength()
+    {
+      size_t segmentsLength = 0;
+      for (size_t i = 0; i < getSegmentCount(); i++)
+      {
+        auto segment = getSegment(i);
+        segmentsLength += (sizeof(segment->size) + segment->size); // size + data
+      }
+      return segmentsLength;
+    }
+    size_t computeContentSize()
+    {
+      return sizeof(type) +             // type
+             sizeof(uint32_t) +         // id
+             sizeof(size_t) +           // segments length
+             sizeof(size_t) +           // segments count
+             computeSegmentsLength() +  // segments
+             sizeof(size_t) +           // base size
+             baseSize;                  // base
+    }
     template <typename T>
     size_t readFrom(char *src, size_t offset, T *dest)
     {
@@ -371,6 +560,16 @@ namespace ipc
     uint32_t id;
     vector<TrIpcMessageSegment *> segments;
 
+  private:
+    static constexpr size_t InlineBaseSize = 256;
+    alignas(16) char inlineBase[InlineBaseSize];
+    static constexpr size_t InlineSegmentsCount = 4;
+    TrIpcMessageSegment inlineSegments[InlineSegmentsCount];
+    size_t inlineSegmentsCount = 0;
+    TrShmRingBuffer *pendingRing = nullptr;
+    size_t pendingRingBytes = 0;
+    TrShmRingPartialMessage *pendingPartial = nullptr;
+
   private:
     Usage usage = USAGE_NOTSET;
     size_t baseSize;
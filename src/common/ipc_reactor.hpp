@@ -0,0 +1,319 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#endif
+
+#include "./utility.hpp"
+#include "./debug.hpp"
+
+namespace ipc
+{
+  /**
+   * The reactor watches the channels' file descriptors at a single thread, and calls the handler of a channel when it becomes
+   * readable, it's used to serve the channels of all the contents at a fixed thread instead of a thread per channel.
+   *
+   * The readiness is edge-triggered (epoll's `EPOLLET` on Linux and Android, kqueue's `EV_CLEAR` on Apple platforms), thus the
+   * handler must drain the channel until it's empty. A handler returns `true` to be called again at the next round, it's used to
+   * drain a busy channel in batches without starving the others. A channel could also be scheduled by `notify()`, such as when
+   * its pending requests could be consumed again.
+   */
+  class TrChannelReactor final
+  {
+  public:
+    using Token = uint32_t;
+    /**
+     * The handler of a channel, it returns `true` if there is more data to handle.
+     */
+    using Handler = std::function<bool()>;
+
+    /**
+     * The token which is never returned by `add()`.
+     */
+    static constexpr Token InvalidToken = 0;
+
+  public:
+    TrChannelReactor(std::string name)
+        : name(name)
+    {
+#if defined(__linux__)
+      pollFd = epoll_create1(EPOLL_CLOEXEC);
+      wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      struct epoll_event event;
+      event.events = EPOLLIN | EPOLLET;
+      event.data.u64 = InvalidToken;
+      epoll_ctl(pollFd, EPOLL_CTL_ADD, wakeFd, &event);
+#elif defined(__APPLE__)
+      pollFd = kqueue();
+      struct kevent event;
+      EV_SET(&event, InvalidToken, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+      kevent(pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+      if (pollFd < 0)
+        DEBUG(LOG_TAG_IPC, "Failed to create the reactor(%s): %s", name.c_str(), strerror(errno));
+
+      running = true;
+      reactorThread = std::thread([this]()
+                                  {
+                                    SET_THREAD_NAME(this->name.c_str());
+                                    run(); });
+    }
+    ~TrChannelReactor()
+    {
+      running = false;
+      wakeUp();
+      if (reactorThread.joinable())
+        reactorThread.join();
+
+      if (wakeFd >= 0)
+        ::close(wakeFd);
+      if (pollFd >= 0)
+        ::close(pollFd);
+    }
+
+  public:
+    /**
+     * Add a channel to watch.
+     *
+     * @param fd The file descriptor of the channel.
+     * @param handler The handler to be called at the reactor thread when the channel is readable, it's also called once after
+     * adding, because the data might arrive before watching.
+     * @returns The token to remove or notify the channel.
+     */
+    Token add(int fd, Handler handler)
+    {
+      if (TR_UNLIKELY(fd < 0 || pollFd < 0))
+        return InvalidToken;
+
+      auto source = std::make_shared<Source>();
+      source->fd = fd;
+      source->handler = std::move(handler);
+
+      Token token;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        token = nextToken++;
+        sources[token] = source;
+      }
+
+#if defined(__linux__)
+      struct epoll_event event;
+      event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+      event.data.u64 = token;
+      epoll_ctl(pollFd, EPOLL_CTL_ADD, fd, &event);
+#elif defined(__APPLE__)
+      struct kevent event;
+      EV_SET(&event, fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, reinterpret_cast<void *>(static_cast<uintptr_t>(token)));
+      kevent(pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+      notify(token);
+      return token;
+    }
+    /**
+     * Remove the channel, it waits for the running handler of this channel, and the handler is not called after returning.
+     *
+     * NOTE: It must not be called from the handlers, otherwise it deadlocks.
+     */
+    void remove(Token token)
+    {
+      std::shared_ptr<Source> source;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = sources.find(token);
+        if (it == sources.end())
+          return;
+        source = it->second;
+        sources.erase(it);
+      }
+
+#if defined(__linux__)
+      epoll_ctl(pollFd, EPOLL_CTL_DEL, source->fd, nullptr);
+#elif defined(__APPLE__)
+      struct kevent event;
+      EV_SET(&event, source->fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+      kevent(pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+
+      std::lock_guard<std::mutex> runningLock(source->runningMutex);
+      source->removed = true;
+    }
+    /**
+     * Schedule the handler of the channel to be called at the next round, it could be called from any thread.
+     */
+    void notify(Token token)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!enqueueLocked(token))
+          return;
+      }
+      wakeUp();
+    }
+    /**
+     * @returns The count of the watched channels.
+     */
+    size_t size()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return sources.size();
+    }
+
+  private:
+    struct Source
+    {
+      int fd = -1;
+      Handler handler;
+      // If the channel is in the ready queue.
+      bool queued = false;
+      bool removed = false;
+      // Held while the handler is running, `remove()` waits for it.
+      std::mutex runningMutex;
+    };
+
+    bool enqueueLocked(Token token)
+    {
+      auto it = sources.find(token);
+      if (it == sources.end() || it->second->queued)
+        return false;
+      it->second->queued = true;
+      readyQueue.push_back(token);
+      return true;
+    }
+    void wakeUp()
+    {
+#if defined(__linux__)
+      uint64_t one = 1;
+      ssize_t r = ::write(wakeFd, &one, sizeof(one));
+      (void)r;
+#elif defined(__APPLE__)
+      struct kevent event;
+      EV_SET(&event, InvalidToken, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+      kevent(pollFd, &event, 1, nullptr, 0, nullptr);
+#endif
+    }
+    /**
+     * Wait for the readable channels and move them to the ready queue.
+     *
+     * @param timeout The timeout in milliseconds, a negative value means waiting forever.
+     */
+    void waitForEvents(int timeout)
+    {
+      static constexpr int MaxEvents = 64;
+#if defined(__linux__)
+      struct epoll_event events[MaxEvents];
+      int n = epoll_wait(pollFd, events, MaxEvents, timeout);
+      std::lock_guard<std::mutex> lock(mutex);
+      for (int i = 0; i < n; i++)
+      {
+        Token token = static_cast<Token>(events[i].data.u64);
+        if (token == InvalidToken)
+        {
+          uint64_t count;
+          while (::read(wakeFd, &count, sizeof(count)) > 0)
+          {
+          }
+          continue;
+        }
+        enqueueLocked(token);
+      }
+#elif defined(__APPLE__)
+      struct kevent events[MaxEvents];
+      struct timespec ts;
+      struct timespec *pts = nullptr;
+      if (timeout >= 0)
+      {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000;
+        pts = &ts;
+      }
+      int n = kevent(pollFd, nullptr, 0, events, MaxEvents, pts);
+      std::lock_guard<std::mutex> lock(mutex);
+      for (int i = 0; i < n; i++)
+      {
+        if (events[i].filter == EVFILT_READ)
+          enqueueLocked(static_cast<Token>(reinterpret_cast<uintptr_t>(events[i].udata)));
+      }
+#else
+      // No readiness notification on this platform, thus all the channels are polled periodically.
+      if (timeout != 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto &it : sources)
+        enqueueLocked(it.first);
+#endif
+    }
+    void run()
+    {
+      std::deque<Token> round;
+      while (running)
+      {
+        bool hasReady;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          hasReady = !readyQueue.empty();
+        }
+        waitForEvents(hasReady ? 0 : -1);
+
+        // Take the ready channels of this round, the channels which are ready again while handling are queued for the next.
+        std::vector<std::pair<Token, std::shared_ptr<Source>>> sourcesToHandle;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          round.swap(readyQueue);
+          for (auto token : round)
+          {
+            auto it = sources.find(token);
+            if (it == sources.end())
+              continue;
+            it->second->queued = false;
+            sourcesToHandle.emplace_back(token, it->second);
+          }
+          round.clear();
+        }
+
+        for (auto &it : sourcesToHandle)
+        {
+          auto &source = it.second;
+          bool hasMore;
+          {
+            std::lock_guard<std::mutex> runningLock(source->runningMutex);
+            if (source->removed)
+              continue;
+            hasMore = source->handler();
+          }
+          if (hasMore)
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            enqueueLocked(it.first);
+          }
+        }
+      }
+    }
+
+  private:
+    std::string name;
+    int pollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running = false;
+    std::thread reactorThread;
+    std::mutex mutex;
+    Token nextToken = InvalidToken + 1;
+    std::unordered_map<Token, std::shared_ptr<Source>> sources;
+    std::deque<Token> readyQueue;
+  };
+}
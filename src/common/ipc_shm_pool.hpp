@@ -0,0 +1,367 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "./utility.hpp"
+#include "./debug.hpp"
+#include "./zone.hpp"
+
+namespace ipc
+{
+  class TrShmBlockPool;
+
+  /**
+   * The reference to a block in the shared memory pool, it's a plain struct to be transferred with the command buffer request,
+   * and the receiver resolves it to the mapped memory at its side.
+   */
+  struct TrShmBlockRef
+  {
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    uint32_t offset = InvalidOffset;
+    uint32_t size = 0;
+
+    inline bool isValid() const
+    {
+      return offset != InvalidOffset;
+    }
+  };
+
+  /**
+   * A block acquired from the pool at the receiver side, the block pages are released back to the pool when the last reference
+   * to this object is dropped, namely after the payload has been consumed by the GL calls.
+   */
+  class TrShmBlock
+  {
+  public:
+    TrShmBlock(std::shared_ptr<TrShmBlockPool> pool, TrShmBlockRef ref);
+    TrShmBlock(const TrShmBlock &) = delete;
+    TrShmBlock &operator=(const TrShmBlock &) = delete;
+    ~TrShmBlock();
+
+  public:
+    void *data();
+    inline uint32_t size()
+    {
+      return ref.size;
+    }
+
+  private:
+    std::shared_ptr<TrShmBlockPool> pool;
+    TrShmBlockRef ref;
+  };
+
+  /**
+   * The header of the shared memory pool, it's followed by the page states and then the page-aligned data area.
+   */
+  struct TrShmBlockPoolHeader
+  {
+    uint32_t magic;
+    uint32_t pageSize;
+    uint32_t pageCount;
+    uint32_t dataOffset;
+  };
+
+  /**
+   * A pool of fixed-size pages in the shared memory, it's used to transfer the large payloads such as the buffer data and the
+   * texture pixels without copying them through the command buffer channel.
+   *
+   * The client (producer) allocates a contiguous run of pages and writes the payload into it directly, and the server (consumer)
+   * releases the pages once it doesn't need the payload anymore. Each page has a shared state word: 0 means free, otherwise it's
+   * in use. Only the client marks pages as used and only the server marks them as free, thus no lock is required.
+   */
+  class TrShmBlockPool : public std::enable_shared_from_this<TrShmBlockPool>
+  {
+  public:
+    static constexpr uint32_t POOL_MAGIC = 0x50534A54; // 'TJSP'
+    /**
+     * The pool holds 256MB in total, namely a few 4K RGBA textures (64MB for 4096x4096) and multi-MB meshes in flight. The file
+     * is sparse, thus only the pages which have been written take the memory.
+     */
+    static constexpr uint32_t DefaultPageSize = 256 * 1024; // 256KB
+    static constexpr uint32_t DefaultPageCount = 1024;
+    static constexpr uint32_t DefaultPayloadThreshold = 64 * 1024;
+
+  public:
+    /**
+     * Create or open a shared memory pool by the given filename.
+     *
+     * @param filename The file path to be mapped.
+     * @param type The server creates the file, and the client opens the existing one.
+     * @param pageSize The size of each page, it's ignored for the client.
+     * @param pageCount The number of pages, it's ignored for the client.
+     */
+    TrShmBlockPool(std::string filename,
+                   TrZoneType type,
+                   uint32_t pageSize = DefaultPageSize,
+                   uint32_t pageCount = DefaultPageCount)
+        : filename(filename)
+        , type(type)
+    {
+      if (type == TrZoneType::Server)
+        create(pageSize, pageCount);
+      else
+        open();
+    }
+    ~TrShmBlockPool()
+    {
+      if (memoryAddr != nullptr)
+      {
+        munmap(memoryAddr, memorySize);
+        memoryAddr = nullptr;
+        header = nullptr;
+      }
+      if (handleFd >= 0)
+      {
+        ::close(handleFd);
+        if (type == TrZoneType::Server)
+          unlink(filename.c_str());
+      }
+    }
+
+  public:
+    /**
+     * @returns If the pool is mapped and ready to use.
+     */
+    inline bool isValid()
+    {
+      return header != nullptr;
+    }
+    inline const std::string &getFilename()
+    {
+      return filename;
+    }
+    inline uint32_t pageSize()
+    {
+      return header == nullptr ? 0 : header->pageSize;
+    }
+    inline uint32_t pageCount()
+    {
+      return header == nullptr ? 0 : header->pageCount;
+    }
+    /**
+     * @returns The minimum payload size that should be transferred via this pool, the smaller ones are cheaper to be inlined.
+     */
+    inline uint32_t payloadThreshold()
+    {
+      return DefaultPayloadThreshold;
+    }
+    /**
+     * @returns The count of the free pages.
+     */
+    uint32_t freePages()
+    {
+      uint32_t count = 0;
+      for (uint32_t i = 0; i < pageCount(); i++)
+      {
+        if (pageStates[i].load(std::memory_order_acquire) == 0)
+          count += 1;
+      }
+      return count;
+    }
+
+    /**
+     * Allocate a block with at least `size` bytes, it returns an invalid reference if there is no enough contiguous pages, then
+     * the caller should fall back to the inline payload.
+     *
+     * NOTE: This method must only be called from the client side.
+     */
+    TrShmBlockRef allocate(size_t size)
+    {
+      TrShmBlockRef ref;
+      if (TR_UNLIKELY(header == nullptr || size == 0 || size > UINT32_MAX))
+        return ref;
+
+      const uint32_t count = header->pageCount;
+      const uint32_t pages = (size + header->pageSize - 1) / header->pageSize;
+      if (pages > count)
+        return ref;
+
+      // Next-fit: start from the last allocated position, it's likely that the older pages have been released.
+      for (uint32_t scanned = 0; scanned < count;)
+      {
+        uint32_t start = (nextPageHint + scanned) % count;
+        if (start + pages > count)
+        {
+          scanned += count - start;
+          continue;
+        }
+
+        uint32_t run = 0;
+        while (run < pages && pageStates[start + run].load(std::memory_order_acquire) == 0)
+          run += 1;
+        if (run == pages)
+        {
+          for (uint32_t i = 0; i < pages; i++)
+            pageStates[start + i].store(1, std::memory_order_relaxed);
+          nextPageHint = (start + pages) % count;
+          ref.offset = start * header->pageSize;
+          ref.size = static_cast<uint32_t>(size);
+          return ref;
+        }
+        scanned += run + 1;
+      }
+      return ref;
+    }
+    /**
+     * Release the pages of the given block.
+     *
+     * NOTE: This method must only be called from the server side.
+     */
+    void release(const TrShmBlockRef &ref)
+    {
+      if (TR_UNLIKELY(!contains(ref)))
+        return;
+      uint32_t start = ref.offset / header->pageSize;
+      uint32_t pages = (ref.size + header->pageSize - 1) / header->pageSize;
+      for (uint32_t i = 0; i < pages; i++)
+        pageStates[start + i].store(0, std::memory_order_release);
+    }
+    /**
+     * Acquire the block at the server side, the returned object releases the block when it's destroyed.
+     *
+     * @returns The block object, or nullptr if the reference is out of this pool.
+     */
+    std::shared_ptr<TrShmBlock> acquire(const TrShmBlockRef &ref)
+    {
+      if (TR_UNLIKELY(!contains(ref)))
+        return nullptr;
+      return std::make_shared<TrShmBlock>(shared_from_this(), ref);
+    }
+    /**
+     * @returns The mapped address of the given block, or nullptr if the reference is out of this pool.
+     */
+    void *data(const TrShmBlockRef &ref)
+    {
+      if (TR_UNLIKELY(!contains(ref)))
+        return nullptr;
+      return dataAddr + ref.offset;
+    }
+
+  private:
+    inline bool contains(const TrShmBlockRef &ref)
+    {
+      if (header == nullptr || !ref.isValid() || ref.size == 0)
+        return false;
+      uint64_t end = static_cast<uint64_t>(ref.offset) + ref.size;
+      return ref.offset % header->pageSize == 0 &&
+             end <= static_cast<uint64_t>(header->pageSize) * header->pageCount;
+    }
+    static inline size_t computeDataOffset(uint32_t pageCount)
+    {
+      size_t statesEnd = sizeof(TrShmBlockPoolHeader) + sizeof(std::atomic<uint32_t>) * pageCount;
+      return (statesEnd + 4095) & ~static_cast<size_t>(4095);
+    }
+    void create(uint32_t pageSize, uint32_t pageCount)
+    {
+      pageSize = (pageSize + 4095) & ~4095u;
+      if (pageSize == 0 || pageCount == 0)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to create the shared memory pool(%s): invalid page size or count.", filename.c_str());
+        return;
+      }
+      handleFd = ::open(filename.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666);
+      if (handleFd < 0)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to create the shared memory pool(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      size_t dataOffset = computeDataOffset(pageCount);
+      memorySize = dataOffset + static_cast<size_t>(pageSize) * pageCount;
+      if (ftruncate(handleFd, memorySize) == -1)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to resize the shared memory pool(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      if (!map(dataOffset))
+        return;
+
+      auto created = new (memoryAddr) TrShmBlockPoolHeader();
+      created->pageSize = pageSize;
+      created->pageCount = pageCount;
+      created->dataOffset = dataOffset;
+      for (uint32_t i = 0; i < pageCount; i++)
+        new (&pageStates[i]) std::atomic<uint32_t>(0);
+      created->magic = POOL_MAGIC;
+      header = created;
+    }
+    void open()
+    {
+      handleFd = ::open(filename.c_str(), O_RDWR);
+      if (handleFd < 0)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to open the shared memory pool(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      struct stat st;
+      if (fstat(handleFd, &st) == -1 || st.st_size <= (off_t)sizeof(TrShmBlockPoolHeader))
+      {
+        DEBUG(LOG_TAG_IPC, "The shared memory pool(%s) is not ready.", filename.c_str());
+        return;
+      }
+      memorySize = st.st_size;
+
+      TrShmBlockPoolHeader probe;
+      if (pread(handleFd, &probe, sizeof(probe), 0) != sizeof(probe) ||
+          probe.magic != POOL_MAGIC ||
+          probe.dataOffset != computeDataOffset(probe.pageCount) ||
+          probe.dataOffset + static_cast<size_t>(probe.pageSize) * probe.pageCount != memorySize)
+      {
+        DEBUG(LOG_TAG_IPC, "The shared memory pool(%s) has an invalid header.", filename.c_str());
+        return;
+      }
+      if (!map(probe.dataOffset))
+        return;
+      header = reinterpret_cast<TrShmBlockPoolHeader *>(memoryAddr);
+    }
+    bool map(size_t dataOffset)
+    {
+      void *addr = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, handleFd, 0);
+      if (addr == MAP_FAILED || addr == nullptr)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to map the shared memory pool(%s): %s", filename.c_str(), strerror(errno));
+        return false;
+      }
+      memoryAddr = reinterpret_cast<char *>(addr);
+      pageStates = reinterpret_cast<std::atomic<uint32_t> *>(memoryAddr + sizeof(TrShmBlockPoolHeader));
+      dataAddr = memoryAddr + dataOffset;
+      return true;
+    }
+
+  private:
+    std::string filename;
+    TrZoneType type;
+    int handleFd = -1;
+    char *memoryAddr = nullptr;
+    char *dataAddr = nullptr;
+    size_t memorySize = 0;
+    TrShmBlockPoolHeader *header = nullptr;
+    std::atomic<uint32_t> *pageStates = nullptr;
+    uint32_t nextPageHint = 0;
+  };
+
+  inline TrShmBlock::TrShmBlock(std::shared_ptr<TrShmBlockPool> pool, TrShmBlockRef ref)
+      : pool(pool)
+      , ref(ref)
+  {
+  }
+
+  inline TrShmBlock::~TrShmBlock()
+  {
+    if (pool != nullptr)
+      pool->release(ref);
+  }
+
+  inline void *TrShmBlock::data()
+  {
+    return pool->data(ref);
+  }
+}
@@ -0,0 +1,480 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+#include "./utility.hpp"
+#include "./debug.hpp"
+#include "./zone.hpp"
+
+namespace ipc
+{
+  /**
+   * The doorbell is used to wake up the other side of the shared memory ring when it's waiting for the data or the space.
+   *
+   * On Linux and Android, it's implemented via the process-shared futex on the shared memory word, thus the waking only costs a
+   * syscall when the peer is really sleeping. On other platforms, it falls back to a short sleeping loop.
+   */
+  class TrShmDoorbell
+  {
+  public:
+    /**
+     * Wait until the value of `word` is not `expected` or the timeout is reached.
+     *
+     * @param word The shared memory word to wait on.
+     * @param expected The value that is observed before waiting.
+     * @param timeout The timeout in milliseconds, a negative value means waiting forever.
+     */
+    static void Wait(std::atomic<uint32_t> *word, uint32_t expected, int timeout)
+    {
+#if defined(__linux__)
+      struct timespec ts;
+      struct timespec *pts = nullptr;
+      if (timeout >= 0)
+      {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000;
+        pts = &ts;
+      }
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, pts, nullptr, 0);
+#else
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+      while (word->load() == expected)
+      {
+        if (timeout >= 0 && std::chrono::steady_clock::now() >= deadline)
+          break;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+#endif
+    }
+    /**
+     * Wake up all the waiters on the given `word`.
+     */
+    static void Wake(std::atomic<uint32_t> *word)
+    {
+#if defined(__linux__)
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+    }
+  };
+
+  /**
+   * The header of the shared memory ring, it's placed at the beginning of the mapped memory and followed by the data area.
+   *
+   * The read and write positions are monotonic byte counters, the data index is computed by `pos & (capacity - 1)`, thus the
+   * capacity must be a power of 2.
+   */
+  struct TrShmRingHeader
+  {
+    uint32_t magic;
+    uint32_t capacity;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> writePos;
+    alignas(64) std::atomic<uint64_t> readPos;
+    alignas(64) std::atomic<uint32_t> dataSeq;
+    std::atomic<uint32_t> consumerWaiting;
+    alignas(64) std::atomic<uint32_t> spaceSeq;
+    std::atomic<uint32_t> producerWaiting;
+  };
+
+  /**
+   * A single-producer/single-consumer lock-free byte ring in the shared memory.
+   *
+   * The server side creates the ring file and owns it, the client side opens the existing file by the same name, then the
+   * producer writes the serialized messages as a byte stream and the consumer reads them back without any socket syscalls.
+   * The consumer could also `peek()` a contiguous region to decode the message in place.
+   */
+  class TrShmRingBuffer
+  {
+  public:
+    static constexpr uint32_t RING_MAGIC = 0x52534A54;            // 'TJSR'
+    static constexpr uint32_t DefaultCapacity = 4 * 1024 * 1024; // 4MB
+
+  public:
+    /**
+     * Create or open a shared memory ring by the given filename.
+     *
+     * @param filename The file path to be mapped.
+     * @param type The server creates the file, and the client opens the existing one.
+     * @param capacity The data capacity in bytes, it will be rounded up to the power of 2, and it's ignored for the client.
+     */
+    TrShmRingBuffer(std::string filename, TrZoneType type, uint32_t capacity = DefaultCapacity)
+        : filename(filename)
+        , type(type)
+    {
+      if (type == TrZoneType::Server)
+        create(capacity);
+      else
+        open();
+    }
+    ~TrShmRingBuffer()
+    {
+      if (header != nullptr)
+      {
+        close();
+        munmap(memoryAddr, memorySize);
+        memoryAddr = nullptr;
+        header = nullptr;
+      }
+      if (handleFd >= 0)
+      {
+        ::close(handleFd);
+        if (type == TrZoneType::Server)
+          unlink(filename.c_str());
+      }
+    }
+
+  public:
+    /**
+     * @returns If the ring is mapped and ready to use.
+     */
+    inline bool isValid()
+    {
+      return header != nullptr;
+    }
+    /**
+     * @returns If the ring has been closed by either side.
+     */
+    inline bool isClosed()
+    {
+      return header == nullptr || header->closed.load() != 0;
+    }
+    inline const std::string &getFilename()
+    {
+      return filename;
+    }
+    inline uint32_t capacity()
+    {
+      return header == nullptr ? 0 : header->capacity;
+    }
+    /**
+     * @returns The bytes which are ready to be read.
+     */
+    inline size_t readableBytes()
+    {
+      return header->writePos.load(std::memory_order_acquire) - header->readPos.load(std::memory_order_relaxed);
+    }
+    /**
+     * Mark this ring as closed and wake up the waiters at both sides.
+     */
+    void close()
+    {
+      if (header == nullptr)
+        return;
+      header->closed.store(1);
+      header->dataSeq.fetch_add(1);
+      header->spaceSeq.fetch_add(1);
+      TrShmDoorbell::Wake(&header->dataSeq);
+      TrShmDoorbell::Wake(&header->spaceSeq);
+    }
+
+    /**
+     * Write the bytes into the ring, it waits for the consumer when there is no enough space. The bytes larger than the capacity
+     * are written in pieces.
+     *
+     * NOTE: This method must only be called from the producer thread.
+     *
+     * @param data The data to write.
+     * @param size The size of the data.
+     * @param timeout The max milliseconds to wait for each piece of space, a negative value means waiting forever.
+     * @returns If all the bytes are written.
+     */
+    bool write(const void *data, size_t size, int timeout = -1)
+    {
+      if (TR_UNLIKELY(isClosed()))
+        return false;
+
+      const char *src = reinterpret_cast<const char *>(data);
+      const uint64_t cap = header->capacity;
+      size_t written = 0;
+      while (written < size)
+      {
+        uint64_t w = header->writePos.load(std::memory_order_relaxed);
+        uint64_t free = cap - (w - header->readPos.load(std::memory_order_acquire));
+        if (free == 0)
+        {
+          if (!waitFor(header->spaceSeq, header->producerWaiting, timeout, [this, cap]()
+                       { return cap - (header->writePos.load() - header->readPos.load()) > 0; }))
+            return false;
+          continue;
+        }
+
+        size_t n = std::min<size_t>(free, size - written);
+        size_t index = w & (cap - 1);
+        size_t first = std::min<size_t>(n, cap - index);
+        memcpy(dataAddr + index, src + written, first);
+        if (n > first)
+          memcpy(dataAddr, src + written + first, n - first);
+
+        header->writePos.store(w + n);
+        written += n;
+        ring(header->dataSeq, header->consumerWaiting);
+      }
+      return true;
+    }
+    /**
+     * Read exactly `size` bytes from the ring.
+     *
+     * The `timeout` is only applied when there is no data at all, once the first byte is consumed, it keeps waiting for the rest
+     * bytes of the message until the ring is closed.
+     *
+     * NOTE: This method must only be called from the consumer thread.
+     *
+     * @returns If the bytes are read.
+     */
+    bool read(void *out, size_t size, int timeout)
+    {
+      if (TR_UNLIKELY(header == nullptr))
+        return false;
+
+      char *dest = reinterpret_cast<char *>(out);
+      size_t readBytes = 0;
+      while (readBytes < size)
+      {
+        uint64_t available = readableBytes();
+        if (available == 0)
+        {
+          if (isClosed())
+            return false;
+          if (!waitForData(readBytes == 0 ? timeout : ContinuationTimeout) && readBytes == 0)
+            return false;
+          continue;
+        }
+        readBytes += tryRead(dest + readBytes, size - readBytes);
+      }
+      return true;
+    }
+    /**
+     * Read up to `size` bytes which are ready in the ring without waiting.
+     *
+     * NOTE: This method must only be called from the consumer thread.
+     *
+     * @returns The bytes read, it's 0 if there is no data.
+     */
+    size_t tryRead(void *out, size_t size)
+    {
+      if (TR_UNLIKELY(header == nullptr || size == 0))
+        return 0;
+
+      char *dest = reinterpret_cast<char *>(out);
+      const uint64_t cap = header->capacity;
+      uint64_t r = header->readPos.load(std::memory_order_relaxed);
+      uint64_t available = header->writePos.load(std::memory_order_acquire) - r;
+      size_t n = std::min<size_t>(available, size);
+      if (n == 0)
+        return 0;
+
+      size_t index = r & (cap - 1);
+      size_t first = std::min<size_t>(n, cap - index);
+      memcpy(dest, dataAddr + index, first);
+      if (n > first)
+        memcpy(dest + first, dataAddr, n - first);
+      advance(n);
+      return n;
+    }
+    /**
+     * Peek a contiguous region with `size` bytes from the read position, it's used to decode the message in place.
+     *
+     * @returns The pointer to the region, or `nullptr` if the bytes are not ready or the region wraps around the ring end.
+     */
+    const char *peek(size_t size)
+    {
+      if (TR_UNLIKELY(header == nullptr))
+        return nullptr;
+
+      uint64_t r = header->readPos.load(std::memory_order_relaxed);
+      if (header->writePos.load(std::memory_order_acquire) - r < size)
+        return nullptr;
+      size_t index = r & (header->capacity - 1);
+      if (index + size > header->capacity)
+        return nullptr;
+      return dataAddr + index;
+    }
+    /**
+     * Consume `size` bytes that has been read via `peek()`.
+     */
+    inline void consume(size_t size)
+    {
+      advance(size);
+    }
+    /**
+     * Wait until there is some data to read.
+     *
+     * @param timeout The max milliseconds to wait, a negative value means waiting forever.
+     * @returns If there is data to read.
+     */
+    bool waitForData(int timeout)
+    {
+      return waitFor(header->dataSeq, header->consumerWaiting, timeout, [this]()
+                     { return readableBytes() > 0 || isClosed(); }) &&
+             readableBytes() > 0;
+    }
+    /**
+     * Ask the producer to wake the consumer via its channel instead of the doorbell, it's used when the consumer is waiting
+     * for many rings at a reactor, which can't wait for the futexes.
+     *
+     * NOTE: This method must only be called from the consumer thread.
+     *
+     * @returns `false` if there is data arrived or the ring is closed, then the consumer should read it instead of waiting.
+     */
+    bool requestWakeByChannel()
+    {
+      if (TR_UNLIKELY(header == nullptr))
+        return false;
+      header->consumerWaiting.store(ConsumerWaitingOnChannel);
+      if (readableBytes() > 0 || isClosed())
+      {
+        header->consumerWaiting.store(0);
+        return false;
+      }
+      return true;
+    }
+    /**
+     * Take the consumer's request from `requestWakeByChannel()`, the producer should wake the consumer via its channel if it
+     * returns `true`.
+     *
+     * NOTE: This method must only be called from the producer thread after writing.
+     */
+    bool takeWakeByChannelRequest()
+    {
+      if (TR_UNLIKELY(header == nullptr))
+        return false;
+      uint32_t expected = ConsumerWaitingOnChannel;
+      return header->consumerWaiting.compare_exchange_strong(expected, 0);
+    }
+
+  private:
+    void create(uint32_t requestedCapacity)
+    {
+      uint32_t cap = 4096;
+      while (cap < requestedCapacity)
+        cap <<= 1;
+
+      handleFd = ::open(filename.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666);
+      if (handleFd < 0)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to create the shared memory ring(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      memorySize = sizeof(TrShmRingHeader) + cap;
+      if (ftruncate(handleFd, memorySize) == -1)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to resize the shared memory ring(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      if (!map())
+        return;
+
+      header = new (memoryAddr) TrShmRingHeader();
+      header->capacity = cap;
+      header->closed.store(0);
+      header->writePos.store(0);
+      header->readPos.store(0);
+      header->dataSeq.store(0);
+      header->consumerWaiting.store(0);
+      header->spaceSeq.store(0);
+      header->producerWaiting.store(0);
+      header->magic = RING_MAGIC;
+    }
+    void open()
+    {
+      handleFd = ::open(filename.c_str(), O_RDWR);
+      if (handleFd < 0)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to open the shared memory ring(%s): %s", filename.c_str(), strerror(errno));
+        return;
+      }
+      struct stat st;
+      if (fstat(handleFd, &st) == -1 || st.st_size <= (off_t)sizeof(TrShmRingHeader))
+      {
+        DEBUG(LOG_TAG_IPC, "The shared memory ring(%s) is not ready.", filename.c_str());
+        return;
+      }
+      memorySize = st.st_size;
+      if (!map())
+        return;
+
+      auto mapped = reinterpret_cast<TrShmRingHeader *>(memoryAddr);
+      if (mapped->magic != RING_MAGIC || mapped->capacity + sizeof(TrShmRingHeader) != memorySize)
+      {
+        DEBUG(LOG_TAG_IPC, "The shared memory ring(%s) has an invalid header.", filename.c_str());
+        munmap(memoryAddr, memorySize);
+        memoryAddr = nullptr;
+        return;
+      }
+      header = mapped;
+    }
+    bool map()
+    {
+      void *addr = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, handleFd, 0);
+      if (addr == MAP_FAILED || addr == nullptr)
+      {
+        DEBUG(LOG_TAG_IPC, "Failed to map the shared memory ring(%s): %s", filename.c_str(), strerror(errno));
+        return false;
+      }
+      memoryAddr = reinterpret_cast<char *>(addr);
+      dataAddr = memoryAddr + sizeof(TrShmRingHeader);
+      return true;
+    }
+    inline void advance(size_t n)
+    {
+      header->readPos.store(header->readPos.load(std::memory_order_relaxed) + n);
+      ring(header->spaceSeq, header->producerWaiting);
+    }
+    /**
+     * Ring the doorbell, the syscall is only made when the peer is waiting.
+     */
+    inline void ring(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiting)
+    {
+      seq.fetch_add(1);
+      if (waiting.load() == WaitingOnDoorbell)
+        TrShmDoorbell::Wake(&seq);
+    }
+    template <typename Predicate>
+    bool waitFor(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiting, int timeout, Predicate ready)
+    {
+      waiting.store(WaitingOnDoorbell);
+      uint32_t observed = seq.load();
+      // The zero timeout is to check without blocking, thus no syscall is needed.
+      if (!ready() && timeout != 0)
+        TrShmDoorbell::Wait(&seq, observed, timeout);
+      waiting.store(0);
+      return ready();
+    }
+
+  private:
+    /**
+     * The timeout to wait for the rest bytes of a partial read message.
+     */
+    static constexpr int ContinuationTimeout = 100;
+    /**
+     * The values of the waiting words: the waiting side sleeps on the futex, or the consumer is waiting for the wake via its
+     * channel.
+     */
+    static constexpr uint32_t WaitingOnDoorbell = 1;
+    static constexpr uint32_t ConsumerWaitingOnChannel = 2;
+
+    std::string filename;
+    TrZoneType type;
+    int handleFd = -1;
+    char *memoryAddr = nullptr;
+    char *dataAddr = nullptr;
+    size_t memorySize = 0;
+    TrShmRingHeader *header = nullptr;
+  };
+}
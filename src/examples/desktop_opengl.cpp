@@ -69,6 +69,14 @@ namespace jsar::example
       const char *enableAppTracking = getenv("JSAR_ENABLE_RENDERER_APP_TRACKING");
       if (enableAppTracking != nullptr && strcmp(enableAppTracking, "1") == 0)
         renderer->enableAppContextSummary();
+
+      const char *disableStatesElimination = getenv("JSAR_DISABLE_RENDERER_STATES_ELIMINATION");
+      if (disableStatesElimination != nullptr && strcmp(disableStatesElimination, "1") == 0)
+        renderer->disableRedundantStatesElimination();
+
+      const char *disableShadowValidation = getenv("JSAR_DISABLE_RENDERER_SHADOW_VALIDATION");
+      if (disableShadowValidation != nullptr && strcmp(disableShadowValidation, "1") == 0)
+        renderer->disableShadowValidation();
     }
 
   public:
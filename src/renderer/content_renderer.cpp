@@ -32,6 +32,8 @@ namespace renderer
   TrBackupGLContextScope::~TrBackupGLContextScope()
   {
     contentRenderer->usingBackupContext = false;
+    // The backup frame changes the driver states, thus the states of the main context need to be restored before trusted.
+    contentRenderer->glContext->MarkStatesUnsynced();
   }
 
   TrContentRenderer::TrContentRenderer(shared_ptr<TrContentRuntime> content, uint8_t contextId, TrConstellation *constellation)
@@ -234,6 +236,7 @@ namespace renderer
       {
         // FIXME: This make sure the XR frame will be rendered in the host context.
         constellation->renderer->glHostContext->ConfigureFramebuffer();
+        glContext->MarkFramebufferStatusDirty();
 
         // Execute the XR frame
         switch (xrDevice->getStereoRenderingMode())
@@ -265,12 +268,15 @@ namespace renderer
   void TrContentRenderer::onStartFrame()
   {
     glContext->Restore();
+    glContext->MarkFramebufferStatusDirty();
     if (constellation->renderer->isAppContextSummaryEnabled)
       glContext->Print();
 
     // Reset frame states
     drawCallsPerFrame = 0;
     drawCallsCountPerFrame = 0;
+    stateCallsIssuedPerFrame = 0;
+    stateCallsElidedPerFrame = 0;
   }
 
   void TrContentRenderer::onEndFrame()
@@ -116,6 +116,18 @@ namespace renderer
       drawCallsPerFrame += 1;
       drawCallsCountPerFrame += count;
     }
+    /**
+     * Increase the count of the state-setting calls.
+     *
+     * @param elided If the call is elided because it's redundant to the recorded states.
+     */
+    inline void increaseStateCallsCount(bool elided)
+    {
+      if (elided)
+        stateCallsElidedPerFrame += 1;
+      else
+        stateCallsIssuedPerFrame += 1;
+    }
 
   private: // private lifecycle
     /**
@@ -182,6 +194,14 @@ namespace renderer
      * The number to describe the vertices count to be drawn per frame.
      */
     size_t drawCallsCountPerFrame = 0;
+    /**
+     * The number of the state-setting calls which are issued to the driver per frame.
+     */
+    size_t stateCallsIssuedPerFrame = 0;
+    /**
+     * The number of the redundant state-setting calls which are elided per frame.
+     */
+    size_t stateCallsElidedPerFrame = 0;
 
   private: // frame rate control
     uint32_t targetFrameRate;
@@ -10,64 +10,110 @@ void OpenGLContextStorage::RecordViewport(int x, int y, int w, int h)
   m_Viewport[3] = h;
 }
 
-void OpenGLContextStorage::RecordCapability(GLenum cap, bool enabled)
+bool OpenGLContextStorage::RecordCapability(GLenum cap, bool enabled)
 {
+  GLboolean *capabilityPtr = nullptr;
   switch (cap)
   {
   case GL_BLEND:
-    m_BlendEnabled = enabled;
+    capabilityPtr = &m_BlendEnabled;
     break;
   case GL_DITHER:
-    m_DitherEnabled = enabled;
+    capabilityPtr = &m_DitherEnabled;
     break;
   case GL_CULL_FACE:
-    m_CullFaceEnabled = enabled;
+    capabilityPtr = &m_CullFaceEnabled;
     break;
   case GL_DEPTH_TEST:
-    m_DepthTestEnabled = enabled;
+    capabilityPtr = &m_DepthTestEnabled;
     break;
   case GL_STENCIL_TEST:
-    m_StencilTestEnabled = enabled;
+    capabilityPtr = &m_StencilTestEnabled;
     break;
   case GL_SCISSOR_TEST:
-    m_ScissorTestEnabled = enabled;
+    capabilityPtr = &m_ScissorTestEnabled;
     break;
   default:
-    break;
+    // The capabilities which are not recorded are always treated as changed.
+    return true;
   }
+
+  GLboolean value = enabled ? GL_TRUE : GL_FALSE;
+  if (*capabilityPtr == value)
+    return false;
+  *capabilityPtr = value;
+  return true;
 }
 
-void OpenGLContextStorage::RecordCullFace(GLenum mode)
+bool OpenGLContextStorage::RecordCullFace(GLenum mode)
 {
+  if (m_CullFace == mode)
+    return false;
   m_CullFace = mode;
+  return true;
 }
 
-void OpenGLContextStorage::RecordFrontFace(GLenum mode)
+bool OpenGLContextStorage::RecordFrontFace(GLenum mode)
 {
+  if (m_FrontFace == mode)
+    return false;
   m_FrontFace = mode;
+  return true;
 }
 
-void OpenGLContextStorage::RecordColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+bool OpenGLContextStorage::RecordColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
 {
+  if (m_ColorMask[0] == r && m_ColorMask[1] == g && m_ColorMask[2] == b && m_ColorMask[3] == a)
+    return false;
   m_ColorMask[0] = r;
   m_ColorMask[1] = g;
   m_ColorMask[2] = b;
   m_ColorMask[3] = a;
+  return true;
 }
 
-void OpenGLContextStorage::RecordDepthMask(GLboolean enabled)
+bool OpenGLContextStorage::RecordDepthMask(GLboolean enabled)
 {
+  if (m_DepthMask == enabled)
+    return false;
   m_DepthMask = enabled;
+  return true;
+}
+
+bool OpenGLContextStorage::RecordDepthFunc(GLenum func)
+{
+  if (m_DepthFunc == func)
+    return false;
+  m_DepthFunc = func;
+  return true;
+}
+
+void OpenGLContextStorage::RecordDepthRange(GLfloat n, GLfloat f)
+{
+  m_DepthRange[0] = n;
+  m_DepthRange[1] = f;
+}
+
+void OpenGLContextStorage::RecordBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+  m_BlendColor[0] = r;
+  m_BlendColor[1] = g;
+  m_BlendColor[2] = b;
+  m_BlendColor[3] = a;
 }
 
-void OpenGLContextStorage::RecordBlendFunc(GLenum sfactor, GLenum dfactor)
+bool OpenGLContextStorage::RecordBlendFunc(GLenum sfactor, GLenum dfactor)
 {
+  bool changed = !m_BlendFunc.Equals(sfactor, dfactor, sfactor, dfactor);
   m_BlendFunc.Reset(sfactor, dfactor);
+  return changed;
 }
 
-void OpenGLContextStorage::RecordBlendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha)
+bool OpenGLContextStorage::RecordBlendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha)
 {
+  bool changed = !m_BlendFunc.Equals(srcRgb, dstRgb, srcAlpha, dstAlpha);
   m_BlendFunc.Reset(srcRgb, dstRgb, srcAlpha, dstAlpha);
+  return changed;
 }
 
 void OpenGLContextStorage::RecordStencilMask(GLenum face, GLuint mask)
@@ -110,19 +156,28 @@ void OpenGLContextStorage::RecordStencilOp(GLenum face, GLenum sfail, GLenum dpf
   }
 }
 
-void OpenGLContextStorage::RecordProgram(int program)
+bool OpenGLContextStorage::RecordProgram(int program)
 {
+  if (m_ProgramId == program)
+    return false;
   m_ProgramId = program;
+  return true;
 }
 
-void OpenGLContextStorage::RecordArrayBuffer(int buffer)
+bool OpenGLContextStorage::RecordArrayBuffer(int buffer)
 {
+  if (m_ArrayBufferId == buffer)
+    return false;
   m_ArrayBufferId = buffer;
+  return true;
 }
 
-void OpenGLContextStorage::RecordElementArrayBuffer(int buffer)
+bool OpenGLContextStorage::RecordElementArrayBuffer(int buffer)
 {
+  if (m_ElementArrayBufferId == buffer)
+    return false;
   m_ElementArrayBufferId = buffer;
+  return true;
 }
 
 void OpenGLContextStorage::RecordFramebuffer(int buffer)
@@ -135,32 +190,89 @@ void OpenGLContextStorage::RecordRenderbuffer(int buffer)
   m_RenderbufferId = buffer;
 }
 
-void OpenGLContextStorage::RecordVertexArrayObject(int vao)
+bool OpenGLContextStorage::RecordVertexArrayObject(int vao)
 {
+  if (m_VertexArrayObjectId == vao)
+    return false;
   m_VertexArrayObjectId = vao;
+  /**
+   * The element array buffer binding is a part of the vao states, thus it's unknown after switching the vao.
+   */
+  m_ElementArrayBufferId = -1;
+  return true;
 }
 
-void OpenGLContextStorage::RecordActiveTextureUnit(int unit)
+bool OpenGLContextStorage::RecordActiveTextureUnit(int unit)
 {
+  if (m_LastActiveTextureUnit == unit)
+    return false;
   m_LastActiveTextureUnit = unit;
+  return true;
 }
 
-void OpenGLContextStorage::RecordTextureBindingWithUnit(GLenum target, GLuint texture)
+bool OpenGLContextStorage::RecordTextureBindingWithUnit(GLenum target, GLuint texture)
 {
   GLint activeUnit;
-  glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
+  if (!GetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit))
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
 
   auto &binding = m_TextureBindingsWithUnit[activeUnit];
   if (binding == nullptr)
+  {
     m_TextureBindingsWithUnit[activeUnit] = make_shared<OpenGLTextureBinding>(target, texture);
-  else
-    binding->Reset(target, texture);
+    return true;
+  }
+  if (binding->GetTarget() == target && binding->GetTexture() == texture)
+    return false;
+  binding->Reset(target, texture);
+  return true;
+}
+
+bool OpenGLContextStorage::GetIntegerv(GLenum pname, GLint *value)
+{
+  /**
+   * The recorded values might be different from the driver's when the states are not synced, e.g. a failed call.
+   */
+  if (!m_StatesSynced)
+    return false;
+
+  GLint recorded;
+  switch (pname)
+  {
+  case GL_CURRENT_PROGRAM:
+    recorded = m_ProgramId;
+    break;
+  case GL_ARRAY_BUFFER_BINDING:
+    recorded = m_ArrayBufferId;
+    break;
+  case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+    recorded = m_ElementArrayBufferId;
+    break;
+  case GL_VERTEX_ARRAY_BINDING:
+    recorded = m_VertexArrayObjectId;
+    break;
+  case GL_ACTIVE_TEXTURE:
+    recorded = m_LastActiveTextureUnit;
+    break;
+  default:
+    return false;
+  }
+
+  // The negative value means it's unknown.
+  if (recorded < 0)
+    return false;
+  *value = recorded;
+  return true;
 }
 
 void OpenGLContextStorage::ResetProgram(int programToReset)
 {
+  /**
+   * The deleted program is still in use by the driver until another program is used, thus mark it as unknown to make sure
+   * the next `glUseProgram()` is issued.
+   */
   if (m_ProgramId == programToReset)
-    m_ProgramId = 0;
+    m_ProgramId = -1;
 }
 
 void OpenGLContextStorage::Restore()
@@ -211,6 +323,9 @@ void OpenGLContextStorage::Restore()
   glDepthFunc(m_DepthFunc); // TODO: valid depth func enum?
   glDepthRangef(m_DepthRange[0], m_DepthRange[1]);
 
+  // Blend color restore
+  glBlendColor(m_BlendColor[0], m_BlendColor[1], m_BlendColor[2], m_BlendColor[3]);
+
   // Stencil state restore
   {
     glStencilMask(m_StencilMask);
@@ -303,6 +418,13 @@ void OpenGLContextStorage::Restore()
   GLenum error = glGetError();
   if (error != GL_NO_ERROR)
     DEBUG(LOG_TAG_ERROR, "Occurs an OpenGL error in restoring %s context: 0x%04X", error, GetName());
+
+  // The recorded states are trusted only if all of them are restored successfully.
+  m_StatesSynced = error == GL_NO_ERROR &&
+                   setViewportError == GL_NO_ERROR &&
+                   useProgramError == GL_NO_ERROR &&
+                   bindBuffersError == GL_NO_ERROR &&
+                   bindTextureError == GL_NO_ERROR;
 }
 
 void OpenGLContextStorage::Print()
@@ -394,6 +516,7 @@ void OpenGLHostContextStorage::Record()
 
   // Blend funcs
   {
+    glGetFloatv(GL_BLEND_COLOR, m_BlendColor);
     GLenum sfactor, dfactor;
     glGetIntegerv(GL_BLEND_SRC_RGB, (GLint *)&sfactor);
     glGetIntegerv(GL_BLEND_DST_RGB, (GLint *)&dfactor);
@@ -507,6 +630,10 @@ OpenGLAppContextStorage::OpenGLAppContextStorage(string name, OpenGLAppContextSt
   m_VertexArrayObjects = OpenGLNamesStorage(&from->m_VertexArrayObjects);
   m_Textures = OpenGLNamesStorage(&from->m_Textures);
   m_Samplers = OpenGLNamesStorage(&from->m_Samplers);
+
+  // The program and vao objects are shared, thus their shadow states are shared as well.
+  m_ProgramInfos = from->m_ProgramInfos;
+  m_VertexArrayStates = from->m_VertexArrayStates;
 }
 
 void OpenGLAppContextStorage::RecordViewport(int x, int y, int w, int h)
@@ -519,6 +646,40 @@ void OpenGLAppContextStorage::RecordViewport(int x, int y, int w, int h)
   m_Viewport[3] = h;
 }
 
+bool OpenGLAppContextStorage::RecordElementArrayBuffer(int buffer)
+{
+  auto vertexArrayStates = GetVertexArrayStates();
+  if (vertexArrayStates != nullptr)
+    vertexArrayStates->elementArrayBuffer = buffer;
+  return OpenGLContextStorage::RecordElementArrayBuffer(buffer);
+}
+
+bool OpenGLAppContextStorage::RecordVertexArrayObject(int vao)
+{
+  if (!OpenGLContextStorage::RecordVertexArrayObject(vao))
+    return false;
+
+  // Recover the element array buffer binding from the vao states if it's known.
+  auto vertexArrayStates = GetVertexArrayStates();
+  if (vertexArrayStates != nullptr)
+    m_ElementArrayBufferId = vertexArrayStates->elementArrayBuffer;
+  return true;
+}
+
+void OpenGLAppContextStorage::RecordVertexAttribArrayEnabled(GLuint index, bool enabled)
+{
+  auto vertexArrayStates = GetVertexArrayStates();
+  if (vertexArrayStates != nullptr)
+    vertexArrayStates->attribs[index].enabled = enabled;
+}
+
+void OpenGLAppContextStorage::RecordVertexAttribPointer(GLuint index)
+{
+  auto vertexArrayStates = GetVertexArrayStates();
+  if (vertexArrayStates != nullptr)
+    vertexArrayStates->attribs[index].buffer = m_ArrayBufferId;
+}
+
 void OpenGLAppContextStorage::RecordProgramOnCreated(GLuint program)
 {
   if (program == 0)
@@ -535,9 +696,17 @@ void OpenGLAppContextStorage::RecordProgramOnDeleted(GLuint program)
   if (m_Programs.find(program) == m_Programs.end())
     return; // Not recorded
   m_Programs.erase(program);
+  m_ProgramInfos.erase(program);
   // FIXME: Reset the current program if it is deleted?
 }
 
+void OpenGLAppContextStorage::RecordProgramOnLinked(GLuint program, shared_ptr<OpenGLProgramInfo> info)
+{
+  if (program == 0)
+    return;
+  m_ProgramInfos[program] = info;
+}
+
 void OpenGLAppContextStorage::RecordShaderOnCreated(GLuint shader)
 {
   if (shader == 0)
@@ -572,6 +741,12 @@ void OpenGLAppContextStorage::RecordBufferOnDeleted(GLuint buffer)
   if (m_Buffers.find(buffer) == m_Buffers.end())
     return; // Not recorded
   m_Buffers.erase(buffer);
+
+  // The deleted buffer is unbound from the current bindings.
+  if (m_ArrayBufferId == static_cast<GLint>(buffer))
+    m_ArrayBufferId = 0;
+  if (m_ElementArrayBufferId == static_cast<GLint>(buffer))
+    m_ElementArrayBufferId = 0;
 }
 
 void OpenGLAppContextStorage::RecordFramebufferOnCreated(GLuint buffer)
@@ -590,6 +765,7 @@ void OpenGLAppContextStorage::RecordFramebufferOnDeleted(GLuint buffer)
   if (m_Framebuffers.find(buffer) == m_Framebuffers.end())
     return; // Not recorded
   m_Framebuffers.erase(buffer);
+  MarkFramebufferStatusDirty();
 }
 
 void OpenGLAppContextStorage::RecordRenderbufferOnCreated(GLuint buffer)
@@ -608,6 +784,7 @@ void OpenGLAppContextStorage::RecordRenderbufferOnDeleted(GLuint buffer)
   if (m_Renderbuffers.find(buffer) == m_Renderbuffers.end())
     return; // Not recorded
   m_Renderbuffers.erase(buffer);
+  MarkFramebufferStatusDirty();
 }
 
 void OpenGLAppContextStorage::RecordVertexArrayObjectOnCreated(GLuint vao)
@@ -617,6 +794,7 @@ void OpenGLAppContextStorage::RecordVertexArrayObjectOnCreated(GLuint vao)
   if (m_VertexArrayObjects.find(vao) != m_VertexArrayObjects.end())
     return; // Already recorded
   m_VertexArrayObjects.insert(pair<GLuint, bool>(vao, true));
+  m_VertexArrayStates[vao] = make_shared<OpenGLVertexArrayStates>();
 }
 
 void OpenGLAppContextStorage::RecordVertexArrayObjectOnDeleted(GLuint vao)
@@ -626,6 +804,11 @@ void OpenGLAppContextStorage::RecordVertexArrayObjectOnDeleted(GLuint vao)
   if (m_VertexArrayObjects.find(vao) == m_VertexArrayObjects.end())
     return; // Not recorded
   m_VertexArrayObjects.erase(vao);
+  m_VertexArrayStates.erase(vao);
+
+  // Deleting the current vao reverts the binding to the default one.
+  if (m_VertexArrayObjectId == static_cast<GLint>(vao))
+    RecordVertexArrayObject(0);
 }
 
 void OpenGLAppContextStorage::RecordTextureOnCreated(GLuint texture)
@@ -644,6 +827,15 @@ void OpenGLAppContextStorage::RecordTextureOnDeleted(GLuint texture)
   if (m_Textures.find(texture) == m_Textures.end())
     return; // Not recorded
   m_Textures.erase(texture);
+  MarkFramebufferStatusDirty();
+
+  // The deleted texture is unbound from the texture units.
+  for (auto it = m_TextureBindingsWithUnit.begin(); it != m_TextureBindingsWithUnit.end(); it++)
+  {
+    auto &binding = it->second;
+    if (binding->GetTexture() == static_cast<GLint>(texture))
+      binding->Reset(binding->GetTarget(), 0);
+  }
 }
 
 void OpenGLAppContextStorage::RecordSamplerOnCreated(GLuint sampler)
@@ -738,3 +930,110 @@ bool OpenGLAppContextStorage::IsChanged(OpenGLAppContextStorage *other)
   // No changes
   return false;
 }
+
+OpenGLProgramInfo *OpenGLAppContextStorage::GetProgramInfo(GLuint program)
+{
+  auto it = m_ProgramInfos.find(program);
+  return it == m_ProgramInfos.end() ? nullptr : it->second.get();
+}
+
+OpenGLVertexArrayStates *OpenGLAppContextStorage::GetVertexArrayStates()
+{
+  auto it = m_VertexArrayStates.find(m_VertexArrayObjectId);
+  return it == m_VertexArrayStates.end() ? nullptr : it->second.get();
+}
+
+GLenum OpenGLAppContextStorage::CheckFramebufferStatus()
+{
+  if (m_FramebufferStatus == 0)
+    m_FramebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  return m_FramebufferStatus;
+}
+
+void OpenGLAppContextStorage::MarkFramebufferStatusDirty()
+{
+  m_FramebufferStatus = 0;
+}
+
+void OpenGLAppContextStorage::PrintDrawCallStates(const char *logTag)
+{
+  DEBUG(logTag, "    States: %s", m_StatesSynced ? "Synced" : "Unsynced (recorded values might be stale)");
+  DEBUG(logTag, "    Program: %d", m_ProgramId);
+  DEBUG(logTag,
+        "    Framebuffer: %d (%s)",
+        m_FramebufferId,
+        m_FramebufferStatus == 0
+          ? "Unchecked"
+          : (m_FramebufferStatus == GL_FRAMEBUFFER_COMPLETE ? "Complete" : "Incomplete"));
+
+  auto programInfo = GetProgramInfo(m_ProgramId);
+  if (programInfo == nullptr)
+    DEBUG(logTag, "    Program: not linked by %s", GetName());
+  else
+    DEBUG(logTag, "    Program: LINK_STATUS=%d", programInfo->linked);
+
+  DEBUG(logTag, "    Element Array Buffer: %d", m_ElementArrayBufferId);
+
+  // Print Active Attributes
+  if (programInfo != nullptr)
+  {
+    auto vertexArrayStates = GetVertexArrayStates();
+    for (auto &attrib : programInfo->attribs)
+    {
+      if (attrib.location == -1 || vertexArrayStates == nullptr)
+      {
+        DEBUG(logTag,
+              "    Active Attribute(%d): Size=%d Type=%s \"%s\"",
+              attrib.location,
+              attrib.size,
+              gles::glEnumToString(attrib.type).c_str(),
+              attrib.name.c_str());
+        continue;
+      }
+
+      OpenGLVertexArrayStates::Attrib attribStates;
+      auto it = vertexArrayStates->attribs.find(attrib.location);
+      if (it != vertexArrayStates->attribs.end())
+        attribStates = it->second;
+      DEBUG(logTag,
+            "    Active Attribute(%d): Enabled=%s Size=%d Type=%s BufferBinding=%d \"%s\"",
+            attrib.location,
+            attribStates.enabled ? "Yes" : "No",
+            attrib.size,
+            gles::glEnumToString(attrib.type).c_str(),
+            attribStates.buffer,
+            attrib.name.c_str());
+    }
+  }
+
+  // Print Blend States
+  if (m_BlendEnabled)
+  {
+    DEBUG(logTag, "    Blend State:");
+    DEBUG(logTag, "      Enabled=Yes");
+    DEBUG(logTag, "      Color=(%f, %f, %f, %f)", m_BlendColor[0], m_BlendColor[1], m_BlendColor[2], m_BlendColor[3]);
+    GLenum srcAlpha = m_BlendFunc.IsSeparate() ? m_BlendFunc.GetSrcAlpha() : m_BlendFunc.GetSrc();
+    GLenum dstAlpha = m_BlendFunc.IsSeparate() ? m_BlendFunc.GetDstAlpha() : m_BlendFunc.GetDst();
+    DEBUG(logTag, "      DstAlpha=%s", gles::glBlendFuncToString(dstAlpha).c_str());
+    DEBUG(logTag, "      DstRGB=%s", gles::glBlendFuncToString(m_BlendFunc.GetDstRgb()).c_str());
+    DEBUG(logTag, "      SrcAlpha=%s", gles::glBlendFuncToString(srcAlpha).c_str());
+    DEBUG(logTag, "      SrcRGB=%s", gles::glBlendFuncToString(m_BlendFunc.GetSrcRgb()).c_str());
+  }
+
+  // Print Color State
+  DEBUG(logTag, "    Color Mask: (%d, %d, %d, %d)", m_ColorMask[0], m_ColorMask[1], m_ColorMask[2], m_ColorMask[3]);
+
+  // Print Cull State
+  if (m_CullFaceEnabled)
+    DEBUG(logTag, "    Cull: Enabled=Yes Face=%s", gles::glEnumToString(m_CullFace).c_str());
+
+  // Print Depth State
+  if (m_DepthTestEnabled)
+  {
+    DEBUG(logTag, "    Depth State:");
+    DEBUG(logTag, "      Enabled=Yes");
+    DEBUG(logTag, "      Func=%s", gles::glDepthFuncToString(m_DepthFunc).c_str());
+    DEBUG(logTag, "      WriteMask=%s", m_DepthMask ? "Yes" : "No");
+    DEBUG(logTag, "      Range=(%f, %f)", m_DepthRange[0], m_DepthRange[1]);
+  }
+}
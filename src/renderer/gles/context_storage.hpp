@@ -3,6 +3,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "common/viewport.hpp"
 #include "./common.hpp"
@@ -50,7 +51,8 @@ public:
   {
   }
   OpenGLBlendingFunc(OpenGLBlendingFunc *from)
-      : m_Src(from->m_Src)
+      : m_IsSeparate(from->m_IsSeparate)
+      , m_Src(from->m_Src)
       , m_Dst(from->m_Dst)
       , m_SrcAlpha(from->m_SrcAlpha)
       , m_DstAlpha(from->m_DstAlpha)
@@ -86,6 +88,16 @@ public:
   {
     return m_DstAlpha;
   }
+  /**
+   * Check if the effective factors are equal to the given ones, the non-separate function uses the RGB factors for alpha.
+   */
+  inline bool Equals(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha)
+  {
+    return m_Src == srcRgb &&
+           m_Dst == dstRgb &&
+           (m_IsSeparate ? m_SrcAlpha : m_Src) == srcAlpha &&
+           (m_IsSeparate ? m_DstAlpha : m_Dst) == dstAlpha;
+  }
   inline void Reset(GLenum src, GLenum dst)
   {
     m_Src = src;
@@ -141,6 +153,48 @@ private:
   GLenum m_DstAlpha;
 };
 
+/**
+ * The shadow states of a vertex array object.
+ */
+class OpenGLVertexArrayStates
+{
+public:
+  struct Attrib
+  {
+    bool enabled = false;
+    GLint buffer = 0; // The array buffer when `glVertexAttribPointer()` is called.
+  };
+
+public:
+  GLint elementArrayBuffer = 0;
+  std::map<GLuint, Attrib> attribs;
+};
+
+/**
+ * The shadow of a linked program, which is recorded when the program is linked.
+ */
+class OpenGLProgramInfo
+{
+public:
+  struct ActiveAttrib
+  {
+    std::string name;
+    GLint size;
+    GLenum type;
+    GLint location;
+  };
+
+public:
+  OpenGLProgramInfo(bool linked)
+      : linked(linked)
+  {
+  }
+
+public:
+  bool linked;
+  std::vector<ActiveAttrib> attribs;
+};
+
 class OpenGLContextStorage
 {
   struct Rect
@@ -201,6 +255,7 @@ public:
     m_Viewport[1] = from->m_Viewport[1];
     m_Viewport[2] = from->m_Viewport[2];
     m_Viewport[3] = from->m_Viewport[3];
+    m_StatesSynced = from->m_StatesSynced;
 
     // States
     m_CullFaceEnabled = from->m_CullFaceEnabled;
@@ -215,6 +270,10 @@ public:
     m_DepthFunc = from->m_DepthFunc;
     m_DepthRange[0] = from->m_DepthRange[0];
     m_DepthRange[1] = from->m_DepthRange[1];
+    m_BlendColor[0] = from->m_BlendColor[0];
+    m_BlendColor[1] = from->m_BlendColor[1];
+    m_BlendColor[2] = from->m_BlendColor[2];
+    m_BlendColor[3] = from->m_BlendColor[3];
     m_DitherEnabled = from->m_DitherEnabled;
     m_BlendEnabled = from->m_BlendEnabled;
     m_BlendFunc = OpenGLBlendingFunc(&from->m_BlendFunc);
@@ -245,25 +304,32 @@ public:
   {
   }
 
+  /**
+   * The following methods record the states, the ones return `bool` indicate if the recorded state is changed, thus the
+   * caller could skip the redundant call when the recorded states are synced, see `IsStatesSynced()`.
+   */
   void RecordViewport(int x, int y, int w, int h);
-  void RecordCapability(GLenum cap, bool enabled);
-  void RecordCullFace(GLenum mode);
-  void RecordFrontFace(GLenum mode);
-  void RecordColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
-  void RecordDepthMask(GLboolean enabled);
-  void RecordBlendFunc(GLenum sfactor, GLenum dfactor);
-  void RecordBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+  bool RecordCapability(GLenum cap, bool enabled);
+  bool RecordCullFace(GLenum mode);
+  bool RecordFrontFace(GLenum mode);
+  bool RecordColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+  bool RecordDepthMask(GLboolean enabled);
+  bool RecordDepthFunc(GLenum func);
+  void RecordDepthRange(GLfloat n, GLfloat f);
+  void RecordBlendColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+  bool RecordBlendFunc(GLenum sfactor, GLenum dfactor);
+  bool RecordBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
   void RecordStencilMask(GLenum face, GLuint mask);
   void RecordStencilFunc(GLenum face, GLenum func, GLint ref, GLuint mask);
   void RecordStencilOp(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
-  void RecordProgram(int program);
-  void RecordArrayBuffer(int buffer);
-  void RecordElementArrayBuffer(int buffer);
+  bool RecordProgram(int program);
+  bool RecordArrayBuffer(int buffer);
+  bool RecordElementArrayBuffer(int buffer);
   void RecordFramebuffer(int buffer);
   void RecordRenderbuffer(int buffer);
-  void RecordVertexArrayObject(int vao);
-  void RecordActiveTextureUnit(int unit);
-  void RecordTextureBindingWithUnit(GLenum target, GLuint texture);
+  bool RecordVertexArrayObject(int vao);
+  bool RecordActiveTextureUnit(int unit);
+  bool RecordTextureBindingWithUnit(GLenum target, GLuint texture);
 
   const char *GetName()
   {
@@ -301,6 +367,29 @@ public:
   {
     return m_LastActiveTextureUnit;
   }
+  /**
+   * @returns If the recorded states are the current states of the driver, it becomes true after `Restore()`.
+   */
+  bool IsStatesSynced()
+  {
+    return m_StatesSynced;
+  }
+  /**
+   * Mark the recorded states are not synced with the driver, it should be called when the driver states are changed out of
+   * this storage or a call to change the states is failed.
+   */
+  void MarkStatesUnsynced()
+  {
+    m_StatesSynced = false;
+  }
+  /**
+   * Answer the `glGetIntegerv()` query from the recorded states.
+   *
+   * @param pname The parameter name, only the bindings and the active texture unit are supported.
+   * @param value The value to be written.
+   * @returns false if the parameter is not supported or the recorded value is unknown.
+   */
+  bool GetIntegerv(GLenum pname, GLint *value);
 
   void ResetProgram(int programToReset);
   void Restore();
@@ -311,6 +400,7 @@ protected:
   std::string m_Name;
   GLint m_Viewport[4] = {-1, -1, -1, -1};
   bool m_ForceChanged = false;
+  bool m_StatesSynced = false;
 
 protected: /** Global States */
   // Culling & face
@@ -329,6 +419,7 @@ protected: /** Global States */
   // Blending
   GLboolean m_BlendEnabled;
   OpenGLBlendingFunc m_BlendFunc;
+  GLfloat m_BlendColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
   // Stencil
   GLboolean m_StencilTestEnabled;
   GLuint m_StencilMask;
@@ -406,8 +497,13 @@ public:
 
 public:
   void RecordViewport(int x, int y, int w, int h);
+  bool RecordElementArrayBuffer(int buffer);
+  bool RecordVertexArrayObject(int vao);
+  void RecordVertexAttribArrayEnabled(GLuint index, bool enabled);
+  void RecordVertexAttribPointer(GLuint index);
   void RecordProgramOnCreated(GLuint program);
   void RecordProgramOnDeleted(GLuint program);
+  void RecordProgramOnLinked(GLuint program, std::shared_ptr<OpenGLProgramInfo> info);
   void RecordShaderOnCreated(GLuint shader);
   void RecordShaderOnDeleted(GLuint shader);
   void RecordBufferOnCreated(GLuint buffer);
@@ -428,6 +524,26 @@ public:
   bool IsDirty();
   bool IsChanged(OpenGLAppContextStorage *other);
 
+public: /** Shadow validation */
+  /**
+   * @returns The recorded info of the program, or nullptr if the program is not linked by this context.
+   */
+  OpenGLProgramInfo *GetProgramInfo(GLuint program);
+  /**
+   * @returns The shadow states of the current vertex array object, or nullptr if it's not created by this context.
+   */
+  OpenGLVertexArrayStates *GetVertexArrayStates();
+  /**
+   * Check the framebuffer status, the result is cached until the framebuffer binding or the attachments are changed, see
+   * `MarkFramebufferStatusDirty()`.
+   */
+  GLenum CheckFramebufferStatus();
+  void MarkFramebufferStatusDirty();
+  /**
+   * Print the states for a draw call from the shadow states, it doesn't make any round-trip to the driver.
+   */
+  void PrintDrawCallStates(const char *logTag);
+
 public:
   gles::GLObjectManager &ObjectManagerRef()
   {
@@ -436,7 +552,10 @@ public:
 
 private:
   bool m_Dirty = false;
+  GLenum m_FramebufferStatus = 0; // 0 means the status needs to be checked
   std::shared_ptr<gles::GLObjectManager> m_GLObjectManager;
+  std::map<GLuint, std::shared_ptr<OpenGLProgramInfo>> m_ProgramInfos;
+  std::map<GLint, std::shared_ptr<OpenGLVertexArrayStates>> m_VertexArrayStates;
   OpenGLNamesStorage m_Programs;
   OpenGLNamesStorage m_Shaders;
   OpenGLNamesStorage m_Buffers;
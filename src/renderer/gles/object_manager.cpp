@@ -65,6 +65,7 @@ namespace gles
     if (program > 0)
       glDeleteProgram(program);
     programs.erase(clientId);
+    programRecords.erase(program);
   }
 
   size_t GLObjectManager::ClearPrograms()
@@ -80,6 +81,7 @@ namespace gles
       }
     }
     programs.clear();
+    programRecords.clear();
     return removed;
   }
 
@@ -100,8 +102,13 @@ namespace gles
   void GLObjectManager::DeleteShader(uint32_t clientId)
   {
     GLuint shader = shaders[clientId];
+    // The deleted shader is still used by the attached programs, thus compile it now if the compiling is deferred.
+    auto record = FindShaderRecord(shader);
+    if (record != nullptr && record->compilePending)
+      glCompileShader(shader);
     glDeleteShader(shader);
     shaders.erase(clientId);
+    shaderRecords.erase(shader);
   }
 
   size_t GLObjectManager::ClearShaders()
@@ -114,6 +121,7 @@ namespace gles
       removed++;
     }
     shaders.clear();
+    shaderRecords.clear();
     return removed;
   }
 
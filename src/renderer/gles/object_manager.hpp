@@ -1,12 +1,39 @@
 #pragma once
 
+#include <map>
 #include <unordered_map>
+#include <vector>
 #include "./common.hpp"
 
 using namespace std;
 
 namespace gles
 {
+  /**
+   * The renderer-side record of a shader for the program binary cache.
+   */
+  struct GLShaderRecord
+  {
+    // The source passed to `glShaderSource()`.
+    std::string source;
+    // The source at the last `glCompileShader()`, the compiled shader and the cache key are from it rather than the current
+    // source, which might be replaced after compiling.
+    std::string compiledSource;
+    // The compiling is deferred until the program is linked without a cached binary, or the shader is queried.
+    bool compilePending = false;
+  };
+
+  /**
+   * The renderer-side record of a program for the program binary cache.
+   */
+  struct GLProgramRecord
+  {
+    // The attached shaders in the attaching order.
+    std::vector<GLuint> shaders;
+    // The attribute bindings via `glBindAttribLocation()`.
+    std::map<std::string, uint32_t> attribBindings;
+  };
+
   class GLObjectManager
   {
   public:
@@ -63,6 +90,29 @@ namespace gles
     void DeleteRenderbuffer(uint32_t clientId);
     size_t ClearRenderbuffers();
 
+    /**
+     * @returns The record of the shader, which is created if it doesn't exist.
+     */
+    inline GLShaderRecord &ShaderRecordRef(GLuint shader)
+    {
+      return shaderRecords[shader];
+    }
+    /**
+     * @returns The record of the shader, or nullptr if it doesn't exist.
+     */
+    inline GLShaderRecord *FindShaderRecord(GLuint shader)
+    {
+      auto it = shaderRecords.find(shader);
+      return it == shaderRecords.end() ? nullptr : &it->second;
+    }
+    /**
+     * @returns The record of the program, which is created if it doesn't exist.
+     */
+    inline GLProgramRecord &ProgramRecordRef(GLuint program)
+    {
+      return programRecords[program];
+    }
+
     GLuint CreateVertexArray();
     GLuint CreateVertexArray(uint32_t clientId);
     GLuint FindVertexArray(uint32_t clientId);
@@ -74,6 +124,8 @@ namespace gles
     std::string name;
     unordered_map<uint32_t, GLuint> programs;
     unordered_map<uint32_t, GLuint> shaders;
+    unordered_map<GLuint, GLShaderRecord> shaderRecords;
+    unordered_map<GLuint, GLProgramRecord> programRecords;
 
   private:
     unordered_map<uint32_t, GLuint *> textures;
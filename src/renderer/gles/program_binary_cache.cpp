@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "./program_binary_cache.hpp"
+
+namespace gles
+{
+  using namespace std;
+  namespace fs = std::filesystem;
+
+  // The header of the entry file, the binary follows it.
+  struct ProgramBinaryFileHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t size;
+  };
+  constexpr uint32_t kProgramBinaryMagic = 0x42505254; // "TRPB"
+  constexpr uint32_t kProgramBinaryVersion = 1;
+  constexpr const char *kProgramBinaryExtension = ".bin";
+
+  // FNV-1a, which is stable across the runs unlike `std::hash`.
+  class Fnv1aHasher
+  {
+  public:
+    inline void update(const void *data, size_t size)
+    {
+      auto bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0; i < size; i++)
+      {
+        hash_ ^= bytes[i];
+        hash_ *= 0x100000001b3ull;
+      }
+    }
+    inline void update(const string &str)
+    {
+      uint64_t size = str.size();
+      update(&size, sizeof(size));
+      update(str.data(), str.size());
+    }
+    inline uint64_t digest() const
+    {
+      return hash_;
+    }
+
+  private:
+    uint64_t hash_ = 0xcbf29ce484222325ull;
+  };
+
+  string ProgramBinaryCache::ComputeKey(const vector<string> &shaderSources,
+                                        const map<string, uint32_t> &attribBindings,
+                                        const string &driverTag)
+  {
+    Fnv1aHasher hasher;
+    hasher.update(driverTag);
+    for (auto &source : shaderSources)
+      hasher.update(source);
+    for (auto &[name, index] : attribBindings)
+    {
+      hasher.update(name);
+      hasher.update(&index, sizeof(index));
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hasher.digest()));
+    return string(key);
+  }
+
+  ProgramBinaryCache::ProgramBinaryCache(const string &directory, size_t maxEntries, size_t maxBytes)
+      : directory_(directory)
+      , maxEntries_(maxEntries)
+      , maxBytes_(maxBytes)
+  {
+    error_code ec;
+    fs::create_directories(directory_, ec);
+    scan();
+  }
+
+  optional<ProgramBinaryCache::Binary> ProgramBinaryCache::load(const string &key)
+  {
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+    {
+      stats_.misses += 1;
+      return nullopt;
+    }
+
+    ifstream file(pathOf(key), ios::binary);
+    ProgramBinaryFileHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        header.magic != kProgramBinaryMagic ||
+        header.version != kProgramBinaryVersion ||
+        sizeof(header) + header.size != it->second.bytes)
+    {
+      remove(key);
+      stats_.misses += 1;
+      return nullopt;
+    }
+
+    Binary binary;
+    binary.format = header.format;
+    binary.data.resize(header.size);
+    if (!file.read(reinterpret_cast<char *>(binary.data.data()), header.size))
+    {
+      remove(key);
+      stats_.misses += 1;
+      return nullopt;
+    }
+
+    // Move to the front, and touch the file to keep the order at the next run.
+    lru_.splice(lru_.begin(), lru_, it->second.position);
+    error_code ec;
+    fs::last_write_time(pathOf(key), fs::file_time_type::clock::now(), ec);
+    stats_.hits += 1;
+    return binary;
+  }
+
+  bool ProgramBinaryCache::store(const string &key, const Binary &binary)
+  {
+    if (binary.data.empty())
+      return false;
+
+    ProgramBinaryFileHeader header = {kProgramBinaryMagic,
+                                      kProgramBinaryVersion,
+                                      binary.format,
+                                      static_cast<uint32_t>(binary.data.size())};
+    size_t bytes = sizeof(header) + binary.data.size();
+    if (bytes > maxBytes_)
+      return false;
+
+    // Write to a temporary file and rename it, thus a crash while writing never leaves a broken entry.
+    auto path = pathOf(key);
+    auto tempPath = path + ".tmp";
+    {
+      ofstream file(tempPath, ios::binary | ios::trunc);
+      if (!file.write(reinterpret_cast<const char *>(&header), sizeof(header)) ||
+          !file.write(reinterpret_cast<const char *>(binary.data.data()), binary.data.size()))
+      {
+        error_code ec;
+        fs::remove(tempPath, ec);
+        return false;
+      }
+    }
+    error_code ec;
+    fs::rename(tempPath, path, ec);
+    if (ec)
+    {
+      fs::remove(tempPath, ec);
+      return false;
+    }
+
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+      totalBytes_ -= it->second.bytes;
+      lru_.erase(it->second.position);
+      entries_.erase(it);
+    }
+    lru_.push_front(key);
+    entries_[key] = {lru_.begin(), bytes};
+    totalBytes_ += bytes;
+    stats_.stores += 1;
+    evictIfNeeded();
+    return true;
+  }
+
+  void ProgramBinaryCache::reject(const string &key)
+  {
+    if (entries_.find(key) == entries_.end())
+      return;
+    remove(key);
+    // The binary is loaded before it's rejected, thus the load is not counted as a hit.
+    if (stats_.hits > 0)
+      stats_.hits -= 1;
+    stats_.rejections += 1;
+  }
+
+  string ProgramBinaryCache::pathOf(const string &key) const
+  {
+    return (fs::path(directory_) / (key + kProgramBinaryExtension)).string();
+  }
+
+  void ProgramBinaryCache::scan()
+  {
+    vector<pair<fs::file_time_type, fs::directory_entry>> files;
+    error_code ec;
+    for (auto &entry : fs::directory_iterator(directory_, ec))
+    {
+      if (!entry.is_regular_file(ec))
+        continue;
+      auto &path = entry.path();
+      if (path.extension() != kProgramBinaryExtension)
+      {
+        // Remove the temporary files left by an interrupted store.
+        if (path.extension() == ".tmp")
+          fs::remove(path, ec);
+        continue;
+      }
+      files.push_back({entry.last_write_time(ec), entry});
+    }
+
+    // The most recently written first.
+    sort(files.begin(), files.end(), [](const auto &a, const auto &b)
+         { return a.first > b.first; });
+    for (auto &[_, entry] : files)
+    {
+      auto key = entry.path().stem().string();
+      size_t bytes = entry.file_size(ec);
+      if (ec)
+        continue;
+      lru_.push_back(key);
+      entries_[key] = {prev(lru_.end()), bytes};
+      totalBytes_ += bytes;
+    }
+    evictIfNeeded();
+  }
+
+  void ProgramBinaryCache::remove(const string &key)
+  {
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+      return;
+
+    totalBytes_ -= it->second.bytes;
+    lru_.erase(it->second.position);
+    entries_.erase(it);
+
+    error_code ec;
+    fs::remove(pathOf(key), ec);
+  }
+
+  void ProgramBinaryCache::evictIfNeeded()
+  {
+    while (!lru_.empty() && (lru_.size() > maxEntries_ || totalBytes_ > maxBytes_))
+    {
+      string key = lru_.back(); // Copied, because the removing erases the node.
+      remove(key);
+      stats_.evictions += 1;
+    }
+  }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gles
+{
+  /**
+   * The persistent cache of the linked program binaries, which is used to skip compiling and linking the same shaders across
+   * the contents and the runs.
+   *
+   * An entry is keyed by the hash of the patched shader sources, the attribute bindings and the driver, and stored as a file
+   * `<key>.bin` in the cache directory. The least recently used entries are evicted when the count or the total bytes exceed
+   * the limits, the last write time of the files is used to restore the order at the next run.
+   *
+   * This class doesn't call the GL functions, the caller reads the binary via `glGetProgramBinary()` and loads it via
+   * `glProgramBinary()`. It's not thread-safe and is expected to be used at the render thread only.
+   */
+  class ProgramBinaryCache
+  {
+  public:
+    /**
+     * The default maximum count of the entries.
+     */
+    static constexpr size_t kDefaultMaxEntries = 256;
+    /**
+     * The default maximum total bytes of the entries.
+     */
+    static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+    /**
+     * The program binary and its format returned by `glGetProgramBinary()`.
+     */
+    struct Binary
+    {
+      uint32_t format = 0;
+      std::vector<uint8_t> data;
+    };
+    struct Stats
+    {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t stores = 0;
+      size_t evictions = 0;
+      size_t rejections = 0;
+    };
+
+    /**
+     * Compute the cache key of a program.
+     *
+     * @param shaderSources The sources of the attached shaders in the attaching order.
+     * @param attribBindings The attribute bindings via `glBindAttribLocation()` before linking.
+     * @param driverTag The string to identify the driver, such as the vendor, renderer and version, because the binaries are
+     *                  not compatible across the drivers.
+     * @returns The hexadecimal string of the key.
+     */
+    static std::string ComputeKey(const std::vector<std::string> &shaderSources,
+                                  const std::map<std::string, uint32_t> &attribBindings,
+                                  const std::string &driverTag);
+
+  public:
+    /**
+     * Create the cache at the given directory, the directory is created if it doesn't exist, and the existing entries are
+     * loaded in the order of their last write time.
+     *
+     * @param directory The directory to store the entries.
+     * @param maxEntries The maximum count of the entries.
+     * @param maxBytes The maximum total bytes of the entries.
+     */
+    ProgramBinaryCache(const std::string &directory,
+                       size_t maxEntries = kDefaultMaxEntries,
+                       size_t maxBytes = kDefaultMaxBytes);
+
+  public:
+    /**
+     * Load the binary of the given key, and mark the entry as the most recently used.
+     *
+     * @returns The binary, or `std::nullopt` if the key is missed or the file is broken.
+     */
+    std::optional<Binary> load(const std::string &key);
+    /**
+     * Store the binary of the given key, it replaces the existing entry and evicts the least recently used entries if needed.
+     *
+     * @returns `true` if the binary is written to the disk.
+     */
+    bool store(const std::string &key, const Binary &binary);
+    /**
+     * Remove the entry of the given key, it's used when the driver rejects the loaded binary, and the load is counted as a
+     * rejection instead of a hit.
+     */
+    void reject(const std::string &key);
+
+  public:
+    inline const std::string &directory() const
+    {
+      return directory_;
+    }
+    /**
+     * @returns The count of the entries.
+     */
+    inline size_t size() const
+    {
+      return lru_.size();
+    }
+    /**
+     * @returns The total bytes of the entries.
+     */
+    inline size_t totalBytes() const
+    {
+      return totalBytes_;
+    }
+    inline const Stats &stats() const
+    {
+      return stats_;
+    }
+
+  private:
+    struct Entry
+    {
+      std::list<std::string>::iterator position;
+      size_t bytes;
+    };
+
+    std::string pathOf(const std::string &key) const;
+    void scan();
+    void remove(const std::string &key);
+    void evictIfNeeded();
+
+  private:
+    std::string directory_;
+    size_t maxEntries_;
+    size_t maxBytes_;
+    size_t totalBytes_ = 0;
+    // The keys from the most recently used to the least recently used.
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, Entry> entries_;
+    Stats stats_;
+  };
+}
@@ -39,6 +39,14 @@ public:
    * Should print the information of this call.
    */
   bool printsCall;
+  /**
+   * Should elide the redundant state-setting calls.
+   */
+  bool elidesRedundantStates;
+  /**
+   * Should answer the debug and validation queries from the recorded states instead of the driver.
+   */
+  bool validatesWithShadowStates;
 };
 
 /**
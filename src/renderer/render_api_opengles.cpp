@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <cstdlib>
+#include <optional>
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -10,8 +12,10 @@
 #include "gles/common.hpp"
 #include "gles/context_storage.hpp"
 #include "gles/object_manager.hpp"
+#include "gles/program_binary_cache.hpp"
 
 #include "math/matrix.hpp"
+#include "runtime/constellation.hpp"
 #include "runtime/content.hpp"
 #include "xr/device.hpp"
 
@@ -52,6 +56,9 @@ class RenderAPI_OpenGLCoreES : public RenderAPI
 {
 private:
   bool m_DebugEnabled = true;
+  bool m_ProgramBinaryCacheChecked = false;
+  std::unique_ptr<gles::ProgramBinaryCache> m_ProgramBinaryCache;
+  std::string m_ProgramBinaryDriverTag;
 
 public:
   RenderAPI_OpenGLCoreES(RHIBackendType backendType);
@@ -83,6 +90,7 @@ private:
       return;
     GLuint vao = glContext->ObjectManagerRef().CreateVertexArray();
     glBindVertexArray(vao);
+    glContext->RecordVertexArrayObjectOnCreated(vao);
     glContext->RecordVertexArrayObject(vao);
   }
 
@@ -99,6 +107,8 @@ private:
     if (TR_UNLIKELY(error != GL_NO_ERROR))
     {
       reqContentRenderer->increaseFrameErrorsCount();
+      // The failed call might not change the driver states as recorded.
+      reqContentRenderer->getOpenGLContext()->MarkStatesUnsynced();
 
       DEBUG(LOG_TAG_ERROR,
             "Occurs an %s error at %s",
@@ -121,9 +131,229 @@ private:
     }
     return error;
   }
+  /**
+   * Decide if a state-setting call should be issued to the driver, the call is elided when it doesn't change the recorded
+   * state and the recorded states are synced with the driver.
+   *
+   * @param changed If the state is changed, namely the result of the corresponding `Record*()` call.
+   * @returns true if the call should be issued.
+   */
+  bool ShouldIssueStateCall(bool changed, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
+  {
+    bool elided = !changed &&
+                  options.elidesRedundantStates &&
+                  reqContentRenderer->getOpenGLContext()->IsStatesSynced();
+    reqContentRenderer->increaseStateCallsCount(elided);
+    return !elided;
+  }
+  /**
+   * Query an integer state for the debug and validation, it's answered from the recorded states of the app context to avoid
+   * the driver round-trip when the shadow validation is enabled, otherwise it falls back to `glGetIntegerv()`.
+   */
+  void GetIntegervForValidation(GLenum pname,
+                                GLint *value,
+                                renderer::TrContentRenderer *reqContentRenderer,
+                                ApiCallOptions &options)
+  {
+    if (options.validatesWithShadowStates && reqContentRenderer->getOpenGLContext()->GetIntegerv(pname, value))
+      return;
+    glGetIntegerv(pname, value);
+  }
+  /**
+   * Get the program binary cache, it's created at the first use if the driver supports the program binaries and the
+   * application cache directory is configured.
+   *
+   * @returns The program binary cache, or nullptr if it's not available.
+   */
+  gles::ProgramBinaryCache *GetProgramBinaryCache()
+  {
+    if (m_ProgramBinaryCacheChecked)
+      return m_ProgramBinaryCache.get();
+    m_ProgramBinaryCacheChecked = true;
+
+    // The program binaries are an extension in OpenGL ES 2.0.
+    if (backendType == RHIBackendType::OpenGLESv2 || constellation == nullptr)
+      return nullptr;
+    string directory = constellation->getOptions().programBinariesDirectory();
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    if (numFormats <= 0 || constellation->getOptions().applicationCacheDirectory.empty())
+    {
+      DEBUG(DEBUG_TAG, "The program binary cache is disabled, the driver supports %d binary formats", numFormats);
+      return nullptr;
+    }
+
+    auto getString = [](GLenum name)
+    {
+      auto value = reinterpret_cast<const char *>(glGetString(name));
+      return value == nullptr ? string() : string(value);
+    };
+    m_ProgramBinaryDriverTag = getString(GL_VENDOR) + "/" + getString(GL_RENDERER) + "/" + getString(GL_VERSION);
+    m_ProgramBinaryCache = make_unique<gles::ProgramBinaryCache>(directory);
+    DEBUG(DEBUG_TAG,
+          "The program binary cache is enabled at %s with %zu entries",
+          directory.c_str(),
+          m_ProgramBinaryCache->size());
+    return m_ProgramBinaryCache.get();
+  }
+  /**
+   * Compile the shader, and print the info log and the source if it fails.
+   */
+  void CompileShader(GLuint shader)
+  {
+    glCompileShader(shader);
+
+    GLint compileStatus;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+    if (compileStatus != GL_TRUE)
+    {
+      DEBUG(LOG_TAG_ERROR, "Failed to compile shader(%d)", shader);
+      GLint logLength;
+      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+      if (logLength > 0)
+      {
+        std::vector<GLchar> log(logLength);
+        glGetShaderInfoLog(shader, logLength, nullptr, log.data());
+        DEBUG(LOG_TAG_ERROR, "Shader compile log: %s", log.data());
+      }
+
+      // Print the shader source
+      GLint sourceSize;
+      glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &sourceSize);
+      GLchar *source = new GLchar[sourceSize];
+      GLint maxLength = sourceSize;
+      GLint bytesWritten;
+      string shaderSource = "";
+      while (true)
+      {
+        glGetShaderSource(shader, maxLength, &bytesWritten, source);
+        if (bytesWritten < maxLength - 1)
+          break;
+        maxLength += sourceSize;
+        shaderSource += string(source);
+        source = (GLchar *)realloc(source, maxLength);
+      }
+      delete[] source;
+
+      DEBUG(LOG_TAG_ERROR, "=============== Shader Source ===============");
+      string line;
+      uint32_t lineNum = 1;
+      size_t pos = 0;
+      while (pos < shaderSource.size())
+      {
+        getline(shaderSource, line, pos);
+
+        int num = lineNum++;
+        if (num < 10)
+          DEBUG(LOG_TAG_ERROR, "[00%d] %s", num, line.c_str());
+        else if (num < 100)
+          DEBUG(LOG_TAG_ERROR, "[0%d] %s", num, line.c_str());
+        else
+          DEBUG(LOG_TAG_ERROR, "[%d] %s", lineNum++, line.c_str());
+      }
+      DEBUG(LOG_TAG_ERROR, "=============== Shader Source ===============");
+    }
+  }
+  /**
+   * Set the source of the shader, it doesn't update the shader record.
+   */
+  void SetShaderSource(GLuint shader, const string &source)
+  {
+    const char *sourceStr = source.c_str();
+    GLint sourceSize = static_cast<GLint>(source.size());
+    glShaderSource(shader, 1, &sourceStr, &sourceSize);
+  }
+  /**
+   * Compile the shader if its compiling is deferred for the program binary cache.
+   */
+  void EnsureShaderCompiled(gles::GLObjectManager &glObjectManager, GLuint shader)
+  {
+    auto record = glObjectManager.FindShaderRecord(shader);
+    if (record == nullptr || !record->compilePending)
+      return;
+    record->compilePending = false;
+
+    // Compile the source at `compileShader()`, then restore the current source if it's replaced since then.
+    bool sourceReplaced = record->source != record->compiledSource;
+    if (sourceReplaced)
+      SetShaderSource(shader, record->compiledSource);
+    CompileShader(shader);
+    if (sourceReplaced)
+      SetShaderSource(shader, record->source);
+  }
+  /**
+   * Link the program from the program binary cache.
+   *
+   * @param cacheKey The cache key of the program, it's set if the program is cacheable.
+   * @returns `true` if the program is linked from a cached binary.
+   */
+  bool LinkProgramFromCache(gles::GLObjectManager &glObjectManager, GLuint program, optional<string> &cacheKey)
+  {
+    auto cache = GetProgramBinaryCache();
+    if (cache == nullptr)
+      return false;
+
+    auto &programRecord = glObjectManager.ProgramRecordRef(program);
+    vector<string> sources;
+    for (auto shader : programRecord.shaders)
+    {
+      auto shaderRecord = glObjectManager.FindShaderRecord(shader);
+      if (shaderRecord == nullptr || shaderRecord->compiledSource.empty())
+        return false; // The shader is deleted or not compiled, thus the program is not cacheable.
+      sources.push_back(shaderRecord->compiledSource);
+    }
+    if (sources.empty())
+      return false;
+
+    cacheKey = gles::ProgramBinaryCache::ComputeKey(sources, programRecord.attribBindings, m_ProgramBinaryDriverTag);
+    auto binary = cache->load(cacheKey.value());
+    if (!binary.has_value())
+      return false;
+
+    glProgramBinary(program, binary->format, binary->data.data(), binary->data.size());
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+      // The binary is rejected such as the driver is updated, drop it and link from the sources.
+      cache->reject(cacheKey.value());
+      return false;
+    }
+    return true;
+  }
+  /**
+   * Store the binary of the linked program to the program binary cache.
+   */
+  void StoreProgramBinary(GLuint program, const string &cacheKey)
+  {
+    auto cache = GetProgramBinaryCache();
+    if (cache == nullptr)
+      return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+      return;
+
+    gles::ProgramBinaryCache::Binary binary;
+    binary.data.resize(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data.data());
+    binary.format = format;
+    cache->store(cacheKey, binary);
+  }
+  void ReportProgramBinaryCacheStats()
+  {
+    auto cache = GetProgramBinaryCache();
+    if (cache == nullptr || constellation == nullptr || constellation->perfFs == nullptr)
+      return;
+    const auto &stats = cache->stats();
+    constellation->perfFs->setProgramBinaryCacheStats(stats.hits, stats.misses + stats.rejections);
+  }
   void DumpDrawCallInfo(const char *logTag,
                         string funcName,
-                        bool isDefaultQueue,
+                        renderer::TrContentRenderer *reqContentRenderer,
+                        ApiCallOptions &options,
                         GLint mode,
                         GLsizei count,
                         GLenum type,
@@ -131,13 +361,19 @@ private:
   {
     DEBUG(logTag,
           "[%d] GL::%s(mode=%s, count=%d, type=%s, indices=%p)",
-          isDefaultQueue,
+          options.isDefaultQueue,
           funcName.c_str(),
           gles::glEnumToString(mode).c_str(),
           count,
           gles::glEnumToString(type).c_str(),
           indices);
 
+    if (options.validatesWithShadowStates)
+    {
+      reqContentRenderer->getOpenGLContext()->PrintDrawCallStates(logTag);
+      return;
+    }
+
     // Get current program
     GLint program;
     glGetIntegerv(GL_CURRENT_PROGRAM, &program);
@@ -414,8 +650,23 @@ private:
                                     ApiCallOptions &options)
   {
     auto glContext = reqContentRenderer->getOpenGLContext();
-    auto program = glContext->ObjectManagerRef().FindProgram(req->clientId);
-    glLinkProgram(program);
+    auto &glObjectManager = glContext->ObjectManagerRef();
+    auto program = glObjectManager.FindProgram(req->clientId);
+
+    /**
+		 * Load the program from the cached binary of the same sources, otherwise compile the deferred shaders and link it, then
+		 * store its binary for the next links.
+		 */
+    optional<string> cacheKey = nullopt;
+    bool linkedFromCache = LinkProgramFromCache(glObjectManager, program, cacheKey);
+    if (!linkedFromCache)
+    {
+      for (auto shader : glObjectManager.ProgramRecordRef(program).shaders)
+        EnsureShaderCompiled(glObjectManager, shader);
+      if (cacheKey.has_value())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glLinkProgram(program);
+    }
     reqContentRenderer->getOpenGLContext()->MarkAsDirty();
 
     /**
@@ -432,17 +683,27 @@ private:
       DEBUG(LOG_TAG_ERROR, "Failed to link program(%d): %s", program, errorStr);
       delete[] errorStr;
 
+      glContext->RecordProgramOnLinked(program, make_shared<OpenGLProgramInfo>(false));
       LinkProgramCommandBufferResponse failureRes(req, false);
       reqContentRenderer->sendCommandBufferResponse(failureRes);
       return;
     }
 
+    if (!linkedFromCache && cacheKey.has_value())
+      StoreProgramBinary(program, cacheKey.value());
+    ReportProgramBinaryCacheStats();
+
     LinkProgramCommandBufferResponse res(req, true);
-    DEBUG(DEBUG_TAG, "    GL::LinkProgram(%d) on content#%d", program, reqContentRenderer->getContent()->id);
+    DEBUG(DEBUG_TAG,
+          "    GL::LinkProgram(%d) on content#%d%s",
+          program,
+          reqContentRenderer->getContent()->id,
+          linkedFromCache ? " from the cached binary" : "");
 
     /**
 		 * Fetch the locations of the attributes when link successfully.
 		 */
+    auto programInfo = make_shared<OpenGLProgramInfo>(true);
     GLint numAttributes = 0;
     glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &numAttributes);
     for (int i = 0; i < numAttributes; i++)
@@ -458,6 +719,7 @@ private:
 
       GLint location = glGetAttribLocation(program, name);
       res.attribLocations.push_back(AttribLocation(name, location));
+      programInfo->attribs.push_back({name, size, type, location});
       DEBUG(DEBUG_TAG,
             "    Attribute[%d](%s) => (size=%d, type=%s)",
             location,
@@ -465,6 +727,7 @@ private:
             size,
             gles::glUniformTypesToString(type).c_str());
     }
+    glContext->RecordProgramOnLinked(program, programInfo);
 
     /**
 		 * Fetch the locations of the uniforms and attributes when link successfully.
@@ -526,8 +789,8 @@ private:
   {
     auto glContext = reqContentRenderer->getOpenGLContext();
     auto program = glContext->ObjectManagerRef().FindProgram(req->clientId);
-    glUseProgram(program);
-    reqContentRenderer->getOpenGLContext()->RecordProgram(program);
+    if (ShouldIssueStateCall(glContext->RecordProgram(program), reqContentRenderer, options))
+      glUseProgram(program);
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::UseProgram(%d)", options.isDefaultQueue, program);
@@ -539,6 +802,8 @@ private:
     auto glContext = reqContentRenderer->getOpenGLContext();
     auto program = glContext->ObjectManagerRef().FindProgram(req->program);
     glBindAttribLocation(program, req->attribIndex, req->attribName.c_str());
+    if (GetProgramBinaryCache() != nullptr)
+      glContext->ObjectManagerRef().ProgramRecordRef(program).attribBindings[req->attribName] = req->attribIndex;
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG,
@@ -595,6 +860,8 @@ private:
     GLuint program = glContext->ObjectManagerRef().FindProgram(req->program);
     GLuint shader = glContext->ObjectManagerRef().FindShader(req->shader);
     glAttachShader(program, shader);
+    if (GetProgramBinaryCache() != nullptr)
+      glContext->ObjectManagerRef().ProgramRecordRef(program).shaders.push_back(shader);
     reqContentRenderer->getOpenGLContext()->MarkAsDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::AttachShader(program=%d, shader=%d)", options.isDefaultQueue, program, shader);
@@ -607,6 +874,11 @@ private:
     GLuint program = glObjectManager.FindProgram(req->program);
     GLuint shader = glObjectManager.FindShader(req->shader);
     glDetachShader(program, shader);
+    if (GetProgramBinaryCache() != nullptr)
+    {
+      auto &attachedShaders = glObjectManager.ProgramRecordRef(program).shaders;
+      attachedShaders.erase(remove(attachedShaders.begin(), attachedShaders.end(), shader), attachedShaders.end());
+    }
     reqContentRenderer->getOpenGLContext()->MarkAsDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::DetachShader(program=%d, shader=%d)", options.isDefaultQueue, program, shader);
@@ -662,10 +934,13 @@ private:
       }
     }
 
-    const char *sourceStr = fixedSource.c_str();
-    size_t sourceSize = fixedSource.size();
-    glShaderSource(shader, 1, &sourceStr, (const GLint *)&sourceSize);
+    SetShaderSource(shader, fixedSource);
     reqContentRenderer->getOpenGLContext()->MarkAsDirty();
+    if (GetProgramBinaryCache() != nullptr)
+    {
+      // A pending compiling is kept, it compiles the source snapshotted at `compileShader()`.
+      glObjectManager.ShaderRecordRef(shader).source = std::move(fixedSource);
+    }
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::ShaderSource(%d)", options.isDefaultQueue, shader);
@@ -676,59 +951,18 @@ private:
   {
     auto &glObjectManager = reqContentRenderer->getOpenGLContext()->ObjectManagerRef();
     auto shader = glObjectManager.FindShader(req->shader);
-    glCompileShader(shader);
-    reqContentRenderer->getOpenGLContext()->MarkAsDirty();
-
-    GLint compileStatus;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-    if (compileStatus != GL_TRUE)
+    if (GetProgramBinaryCache() != nullptr)
     {
-      DEBUG(LOG_TAG_ERROR, "Failed to compile shader(%d)", shader);
-      GLint logLength;
-      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-      if (logLength > 0)
-      {
-        std::vector<GLchar> log(logLength);
-        glGetShaderInfoLog(shader, logLength, nullptr, log.data());
-        DEBUG(LOG_TAG_ERROR, "Shader compile log: %s", log.data());
-      }
-
-      // Print the shader source
-      GLint sourceSize;
-      glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &sourceSize);
-      GLchar *source = new GLchar[sourceSize];
-      GLint maxLength = sourceSize;
-      GLint bytesWritten;
-      string shaderSource = "";
-      while (true)
-      {
-        glGetShaderSource(shader, maxLength, &bytesWritten, source);
-        if (bytesWritten < maxLength - 1)
-          break;
-        maxLength += sourceSize;
-        shaderSource += string(source);
-        source = (GLchar *)realloc(source, maxLength);
-      }
-      delete[] source;
-
-      DEBUG(LOG_TAG_ERROR, "=============== Shader Source ===============");
-      string line;
-      uint32_t lineNum = 1;
-      size_t pos = 0;
-      while (pos < shaderSource.size())
-      {
-        getline(shaderSource, line, pos);
-
-        int num = lineNum++;
-        if (num < 10)
-          DEBUG(LOG_TAG_ERROR, "[00%d] %s", num, line.c_str());
-        else if (num < 100)
-          DEBUG(LOG_TAG_ERROR, "[0%d] %s", num, line.c_str());
-        else
-          DEBUG(LOG_TAG_ERROR, "[%d] %s", lineNum++, line.c_str());
-      }
-      DEBUG(LOG_TAG_ERROR, "=============== Shader Source ===============");
+      // Defer the compiling, the program might be linked from the cached binary without compiling its shaders.
+      auto &record = glObjectManager.ShaderRecordRef(shader);
+      record.compiledSource = record.source;
+      record.compilePending = true;
     }
+    else
+    {
+      CompileShader(shader);
+    }
+    reqContentRenderer->getOpenGLContext()->MarkAsDirty();
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::CompileShader(%d)", options.isDefaultQueue, shader);
@@ -773,6 +1007,7 @@ private:
   {
     auto &glObjectManager = reqContentRenderer->getOpenGLContext()->ObjectManagerRef();
     GLuint shader = glObjectManager.FindShader(req->shader);
+    EnsureShaderCompiled(glObjectManager, shader);
     GLint value;
     glGetShaderiv(shader, req->pname, &value);
 
@@ -787,6 +1022,7 @@ private:
   {
     auto &glObjectManager = reqContentRenderer->getOpenGLContext()->ObjectManagerRef();
     GLuint shader = glObjectManager.FindShader(req->shader);
+    EnsureShaderCompiled(glObjectManager, shader);
     GLint logSize;
     glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
     GLchar *log = new GLchar[logSize];
@@ -836,13 +1072,15 @@ private:
     }
 
     /** Update the app states for next restore. */
+    bool changed = true;
     if (target == GL_ARRAY_BUFFER)
-      reqContentRenderer->getOpenGLContext()->RecordArrayBuffer(buffer);
+      changed = reqContentRenderer->getOpenGLContext()->RecordArrayBuffer(buffer);
     else if (target == GL_ELEMENT_ARRAY_BUFFER)
-      reqContentRenderer->getOpenGLContext()->RecordElementArrayBuffer(buffer);
+      changed = reqContentRenderer->getOpenGLContext()->RecordElementArrayBuffer(buffer);
     // TODO: support other targets?
 
-    glBindBuffer(target, buffer);
+    if (ShouldIssueStateCall(changed, reqContentRenderer, options))
+      glBindBuffer(target, buffer);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG,
@@ -872,8 +1110,10 @@ private:
             data,
             gles::glEnumToString(usage).c_str());
       GLint bindingBuffer;
-      glGetIntegerv(target == GL_ARRAY_BUFFER ? GL_ARRAY_BUFFER_BINDING : GL_ELEMENT_ARRAY_BUFFER_BINDING,
-                    &bindingBuffer);
+      GetIntegervForValidation(target == GL_ARRAY_BUFFER ? GL_ARRAY_BUFFER_BINDING : GL_ELEMENT_ARRAY_BUFFER_BINDING,
+                               &bindingBuffer,
+                               reqContentRenderer,
+                               options);
       DEBUG(DEBUG_TAG, "    Binding: %d", bindingBuffer);
     }
   }
@@ -928,6 +1168,7 @@ private:
 
     glBindFramebuffer(target, framebuffer);
     reqContentRenderer->getOpenGLContext()->RecordFramebuffer(framebuffer);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::BindFramebuffer(%d)", options.isDefaultQueue, framebuffer);
   }
@@ -942,6 +1183,7 @@ private:
     auto renderbuffer = glObjectManager.FindRenderbuffer(req->renderbuffer);
 
     glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG,
@@ -967,6 +1209,7 @@ private:
     auto texture = glObjectManager.FindTexture(req->texture);
     auto level = req->level;
     glFramebufferTexture2D(target, attachment, textarget, texture, level);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG,
@@ -1035,6 +1278,7 @@ private:
     auto width = req->width;
     auto height = req->height;
     glRenderbufferStorage(target, internalformat, width, height);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer, "https://docs.gl/es3/glRenderbufferStorage") != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::RenderbufferStorage(%s, internal_format=%d, width=%d, height=%d)", options.isDefaultQueue, gles::glEnumToString(target).c_str(), internalformat, width, height);
   }
@@ -1091,6 +1335,7 @@ private:
     auto width = req->width;
     auto height = req->height;
     glRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::RenderbufferStorageMultisample(0x%x, samples=%d, internalformat=0x%x, size=[%d,%d])", options.isDefaultQueue, target, samples, internalformat, width, height);
   }
@@ -1122,8 +1367,8 @@ private:
       glObjectManager.PrintVertexArrays();
       return;
     }
-    glBindVertexArray(vao);
-    reqContentRenderer->getOpenGLContext()->RecordVertexArrayObject(vao);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordVertexArrayObject(vao), reqContentRenderer, options))
+      glBindVertexArray(vao);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::BindVertexArray(%d)", options.isDefaultQueue, vao);
   }
@@ -1155,15 +1400,16 @@ private:
     auto &glObjectManager = reqContentRenderer->getOpenGLContext()->ObjectManagerRef();
     auto target = req->target;
     auto texture = glObjectManager.FindTexture(req->texture);
-    GetRenderer()->getOpenGLContext()->RecordTextureBindingFromHost();
-    glBindTexture(target, texture);
-
     auto contentGlContext = reqContentRenderer->getOpenGLContext();
-    contentGlContext->RecordTextureBindingWithUnit(target, texture);
+    if (ShouldIssueStateCall(contentGlContext->RecordTextureBindingWithUnit(target, texture), reqContentRenderer, options))
+    {
+      GetRenderer()->getOpenGLContext()->RecordTextureBindingFromHost();
+      glBindTexture(target, texture);
+    }
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       GLint activeUnit;
-      glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
+      GetIntegervForValidation(GL_ACTIVE_TEXTURE, &activeUnit, reqContentRenderer, options);
       DEBUG(DEBUG_TAG, "[%d] GL::BindTexture(%s, texture(%d)) for active(%d) program(%d)", options.isDefaultQueue, gles::glEnumToString(target).c_str(), texture, activeUnit, contentGlContext->GetProgram());
     }
   }
@@ -1201,6 +1447,7 @@ private:
       }
       glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
     }
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
@@ -1244,6 +1491,7 @@ private:
       req->width,
       req->height,
       req->border);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::CopyTexImage2D: %d", options.isDefaultQueue, req->target);
   }
@@ -1288,12 +1536,12 @@ private:
   TR_OPENGL_FUNC void OnActiveTexture(ActiveTextureCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     auto textureUnit = req->activeUnit;
-    glActiveTexture(textureUnit);
-    reqContentRenderer->getOpenGLContext()->RecordActiveTextureUnit(textureUnit);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordActiveTextureUnit(textureUnit), reqContentRenderer, options))
+      glActiveTexture(textureUnit);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       GLint currentProgram;
-      glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+      GetIntegervForValidation(GL_CURRENT_PROGRAM, &currentProgram, reqContentRenderer, options);
       DEBUG(DEBUG_TAG, "[%d] GL::ActiveTexture(%s)", options.isDefaultQueue, gles::glEnumToString(textureUnit).c_str());
       DEBUG(DEBUG_TAG, "    program: %d", currentProgram);
       DEBUG(DEBUG_TAG, "         id: %d", textureUnit - GL_TEXTURE0);
@@ -1318,6 +1566,7 @@ private:
     auto type = req->pixelType;
     auto pixels = req->pixels;
     glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG, "[%d] GL::TexImage3D(target=%s, level=%d, size=[%d,%d,%d], pixels=%p)", options.isDefaultQueue, gles::glEnumToString(target).c_str(), level, width, height, depth, pixels);
@@ -1350,6 +1599,7 @@ private:
     auto width = req->width;
     auto height = req->height;
     glTexStorage2D(target, levels, internalformat, width, height);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG, "[%d] GL::TexStorage2D(target=0x%x, levels=%d, internalformat=0x%x, size=[%d,%d])", options.isDefaultQueue, target, levels, internalformat, width, height);
@@ -1364,6 +1614,7 @@ private:
     auto height = req->height;
     auto depth = req->depth;
     glTexStorage3D(target, levels, internalformat, width, height, depth);
+    reqContentRenderer->getOpenGLContext()->MarkFramebufferStatusDirty();
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG, "[%d] GL::TexStorage3D(target=0x%x, levels=%d, internalformat=0x%x, size=[%d,%d,%d])", options.isDefaultQueue, target, levels, internalformat, width, height, depth);
@@ -1380,6 +1631,7 @@ private:
     if (backendType == RHIBackendType::OpenGLCore)
       EnsureVertexArrayObject(reqContentRenderer->getOpenGLContext());
     glEnableVertexAttribArray(req->index);
+    reqContentRenderer->getOpenGLContext()->RecordVertexAttribArrayEnabled(req->index, true);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::EnableVertexAttribArray(%d)", options.isDefaultQueue, req->index);
   }
@@ -1394,6 +1646,7 @@ private:
     if (backendType == RHIBackendType::OpenGLCore)
       EnsureVertexArrayObject(reqContentRenderer->getOpenGLContext());
     glDisableVertexAttribArray(req->index);
+    reqContentRenderer->getOpenGLContext()->RecordVertexAttribArrayEnabled(req->index, false);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::DisableVertexAttribArray(%d)", options.isDefaultQueue, req->index);
   }
@@ -1407,6 +1660,7 @@ private:
     auto offset = req->offset;
 
     glVertexAttribPointer(index, size, type, normalized, stride, (const char *)NULL + offset);
+    reqContentRenderer->getOpenGLContext()->RecordVertexAttribPointer(index);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       DEBUG(DEBUG_TAG, "[%d] GL::VertexAttribPointer(%d)", options.isDefaultQueue, index);
@@ -1417,8 +1671,8 @@ private:
       DEBUG(DEBUG_TAG, "    offset=%u", offset);
 
       GLint bindingVao, bindingArrayBuffer;
-      glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &bindingVao);
-      glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &bindingArrayBuffer);
+      GetIntegervForValidation(GL_VERTEX_ARRAY_BINDING, &bindingVao, reqContentRenderer, options);
+      GetIntegervForValidation(GL_ARRAY_BUFFER_BINDING, &bindingArrayBuffer, reqContentRenderer, options);
       DEBUG(DEBUG_TAG, "    Binding(VAO = %d, ArrayBuffer = %d)", bindingVao, bindingArrayBuffer);
     }
   }
@@ -1433,6 +1687,7 @@ private:
     auto offset = req->offset;
 
     glVertexAttribIPointer(index, size, type, stride, (const char *)NULL + offset);
+    reqContentRenderer->getOpenGLContext()->RecordVertexAttribPointer(index);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::VertexAttribIPointer(%d) size=%d type=0x%x stride=%d offset=%d", options.isDefaultQueue, index, size, type, stride, offset);
   }
@@ -1711,7 +1966,7 @@ private:
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       GLint currentProgram;
-      glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+      GetIntegervForValidation(GL_CURRENT_PROGRAM, &currentProgram, reqContentRenderer, options);
       DEBUG(DEBUG_TAG, "[%d] GL::UniformMatrix4fv(%d, values=[%d, use_placeholder=%s], count=%d, transpose=%s)", options.isDefaultQueue, location, matrixValuesSize, usePlaceholder ? "true" : "false", count, transpose ? "true" : "false");
       DEBUG(DEBUG_TAG, "    Program: %d", currentProgram);
       for (int i = 0; i < count; i++)
@@ -1739,7 +1994,7 @@ private:
     glDrawArrays(mode, first, count);
     reqContentRenderer->increaseDrawCallsCount(count);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
-      DumpDrawCallInfo(DEBUG_TAG, "DrawArrays", options.isDefaultQueue, mode, count, 0, nullptr);
+      DumpDrawCallInfo(DEBUG_TAG, "DrawArrays", reqContentRenderer, options, mode, count, 0, nullptr);
   }
   TR_OPENGL_FUNC void OnDrawElements(DrawElementsCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
@@ -1750,7 +2005,10 @@ private:
 
     assert(count < WEBGL_MAX_COUNT_PER_DRAWCALL);
 
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    GLenum framebufferStatus = options.validatesWithShadowStates
+                                 ? reqContentRenderer->getOpenGLContext()->CheckFramebufferStatus()
+                                 : glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (framebufferStatus != GL_FRAMEBUFFER_COMPLETE)
     {
       DEBUG(LOG_TAG_ERROR, "Skip this drawElements(): the framebuffer is not complete.");
       return;
@@ -1759,7 +2017,7 @@ private:
     reqContentRenderer->increaseDrawCallsCount(count);
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
-      DumpDrawCallInfo(DEBUG_TAG, "DrawElements", options.isDefaultQueue, mode, count, type, indices);
+      DumpDrawCallInfo(DEBUG_TAG, "DrawElements", reqContentRenderer, options, mode, count, type, indices);
   }
   TR_OPENGL_FUNC void OnDrawBuffers(DrawBuffersCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
@@ -1790,7 +2048,7 @@ private:
     glDrawArraysInstanced(mode, first, count, instanceCount);
     reqContentRenderer->increaseDrawCallsCount(count);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
-      DumpDrawCallInfo(DEBUG_TAG, "DrawArraysInstanced", options.isDefaultQueue, mode, count, 0, nullptr);
+      DumpDrawCallInfo(DEBUG_TAG, "DrawArraysInstanced", reqContentRenderer, options, mode, count, 0, nullptr);
   }
   TR_OPENGL_FUNC void OnDrawElementsInstanced(DrawElementsInstancedCommandBufferRequest *req,
                                               renderer::TrContentRenderer *reqContentRenderer,
@@ -1806,7 +2064,7 @@ private:
     glDrawElementsInstanced(mode, count, type, indices, instanceCount);
     reqContentRenderer->increaseDrawCallsCount(count);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
-      DumpDrawCallInfo(DEBUG_TAG, "DrawElementsInstanced", options.isDefaultQueue, mode, count, type, indices);
+      DumpDrawCallInfo(DEBUG_TAG, "DrawElementsInstanced", reqContentRenderer, options, mode, count, type, indices);
   }
   TR_OPENGL_FUNC void OnDrawRangeElements(DrawRangeElementsCommandBufferRequest *req,
                                           renderer::TrContentRenderer *reqContentRenderer,
@@ -1823,7 +2081,7 @@ private:
     glDrawRangeElements(mode, start, end, count, type, indices);
     reqContentRenderer->increaseDrawCallsCount(count);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
-      DumpDrawCallInfo(DEBUG_TAG, "DrawRangeElements", options.isDefaultQueue, mode, count, type, indices);
+      DumpDrawCallInfo(DEBUG_TAG, "DrawRangeElements", reqContentRenderer, options, mode, count, type, indices);
   }
   TR_OPENGL_FUNC void OnHint(HintCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
@@ -1892,20 +2150,22 @@ private:
   }
   TR_OPENGL_FUNC void OnDepthMask(DepthMaskCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
-    glDepthMask(req->flag);
-    reqContentRenderer->getOpenGLContext()->RecordDepthMask(req->flag);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordDepthMask(req->flag), reqContentRenderer, options))
+      glDepthMask(req->flag);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::DepthMask(%d)", options.isDefaultQueue, req->flag);
   }
   TR_OPENGL_FUNC void OnDepthFunc(DepthFuncCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
-    glDepthFunc(req->func);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordDepthFunc(req->func), reqContentRenderer, options))
+      glDepthFunc(req->func);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::DepthFunc(%s)", options.isDefaultQueue, gles::glDepthFuncToString(req->func).c_str());
   }
   TR_OPENGL_FUNC void OnDepthRange(DepthRangeCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     glDepthRangef(req->n, req->f);
+    reqContentRenderer->getOpenGLContext()->RecordDepthRange(req->n, req->f);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::DepthRange(%f, %f)", options.isDefaultQueue, req->n, req->f);
   }
@@ -1987,6 +2247,7 @@ private:
   TR_OPENGL_FUNC void OnBlendColor(BlendColorCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     glBlendColor(req->red, req->green, req->blue, req->alpha);
+    reqContentRenderer->getOpenGLContext()->RecordBlendColor(req->red, req->green, req->blue, req->alpha);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::BlendColor(%f, %f, %f, %f)", options.isDefaultQueue, req->red, req->green, req->blue, req->alpha);
   }
@@ -2006,8 +2267,8 @@ private:
   }
   TR_OPENGL_FUNC void OnBlendFunc(BlendFuncCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
-    glBlendFunc(req->sfactor, req->dfactor);
-    reqContentRenderer->getOpenGLContext()->RecordBlendFunc(req->sfactor, req->dfactor);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordBlendFunc(req->sfactor, req->dfactor), reqContentRenderer, options))
+      glBlendFunc(req->sfactor, req->dfactor);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::BlendFunc(%d)", options.isDefaultQueue, req->sfactor);
   }
@@ -2019,8 +2280,9 @@ private:
     auto dstRGB = req->dstRGB;
     auto srcAlpha = req->srcAlpha;
     auto dstAlpha = req->dstAlpha;
-    glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
-    reqContentRenderer->getOpenGLContext()->RecordBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    auto glContext = reqContentRenderer->getOpenGLContext();
+    if (ShouldIssueStateCall(glContext->RecordBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha), reqContentRenderer, options))
+      glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::BlendFuncSeparate(%s, %s, %s, %s)", options.isDefaultQueue, gles::glBlendFuncToString(srcRGB).c_str(), gles::glBlendFuncToString(dstRGB).c_str(), gles::glBlendFuncToString(srcAlpha).c_str(), gles::glBlendFuncToString(dstAlpha).c_str());
@@ -2032,8 +2294,8 @@ private:
     GLboolean b = req->blue;
     GLboolean a = req->alpha;
 
-    glColorMask(r, g, b, a);
-    reqContentRenderer->getOpenGLContext()->RecordColorMask(r, g, b, a);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordColorMask(r, g, b, a), reqContentRenderer, options))
+      glColorMask(r, g, b, a);
 
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::ColorMask(%d, %d, %d, %d)", options.isDefaultQueue, r, g, b, a);
@@ -2041,24 +2303,24 @@ private:
   TR_OPENGL_FUNC void OnCullFace(CullFaceCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     auto mode = req->mode;
-    glCullFace(mode);
-    reqContentRenderer->getOpenGLContext()->RecordCullFace(mode);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordCullFace(mode), reqContentRenderer, options))
+      glCullFace(mode);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::CullFace(%s)", options.isDefaultQueue, gles::glEnumToString(mode).c_str());
   }
   TR_OPENGL_FUNC void OnFrontFace(FrontFaceCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     auto mode = req->mode;
-    glFrontFace(mode);
-    reqContentRenderer->getOpenGLContext()->RecordFrontFace(mode);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordFrontFace(mode), reqContentRenderer, options))
+      glFrontFace(mode);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
       DEBUG(DEBUG_TAG, "[%d] GL::FrontFace(%s)", options.isDefaultQueue, gles::glEnumToString(mode).c_str());
   }
   TR_OPENGL_FUNC void OnEnable(EnableCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     auto cap = req->cap;
-    glEnable(cap);
-    reqContentRenderer->getOpenGLContext()->RecordCapability(cap, true);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordCapability(cap, true), reqContentRenderer, options))
+      glEnable(cap);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       if (cap == GL_BLEND ||
@@ -2079,8 +2341,8 @@ private:
   TR_OPENGL_FUNC void OnDisable(DisableCommandBufferRequest *req, renderer::TrContentRenderer *reqContentRenderer, ApiCallOptions &options)
   {
     auto cap = req->cap;
-    glDisable(cap);
-    reqContentRenderer->getOpenGLContext()->RecordCapability(cap, false);
+    if (ShouldIssueStateCall(reqContentRenderer->getOpenGLContext()->RecordCapability(cap, false), reqContentRenderer, options))
+      glDisable(cap);
     if (TR_UNLIKELY(CheckError(req, reqContentRenderer) != GL_NO_ERROR || options.printsCall))
     {
       if (cap == GL_BLEND ||
@@ -2318,6 +2580,8 @@ bool RenderAPI_OpenGLCoreES::ExecuteCommandBuffer(
 
   ApiCallOptions callOptions;
   callOptions.printsCall = GetRenderer()->isTracingEnabled;
+  callOptions.elidesRedundantStates = GetRenderer()->isRedundantStatesEliminationEnabled;
+  callOptions.validatesWithShadowStates = GetRenderer()->isShadowValidationEnabled;
 
   for (auto commandBuffer : commandBuffers)
   {
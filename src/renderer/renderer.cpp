@@ -17,6 +17,10 @@ namespace renderer
       , api(nullptr)
       , commandBufferChanServer(std::make_unique<CommandBufferChanServer>("commandBufferChan"))
   {
+#if defined(__linux__)
+    // Use the shared memory ring for command buffers where the futex doorbell is available.
+    commandBufferChanType = ipc::TR_CHANNEL_TYPE_SHM;
+#endif
   }
 
   TrRenderer::~TrRenderer()
@@ -69,6 +73,7 @@ namespace renderer
     perfCounter.record("  renderer.finishedHostContextRecord");
 
     size_t totalDrawCalls = 0, totalDrawCallsCount = 0;
+    size_t totalStateCallsIssued = 0, totalStateCallsElided = 0;
     {
       for (auto contentRenderer : contentRenderers)
       {
@@ -85,10 +90,13 @@ namespace renderer
         contentRenderer->onHostFrame(tickingTimepoint);
         totalDrawCalls += contentRenderer->drawCallsPerFrame;
         totalDrawCallsCount += contentRenderer->drawCallsCountPerFrame;
+        totalStateCallsIssued += contentRenderer->stateCallsIssuedPerFrame;
+        totalStateCallsElided += contentRenderer->stateCallsElidedPerFrame;
       }
       auto perfFs = constellation->perfFs;
       perfFs->setDrawCallsPerFrame(totalDrawCalls);
       perfFs->setDrawCallsCountPerFrame(totalDrawCallsCount);
+      perfFs->setStateCallsPerFrame(totalStateCallsIssued, totalStateCallsElided);
       perfCounter.record("  renderer.finishedContentRendererFrame");
     }
     glHostContext->Restore();
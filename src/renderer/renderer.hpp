@@ -91,6 +91,21 @@ namespace renderer
     {
       isAppContextSummaryEnabled = true;
     }
+    /**
+     * Disable the redundant states elimination, all the state-setting calls from the content are issued to the driver.
+     */
+    inline void disableRedundantStatesElimination()
+    {
+      isRedundantStatesEliminationEnabled = false;
+    }
+    /**
+     * Disable the shadow validation, the debug and validation queries are answered by the driver, which is slower but useful
+     * to debug the recorded states.
+     */
+    inline void disableShadowValidation()
+    {
+      isShadowValidationEnabled = false;
+    }
     /**
      * Configure the client frame rate.
      *
@@ -126,6 +141,14 @@ namespace renderer
     {
       return commandBufferChanServer->getPort();
     }
+    /**
+     * @returns The transport type of the command buffer requests, `TR_CHANNEL_TYPE_SHM` means the requests are sent via the
+     * shared memory ring, and the socket is only used for the handshake and responses.
+     */
+    inline ipc::TrChannelType getCommandBufferChanType()
+    {
+      return commandBufferChanType;
+    }
     /**
      * Remove the command buffer channel client.
      *
@@ -221,6 +244,8 @@ namespace renderer
     bool isTracingEnabled = false;
     bool isHostContextSummaryEnabled = false;
     bool isAppContextSummaryEnabled = false;
+    bool isRedundantStatesEliminationEnabled = true;
+    bool isShadowValidationEnabled = true;
     bool useDoubleWideFramebuffer = false;
     uint32_t clientDefaultFrameRate = 45;
 
@@ -245,5 +270,6 @@ namespace renderer
   private: // fields for command buffer
     std::unique_ptr<thread> commandBufferClientWatcher = nullptr;
     std::unique_ptr<ipc::TrOneShotServer<TrCommandBufferMessage>> commandBufferChanServer = nullptr;
+    ipc::TrChannelType commandBufferChanType = ipc::TR_CHANNEL_TYPE_SOCKET;
   };
 }
@@ -74,6 +74,13 @@ public:
   {
     return applicationCacheDirectory + "/scripts";
   }
+  /**
+   * @returns The directory to store the linked program binaries of the renderer.
+   */
+  inline std::string programBinariesDirectory()
+  {
+    return applicationCacheDirectory + "/program_binaries";
+  }
 
 public:
   /**
@@ -155,7 +162,17 @@ public:
     fps = makeValue<int>("host_fps", -1);
     drawCallsPerFrame = makeValue<int>("host_drawcalls_per_frame", -1);
     drawCallsCountPerFrame = makeValue<int>("host_drawcalls_count_per_frame", -1);
+    stateCallsIssuedPerFrame = makeValue<int>("host_state_calls_issued_per_frame", -1);
+    stateCallsElidedPerFrame = makeValue<int>("host_state_calls_elided_per_frame", -1);
     frameDuration = makeValue<double>("host_frame_duration", -1.0);
+    programBinaryCacheHits = makeValue<int>("host_program_binary_cache_hits", 0);
+    programBinaryCacheMisses = makeValue<int>("host_program_binary_cache_misses", 0);
+    audioDecodeMemory = makeValue<int>("host_audio_decode_memory", 0);
+    audioStreamingSources = makeValue<int>("host_audio_streaming_sources", 0);
+    audioStreamingUnderruns = makeValue<int>("host_audio_streaming_underruns", 0);
+    audioLoadDuration = makeValue<double>("host_audio_load_duration", -1.0);
+    soundCacheHits = makeValue<int>("host_sound_cache_hits", 0);
+    soundCacheMisses = makeValue<int>("host_sound_cache_misses", 0);
   }
   ~TrHostPerformanceFileSystem() = default;
 
@@ -172,16 +189,65 @@ public:
   {
     drawCallsCountPerFrame->set(value);
   }
+  inline void setStateCallsPerFrame(int issued, int elided)
+  {
+    stateCallsIssuedPerFrame->set(issued);
+    stateCallsElidedPerFrame->set(elided);
+  }
   inline void setFrameDuration(double value)
   {
     frameDuration->set(value);
   }
+  inline void setProgramBinaryCacheStats(int hits, int misses)
+  {
+    programBinaryCacheHits->set(hits);
+    programBinaryCacheMisses->set(misses);
+  }
+  inline void setAudioDecodeStats(int memory, int streamingSources, int underruns)
+  {
+    audioDecodeMemory->set(memory);
+    audioStreamingSources->set(streamingSources);
+    audioStreamingUnderruns->set(underruns);
+  }
+  inline void setAudioLoadDuration(double value)
+  {
+    audioLoadDuration->set(value);
+  }
+  inline void setSoundCacheStats(int hits, int misses)
+  {
+    soundCacheHits->set(hits);
+    soundCacheMisses->set(misses);
+  }
 
 public:
   unique_ptr<analytics::PerformanceValue<int>> fps;
   unique_ptr<analytics::PerformanceValue<int>> drawCallsPerFrame;
   unique_ptr<analytics::PerformanceValue<int>> drawCallsCountPerFrame;
+  unique_ptr<analytics::PerformanceValue<int>> stateCallsIssuedPerFrame;
+  unique_ptr<analytics::PerformanceValue<int>> stateCallsElidedPerFrame;
   unique_ptr<analytics::PerformanceValue<double>> frameDuration;
+  /**
+   * The total count of the program links which are loaded from the program binary cache, and the ones compiled and linked
+   * from the sources.
+   */
+  unique_ptr<analytics::PerformanceValue<int>> programBinaryCacheHits;
+  unique_ptr<analytics::PerformanceValue<int>> programBinaryCacheMisses;
+  /**
+   * The bytes of the encoded and PCM data kept by the sound decoders, the count of the streaming sounds and their total
+   * underruns, which are updated when a sound is loaded or removed.
+   */
+  unique_ptr<analytics::PerformanceValue<int>> audioDecodeMemory;
+  unique_ptr<analytics::PerformanceValue<int>> audioStreamingSources;
+  unique_ptr<analytics::PerformanceValue<int>> audioStreamingUnderruns;
+  /**
+   * The milliseconds of the last sound's loading, from its data is received to the first frame is ready to play.
+   */
+  unique_ptr<analytics::PerformanceValue<double>> audioLoadDuration;
+  /**
+   * The total count of the sound loadings which share a decoded clip from the sound cache, and the ones which decode.
+   */
+  unique_ptr<analytics::PerformanceValue<int>> soundCacheHits;
+  unique_ptr<analytics::PerformanceValue<int>> soundCacheMisses;
 };
 
 /**
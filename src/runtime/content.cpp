@@ -29,9 +29,27 @@ TrContentRuntime::TrContentRuntime(TrContentManager *contentMgr)
 void TrContentRuntime::preStart()
 {
   available = true;
-  commandBuffersRecvWorker = make_unique<WorkerThread>("TrCBWorker", [this](WorkerThread &worker)
-                                                       { recvCommandBuffers(worker, 100); });
   auto renderer = contentManager->constellation->renderer;
+  if (renderer->getCommandBufferChanType() == ipc::TR_CHANNEL_TYPE_SHM)
+  {
+    auto ringFilename = getConstellation()->getOptions().getZoneFilename(to_string(id), "cmdbuf");
+    commandBufferChanRing.reset(); // Release the previous ring first, it unlinks the same filename.
+    commandBufferChanRing = make_shared<ipc::TrShmRingBuffer>(ringFilename, TrZoneType::Server);
+    if (!commandBufferChanRing->isValid())
+    {
+      DEBUG(LOG_TAG_ERROR, "Failed to create the command buffer ring for the content(%d).", id);
+      commandBufferChanRing.reset();
+    }
+
+    auto poolFilename = getConstellation()->getOptions().getZoneFilename(to_string(id) + ".payload", "cmdbuf");
+    commandBufferPayloadPool.reset(); // Release the previous pool first, it unlinks the same filename.
+    commandBufferPayloadPool = make_shared<ipc::TrShmBlockPool>(poolFilename, TrZoneType::Server);
+    if (!commandBufferPayloadPool->isValid())
+    {
+      DEBUG(LOG_TAG_ERROR, "Failed to create the command buffer payload pool for the content(%d).", id);
+      commandBufferPayloadPool.reset();
+    }
+  }
 
   // Send the create process request to the hive daemon.
   TrDocumentRequestInit init;
@@ -91,7 +109,9 @@ void TrContentRuntime::onCommandBuffersExecuting()
 void TrContentRuntime::onCommandBuffersExecuted()
 {
   isCommandBufferRequestsExecuting.store(false);
-  commandBufferExecutingCv.notify_all();
+  // Resume receiving the requests which are deferred while executing.
+  if (commandBufferChanToken != ipc::TrChannelReactor::InvalidToken)
+    getChannelsReactor().notify(commandBufferChanToken);
 }
 
 void TrContentRuntime::onClientProcessExited(int exitCode)
@@ -112,12 +132,29 @@ xr::Device *TrContentRuntime::getXrDevice()
   return contentManager->constellation->xrDevice.get();
 }
 
+ipc::TrChannelReactor &TrContentRuntime::getChannelsReactor()
+{
+  return *contentManager->channelsReactor;
+}
+
 void TrContentRuntime::setupWithCommandBufferClient(TrOneShotClient<TrCommandBufferMessage> *client)
 {
   assert(client != nullptr);
-  commandBufferChanReceiver = std::make_unique<TrCommandBufferReceiver>(client);
+  auto receiver = std::make_unique<TrCommandBufferReceiver>(client);
+  if (commandBufferChanRing != nullptr)
+    receiver->attachSharedMemoryRing(commandBufferChanRing);
+  if (commandBufferPayloadPool != nullptr)
+    receiver->attachPayloadPool(commandBufferPayloadPool);
+  // Stop watching the previous channel before replacing the receiver.
+  if (commandBufferChanToken != ipc::TrChannelReactor::InvalidToken)
+    getChannelsReactor().remove(commandBufferChanToken);
+  contentRenderersCache.clear();
+
+  commandBufferChanReceiver = std::move(receiver);
   commandBufferChanSender = std::make_unique<TrCommandBufferSender>(client);
   commandBufferChanClient = client;
+  commandBufferChanToken = getChannelsReactor().add(commandBufferChanReceiver->getFd(), [this]()
+                                                    { return recvCommandBuffers(); });
   DEBUG(LOG_TAG_CONTENT, "Setup the command buffer channel with client(%d, %d)", client->getPid(), id);
 }
 
@@ -131,8 +168,15 @@ bool TrContentRuntime::sendCommandBufferResponse(TrCommandBufferResponse &res)
 
 void TrContentRuntime::onEventChanConnected(TrOneShotClient<events_comm::TrNativeEventMessage> &client)
 {
+  if (eventChanToken != ipc::TrChannelReactor::InvalidToken)
+    getChannelsReactor().remove(eventChanToken);
+
   eventChanReceiver = make_unique<events_comm::TrNativeEventReceiver>(&client);
   eventChanSender = make_unique<events_comm::TrNativeEventSender>(&client);
+  eventChanToken = getChannelsReactor().add(eventChanReceiver->getFd(), [this]()
+                                            {
+                                              eventChanReadable = true;
+                                              return false; });
 }
 
 bool TrContentRuntime::dispatchEvent(std::shared_ptr<events_comm::TrNativeEvent> event)
@@ -171,6 +215,10 @@ void TrContentRuntime::onMediaChanConnected(TrOneShotClient<media_comm::TrMediaC
   }
   mediaChanReceiver = make_unique<media_comm::TrMediaCommandReceiver>(&client);
   mediaChanSender = make_unique<media_comm::TrMediaCommandSender>(&client);
+  mediaChanToken = getChannelsReactor().add(mediaChanReceiver->getFd(), [this]()
+                                            {
+                                              mediaChanReadable = true;
+                                              return false; });
   tryDispatchRequest();
 }
 
@@ -214,68 +262,100 @@ bool TrContentRuntime::removeXRSession(xr::TrXRSession *session)
   return false;
 }
 
-void TrContentRuntime::recvCommandBuffers(WorkerThread &worker, uint32_t timeout)
+bool TrContentRuntime::recvCommandBuffers()
 {
-  /**
-   * When the following conditions are met, the worker thread will sleep and wait for the next frame tick:
-   *
-   * 1. The command buffer channel receiver is not ready.
-   * 2. The command buffer requests are executing.
-   */
   if (commandBufferChanReceiver == nullptr)
+    return false;
+
+  for (size_t i = 0; i < CommandBuffersBatchSize; i++)
   {
-    worker.sleep();
+    /**
+     * The requests are not received while the previous ones are executing, and `onCommandBuffersExecuted()` notifies the
+     * reactor to resume.
+     */
+    if (isCommandBufferRequestsExecuting.load())
+      return false;
+
+    commandbuffers::TrCommandBufferBase *commandBuffer = commandBufferChanReceiver->recvCommandBufferRequest(0);
+    if (commandBuffer == nullptr)
+    {
+      // Wait for the next readiness of the channel, unless the requests arrived meanwhile.
+      if (commandBufferChanReceiver->waitForRequestsByChannel())
+        return false;
+      continue;
+    }
+    dispatchCommandBufferRequest(commandBuffer);
+  }
+  return true;
+}
+
+void TrContentRuntime::dispatchCommandBufferRequest(commandbuffers::TrCommandBufferBase *commandBuffer)
+{
+  lock_guard<mutex> lock(commandBufferRequestsMutex);
+  auto renderer = contentManager->constellation->renderer;
+  auto contextId = commandBuffer->contextId;
+
+  if (commandBuffer->type == CommandBufferType::COMMAND_BUFFER_CREATE_WEBGL_CONTEXT_REQ)
+  {
+    renderer->addContentRenderer(shared_from_this(), contextId);
+    contentRenderersCache.erase(contextId);
+    delete commandBuffer;
     return;
   }
-  if (isCommandBufferRequestsExecuting.load())
+  else if (commandBuffer->type == CommandBufferType::COMMAND_BUFFER_REMOVE_WEBGL_CONTEXT_REQ)
   {
-    /**
-     * When the executing is true, just wait for the execution is finished via the condition variable.
-     */
-    unique_lock<mutex> lock(commandBufferExecutingMutex);
-    commandBufferExecutingCv.wait(lock, [this]
-                                  { return !isCommandBufferRequestsExecuting.load(); });
+    renderer->removeContentRenderer(id, contextId);
+    contentRenderersCache.erase(contextId);
+    delete commandBuffer;
+    return;
   }
 
-  // Do the command buffer receving work.
-  commandbuffers::TrCommandBufferBase *commandBuffer = commandBufferChanReceiver->recvCommandBufferRequest(timeout);
-  if (commandBuffer != nullptr)
+  shared_ptr<renderer::TrContentRenderer> contentRenderer;
+  auto cachedIt = contentRenderersCache.find(contextId);
+  if (cachedIt != contentRenderersCache.end())
   {
-    lock_guard<mutex> lock(commandBufferRequestsMutex);
-    auto renderer = contentManager->constellation->renderer;
-    auto contextId = commandBuffer->contextId;
+    contentRenderer = cachedIt->second;
+  }
+  else
+  {
+    contentRenderer = renderer->getContentRenderer(id, contextId);
+    if (contentRenderer != nullptr)
+      contentRenderersCache[contextId] = contentRenderer;
+  }
 
-    if (commandBuffer->type == CommandBufferType::COMMAND_BUFFER_CREATE_WEBGL_CONTEXT_REQ)
-    {
-      renderer->addContentRenderer(shared_from_this(), contextId);
-      delete commandBuffer;
-      return;
-    }
-    else if (commandBuffer->type == CommandBufferType::COMMAND_BUFFER_REMOVE_WEBGL_CONTEXT_REQ)
-    {
-      renderer->removeContentRenderer(id, contextId);
-      delete commandBuffer;
-      return;
-    }
+  if (TR_UNLIKELY(contentRenderer == nullptr))
+  {
+    DEBUG(LOG_TAG_ERROR,
+          "There is no available ContentRenderer for the content(%d) with context(%d)",
+          id,
+          static_cast<int>(contextId));
+    delete commandBuffer;
+    return;
+  }
+  contentRenderer->dispatchCommandBufferRequest(commandBuffer);
+}
 
-    auto contentRenderer = renderer->getContentRenderer(id, contextId);
-    if (TR_UNLIKELY(contentRenderer == nullptr))
+void TrContentRuntime::unwatchChannels()
+{
+  auto &reactor = getChannelsReactor();
+  for (auto token : {&commandBufferChanToken, &eventChanToken, &mediaChanToken})
+  {
+    if (*token != ipc::TrChannelReactor::InvalidToken)
     {
-      DEBUG(LOG_TAG_ERROR,
-            "There is no available ContentRenderer for the content(%d) with context(%d)",
-            id,
-            static_cast<int>(contextId));
-      delete commandBuffer;
-      return;
+      reactor.remove(*token);
+      *token = ipc::TrChannelReactor::InvalidToken;
     }
-    contentRenderer->dispatchCommandBufferRequest(commandBuffer);
   }
+  contentRenderersCache.clear();
 }
 
 void TrContentRuntime::recvEvent()
 {
   if (TR_UNLIKELY(!available || shouldDestroy || eventChanReceiver == nullptr))
     return;
+  // The flag is cleared before receiving, thus the message arrived after receiving is not missed.
+  if (!eventChanReadable.exchange(false))
+    return;
 
   auto eventTarget = contentManager->constellation->nativeEventTarget;
   assert(eventTarget != nullptr);
@@ -283,6 +363,8 @@ void TrContentRuntime::recvEvent()
   events_comm::TrNativeEventMessage eventMessage;
   if (eventChanReceiver->recvEventOn(eventMessage, 0))
   {
+    // There might be more messages, it's checked at the next tick.
+    eventChanReadable = true;
     switch (eventMessage.getType())
     {
 #define CASE(eventType)                                                                                                       \
@@ -308,10 +390,13 @@ void TrContentRuntime::recvMediaRequest()
 {
   if (TR_UNLIKELY(!available || shouldDestroy || mediaChanReceiver == nullptr))
     return;
+  if (!mediaChanReadable.exchange(false))
+    return;
 
   media_comm::TrMediaCommandMessage mediaMessage;
   if (mediaChanReceiver->recvCommand(mediaMessage, 0))
   {
+    mediaChanReadable = true;
     auto mediaManager = getConstellation()->mediaManager;
     mediaManager->onContentRequest(shared_from_this(), mediaMessage);
   }
@@ -396,8 +481,11 @@ void TrContentRuntime::release()
   std::cout << "Releasing the content runtime(" << id << ")" << std::endl;
   auto constellation = getConstellation();
 
-  // Stopping the receiver worker.
-  commandBuffersRecvWorker->stop();
+  // Close the ring first to release a reactor handler which is reading it, then stop receiving from the channels, it waits
+  // for the running reactor handlers of this content.
+  if (commandBufferChanRing != nullptr)
+    commandBufferChanRing->close();
+  unwatchChannels();
 
   // Removing the content renderer and command buffer client.
   auto renderer = constellation->renderer;
@@ -4,6 +4,7 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_map>
 #include <condition_variable>
 #include <filesystem>
 
@@ -12,6 +13,7 @@
 #include "common/options.hpp"
 #include "common/scoped_thread.hpp"
 #include "common/ipc.hpp"
+#include "common/ipc_reactor.hpp"
 #include "common/command_buffers/shared.hpp"
 #include "common/command_buffers/sender.hpp"
 #include "common/command_buffers/receiver.hpp"
@@ -235,7 +237,16 @@ public: // WebXR methods
   bool removeXRSession(xr::TrXRSession *session);
 
 private:
-  void recvCommandBuffers(WorkerThread &worker, uint32_t timeout);
+  /**
+   * Receive the command buffer requests at the content manager's channels reactor, at most `CommandBuffersBatchSize` requests
+   * are received in a call to keep the other contents from waiting.
+   *
+   * @returns `true` if there are more requests to receive.
+   */
+  bool recvCommandBuffers();
+  void dispatchCommandBufferRequest(commandbuffers::TrCommandBufferBase *commandBuffer);
+  ipc::TrChannelReactor &getChannelsReactor();
+  void unwatchChannels();
   void recvEvent();
   void recvMediaRequest();
   bool recvXRCommand(int timeout = 0);
@@ -324,7 +335,35 @@ private:
   std::unique_ptr<TrCommandBufferReceiver> commandBufferChanReceiver = nullptr;
   std::unique_ptr<TrCommandBufferSender> commandBufferChanSender = nullptr;
   ipc::TrOneShotClient<TrCommandBufferMessage> *commandBufferChanClient = nullptr;
-  std::unique_ptr<WorkerThread> commandBuffersRecvWorker;
+  /**
+   * The shared memory ring to receive the command buffer requests, it's created at pre-start when the renderer selects the
+   * `TR_CHANNEL_TYPE_SHM` transport, and the client process opens it by the content id.
+   */
+  std::shared_ptr<ipc::TrShmRingBuffer> commandBufferChanRing = nullptr;
+  /**
+   * The shared memory pool for the large payloads of the command buffer requests, it's created next to the ring, and the
+   * received requests keep the acquired blocks alive until they are executed and destroyed.
+   */
+  std::shared_ptr<ipc::TrShmBlockPool> commandBufferPayloadPool = nullptr;
+  /**
+   * The content renderers by the context id, it's only accessed at the reactor thread to skip looking up the renderer's list for
+   * each request, and it's updated by the requests to create or remove the WebGL contexts.
+   */
+  std::unordered_map<uint8_t, std::shared_ptr<renderer::TrContentRenderer>> contentRenderersCache;
+
+private: // channels reactor fields
+  /**
+   * The tokens of the channels watched by the content manager's reactor.
+   */
+  ipc::TrChannelReactor::Token commandBufferChanToken = ipc::TrChannelReactor::InvalidToken;
+  ipc::TrChannelReactor::Token eventChanToken = ipc::TrChannelReactor::InvalidToken;
+  ipc::TrChannelReactor::Token mediaChanToken = ipc::TrChannelReactor::InvalidToken;
+  /**
+   * The event and media messages are dispatched at the frame tick, the reactor only marks the channels as readable, thus the
+   * tick skips polling the channels without messages.
+   */
+  std::atomic<bool> eventChanReadable = false;
+  std::atomic<bool> mediaChanReadable = false;
 
 private: // XR fields
   ipc::TrOneShotClient<xr::TrXRCommandMessage> *xrCommandChanClient = nullptr;
@@ -354,8 +393,11 @@ private: // XR fields
   std::vector<xr::TrXRSession *> xrSessionsStack;
 
 private:
+  /**
+   * The max count of the command buffer requests to receive in a reactor round.
+   */
+  static constexpr size_t CommandBuffersBatchSize = 256;
+
   std::mutex commandBufferRequestsMutex;
-  std::mutex commandBufferExecutingMutex;
-  std::condition_variable commandBufferExecutingCv;
   std::atomic<bool> isCommandBufferRequestsExecuting = false;
 };
@@ -10,6 +10,7 @@ using namespace std::filesystem;
 
 TrContentManager::TrContentManager(TrConstellation *constellation)
     : constellation(constellation)
+    , channelsReactor(make_unique<ipc::TrChannelReactor>("TrChannelsReactor"))
     , hived(make_unique<TrHiveDaemon>(constellation))
 {
   eventChanServer = new TrOneShotServer<events_comm::TrNativeEventMessage>("eventChan");
@@ -477,6 +478,9 @@ void TrContentManager::startHived()
     hived->eventChanPort = eventChanServer->getPort();
     hived->mediaChanPort = constellation->mediaManager->chanPort();
     hived->commandBufferChanPort = constellation->renderer->getCommandBufferChanPort();
+    hived->commandBufferChanType = constellation->renderer->getCommandBufferChanType();
+    if (hived->commandBufferChanType == ipc::TR_CHANNEL_TYPE_SHM)
+      hived->commandBufferChanZoneDirectory = constellation->getOptions().getZoneDirname("cmdbuf");
   }
   hived->start();
 }
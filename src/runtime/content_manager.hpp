@@ -104,6 +104,11 @@ private:
 
 private:
   TrConstellation *constellation = nullptr;
+  /**
+   * The reactor to receive from the channels of all the contents at a single thread, it's declared before the contents to
+   * outlive them, because the contents stop watching their channels when they are released.
+   */
+  std::unique_ptr<ipc::TrChannelReactor> channelsReactor;
   shared_mutex contentsMutex;
   std::vector<std::shared_ptr<TrContentRuntime>> contents;
   std::unique_ptr<TrHiveDaemon> hived;
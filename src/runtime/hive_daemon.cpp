@@ -135,6 +135,10 @@ void TrHiveDaemon::onDeamonProcess()
   hiveConfig.AddMember("eventChanPort", eventChanPort, allocator);
   hiveConfig.AddMember("mediaChanPort", mediaChanPort, allocator);
   hiveConfig.AddMember("commandBufferChanPort", commandBufferChanPort, allocator);
+  hiveConfig.AddMember("commandBufferChanType", static_cast<int>(commandBufferChanType), allocator);
+  hiveConfig.AddMember("commandBufferChanZoneDirectory",
+                       rapidjson::Value(commandBufferChanZoneDirectory.c_str(), allocator),
+                       allocator);
 
   // Global settings
   auto &options = constellation->getOptions();
@@ -125,6 +125,14 @@ public: // fields to share for hived
    * The channel port for the `CommandBuffer` channel.
    */
   int commandBufferChanPort;
+  /**
+   * The transport type for the `CommandBuffer` requests.
+   */
+  ipc::TrChannelType commandBufferChanType = ipc::TR_CHANNEL_TYPE_SOCKET;
+  /**
+   * The directory of the `CommandBuffer` shared memory rings, each content's ring is named by its id.
+   */
+  std::string commandBufferChanZoneDirectory;
 
 private:
   TrConstellation *constellation = nullptr;
@@ -26,8 +26,8 @@ TrSoundSource::TrSoundSource(TrMediaManager *mediaManager,
 
 TrSoundSource::~TrSoundSource()
 {
-  ma_sound_uninit(sound.get());
-  ma_decoder_uninit(decoder.get());
+  // The sound reads from the decoder, thus it must be released before the decoder.
+  unloadSound();
 }
 
 void TrSoundSource::play()
@@ -51,52 +51,133 @@ void TrSoundSource::close()
 {
   if (isSrcDataLoaded)
     ma_sound_stop(sound.get());
+  unloadSound();
+  replaceDecoder(nullptr);
+}
+
+void TrSoundSource::unloadSound()
+{
+  // The audio thread checks the flag under the same lock, thus it never reads the sound being uninitialized.
+  lock_guard<mutex> lock(mutexForSound);
+  if (isSrcDataLoaded.exchange(false))
+    ma_sound_uninit(sound.get());
+}
+
+void TrSoundSource::replaceDecoder(unique_ptr<TrSoundDecoder> newDecoder)
+{
+  bool hadDecoder;
+  {
+    lock_guard<mutex> lock(mutexForDecoder);
+    hadDecoder = decoder != nullptr;
+    decoder = std::move(newDecoder);
+  }
+  // The released decoder may be the last user of its shared clip.
+  if (hadDecoder)
+    mediaManager->soundCache.trim();
 }
 
 void TrSoundSource::enableSpatialization(bool enabled)
 {
-  ma_sound_set_spatialization_enabled(sound.get(), enabled ? MA_TRUE : MA_FALSE);
+  if (isSrcDataLoaded)
+    ma_sound_set_spatialization_enabled(sound.get(), enabled ? MA_TRUE : MA_FALSE);
 }
 
 void TrSoundSource::setSrcData(const char *audioBuffer, size_t sizeInBytes)
 {
   if (sound == nullptr)
     sound = make_unique<ma_sound>();
-  if (decoder == nullptr)
-    decoder = make_unique<ma_decoder>();
+  unloadSound();
 
   dispatchMediaEvent(media_comm::TrMediaEventType::LoadStart);
-  ma_sound *pSound = sound.get();
-  ma_decoder *pDecoder = decoder.get();
-  ma_decoder_config decoderConfig = ma_decoder_config_init(TR_MEDIA_OUTPUT_FORMAT,
-                                                           TR_MEDIA_OUTPUT_CHANNELS,
-                                                           TR_MEDIA_OUTPUT_SAMPLE_RATE);
-  ma_decoder_init_memory(audioBuffer, sizeInBytes, &decoderConfig, pDecoder);
+  /**
+   * The short clips are fully decoded here and shared via the sound cache, and the long ones are decoded into a ring of
+   * pages at the media manager's decoding thread while playing, see `TrSoundDecoder` for the details.
+   */
+  auto &soundCache = mediaManager->soundCache;
+  // The encoded data is smaller than its decoded f32 PCM in practice, thus the larger data is streamed and not hashed.
+  bool cacheable = sizeInBytes <= TrSoundDecoder::kDefaultFullDecodeMaxBytes;
+  TrSoundCache::Key cacheKey;
+  shared_ptr<const TrDecodedSound> cachedSound = nullptr;
+  if (cacheable)
+  {
+    cacheKey = TrSoundCache::ComputeKey(audioBuffer,
+                                        sizeInBytes,
+                                        TR_MEDIA_OUTPUT_FORMAT,
+                                        TR_MEDIA_OUTPUT_CHANNELS,
+                                        TR_MEDIA_OUTPUT_SAMPLE_RATE);
+    cachedSound = soundCache.find(cacheKey);
+  }
+
+  unique_ptr<TrSoundDecoder> newDecoder = nullptr;
+  if (cachedSound != nullptr)
+  {
+    newDecoder = TrSoundDecoder::Make(cachedSound);
+  }
+  else
+  {
+    newDecoder = TrSoundDecoder::Make(audioBuffer,
+                                      sizeInBytes,
+                                      TR_MEDIA_OUTPUT_FORMAT,
+                                      TR_MEDIA_OUTPUT_CHANNELS,
+                                      TR_MEDIA_OUTPUT_SAMPLE_RATE);
+    if (cacheable && newDecoder != nullptr && newDecoder->mode() == TrSoundDecodeMode::kFull)
+      soundCache.insert(cacheKey, newDecoder->decodedSound());
+  }
+  // The decoder is replaced after decoding, thus the decoding thread is not blocked by the loading.
+  replaceDecoder(std::move(newDecoder));
+  if (decoder == nullptr)
+  {
+    DEBUG(LOG_TAG_ERROR, "Failed to decode the audio data(%zu bytes) of sound(%u)", sizeInBytes, id);
+    dispatchMediaEvent(media_comm::TrMediaEventType::Error);
+    return;
+  }
+  auto &metrics = decoder->metrics();
+  DEBUG(LOG_TAG_MEDIA, "Sound(%u) is loaded in %s mode: duration=%.2fs, encoded=%zu bytes, pcm=%zu bytes, load=%.2fms",
+        id,
+        metrics.mode == TrSoundDecodeMode::kStreaming ? "streaming"
+        : metrics.shared                              ? "shared"
+                                                      : "full",
+        decoder->duration(),
+        metrics.encodedBytes,
+        metrics.pcmBytes,
+        metrics.loadDuration);
+  if (mediaManager->constellation->perfFs != nullptr)
+    mediaManager->constellation->perfFs->setAudioLoadDuration(metrics.loadDuration);
   dispatchMediaMetadata();
   dispatchMediaEvent(media_comm::TrMediaEventType::LoadedMetadata);
   dispatchMediaEvent(media_comm::TrMediaEventType::LoadedData);
 
+  ma_sound *pSound = sound.get();
   ma_sound_config soundConfig = ma_sound_config_init();
   soundConfig.pFilePath = nullptr;
-  soundConfig.pDataSource = pDecoder;
+  soundConfig.pDataSource = decoder->dataSource();
   soundConfig.channelsOut = 0;
   soundConfig.isLooping = MA_FALSE;
-  soundConfig.flags = MA_SOUND_FLAG_DECODE;
-  ma_sound_init_ex(&mediaManager->audioEngine, &soundConfig, pSound);
+  if (ma_sound_init_ex(&mediaManager->audioEngine, &soundConfig, pSound) != MA_SUCCESS)
+  {
+    DEBUG(LOG_TAG_ERROR, "Failed to initialize the sound(%u)", id);
+    dispatchMediaEvent(media_comm::TrMediaEventType::Error);
+    return;
+  }
   ma_sound_set_spatialization_enabled(pSound, MA_TRUE);
   ma_sound_set_attenuation_model(pSound, ma_attenuation_model_exponential);
   applyBaseMatrixToSound();
-  isSrcDataLoaded = true;
+  {
+    lock_guard<mutex> lock(mutexForSound);
+    isSrcDataLoaded = true;
+  }
 }
 
 void TrSoundSource::setVolume(float volume)
 {
-  ma_sound_set_volume(sound.get(), volume);
+  if (isSrcDataLoaded)
+    ma_sound_set_volume(sound.get(), volume);
 }
 
 void TrSoundSource::setLooping(bool looping)
 {
-  ma_sound_set_looping(sound.get(), looping ? MA_TRUE : MA_FALSE);
+  if (isSrcDataLoaded)
+    ma_sound_set_looping(sound.get(), looping ? MA_TRUE : MA_FALSE);
 }
 
 void TrSoundSource::setBaseMatrix(glm::mat4 &baseMatrix)
@@ -116,9 +197,7 @@ bool TrSoundSource::dispatchMediaMetadata()
   media_comm::TrOnMediaMetadata metadata(id);
   {
     // Update the media metadata
-    ma_uint64 framesCount;
-    ma_decoder_get_length_in_pcm_frames(decoder.get(), &framesCount);
-    metadata.duration = static_cast<double>(framesCount) / decoder->outputSampleRate;
+    metadata.duration = decoder->duration();
   }
   return content->dispatchMediaEvent(metadata);
 }
@@ -136,7 +215,9 @@ void TrSoundSource::applyBaseMatrixToSound()
 
 void TrSoundSource::onBeforeData()
 {
-  if (sound != nullptr && isSrcDataLoaded)
+  // Skip this period instead of blocking the audio thread if the sound is being loaded or unloaded.
+  unique_lock<mutex> lock(mutexForSound, try_to_lock);
+  if (lock.owns_lock() && sound != nullptr && isSrcDataLoaded)
   {
     ma_sound *pSound = sound.get();
     auto soundAtEnd = ma_sound_get_at_end(pSound);
@@ -146,9 +227,17 @@ void TrSoundSource::onBeforeData()
   }
 }
 
+void TrSoundSource::pumpDecoder()
+{
+  lock_guard<mutex> lock(mutexForDecoder);
+  if (decoder != nullptr)
+    decoder->pump();
+}
+
 void TrSoundSource::onAfterData()
 {
-  if (sound != nullptr && isSrcDataLoaded)
+  unique_lock<mutex> lock(mutexForSound, try_to_lock);
+  if (lock.owns_lock() && sound != nullptr && isSrcDataLoaded)
   {
     // TODO
   }
@@ -197,6 +286,12 @@ void TrMediaManager::initialize()
                                                  { commandChanServer->tryAccept([this](TrOneShotClient<TrMediaCommandMessage> &chanClient)
                                                                                 { onNewChanClient(chanClient); },
                                                                                 1000); });
+  // The streaming sources are refilled here, thus the audio callback only copies the decoded pages.
+  soundDecodeWorker = make_unique<WorkerThread>("mediaSoundDecoder", [this](WorkerThread &worker)
+                                                {
+                                                  pumpSoundDecoders();
+                                                  worker.sleep(); },
+                                                SoundDecodeInterval);
   initialized = true;
   disabled = false;
 }
@@ -211,6 +306,7 @@ void TrMediaManager::shutdown()
       soundSources.clear();
     }
     chanClientsWatcher->stop();
+    soundDecodeWorker->stop();
     ma_engine_stop(&audioEngine);
   }
   DEBUG(LOG_TAG_MEDIA, "TrMediaManager::shutdown() done.");
@@ -263,6 +359,9 @@ void TrMediaManager::removeSoundSourcesByContent(int contentId)
     else
       ++it;
   }
+  // The removed sources may release their shared clips.
+  soundCache.trim();
+  updateDecodePerformanceValues();
 }
 
 void TrMediaManager::updateListenerBaseMatrix(glm::mat4 &baseMatrix)
@@ -317,7 +416,12 @@ void TrMediaManager::onContentRequest(shared_ptr<TrContentRuntime> content, TrMe
     auto closeReq = TrMediaCommandBase::CreateFromMessage<TrCloseRequest>(reqMessage);
     auto soundSource = findSoundSource(content, closeReq.clientId);
     if (soundSource != nullptr && soundSource->content == content)
+    {
       soundSource->close();
+
+      shared_lock<shared_mutex> lock(mutexForSoundSources);
+      updateDecodePerformanceValues();
+    }
   }
   else if (messageType == TrMediaCommandType::SetSrcDataRequest)
   {
@@ -328,7 +432,12 @@ void TrMediaManager::onContentRequest(shared_ptr<TrContentRuntime> content, TrMe
       soundSource->setSrcData((char *)setSrcDataReq.srcData, setSrcDataReq.sizeInBytes);
       soundSource->setVolume(setSrcDataReq.initialVolume);
       soundSource->setLooping(setSrcDataReq.loopingAtStart);
+
+      shared_lock<shared_mutex> lock(mutexForSoundSources);
+      updateDecodePerformanceValues();
     }
+    // The decoder keeps its own copy of the data.
+    free(setSrcDataReq.srcData);
   }
   else if (messageType == TrMediaCommandType::SetVolumeRequest)
   {
@@ -357,6 +466,38 @@ void TrMediaManager::onContentRequest(shared_ptr<TrContentRuntime> content, TrMe
   }
 }
 
+void TrMediaManager::updateDecodePerformanceValues()
+{
+  auto perfFs = constellation->perfFs;
+  if (perfFs == nullptr)
+    return;
+
+  // The decoded clips in use are in the cache too, thus only the streaming sources are counted here.
+  size_t streamingBytes = 0;
+  int streamingSources = 0;
+  int underruns = 0;
+  for (auto &soundSource : soundSources)
+  {
+    auto metrics = soundSource->decodeMetrics();
+    if (metrics == nullptr || metrics->mode != TrSoundDecodeMode::kStreaming)
+      continue;
+    streamingBytes += metrics->pcmBytes + metrics->encodedBytes;
+    underruns += metrics->underruns;
+    streamingSources += 1;
+  }
+  perfFs->setAudioDecodeStats(soundCache.totalBytes() + streamingBytes, streamingSources, underruns);
+
+  auto cacheStats = soundCache.stats();
+  perfFs->setSoundCacheStats(cacheStats.hits, cacheStats.misses);
+}
+
+void TrMediaManager::pumpSoundDecoders()
+{
+  shared_lock<shared_mutex> lock(mutexForSoundSources);
+  for (auto &soundSource : soundSources)
+    soundSource->pumpDecoder();
+}
+
 void TrMediaManager::nextAudioData(void *pOutput, const void *pInput, ma_uint32 frameCount)
 {
   for (auto &soundSource : soundSources)
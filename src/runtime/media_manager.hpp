@@ -2,7 +2,9 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 #include <vector>
+#include <mutex>
 #include <shared_mutex>
 
 #include <miniaudio/miniaudio.h>
@@ -16,6 +18,8 @@
 #include "common/media/message.hpp"
 #include "common/media/sender.hpp"
 #include "common/media/receiver.hpp"
+#include "./sound_decoder.hpp"
+#include "./sound_cache.hpp"
 
 using namespace ipc;
 using namespace media_comm;
@@ -74,6 +78,13 @@ public:
    * position and orientation.
    */
   void setBaseMatrix(glm::mat4 &baseMatrix);
+  /**
+   * @returns The decode metrics of the loaded audio data, or `nullptr` if the data is not loaded.
+   */
+  inline const TrSoundDecodeMetrics *decodeMetrics() const
+  {
+    return decoder == nullptr ? nullptr : &decoder->metrics();
+  }
 
 private:
   bool dispatchMediaEvent(media_comm::TrMediaEventType eventType);
@@ -81,6 +92,18 @@ private:
   void applyBaseMatrixToSound();
   void onBeforeData();
   void onAfterData();
+  /**
+   * Uninitialize the sound if it's loaded, it's synchronized with the audio thread.
+   */
+  void unloadSound();
+  /**
+   * Decode the consumed pages of the streaming decoder, it's called at the media manager's decoding thread.
+   */
+  void pumpDecoder();
+  /**
+   * Replace the decoder with the new one or `nullptr`, and trim the sound cache if a decoder is released.
+   */
+  void replaceDecoder(std::unique_ptr<TrSoundDecoder> newDecoder);
 
 public:
   uint32_t id;
@@ -89,10 +112,14 @@ private:
   TrMediaManager *mediaManager = nullptr;
   std::shared_ptr<TrContentRuntime> content = nullptr;
   std::unique_ptr<ma_sound> sound = nullptr;
-  std::unique_ptr<ma_decoder> decoder = nullptr;
+  std::unique_ptr<TrSoundDecoder> decoder = nullptr;
+  // Guards the decoder against being replaced while it's pumped.
+  std::mutex mutexForDecoder;
+  // Guards the sound against being uninitialized while it's read at the audio thread.
+  std::mutex mutexForSound;
   glm::mat4 baseMatrix = glm::mat4(1.0f);
   bool autoPlay = true;
-  bool isSrcDataLoaded = false;
+  std::atomic<bool> isSrcDataLoaded = false;
   bool isEnded = true;
 
   friend class TrMediaManager;
@@ -109,6 +136,10 @@ class TrMediaManager final
 
 public:
   static void DataCallback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount);
+  /**
+   * The milliseconds between the pumps of the streaming decoders, it's much shorter than the ~370ms of the decoded pages.
+   */
+  static constexpr uint32_t SoundDecodeInterval = 10;
 
 public:
   TrMediaManager(TrConstellation *constellation);
@@ -180,6 +211,8 @@ private:
   void onNewChanClient(TrOneShotClient<TrMediaCommandMessage> &chanClient);
   void onContentRequest(std::shared_ptr<TrContentRuntime> content, TrMediaCommandMessage &reqMessage);
   void nextAudioData(void *pOutput, const void *pInput, ma_uint32 frameCount);
+  void pumpSoundDecoders();
+  void updateDecodePerformanceValues();
 
 private:
   TrConstellation *constellation = nullptr;
@@ -187,8 +220,10 @@ private:
   ma_device audioDevice;
   std::shared_mutex mutexForSoundSources;
   vector<std::shared_ptr<TrSoundSource>> soundSources;
+  TrSoundCache soundCache;
   std::unique_ptr<TrOneShotServer<TrMediaCommandMessage>> commandChanServer = nullptr;
   std::unique_ptr<WorkerThread> chanClientsWatcher = nullptr;
+  std::unique_ptr<WorkerThread> soundDecodeWorker = nullptr;
   std::atomic<bool> initialized = false;
   std::atomic<bool> disabled = false;
 };
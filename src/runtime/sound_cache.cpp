@@ -0,0 +1,119 @@
+#include "./sound_cache.hpp"
+
+using namespace std;
+
+TrSoundCache::Key TrSoundCache::ComputeKey(const char *data, size_t sizeInBytes, ma_format format, ma_uint32 channels,
+                                           ma_uint32 sampleRate)
+{
+  // FNV-1a as the hash and a polynomial hash as the checksum over the output format and the encoded data, the two are
+  // computed in one pass.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  uint64_t checksum = 0;
+  auto update = [&hash, &checksum](const void *bytes, size_t size)
+  {
+    auto p = static_cast<const uint8_t *>(bytes);
+    for (size_t i = 0; i < size; i++)
+    {
+      hash ^= p[i];
+      hash *= 0x100000001b3ull;
+      checksum = checksum * 0x9e3779b97f4a7c15ull + p[i] + 1;
+    }
+  };
+  uint32_t formatValues[3] = {static_cast<uint32_t>(format), channels, sampleRate};
+  uint64_t size = sizeInBytes;
+  update(formatValues, sizeof(formatValues));
+  update(&size, sizeof(size));
+  update(data, sizeInBytes);
+  return Key{hash, checksum, sizeInBytes};
+}
+
+TrSoundCache::TrSoundCache(size_t budgetBytes)
+    : budgetBytes_(budgetBytes)
+{
+}
+
+shared_ptr<const TrDecodedSound> TrSoundCache::find(const Key &key)
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = entries_.find(key.hash);
+  if (it == entries_.end() || it->second.key != key)
+  {
+    stats_.misses += 1;
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.position);
+  stats_.hits += 1;
+  return it->second.decoded;
+}
+
+void TrSoundCache::insert(const Key &key, shared_ptr<const TrDecodedSound> decoded)
+{
+  if (decoded == nullptr)
+    return;
+
+  lock_guard<mutex> lock(mutex_);
+  auto it = entries_.find(key.hash);
+  if (it != entries_.end())
+  {
+    totalBytes_ -= it->second.decoded->pcm.size();
+    lru_.erase(it->second.position);
+    entries_.erase(it);
+  }
+  lru_.push_front(key.hash);
+  totalBytes_ += decoded->pcm.size();
+  // Move the reference into the entry, otherwise the argument is counted as a user at trimming.
+  entries_[key.hash] = Entry{key, std::move(decoded), lru_.begin()};
+  trimLocked();
+}
+
+void TrSoundCache::trim()
+{
+  lock_guard<mutex> lock(mutex_);
+  trimLocked();
+}
+
+size_t TrSoundCache::size()
+{
+  lock_guard<mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t TrSoundCache::totalBytes()
+{
+  lock_guard<mutex> lock(mutex_);
+  return totalBytes_;
+}
+
+TrSoundCache::Stats TrSoundCache::stats()
+{
+  lock_guard<mutex> lock(mutex_);
+  return stats_;
+}
+
+void TrSoundCache::trimLocked()
+{
+  // The entries in use are not counted in the budget, because evicting them releases no memory.
+  size_t unusedBytes = 0;
+  for (auto &it : entries_)
+  {
+    if (it.second.decoded.use_count() == 1)
+      unusedBytes += it.second.decoded->pcm.size();
+  }
+
+  auto it = lru_.end();
+  while (unusedBytes > budgetBytes_ && it != lru_.begin())
+  {
+    --it;
+    auto entryIt = entries_.find(*it);
+    auto &decoded = entryIt->second.decoded;
+    if (decoded.use_count() > 1)
+      continue;
+
+    size_t bytes = decoded->pcm.size();
+    unusedBytes -= bytes;
+    totalBytes_ -= bytes;
+    entries_.erase(entryIt);
+    it = lru_.erase(it);
+    stats_.evictions += 1;
+  }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "./sound_decoder.hpp"
+
+/**
+ * The cache of the decoded clips which are shared by the sound sources across the contents, such as the click sounds of the
+ * panels or the footsteps in a game, thus loading the same clip again costs neither the decoding nor the memory.
+ *
+ * An entry is keyed by the hash of the encoded data and the output format, and a hit is verified by the encoded size and a
+ * second hash, thus two clips of the same hash are not mixed up. The entries are reference-counted: the ones in use by any
+ * source are always kept, and the unused ones are kept until their total bytes exceed the budget, then the least recently
+ * used are evicted.
+ *
+ * The streaming clips are not cached because their decoders are stateful, see `TrSoundDecoder`. It's thread-safe.
+ */
+class TrSoundCache
+{
+public:
+  /**
+   * The default budget of the unused entries.
+   */
+  static constexpr size_t kDefaultBudgetBytes = 32 * 1024 * 1024;
+
+  /**
+   * The key of an entry, the `hash` is used to look up the entry and the others are compared to verify it.
+   */
+  struct Key
+  {
+    uint64_t hash = 0;
+    uint64_t checksum = 0;
+    size_t encodedBytes = 0;
+
+    inline bool operator==(const Key &other) const
+    {
+      return hash == other.hash && checksum == other.checksum && encodedBytes == other.encodedBytes;
+    }
+    inline bool operator!=(const Key &other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  struct Stats
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+
+  /**
+   * Compute the cache key of the encoded data decoded to the given format.
+   */
+  static Key ComputeKey(const char *data, size_t sizeInBytes, ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+
+public:
+  TrSoundCache(size_t budgetBytes = kDefaultBudgetBytes);
+
+public:
+  /**
+   * Find the decoded clip of the given key, and mark it as the most recently used.
+   *
+   * @returns The decoded clip, or `nullptr` if the key is missed or the entry of the same hash is another clip.
+   */
+  std::shared_ptr<const TrDecodedSound> find(const Key &key);
+  /**
+   * Insert the decoded clip of the given key, it replaces the existing entry of the same hash and evicts the unused entries
+   * if needed.
+   */
+  void insert(const Key &key, std::shared_ptr<const TrDecodedSound> decoded);
+  /**
+   * Evict the unused entries until their total bytes fit the budget, it should be called when a source releases its clip.
+   */
+  void trim();
+
+public:
+  /**
+   * @returns The count of the entries.
+   */
+  size_t size();
+  /**
+   * @returns The total bytes of the entries, including the ones in use.
+   */
+  size_t totalBytes();
+  Stats stats();
+
+private:
+  struct Entry
+  {
+    Key key;
+    std::shared_ptr<const TrDecodedSound> decoded;
+    std::list<uint64_t>::iterator position;
+  };
+
+  void trimLocked();
+
+private:
+  size_t budgetBytes_;
+  size_t totalBytes_ = 0;
+  // The keys from the most recently used to the least recently used.
+  std::list<uint64_t> lru_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  Stats stats_;
+  std::mutex mutex_;
+};
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "./sound_decoder.hpp"
+
+using namespace std;
+
+unique_ptr<TrSoundDecoder> TrSoundDecoder::Make(const char *data,
+                                                size_t sizeInBytes,
+                                                ma_format format,
+                                                ma_uint32 channels,
+                                                ma_uint32 sampleRate,
+                                                size_t fullDecodeMaxBytes)
+{
+  if (data == nullptr || sizeInBytes == 0)
+    return nullptr;
+
+  auto startedAt = chrono::steady_clock::now();
+  unique_ptr<TrSoundDecoder> soundDecoder(new TrSoundDecoder(format, channels, sampleRate));
+  soundDecoder->encoded_.assign(data, data + sizeInBytes);
+  soundDecoder->decoder_ = make_unique<ma_decoder>();
+
+  // The decoder reads the encoded data in place, thus it must be initialized from the copy owned by the sound decoder.
+  ma_decoder *pDecoder = soundDecoder->decoder_.get();
+  ma_decoder_config decoderConfig = ma_decoder_config_init(format, channels, sampleRate);
+  if (ma_decoder_init_memory(soundDecoder->encoded_.data(), sizeInBytes, &decoderConfig, pDecoder) != MA_SUCCESS)
+  {
+    soundDecoder->decoder_ = nullptr;
+    return nullptr;
+  }
+  if (ma_decoder_get_length_in_pcm_frames(pDecoder, &soundDecoder->lengthInFrames_) != MA_SUCCESS)
+    soundDecoder->lengthInFrames_ = 0;
+
+  auto &metrics = soundDecoder->metrics_;
+  size_t pcmBytes = soundDecoder->lengthInFrames_ * soundDecoder->bytesPerFrame_;
+  if (soundDecoder->lengthInFrames_ > 0 && pcmBytes <= fullDecodeMaxBytes)
+  {
+    auto decoded = make_shared<TrDecodedSound>();
+    decoded->format = format;
+    decoded->channels = channels;
+    decoded->sampleRate = sampleRate;
+    decoded->pcm.resize(pcmBytes);
+
+    ma_uint64 framesRead = 0;
+    ma_decoder_read_pcm_frames(pDecoder, decoded->pcm.data(), soundDecoder->lengthInFrames_, &framesRead);
+    decoded->framesCount = framesRead;
+    decoded->pcm.resize(framesRead * soundDecoder->bytesPerFrame_);
+    decoded->pcm.shrink_to_fit();
+    soundDecoder->lengthInFrames_ = framesRead;
+    soundDecoder->decoded_ = decoded;
+
+    // The encoded data is not needed anymore.
+    ma_decoder_uninit(pDecoder);
+    soundDecoder->decoder_ = nullptr;
+    soundDecoder->encoded_.clear();
+    soundDecoder->encoded_.shrink_to_fit();
+    metrics.mode = TrSoundDecodeMode::kFull;
+  }
+  else
+  {
+    soundDecoder->pcm_.resize(static_cast<size_t>(kPageFrames) * kPagesCount * soundDecoder->bytesPerFrame_);
+    soundDecoder->pump();
+    metrics.mode = TrSoundDecodeMode::kStreaming;
+  }
+
+  metrics.encodedBytes = soundDecoder->encoded_.size();
+  metrics.pcmBytes = metrics.mode == TrSoundDecodeMode::kFull
+                       ? soundDecoder->decoded_->pcm.size()
+                       : soundDecoder->pcm_.size();
+  metrics.loadDuration = chrono::duration<double, milli>(chrono::steady_clock::now() - startedAt).count();
+  return soundDecoder;
+}
+
+unique_ptr<TrSoundDecoder> TrSoundDecoder::Make(shared_ptr<const TrDecodedSound> decoded)
+{
+  if (decoded == nullptr)
+    return nullptr;
+
+  auto startedAt = chrono::steady_clock::now();
+  unique_ptr<TrSoundDecoder> soundDecoder(new TrSoundDecoder(decoded->format, decoded->channels, decoded->sampleRate));
+  soundDecoder->lengthInFrames_ = decoded->framesCount;
+  soundDecoder->decoded_ = decoded;
+
+  auto &metrics = soundDecoder->metrics_;
+  metrics.mode = TrSoundDecodeMode::kFull;
+  metrics.pcmBytes = decoded->pcm.size();
+  metrics.shared = true;
+  metrics.loadDuration = chrono::duration<double, milli>(chrono::steady_clock::now() - startedAt).count();
+  return soundDecoder;
+}
+
+TrSoundDecoder::TrSoundDecoder(ma_format format, ma_uint32 channels, ma_uint32 sampleRate)
+    : format_(format)
+    , channels_(channels)
+    , sampleRate_(sampleRate)
+    , bytesPerFrame_(ma_get_bytes_per_frame(format, channels))
+{
+  static ma_data_source_vtable vtable = {
+    OnRead,
+    OnSeek,
+    OnGetDataFormat,
+    OnGetCursor,
+    OnGetLength,
+    nullptr, // onSetLooping
+    0,       // flags
+  };
+
+  source_.self = this;
+  ma_data_source_config sourceConfig = ma_data_source_config_init();
+  sourceConfig.vtable = &vtable;
+  ma_data_source_init(&sourceConfig, &source_.base);
+}
+
+TrSoundDecoder::~TrSoundDecoder()
+{
+  ma_data_source_uninit(&source_.base);
+  if (decoder_ != nullptr)
+    ma_decoder_uninit(decoder_.get());
+}
+
+double TrSoundDecoder::duration() const
+{
+  return sampleRate_ == 0 ? 0.0 : static_cast<double>(lengthInFrames_) / sampleRate_;
+}
+
+void TrSoundDecoder::pump()
+{
+  if (decoder_ == nullptr)
+    return;
+
+  // Apply the seek which is requested by the audio thread since the last pump.
+  uint64_t generation = generation_.load(memory_order_acquire);
+  if (generation != decoderGeneration_)
+  {
+    ma_uint64 target = seekTarget_.load(memory_order_relaxed);
+    decoderGeneration_ = generation;
+    decoderAtEnd_ = ma_decoder_seek_to_pcm_frame(decoder_.get(), target) != MA_SUCCESS;
+    decoderCursor_ = target;
+    if (decoderAtEnd_)
+      endedGeneration_.store(generation, memory_order_release);
+  }
+
+  while (!decoderAtEnd_ &&
+         writtenPages_.load(memory_order_relaxed) - readPages_.load(memory_order_acquire) < kPagesCount)
+    decodePage(generation);
+}
+
+ma_uint64 TrSoundDecoder::read(uint8_t *out, ma_uint64 frameCount, bool &atEnd)
+{
+  ma_uint64 framesRead = 0;
+  atEnd = false;
+  if (decoder_ == nullptr)
+  {
+    ma_uint64 cursor = cursor_.load(memory_order_relaxed);
+    if (cursor < lengthInFrames_)
+    {
+      framesRead = std::min(frameCount, lengthInFrames_ - cursor);
+      if (out != nullptr)
+        memcpy(out, decoded_->pcm.data() + cursor * bytesPerFrame_, framesRead * bytesPerFrame_);
+      cursor_.store(cursor + framesRead, memory_order_relaxed);
+    }
+    atEnd = framesRead < frameCount;
+    return framesRead;
+  }
+
+  uint64_t generation = generation_.load(memory_order_relaxed);
+  while (framesRead < frameCount)
+  {
+    // The ended generation is loaded before the written pages, thus the pages published before the end are visible.
+    bool ended = endedGeneration_.load(memory_order_acquire) == generation;
+    uint64_t readPages = readPages_.load(memory_order_relaxed);
+    if (readPages == writtenPages_.load(memory_order_acquire))
+    {
+      if (ended)
+      {
+        atEnd = true;
+        break;
+      }
+      // No page is ready, output the silence instead of decoding at the audio thread.
+      metrics_.underruns++;
+      if (out != nullptr)
+        memset(out + framesRead * bytesPerFrame_, 0, (frameCount - framesRead) * bytesPerFrame_);
+      return frameCount;
+    }
+
+    size_t pageIndex = readPages % kPagesCount;
+    const Page &page = pages_[pageIndex];
+    if (page.generation != generation)
+    {
+      // The page is decoded before the last seek.
+      readFrameInPage_ = 0;
+      readPages_.store(readPages + 1, memory_order_release);
+      continue;
+    }
+
+    ma_uint32 framesInPage = page.framesCount - readFrameInPage_;
+    ma_uint64 framesToCopy = std::min(static_cast<ma_uint64>(framesInPage), frameCount - framesRead);
+    size_t pageOffset = (pageIndex * kPageFrames + readFrameInPage_) * bytesPerFrame_;
+    if (out != nullptr)
+      memcpy(out + framesRead * bytesPerFrame_, pcm_.data() + pageOffset, framesToCopy * bytesPerFrame_);
+    framesRead += framesToCopy;
+    readFrameInPage_ += static_cast<ma_uint32>(framesToCopy);
+    cursor_.store(page.firstFrame + readFrameInPage_, memory_order_relaxed);
+    if (readFrameInPage_ == page.framesCount)
+    {
+      readFrameInPage_ = 0;
+      readPages_.store(readPages + 1, memory_order_release);
+    }
+  }
+  return framesRead;
+}
+
+bool TrSoundDecoder::seek(ma_uint64 frameIndex)
+{
+  if (lengthInFrames_ > 0 && frameIndex > lengthInFrames_)
+    return false;
+
+  cursor_.store(frameIndex, memory_order_relaxed);
+  if (decoder_ == nullptr)
+    return true;
+
+  // Request the decoder to seek at the next pump, and drop the ready pages which are decoded before this seek.
+  seekTarget_.store(frameIndex, memory_order_relaxed);
+  generation_.fetch_add(1, memory_order_release);
+  readFrameInPage_ = 0;
+  readPages_.store(writtenPages_.load(memory_order_acquire), memory_order_release);
+  return true;
+}
+
+void TrSoundDecoder::decodePage(uint64_t generation)
+{
+  uint64_t writtenPages = writtenPages_.load(memory_order_relaxed);
+  size_t pageIndex = writtenPages % kPagesCount;
+  ma_uint64 framesRead = 0;
+  ma_result result = ma_decoder_read_pcm_frames(decoder_.get(),
+                                                pcm_.data() + pageIndex * kPageFrames * bytesPerFrame_,
+                                                kPageFrames,
+                                                &framesRead);
+  if (framesRead > 0)
+  {
+    Page &page = pages_[pageIndex];
+    page.firstFrame = decoderCursor_;
+    page.framesCount = static_cast<ma_uint32>(framesRead);
+    page.generation = generation;
+    decoderCursor_ += framesRead;
+    writtenPages_.store(writtenPages + 1, memory_order_release);
+  }
+
+  if (result != MA_SUCCESS || framesRead < kPageFrames)
+  {
+    // The looping clip continues from the start without a seek at the audio thread, unless it's empty.
+    bool looping = ma_data_source_is_looping(&source_.base) == MA_TRUE;
+    if (looping && (framesRead > 0 || decoderCursor_ > 0) &&
+        ma_decoder_seek_to_pcm_frame(decoder_.get(), 0) == MA_SUCCESS)
+    {
+      decoderCursor_ = 0;
+    }
+    else
+    {
+      decoderAtEnd_ = true;
+      endedGeneration_.store(generation, memory_order_release);
+    }
+  }
+}
+
+ma_result TrSoundDecoder::OnRead(ma_data_source *pDataSource, void *pFramesOut, ma_uint64 frameCount, ma_uint64 *pFramesRead)
+{
+  auto self = reinterpret_cast<Source *>(pDataSource)->self;
+  bool atEnd = false;
+  ma_uint64 framesRead = self->read(static_cast<uint8_t *>(pFramesOut), frameCount, atEnd);
+  if (pFramesRead != nullptr)
+    *pFramesRead = framesRead;
+  return atEnd ? MA_AT_END : MA_SUCCESS;
+}
+
+ma_result TrSoundDecoder::OnSeek(ma_data_source *pDataSource, ma_uint64 frameIndex)
+{
+  auto self = reinterpret_cast<Source *>(pDataSource)->self;
+  return self->seek(frameIndex) ? MA_SUCCESS : MA_INVALID_OPERATION;
+}
+
+ma_result TrSoundDecoder::OnGetDataFormat(ma_data_source *pDataSource, ma_format *pFormat, ma_uint32 *pChannels,
+                                          ma_uint32 *pSampleRate, ma_channel *pChannelMap, size_t channelMapCap)
+{
+  auto self = reinterpret_cast<Source *>(pDataSource)->self;
+  if (pFormat != nullptr)
+    *pFormat = self->format_;
+  if (pChannels != nullptr)
+    *pChannels = self->channels_;
+  if (pSampleRate != nullptr)
+    *pSampleRate = self->sampleRate_;
+  if (pChannelMap != nullptr)
+    ma_channel_map_init_standard(ma_standard_channel_map_default, pChannelMap, channelMapCap, self->channels_);
+  return MA_SUCCESS;
+}
+
+ma_result TrSoundDecoder::OnGetCursor(ma_data_source *pDataSource, ma_uint64 *pCursor)
+{
+  auto self = reinterpret_cast<Source *>(pDataSource)->self;
+  *pCursor = self->cursor_.load(memory_order_relaxed);
+  return MA_SUCCESS;
+}
+
+ma_result TrSoundDecoder::OnGetLength(ma_data_source *pDataSource, ma_uint64 *pLength)
+{
+  auto self = reinterpret_cast<Source *>(pDataSource)->self;
+  *pLength = self->lengthInFrames_;
+  return self->lengthInFrames_ == 0 ? MA_NOT_IMPLEMENTED : MA_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <miniaudio/miniaudio.h>
+
+/**
+ * How the PCM frames of a sound are produced from its encoded data.
+ */
+enum class TrSoundDecodeMode
+{
+  /**
+   * The whole clip is decoded at loading, it's used for the short clips such as the sound effects which are played
+   * frequently and should start without any decoding work.
+   */
+  kFull,
+  /**
+   * The clip is decoded incrementally into a small ring of PCM pages while playing, it's used for the long clips such as
+   * the music tracks to avoid the memory of the full PCM and the stall of decoding at loading.
+   */
+  kStreaming,
+};
+
+/**
+ * The fully decoded PCM frames of a clip, it's immutable after decoding thus could be shared by the decoders of the sources
+ * which load the same clip, see `TrSoundCache`.
+ */
+struct TrDecodedSound
+{
+  ma_format format;
+  ma_uint32 channels;
+  ma_uint32 sampleRate;
+  ma_uint64 framesCount;
+  std::vector<uint8_t> pcm;
+};
+
+/**
+ * The memory and latency metrics of a sound decoder.
+ */
+struct TrSoundDecodeMetrics
+{
+  TrSoundDecodeMode mode = TrSoundDecodeMode::kFull;
+  /**
+   * The bytes of the encoded data which is kept by the decoder, it's 0 in the full mode because the encoded data is released
+   * after decoding.
+   */
+  size_t encodedBytes = 0;
+  /**
+   * The bytes of the PCM frames which are kept by the decoder, namely the whole clip in the full mode and the pages in the
+   * streaming mode.
+   */
+  size_t pcmBytes = 0;
+  /**
+   * If the decoded clip is shared from the cache instead of decoded by this decoder.
+   */
+  bool shared = false;
+  /**
+   * The milliseconds from the encoded data is received to the first frame is ready to play.
+   */
+  double loadDuration = 0.0;
+  /**
+   * The count of the reads which found no decoded page and output the silence, it should be 0 if the pages are pumped in
+   * time.
+   */
+  std::atomic<uint32_t> underruns = 0;
+};
+
+/**
+ * The sound decoder which is the miniaudio data source of a `TrSoundSource`, it owns the encoded data and decodes it in the
+ * mode picked by the size of the decoded clip.
+ *
+ * In the streaming mode, the pages are a single-producer single-consumer queue: `pump()` decodes the consumed pages at a
+ * worker thread, and the engine reads the ready pages at the audio thread without locks or decoding, it outputs the silence
+ * if no page is ready. A seek at the audio thread drops the ready pages and is applied to the decoder at the next pump.
+ */
+class TrSoundDecoder
+{
+public:
+  /**
+   * The clips whose decoded PCM is not larger than this are fully decoded, it's about 3 seconds of the stereo f32 frames at
+   * 44.1kHz.
+   */
+  static constexpr size_t kDefaultFullDecodeMaxBytes = 1024 * 1024;
+  /**
+   * The frames of a page and the count of the pages in the streaming mode, which holds about 370ms at 44.1kHz.
+   */
+  static constexpr ma_uint32 kPageFrames = 4096;
+  static constexpr size_t kPagesCount = 4;
+
+  /**
+   * Create a decoder from the encoded data, the data is copied thus the caller could release it after this call.
+   *
+   * @param data The encoded data, such as WAV, MP3 or FLAC.
+   * @param sizeInBytes The size of the encoded data.
+   * @param format The output format of the PCM frames.
+   * @param channels The output channels of the PCM frames.
+   * @param sampleRate The output sample rate of the PCM frames.
+   * @param fullDecodeMaxBytes The maximum bytes of the decoded PCM to be fully decoded, the larger clips and the clips whose
+   *                           length is unknown are streamed.
+   * @returns The decoder, or `nullptr` if the data could not be decoded.
+   */
+  static std::unique_ptr<TrSoundDecoder> Make(const char *data,
+                                              size_t sizeInBytes,
+                                              ma_format format,
+                                              ma_uint32 channels,
+                                              ma_uint32 sampleRate,
+                                              size_t fullDecodeMaxBytes = kDefaultFullDecodeMaxBytes);
+  /**
+   * Create a decoder in the full mode which reads the shared decoded clip.
+   */
+  static std::unique_ptr<TrSoundDecoder> Make(std::shared_ptr<const TrDecodedSound> decoded);
+
+public:
+  ~TrSoundDecoder();
+
+public:
+  /**
+   * @returns The data source to initialize the `ma_sound`.
+   */
+  inline ma_data_source *dataSource()
+  {
+    return &source_;
+  }
+  inline TrSoundDecodeMode mode() const
+  {
+    return metrics_.mode;
+  }
+  inline const TrSoundDecodeMetrics &metrics() const
+  {
+    return metrics_;
+  }
+  /**
+   * @returns The decoded clip in the full mode, or `nullptr` in the streaming mode.
+   */
+  inline std::shared_ptr<const TrDecodedSound> decodedSound() const
+  {
+    return decoded_;
+  }
+  /**
+   * @returns The duration of the clip in seconds, or 0 if the length is unknown.
+   */
+  double duration() const;
+  /**
+   * Decode the consumed pages ahead in the streaming mode, it does nothing in the full mode.
+   *
+   * NOTE: It must be called from one thread at a time, which is not the audio thread.
+   */
+  void pump();
+
+private:
+  struct Source
+  {
+    // It must be the first member to be used as `ma_data_source`.
+    ma_data_source_base base;
+    TrSoundDecoder *self;
+  };
+
+  static ma_result OnRead(ma_data_source *pDataSource, void *pFramesOut, ma_uint64 frameCount, ma_uint64 *pFramesRead);
+  static ma_result OnSeek(ma_data_source *pDataSource, ma_uint64 frameIndex);
+  static ma_result OnGetDataFormat(ma_data_source *pDataSource, ma_format *pFormat, ma_uint32 *pChannels,
+                                   ma_uint32 *pSampleRate, ma_channel *pChannelMap, size_t channelMapCap);
+  static ma_result OnGetCursor(ma_data_source *pDataSource, ma_uint64 *pCursor);
+  static ma_result OnGetLength(ma_data_source *pDataSource, ma_uint64 *pLength);
+
+private:
+  TrSoundDecoder(ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+
+  ma_uint64 read(uint8_t *out, ma_uint64 frameCount, bool &atEnd);
+  bool seek(ma_uint64 frameIndex);
+  void decodePage(uint64_t generation);
+
+private:
+  Source source_;
+  ma_format format_;
+  ma_uint32 channels_;
+  ma_uint32 sampleRate_;
+  ma_uint32 bytesPerFrame_;
+  ma_uint64 lengthInFrames_ = 0;
+  std::atomic<ma_uint64> cursor_ = 0;
+
+  // The encoded data and its decoder, which are kept in the streaming mode only and used by the pumping thread.
+  std::vector<char> encoded_;
+  std::unique_ptr<ma_decoder> decoder_ = nullptr;
+  ma_uint64 decoderCursor_ = 0;
+  uint64_t decoderGeneration_ = 0;
+  bool decoderAtEnd_ = false;
+
+  // The whole clip in the full mode, which could be shared with the other decoders.
+  std::shared_ptr<const TrDecodedSound> decoded_ = nullptr;
+  // The pages in the streaming mode, a page is written by the pumping thread until it's published by `writtenPages_`, then
+  // it's read by the audio thread until it's released by `readPages_`.
+  struct Page
+  {
+    ma_uint64 firstFrame = 0;
+    ma_uint32 framesCount = 0;
+    // The seek generation which the page is decoded at, the pages of the former generations are dropped.
+    uint64_t generation = 0;
+  };
+  std::vector<uint8_t> pcm_;
+  Page pages_[kPagesCount];
+  std::atomic<uint64_t> writtenPages_ = 0;
+  std::atomic<uint64_t> readPages_ = 0;
+  ma_uint32 readFrameInPage_ = 0;
+  // The seek requested by the audio thread, it's applied to the decoder at the next pump.
+  std::atomic<uint64_t> generation_ = 0;
+  std::atomic<ma_uint64> seekTarget_ = 0;
+  // The generation whose last page is published, namely the reads of this generation are at the end after the ready pages.
+  std::atomic<uint64_t> endedGeneration_ = UINT64_MAX;
+
+  TrSoundDecodeMetrics metrics_;
+};
@@ -266,6 +266,18 @@ static void OnPlatformSetup(UnityEmbedder *embedder)
         strcmp(enablePrintAppContextSummaryStr, "yes") == 0)
         renderer->enableAppContextSummary();
 
+      char disableStatesEliminationStr[PROP_VALUE_MAX];
+      if (
+        __system_property_get("jsar.renderer.disable_states_elimination", disableStatesEliminationStr) >= 0 &&
+        strcmp(disableStatesEliminationStr, "yes") == 0)
+        renderer->disableRedundantStatesElimination();
+
+      char disableShadowValidationStr[PROP_VALUE_MAX];
+      if (
+        __system_property_get("jsar.renderer.disable_shadow_validation", disableShadowValidationStr) >= 0 &&
+        strcmp(disableShadowValidationStr, "yes") == 0)
+        renderer->disableShadowValidation();
+
       char logfilter[PROP_VALUE_MAX];
       if (__system_property_get("jsar.renderer.logfilter", logfilter) >= 0)
         renderer->setLogFilter(logfilter);
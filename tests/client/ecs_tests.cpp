@@ -1,5 +1,9 @@
 #define CATCH_CONFIG_MAIN
 #include "../catch2/catch_amalgamated.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include <client/builtin_scene/ecs.hpp>
 #include <client/builtin_scene/ecs-inl.hpp>
 
@@ -183,3 +187,272 @@ TEST_CASE("Test chaining systems", "[ecs]")
   REQUIRE(systemSecond->executed);
   REQUIRE(systemThird->executed);
 }
+
+TEST_CASE("Query entities via the cached query", "[ecs]")
+{
+  auto app = std::make_shared<App>();
+  app->registerComponent<TestComponent>();
+  app->registerComponent<TestComponent2>();
+
+  auto a = app->spawn(TestComponent{1});
+  auto b = app->spawn(TestComponent{2}, TestComponent2{2.0f});
+  auto c = app->spawn(TestComponent2{3.0f});
+
+  auto sumOf = [&app]()
+  {
+    int sum = 0;
+    app->forEach<TestComponent>([&sum](EntityId, TestComponent &component)
+                                { sum += component.value; });
+    return sum;
+  };
+  REQUIRE(sumOf() == 3);
+
+  int matched = 0;
+  app->forEach<TestComponent, TestComponent2>([&](EntityId entity, TestComponent &component, TestComponent2 &component2)
+                                              {
+                                                REQUIRE(entity == b);
+                                                REQUIRE(component2.value == 2.0f);
+                                                component.value = 20;
+                                                matched += 1; });
+  REQUIRE(matched == 1);
+  REQUIRE(app->getComponent<TestComponent>(b)->value == 20);
+  REQUIRE(sumOf() == 21);
+
+  // The cached query follows the component changes and the new archetypes.
+  app->addComponent(c, TestComponent{300});
+  REQUIRE(sumOf() == 321);
+  app->replaceComponent(a, TestComponent{1000});
+  REQUIRE(sumOf() == 1320);
+  app->removeComponent<TestComponent>(b);
+  REQUIRE(sumOf() == 1300);
+  app->removeEntity(c);
+  REQUIRE(sumOf() == 1000);
+  REQUIRE(app->queryEntities<TestComponent>().size() == 1);
+}
+
+/**
+ * Run with `TransmuteUnitTests "[benchmark]"` to compare the cost of querying and iterating the entities with the components.
+ */
+TEST_CASE("ECS query and iteration", "[.][benchmark]")
+{
+  for (int entitiesCount : {1000, 10000, 50000})
+  {
+    auto app = std::make_shared<App>();
+    app->registerComponent<TestComponent>();
+    app->registerComponent<TestComponent2>();
+    for (int i = 0; i < entitiesCount; i++)
+    {
+      if (i % 4 == 0)
+        app->spawn(TestComponent{i});
+      else
+        app->spawn(TestComponent{i}, TestComponent2{1.0f});
+    }
+
+    BENCHMARK("queryEntitiesWithComponent (" + std::to_string(entitiesCount) + " entities)")
+    {
+      float sum = 0;
+      for (auto &item : app->queryEntitiesWithComponent<TestComponent2, TestComponent2>())
+        sum += item.second->value;
+      return sum;
+    };
+    BENCHMARK("forEach (" + std::to_string(entitiesCount) + " entities)")
+    {
+      float sum = 0;
+      app->forEach<TestComponent2>([&sum](EntityId, TestComponent2 &component)
+                                   { sum += component.value; });
+      return sum;
+    };
+  }
+}
+
+class AccessTestSystem : public System
+{
+public:
+  AccessTestSystem(std::function<void()> fn)
+      : fn(fn)
+  {
+  }
+
+  const std::string name() const override
+  {
+    return "AccessTestSystem";
+  }
+  void onExecute() override
+  {
+    threadId = std::this_thread::get_id();
+    fn();
+  }
+
+  template <typename T>
+  inline void reads()
+  {
+    declareRead<T>();
+  }
+  template <typename T>
+  inline void writes()
+  {
+    declareWrite<T>();
+  }
+
+  std::function<void()> fn;
+  std::thread::id threadId;
+};
+
+TEST_CASE("SystemAccess detects the conflicts", "[ecs]")
+{
+  SystemAccess exclusive;
+  SystemAccess readA, readA2, writeA, writeB;
+  readA.addRead<TestComponent>();
+  readA2.addRead<TestComponent>();
+  writeA.addWrite<TestComponent>();
+  writeB.addWrite<TestComponent2>();
+
+  REQUIRE(exclusive.conflictsWith(readA));
+  REQUIRE_FALSE(readA.conflictsWith(readA2));
+  REQUIRE(readA.conflictsWith(writeA));
+  REQUIRE(writeA.conflictsWith(readA));
+  REQUIRE_FALSE(writeA.conflictsWith(writeB));
+
+  SystemAccess chained = writeB;
+  chained.merge(readA);
+  REQUIRE(chained.conflictsWith(writeA));
+  chained.merge(exclusive);
+  REQUIRE_FALSE(chained.isDeclared());
+}
+
+TEST_CASE("Parallel scheduling runs the non-conflicting systems concurrently", "[ecs]")
+{
+  auto app = std::make_shared<Example>();
+  app->enableParallelScheduling(2);
+
+  // Each system waits for the other one to start, which only returns in time when they run concurrently.
+  std::atomic<int> started = 0;
+  auto rendezvous = [&started]()
+  {
+    started.fetch_add(1);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (started.load() < 2 && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::yield();
+  };
+  auto systemA = System::Make<AccessTestSystem>(rendezvous);
+  auto systemB = System::Make<AccessTestSystem>(rendezvous);
+  systemA->writes<TestComponent>();
+  systemB->writes<TestComponent2>();
+
+  // The undeclared system is exclusive, it runs after both at the updating thread.
+  int startedWhenExclusive = 0;
+  auto exclusiveSystem = System::Make<AccessTestSystem>([&started, &startedWhenExclusive]()
+                                                        { startedWhenExclusive = started.load(); });
+
+  app->addSystem(SchedulerLabel::kUpdate, systemA);
+  app->addSystem(SchedulerLabel::kUpdate, systemB);
+  app->addSystem(SchedulerLabel::kUpdate, exclusiveSystem);
+  app->start();
+
+  REQUIRE(started.load() == 2);
+  REQUIRE(systemA->threadId != systemB->threadId);
+  REQUIRE(startedWhenExclusive == 2);
+  REQUIRE(exclusiveSystem->threadId == std::this_thread::get_id());
+}
+
+TEST_CASE("Parallel scheduling keeps the order of the conflicting systems", "[ecs]")
+{
+  auto app = std::make_shared<Example>();
+  app->enableParallelScheduling(4);
+
+  std::vector<int> order;
+  std::mutex mutexForOrder;
+  auto record = [&order, &mutexForOrder](int value)
+  {
+    return [&order, &mutexForOrder, value]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      std::lock_guard<std::mutex> lock(mutexForOrder);
+      order.push_back(value);
+    };
+  };
+  auto writer = System::Make<AccessTestSystem>(record(1));
+  auto reader = System::Make<AccessTestSystem>(record(2));
+  auto rewriter = System::Make<AccessTestSystem>(record(3));
+  writer->writes<TestComponent>();
+  reader->reads<TestComponent>();
+  rewriter->writes<TestComponent>();
+
+  app->addSystem(SchedulerLabel::kUpdate, writer);
+  app->addSystem(SchedulerLabel::kUpdate, reader);
+  app->addSystem(SchedulerLabel::kUpdate, rewriter);
+  for (int i = 0; i < 10; i++)
+  {
+    order.clear();
+    app->start();
+    REQUIRE(order == std::vector<int>{1, 2, 3});
+  }
+}
+
+TEST_CASE("Iterate the entities in parallel chunks", "[ecs]")
+{
+  auto app = std::make_shared<App>();
+  app->registerComponent<TestComponent>();
+  app->registerComponent<TestComponent2>();
+  app->enableParallelScheduling(4);
+
+  for (int i = 0; i < 10000; i++)
+  {
+    if (i % 2 == 0)
+      app->spawn(TestComponent{1});
+    else
+      app->spawn(TestComponent{1}, TestComponent2{1.0f});
+  }
+
+  std::atomic<int> sum = 0;
+  app->parallelForEach<TestComponent>([&sum](EntityId, TestComponent &component)
+                                      {
+                                        component.value += 1;
+                                        sum.fetch_add(component.value, std::memory_order_relaxed); },
+                                      100);
+  REQUIRE(sum.load() == 20000);
+}
+
+class ParallelJobsTestSystem : public System
+{
+public:
+  const std::string name() const override
+  {
+    return "ParallelJobsTestSystem";
+  }
+  void onExecute() override
+  {
+    entities.clear();
+    forEach<TestComponent>([this](EntityId entity, TestComponent &)
+                           { entities.push_back(entity); });
+
+    // The exclusive system fans out the jobs of the collected entities to the pool, and joins them before returning.
+    auto pool = taskPool();
+    REQUIRE(pool != nullptr);
+    pool->parallelFor(entities.size(), [this](size_t i)
+                      {
+                        auto component = getComponent<TestComponent>(entities[i]);
+                        component->value *= 2; });
+  }
+
+  std::vector<EntityId> entities;
+};
+
+TEST_CASE("Run the jobs of a system on the app's task pool", "[ecs]")
+{
+  auto app = std::make_shared<Example>();
+  app->registerComponent<TestComponent>();
+  app->enableParallelScheduling(4);
+  for (int i = 0; i < 64; i++)
+    app->spawn(TestComponent{i});
+
+  auto system = System::Make<ParallelJobsTestSystem>();
+  app->addSystem(SchedulerLabel::kUpdate, system);
+  app->start();
+
+  int sum = 0;
+  app->forEach<TestComponent>([&sum](EntityId, TestComponent &component)
+                              { sum += component.value; });
+  REQUIRE(system->entities.size() == 64);
+  REQUIRE(sum == 2 * (63 * 64 / 2));
+}
@@ -0,0 +1,51 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <memory>
+#include <client/html/image_decode_cache.hpp>
+
+using namespace dom;
+
+using MockImage = std::shared_ptr<int>;
+
+TEST_CASE("ImageDecodeCache finds the images by the key", "[ImageDecodeCache]")
+{
+  ImageDecodeCache<MockImage> cache;
+  REQUIRE(cache.find("a.png@1024") == nullptr);
+
+  auto image = std::make_shared<int>(1);
+  cache.insert("a.png@1024", image, 4096);
+  REQUIRE(cache.find("a.png@1024") == image);
+  // The downscaled variants are cached by the target size.
+  REQUIRE(cache.find("a.png@512") == nullptr);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.totalBytes() == 4096);
+  REQUIRE(cache.stats().hits == 1);
+  REQUIRE(cache.stats().misses == 2);
+
+  // Replacing the image of the same key doesn't count the bytes twice.
+  cache.insert("a.png@1024", std::make_shared<int>(2), 2048);
+  REQUIRE(*cache.find("a.png@1024") == 2);
+  REQUIRE(cache.totalBytes() == 2048);
+}
+
+TEST_CASE("ImageDecodeCache evicts the least recently used images over the budget", "[ImageDecodeCache]")
+{
+  ImageDecodeCache<MockImage> cache(3000);
+  cache.insert("a", std::make_shared<int>(1), 1000);
+  cache.insert("b", std::make_shared<int>(2), 1000);
+  cache.insert("c", std::make_shared<int>(3), 1000);
+  REQUIRE(cache.find("a") != nullptr); // "b" is the least recently used now.
+
+  cache.insert("d", std::make_shared<int>(4), 1500);
+  REQUIRE(cache.stats().evictions == 2);
+  REQUIRE(cache.find("b") == nullptr);
+  REQUIRE(cache.find("c") == nullptr);
+  REQUIRE(cache.find("a") != nullptr);
+  REQUIRE(cache.find("d") != nullptr);
+  REQUIRE(cache.totalBytes() == 2500);
+
+  // The image larger than the budget is not cached.
+  cache.insert("e", std::make_shared<int>(5), 4000);
+  REQUIRE(cache.find("e") == nullptr);
+  REQUIRE(cache.size() == 2);
+}
@@ -0,0 +1,111 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <future>
+#include <client/html/image_decode_scheduler.hpp>
+
+using namespace dom;
+
+// The decoded images are mocked as the shared integers.
+using MockImage = std::shared_ptr<int>;
+using MockScheduler = ImageDecodeScheduler<MockImage>;
+
+/**
+ * Block the only worker of the scheduler until the returned promise is fulfilled, thus the following jobs are queued.
+ */
+static std::shared_ptr<std::promise<void>> blockWorker(MockScheduler &scheduler)
+{
+  auto unblock = std::make_shared<std::promise<void>>();
+  auto started = std::make_shared<std::promise<void>>();
+  auto startedFuture = started->get_future();
+  auto decode = [unblock, started]() -> MockImage
+  {
+    started->set_value();
+    unblock->get_future().wait();
+    return nullptr;
+  };
+  scheduler.schedule("blocker", ImageDecodePriority::kLow, decode, [](const MockImage &) {});
+  startedFuture.wait();
+  return unblock;
+}
+
+TEST_CASE("ImageDecodeScheduler decodes by the priority", "[ImageDecodeScheduler]")
+{
+  std::mutex orderMutex;
+  std::vector<std::string> order;
+  std::promise<void> done;
+  int remaining = 4;
+
+  {
+    MockScheduler scheduler(1);
+    auto unblock = blockWorker(scheduler);
+
+    auto scheduleMock = [&](const std::string &key, ImageDecodePriority priority)
+    {
+      auto decode = [&order, &orderMutex, key]() -> MockImage
+      {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(key);
+        return std::make_shared<int>(static_cast<int>(order.size()));
+      };
+      auto callback = [&](const MockImage &)
+      {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        if (--remaining == 0)
+          done.set_value();
+      };
+      scheduler.schedule(key, priority, decode, callback);
+    };
+    scheduleMock("low", ImageDecodePriority::kLow);
+    scheduleMock("normal1", ImageDecodePriority::kNormal);
+    scheduleMock("visible", ImageDecodePriority::kVisible);
+    scheduleMock("normal2", ImageDecodePriority::kNormal);
+
+    // The image becomes visible while it's queued.
+    scheduler.prioritize("normal2", ImageDecodePriority::kVisible);
+    // Lowering the priority is ignored.
+    scheduler.prioritize("visible", ImageDecodePriority::kLow);
+    REQUIRE(scheduler.pendingJobs() == 5);
+
+    unblock->set_value();
+    done.get_future().wait();
+    REQUIRE(scheduler.stats().scheduled == 5);
+  }
+  REQUIRE(order == std::vector<std::string>{"visible", "normal2", "normal1", "low"});
+}
+
+TEST_CASE("ImageDecodeScheduler coalesces the same key", "[ImageDecodeScheduler]")
+{
+  MockScheduler scheduler(1);
+  auto unblock = blockWorker(scheduler);
+
+  std::atomic<int> decodes = 0;
+  auto decode = [&decodes]() -> MockImage
+  {
+    decodes++;
+    return std::make_shared<int>(42);
+  };
+
+  std::promise<MockImage> first;
+  std::promise<MockImage> second;
+  REQUIRE_FALSE(scheduler.schedule("a.png@1024", ImageDecodePriority::kNormal, decode, [&first](const MockImage &image)
+                                   { first.set_value(image); }));
+  REQUIRE(scheduler.schedule("a.png@1024", ImageDecodePriority::kVisible, decode, [&second](const MockImage &image)
+                             { second.set_value(image); }));
+
+  unblock->set_value();
+  auto firstImage = first.get_future().get();
+  auto secondImage = second.get_future().get();
+  REQUIRE(firstImage != nullptr);
+  REQUIRE(*firstImage == 42);
+  // Both the callbacks receive the same decoded image.
+  REQUIRE(firstImage == secondImage);
+  REQUIRE(decodes == 1);
+  REQUIRE(scheduler.stats().coalesced == 1);
+
+  // The key is decoded again after the job is done, the result is expected to be cached by the caller.
+  std::promise<void> third;
+  REQUIRE_FALSE(scheduler.schedule("a.png@1024", ImageDecodePriority::kNormal, decode, [&third](const MockImage &)
+                                   { third.set_value(); }));
+  third.get_future().wait();
+  REQUIRE(decodes == 2);
+}
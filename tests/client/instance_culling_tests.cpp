@@ -0,0 +1,82 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <client/builtin_scene/instance_culling.hpp>
+
+using namespace builtin_scene;
+
+// The local bounds of a unit plane which faces +Z.
+static const glm::vec3 kPlaneMin(-0.5f, -0.5f, 0.0f);
+static const glm::vec3 kPlaneMax(0.5f, 0.5f, 0.0f);
+
+/**
+ * The view projection matrix of a 90 degrees camera at the given position and looking at -Z.
+ */
+static glm::mat4 makeViewProjection(const glm::vec3 &position)
+{
+  auto projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+  auto view = glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  return projection * view;
+}
+
+static bool isInFrustum(const glm::mat4 &worldMatrix, const FrustumPlanes &planes)
+{
+  InstanceBounds bounds;
+  return bounds.isInFrustum(kPlaneMin, kPlaneMax, worldMatrix, planes);
+}
+
+TEST_CASE("InstanceBounds tests the instances against the view frustum", "[InstanceCulling]")
+{
+  auto planes = frustumPlanesForViews({makeViewProjection(glm::vec3(0.0f))});
+  REQUIRE(planes.has_value());
+
+  REQUIRE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f)), *planes));
+  // Behind the camera.
+  REQUIRE_FALSE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 5.0f)), *planes));
+  // Beyond the far plane.
+  REQUIRE_FALSE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -200.0f)), *planes));
+  // Scrolled out of the view, the frustum is 10m wide at 5m.
+  REQUIRE_FALSE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -20.0f, -5.0f)), *planes));
+  // Partially in the view.
+  REQUIRE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(5.2f, 0.0f, -5.0f)), *planes));
+  // The scaled instance is partially in the view.
+  auto scaled = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(7.0f, 0.0f, -5.0f)), glm::vec3(5.0f));
+  REQUIRE(isInFrustum(scaled, *planes));
+}
+
+TEST_CASE("InstanceBounds updates the world-space bounds when the instance is moved", "[InstanceCulling]")
+{
+  auto planes = frustumPlanesForViews({makeViewProjection(glm::vec3(0.0f))});
+  InstanceBounds bounds;
+
+  auto visible = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+  auto hidden = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 20.0f, -5.0f));
+  REQUIRE(bounds.isInFrustum(kPlaneMin, kPlaneMax, visible, *planes));
+  REQUIRE_FALSE(bounds.isInFrustum(kPlaneMin, kPlaneMax, hidden, *planes));
+  REQUIRE(bounds.isInFrustum(kPlaneMin, kPlaneMax, visible, *planes));
+
+  // The changed local bounds are applied.
+  REQUIRE(bounds.isInFrustum(glm::vec3(-0.5f, 14.0f, 0.0f), glm::vec3(0.5f, 16.0f, 0.0f), hidden, *planes) == false);
+  REQUIRE(bounds.isInFrustum(glm::vec3(-0.5f, -16.0f, 0.0f), glm::vec3(0.5f, -14.0f, 0.0f), hidden, *planes));
+}
+
+TEST_CASE("frustumPlanesForViews covers all the views", "[InstanceCulling]")
+{
+  REQUIRE_FALSE(frustumPlanesForViews({}).has_value());
+
+  auto left = makeViewProjection(glm::vec3(-1.0f, 0.0f, 0.0f));
+  auto right = makeViewProjection(glm::vec3(1.0f, 0.0f, 0.0f));
+  auto planes = frustumPlanesForViews({left, right});
+  REQUIRE(planes.has_value());
+
+  // Only in the right view.
+  auto onTheRight = glm::translate(glm::mat4(1.0f), glm::vec3(2.5f, 0.0f, -2.0f));
+  REQUIRE_FALSE(isInFrustum(onTheRight, *frustumPlanesForViews({left})));
+  REQUIRE(isInFrustum(onTheRight, *planes));
+  // Only in the left view.
+  auto onTheLeft = glm::translate(glm::mat4(1.0f), glm::vec3(-2.5f, 0.0f, -2.0f));
+  REQUIRE_FALSE(isInFrustum(onTheLeft, *frustumPlanesForViews({right})));
+  REQUIRE(isInFrustum(onTheLeft, *planes));
+  // Out of both the views.
+  REQUIRE_FALSE(isInFrustum(glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, -2.0f)), *planes));
+}
@@ -0,0 +1,67 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <vector>
+#include <client/builtin_scene/instance_slots.hpp>
+
+using namespace builtin_scene;
+
+using Ranges = std::vector<InstanceSlotRange>;
+
+TEST_CASE("InstanceDirtySlots coalesces the dirty slots into ranges", "[InstanceDirtySlots]")
+{
+  InstanceDirtySlots dirtySlots;
+  REQUIRE(dirtySlots.empty());
+  REQUIRE(dirtySlots.takeRanges(1000).empty());
+
+  // A single changed instance uploads a single slot.
+  dirtySlots.mark(500);
+  REQUIRE_FALSE(dirtySlots.empty());
+  REQUIRE(dirtySlots.takeRanges(1000) == Ranges{{500, 1}});
+  REQUIRE(dirtySlots.empty());
+
+  // The close slots are merged, and the duplicated marks are ignored.
+  dirtySlots.mark(12);
+  dirtySlots.mark(10);
+  dirtySlots.mark(10);
+  dirtySlots.mark(11);
+  dirtySlots.mark(10 + 2 + InstanceDirtySlots::kMaxMergeGap + 1);
+  dirtySlots.mark(900);
+  REQUIRE(dirtySlots.takeRanges(1000) == Ranges{{10, 8}, {900, 1}});
+
+  // The far slots are uploaded separately.
+  dirtySlots.mark(0);
+  dirtySlots.mark(1 + InstanceDirtySlots::kMaxMergeGap + 1);
+  REQUIRE(dirtySlots.takeRanges(1000) == Ranges{{0, 1}, {1 + InstanceDirtySlots::kMaxMergeGap + 1, 1}});
+}
+
+TEST_CASE("InstanceDirtySlots drops the slots out of the count", "[InstanceDirtySlots]")
+{
+  InstanceDirtySlots dirtySlots;
+
+  // The last slot is marked and then the list is shrunk.
+  dirtySlots.mark(3);
+  dirtySlots.mark(9);
+  REQUIRE(dirtySlots.takeRanges(9) == Ranges{{3, 1}});
+  REQUIRE(dirtySlots.empty());
+
+  // The slot could be marked again after taking.
+  dirtySlots.mark(9);
+  REQUIRE(dirtySlots.takeRanges(10) == Ranges{{9, 1}});
+}
+
+TEST_CASE("InstanceDirtySlots uploads all the slots after marking all", "[InstanceDirtySlots]")
+{
+  InstanceDirtySlots dirtySlots;
+  dirtySlots.mark(5);
+  dirtySlots.markAll();
+  dirtySlots.mark(7);
+  REQUIRE(dirtySlots.takeRanges(100) == Ranges{{0, 100}});
+  REQUIRE(dirtySlots.empty());
+  REQUIRE(dirtySlots.takeRanges(100).empty());
+
+  dirtySlots.mark(5);
+  dirtySlots.clear();
+  REQUIRE(dirtySlots.empty());
+  dirtySlots.mark(5);
+  REQUIRE(dirtySlots.takeRanges(100) == Ranges{{5, 1}});
+}
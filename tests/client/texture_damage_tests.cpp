@@ -0,0 +1,96 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <client/builtin_scene/texture_damage.hpp>
+
+using namespace builtin_scene;
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 32;
+
+TEST_CASE("TextureDamageTracker returns the full rect at the first take", "[TextureDamageTracker]")
+{
+  TextureDamageTracker tracker;
+  REQUIRE(tracker.hasDamage());
+
+  tracker.addDamage({10, 4, 5, 3});
+  auto &rects = tracker.take(kWidth, kHeight);
+  REQUIRE(rects.size() == 1);
+  REQUIRE(rects[0] == TextureDamageRect{0, 0, kWidth, kHeight});
+
+  // Nothing is painted since the last take.
+  REQUIRE_FALSE(tracker.hasDamage());
+  REQUIRE(tracker.take(kWidth, kHeight).empty());
+}
+
+TEST_CASE("TextureDamageTracker returns the painted rects", "[TextureDamageTracker]")
+{
+  TextureDamageTracker tracker;
+  tracker.take(kWidth, kHeight);
+
+  SECTION("a single region")
+  {
+    tracker.addDamage({10, 4, 5, 3});
+    auto &rects = tracker.take(kWidth, kHeight);
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0] == TextureDamageRect{10, 4, 5, 3});
+    REQUIRE(rects[0].area() == 15);
+  }
+
+  SECTION("the separated regions are sorted by rows")
+  {
+    tracker.addDamage({40, 20, 8, 4});
+    tracker.addDamage({1, 1, 2, 2});
+    auto &rects = tracker.take(kWidth, kHeight);
+    REQUIRE(rects.size() == 2);
+    REQUIRE(rects[0] == TextureDamageRect{1, 1, 2, 2});
+    REQUIRE(rects[1] == TextureDamageRect{40, 20, 8, 4});
+  }
+
+  SECTION("the overlapped regions are united")
+  {
+    tracker.addDamage({2, 8, 10, 2});
+    tracker.addDamage({8, 9, 10, 4});
+    auto &rects = tracker.take(kWidth, kHeight);
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0] == TextureDamageRect{2, 8, 16, 5});
+  }
+
+  SECTION("the regions are clipped by the content")
+  {
+    tracker.addDamage({-4, -4, 8, 8});
+    tracker.addDamage({60, 30, 10, 10});
+    tracker.addDamage({kWidth, 0, 4, 4});
+    tracker.addDamage({0, 0, 0, 4});
+    auto &rects = tracker.take(kWidth, kHeight);
+    REQUIRE(rects.size() == 2);
+    REQUIRE(rects[0] == TextureDamageRect{0, 0, 4, 4});
+    REQUIRE(rects[1] == TextureDamageRect{60, 30, 4, 2});
+  }
+
+  SECTION("the closest regions are merged over the limit")
+  {
+    for (int i = 0; i < 6; i++)
+      tracker.addDamage({4, i * 5, 4, 1});
+    tracker.addDamage({4, 31, 4, 1});
+    auto &rects = tracker.take(kWidth, kHeight);
+    REQUIRE(rects.size() == TextureDamageTracker::kMaxDamageRects);
+    REQUIRE(rects.front().y == 0);
+    REQUIRE(rects.back().y + rects.back().height == 32);
+  }
+
+  // The damage is taken, thus the same regions are not uploaded again.
+  REQUIRE(tracker.take(kWidth, kHeight).empty());
+}
+
+TEST_CASE("TextureDamageTracker returns the full rect after reset", "[TextureDamageTracker]")
+{
+  TextureDamageTracker tracker;
+  tracker.take(kWidth, kHeight);
+
+  tracker.addDamage({1, 1, 2, 2});
+  tracker.reset();
+  REQUIRE(tracker.hasDamage());
+  auto &rects = tracker.take(kWidth / 2, kHeight);
+  REQUIRE(rects.size() == 1);
+  REQUIRE(rects[0] == TextureDamageRect{0, 0, kWidth / 2, kHeight});
+}
@@ -0,0 +1,390 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <dlfcn.h>
+#include <client/graphics/webgl_shadow_state.hpp>
+
+using namespace client_graphics;
+
+TEST_CASE("WebGLShadowState answers the initial state", "[WebGLShadowState]")
+{
+  WebGLShadowState state;
+  state.resetViewport(0, 0, 800, 600);
+
+  REQUIRE(state.isEnabled(WEBGL_DITHER) == true);
+  REQUIRE(state.isEnabled(WEBGL_BLEND) == false);
+  REQUIRE(state.isEnabled(WEBGL_DEPTH_TEST) == false);
+  // RASTERIZER_DISCARD is not a capability of WebGL 1.0.
+  REQUIRE_FALSE(state.isEnabled(WEBGL2_RASTERIZER_DISCARD).has_value());
+
+  REQUIRE(state.getBoolean(WEBGL_DEPTH_WRITEMASK) == true);
+  REQUIRE(state.getBooleanv(WEBGL_COLOR_WRITEMASK) == std::array<bool, 4>{true, true, true, true});
+  REQUIRE(state.getInteger(WEBGL_ACTIVE_TEXTURE) == WEBGL_TEXTURE0);
+  REQUIRE(state.getInteger(WEBGL_DEPTH_FUNC) == WEBGL_LESS);
+  REQUIRE(state.getInteger(WEBGL_BLEND_SRC_RGB) == WEBGL_ONE);
+  REQUIRE(state.getInteger(WEBGL_UNPACK_ALIGNMENT) == 4);
+  REQUIRE(state.getInteger(WEBGL_UNPACK_COLORSPACE_CONVERSION_WEBGL) == WEBGL_BROWSER_DEFAULT_WEBGL);
+  REQUIRE(state.getFloat(WEBGL_DEPTH_CLEAR_VALUE) == 1.0f);
+  REQUIRE(state.getFloatv(WEBGL_VIEWPORT) == std::vector<float>{0, 0, 800, 600});
+  REQUIRE(state.getFloatv(WEBGL_SCISSOR_BOX) == std::vector<float>{0, 0, 800, 600});
+  REQUIRE(state.getFloatv(WEBGL_DEPTH_RANGE) == std::vector<float>{0, 1});
+
+  // The answers depend on the framebuffer, thus they are not shadowed.
+  REQUIRE_FALSE(state.getInteger(WEBGL_STENCIL_REF).has_value());
+  REQUIRE_FALSE(state.getInteger(WEBGL_STENCIL_VALUE_MASK).has_value());
+  REQUIRE_FALSE(state.getInteger(WEBGL_DEPTH_BITS).has_value());
+  REQUIRE_FALSE(state.getFloat(WEBGL_SAMPLE_COVERAGE_VALUE).has_value());
+}
+
+TEST_CASE("WebGLShadowState ignores the calls that the GL rejects", "[WebGLShadowState]")
+{
+  WebGLShadowState state;
+  state.setMaxCombinedTextureImageUnits(16);
+
+  REQUIRE_FALSE(state.setCapability(WEBGL_TEXTURE_2D, true));
+  state.blendFuncSeparate(WEBGL_SRC_ALPHA, WEBGL_LESS, WEBGL_ONE, WEBGL_ZERO);
+  REQUIRE(state.getInteger(WEBGL_BLEND_SRC_RGB) == WEBGL_ONE);
+  state.depthFunc(WEBGL_KEEP);
+  REQUIRE(state.getInteger(WEBGL_DEPTH_FUNC) == WEBGL_LESS);
+  state.stencilOpSeparate(WEBGL_FRONT, WEBGL_KEEP, WEBGL_LESS, WEBGL_KEEP);
+  REQUIRE(state.getInteger(WEBGL_STENCIL_PASS_DEPTH_FAIL) == WEBGL_KEEP);
+  state.viewport(1, 2, -1, 4);
+  REQUIRE(state.getFloatv(WEBGL_VIEWPORT) == std::vector<float>{0, 0, 0, 0});
+  state.lineWidth(0.0f);
+  REQUIRE(state.getFloat(WEBGL_LINE_WIDTH) == 1.0f);
+  state.activeTexture(WEBGL_TEXTURE0 + 16);
+  REQUIRE(state.getInteger(WEBGL_ACTIVE_TEXTURE) == WEBGL_TEXTURE0);
+  state.activeTexture(WEBGL_TEXTURE0 + 15);
+  REQUIRE(state.getInteger(WEBGL_ACTIVE_TEXTURE) == WEBGL_TEXTURE0 + 15);
+
+  REQUIRE_FALSE(state.pixelStorei(WEBGL_UNPACK_ALIGNMENT, 3));
+  REQUIRE(state.unpackAlignment() == 4);
+  REQUIRE(state.pixelStorei(WEBGL_UNPACK_FLIP_Y_WEBGL, 1));
+  REQUIRE(state.unpackFlipY());
+  // The pixel store parameters of WebGL 2.0 are rejected by WebGL 1.0.
+  REQUIRE_FALSE(state.pixelStorei(WEBGL2_UNPACK_ROW_LENGTH, 16));
+
+  SECTION("the colors are clamped in WebGL 1.0 only")
+  {
+    state.clearColor(2.0f, -1.0f, 0.5f, 1.0f);
+    REQUIRE(state.getFloatv(WEBGL_COLOR_CLEAR_VALUE) == std::vector<float>{1.0f, 0.0f, 0.5f, 1.0f});
+
+    WebGLShadowState state2(true);
+    state2.clearColor(2.0f, -1.0f, 0.5f, 1.0f);
+    REQUIRE(state2.getFloatv(WEBGL_COLOR_CLEAR_VALUE) == std::vector<float>{2.0f, -1.0f, 0.5f, 1.0f});
+    REQUIRE(state2.pixelStorei(WEBGL2_UNPACK_ROW_LENGTH, 16));
+    REQUIRE(state2.getInteger(WEBGL2_UNPACK_ROW_LENGTH) == 16);
+    REQUIRE_FALSE(state2.pixelStorei(WEBGL2_UNPACK_ROW_LENGTH, -1));
+  }
+}
+
+namespace
+{
+  /**
+   * A surfaceless OpenGL ES 3.0 context via EGL, which is loaded at runtime to run the conformance test against the real
+   * driver where it's available, such as Mesa.
+   */
+  class HeadlessGLContext
+  {
+    using EGLDisplay = void *;
+    using EGLConfig = void *;
+    using EGLContext = void *;
+    using EGLint = int32_t;
+    using EGLBoolean = uint32_t;
+
+  public:
+    HeadlessGLContext()
+    {
+      lib_ = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+      if (lib_ == nullptr)
+        return;
+
+      auto getProcAddress = reinterpret_cast<void *(*)(const char *)>(dlsym(lib_, "eglGetProcAddress"));
+      auto initialize = reinterpret_cast<EGLBoolean (*)(EGLDisplay, EGLint *, EGLint *)>(dlsym(lib_, "eglInitialize"));
+      auto bindAPI = reinterpret_cast<EGLBoolean (*)(uint32_t)>(dlsym(lib_, "eglBindAPI"));
+      auto chooseConfig = reinterpret_cast<EGLBoolean (*)(EGLDisplay, const EGLint *, EGLConfig *, EGLint, EGLint *)>(
+        dlsym(lib_, "eglChooseConfig"));
+      auto createContext = reinterpret_cast<EGLContext (*)(EGLDisplay, EGLConfig, EGLContext, const EGLint *)>(
+        dlsym(lib_, "eglCreateContext"));
+      auto makeCurrent = reinterpret_cast<EGLBoolean (*)(EGLDisplay, void *, void *, EGLContext)>(
+        dlsym(lib_, "eglMakeCurrent"));
+      if (getProcAddress == nullptr || initialize == nullptr || bindAPI == nullptr ||
+          chooseConfig == nullptr || createContext == nullptr || makeCurrent == nullptr)
+        return;
+
+      auto getPlatformDisplay = reinterpret_cast<EGLDisplay (*)(uint32_t, void *, const intptr_t *)>(
+        getProcAddress("eglGetPlatformDisplay"));
+      if (getPlatformDisplay == nullptr)
+        return;
+      EGLDisplay display = getPlatformDisplay(0x31DD /* EGL_PLATFORM_SURFACELESS_MESA */, nullptr, nullptr);
+      EGLint major, minor;
+      if (display == nullptr || !initialize(display, &major, &minor) || !bindAPI(0x30A0 /* EGL_OPENGL_ES_API */))
+        return;
+
+      // EGL_SURFACE_TYPE = 0, EGL_RENDERABLE_TYPE = EGL_OPENGL_ES3_BIT
+      const EGLint configAttribs[] = {0x3033, 0, 0x3040, 0x40, 0x3038};
+      EGLConfig config;
+      EGLint configsCount = 0;
+      if (!chooseConfig(display, configAttribs, &config, 1, &configsCount) || configsCount < 1)
+        return;
+      // EGL_CONTEXT_CLIENT_VERSION = 3
+      const EGLint contextAttribs[] = {0x3098, 3, 0x3038};
+      EGLContext context = createContext(display, config, nullptr, contextAttribs);
+      if (context == nullptr || !makeCurrent(display, nullptr, nullptr, context))
+        return;
+      getProcAddress_ = getProcAddress;
+    }
+
+  public:
+    bool isAvailable() const
+    {
+      return getProcAddress_ != nullptr;
+    }
+    template <typename Fn>
+    Fn *get(const char *name) const
+    {
+      auto fn = reinterpret_cast<Fn *>(getProcAddress_(name));
+      REQUIRE(fn != nullptr);
+      return fn;
+    }
+
+  private:
+    void *lib_ = nullptr;
+    void *(*getProcAddress_)(const char *) = nullptr;
+  };
+}
+
+TEST_CASE("WebGLShadowState answers the same as the GL", "[WebGLShadowState]")
+{
+  HeadlessGLContext gl;
+  if (!gl.isAvailable())
+    SKIP("No EGL surfaceless context is available.");
+
+  auto glEnable = gl.get<void(uint32_t)>("glEnable");
+  auto glDisable = gl.get<void(uint32_t)>("glDisable");
+  auto glIsEnabled = gl.get<uint8_t(uint32_t)>("glIsEnabled");
+  auto glGetBooleanv = gl.get<void(uint32_t, uint8_t *)>("glGetBooleanv");
+  auto glGetIntegerv = gl.get<void(uint32_t, int32_t *)>("glGetIntegerv");
+  auto glGetFloatv = gl.get<void(uint32_t, float *)>("glGetFloatv");
+  auto glBlendColor = gl.get<void(float, float, float, float)>("glBlendColor");
+  auto glBlendEquationSeparate = gl.get<void(uint32_t, uint32_t)>("glBlendEquationSeparate");
+  auto glBlendFuncSeparate = gl.get<void(uint32_t, uint32_t, uint32_t, uint32_t)>("glBlendFuncSeparate");
+  auto glDepthFunc = gl.get<void(uint32_t)>("glDepthFunc");
+  auto glDepthMask = gl.get<void(uint8_t)>("glDepthMask");
+  auto glDepthRangef = gl.get<void(float, float)>("glDepthRangef");
+  auto glStencilFuncSeparate = gl.get<void(uint32_t, uint32_t, int32_t, uint32_t)>("glStencilFuncSeparate");
+  auto glStencilOpSeparate = gl.get<void(uint32_t, uint32_t, uint32_t, uint32_t)>("glStencilOpSeparate");
+  auto glColorMask = gl.get<void(uint8_t, uint8_t, uint8_t, uint8_t)>("glColorMask");
+  auto glCullFace = gl.get<void(uint32_t)>("glCullFace");
+  auto glFrontFace = gl.get<void(uint32_t)>("glFrontFace");
+  auto glLineWidth = gl.get<void(float)>("glLineWidth");
+  auto glPolygonOffset = gl.get<void(float, float)>("glPolygonOffset");
+  auto glHint = gl.get<void(uint32_t, uint32_t)>("glHint");
+  auto glActiveTexture = gl.get<void(uint32_t)>("glActiveTexture");
+  auto glViewport = gl.get<void(int32_t, int32_t, int32_t, int32_t)>("glViewport");
+  auto glScissor = gl.get<void(int32_t, int32_t, int32_t, int32_t)>("glScissor");
+  auto glClearColor = gl.get<void(float, float, float, float)>("glClearColor");
+  auto glClearDepthf = gl.get<void(float)>("glClearDepthf");
+  auto glClearStencil = gl.get<void(int32_t)>("glClearStencil");
+  auto glPixelStorei = gl.get<void(uint32_t, int32_t)>("glPixelStorei");
+  auto glGetError = gl.get<uint32_t()>("glGetError");
+
+  int32_t viewport[4];
+  int32_t maxTextureUnits;
+  glGetIntegerv(WEBGL_VIEWPORT, viewport);
+  glGetIntegerv(WEBGL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+
+  WebGLShadowState state(true);
+  state.resetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  state.setMaxCombinedTextureImageUnits(maxTextureUnits);
+
+  auto compare = [&](const char *step)
+  {
+    INFO("After " << step);
+    const int caps[] = {WEBGL_BLEND, WEBGL_CULL_FACE, WEBGL_DEPTH_TEST, WEBGL_DITHER, WEBGL_POLYGON_OFFSET_FILL,
+                        WEBGL_SAMPLE_ALPHA_TO_COVERAGE, WEBGL_SAMPLE_COVERAGE, WEBGL_SCISSOR_TEST, WEBGL_STENCIL_TEST,
+                        WEBGL2_RASTERIZER_DISCARD};
+    for (int cap : caps)
+    {
+      INFO("cap 0x" << std::hex << cap);
+      REQUIRE(state.isEnabled(cap) == (glIsEnabled(cap) != 0));
+      REQUIRE(state.getBoolean(cap) == (glIsEnabled(cap) != 0));
+    }
+
+    uint8_t depthMask;
+    glGetBooleanv(WEBGL_DEPTH_WRITEMASK, &depthMask);
+    REQUIRE(state.getBoolean(WEBGL_DEPTH_WRITEMASK) == (depthMask != 0));
+    uint8_t colorMask[4];
+    glGetBooleanv(WEBGL_COLOR_WRITEMASK, colorMask);
+    REQUIRE(state.getBooleanv(WEBGL_COLOR_WRITEMASK) ==
+            std::array<bool, 4>{colorMask[0] != 0, colorMask[1] != 0, colorMask[2] != 0, colorMask[3] != 0});
+
+    const int integers[] = {WEBGL_ACTIVE_TEXTURE, WEBGL_BLEND_EQUATION_RGB, WEBGL_BLEND_EQUATION_ALPHA,
+                            WEBGL_BLEND_SRC_RGB, WEBGL_BLEND_DST_RGB, WEBGL_BLEND_SRC_ALPHA, WEBGL_BLEND_DST_ALPHA,
+                            WEBGL_DEPTH_FUNC, WEBGL_STENCIL_FUNC, WEBGL_STENCIL_FAIL, WEBGL_STENCIL_PASS_DEPTH_FAIL,
+                            WEBGL_STENCIL_PASS_DEPTH_PASS, WEBGL_STENCIL_BACK_FUNC, WEBGL_STENCIL_BACK_FAIL,
+                            WEBGL_STENCIL_BACK_PASS_DEPTH_FAIL, WEBGL_STENCIL_BACK_PASS_DEPTH_PASS,
+                            WEBGL_STENCIL_CLEAR_VALUE, WEBGL_CULL_FACE_MODE, WEBGL_FRONT_FACE,
+                            WEBGL_GENERATE_MIPMAP_HINT, WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT,
+                            WEBGL_PACK_ALIGNMENT, WEBGL_UNPACK_ALIGNMENT, WEBGL2_PACK_ROW_LENGTH,
+                            WEBGL2_PACK_SKIP_ROWS, WEBGL2_PACK_SKIP_PIXELS, WEBGL2_UNPACK_ROW_LENGTH,
+                            WEBGL2_UNPACK_IMAGE_HEIGHT, WEBGL2_UNPACK_SKIP_ROWS, WEBGL2_UNPACK_SKIP_PIXELS,
+                            WEBGL2_UNPACK_SKIP_IMAGES};
+    for (int pname : integers)
+    {
+      INFO("pname 0x" << std::hex << pname);
+      int32_t value;
+      glGetIntegerv(pname, &value);
+      REQUIRE(state.getInteger(pname) == value);
+    }
+
+    const int floats[] = {WEBGL_DEPTH_CLEAR_VALUE, WEBGL_LINE_WIDTH, WEBGL_POLYGON_OFFSET_FACTOR,
+                          WEBGL_POLYGON_OFFSET_UNITS};
+    for (int pname : floats)
+    {
+      INFO("pname 0x" << std::hex << pname);
+      float value;
+      glGetFloatv(pname, &value);
+      REQUIRE(state.getFloat(pname) == value);
+    }
+
+    const std::pair<int, size_t> floatArrays[] = {{WEBGL_VIEWPORT, 4}, {WEBGL_SCISSOR_BOX, 4}, {WEBGL_BLEND_COLOR, 4},
+                                                  {WEBGL_COLOR_CLEAR_VALUE, 4}, {WEBGL_DEPTH_RANGE, 2}};
+    for (auto [pname, size] : floatArrays)
+    {
+      INFO("pname 0x" << std::hex << pname);
+      std::vector<float> values(size);
+      glGetFloatv(pname, values.data());
+      REQUIRE(state.getFloatv(pname) == values);
+    }
+    REQUIRE(glGetError() == WEBGL_NO_ERROR);
+  };
+  compare("the initialization");
+
+  // Apply the same calls to both, including the ones rejected by the GL.
+  auto apply = [&](auto &&shadowCall, auto &&glCall)
+  {
+    shadowCall();
+    glCall();
+    glGetError(); // The rejected calls are expected to be ignored.
+  };
+
+  apply([&]
+        { state.setCapability(WEBGL_BLEND, true); state.setCapability(WEBGL_DITHER, false); },
+        [&]
+        { glEnable(WEBGL_BLEND); glDisable(WEBGL_DITHER); });
+  apply([&]
+        { state.setCapability(WEBGL2_RASTERIZER_DISCARD, true); state.setCapability(WEBGL_STENCIL_TEST, true); },
+        [&]
+        { glEnable(WEBGL2_RASTERIZER_DISCARD); glEnable(WEBGL_STENCIL_TEST); });
+  compare("enable() and disable()");
+
+  apply([&]
+        { state.blendColor(2.0f, -1.0f, 0.25f, 0.5f); },
+        [&]
+        { glBlendColor(2.0f, -1.0f, 0.25f, 0.5f); });
+  apply([&]
+        { state.blendEquationSeparate(WEBGL_FUNC_SUBTRACT, WEBGL2_MAX); },
+        [&]
+        { glBlendEquationSeparate(WEBGL_FUNC_SUBTRACT, WEBGL2_MAX); });
+  apply([&]
+        { state.blendEquationSeparate(WEBGL_LESS, WEBGL_FUNC_ADD); },
+        [&]
+        { glBlendEquationSeparate(WEBGL_LESS, WEBGL_FUNC_ADD); });
+  apply([&]
+        { state.blendFuncSeparate(WEBGL_SRC_ALPHA, WEBGL_ONE_MINUS_SRC_ALPHA, WEBGL_CONSTANT_COLOR, WEBGL_DST_COLOR); },
+        [&]
+        { glBlendFuncSeparate(WEBGL_SRC_ALPHA, WEBGL_ONE_MINUS_SRC_ALPHA, WEBGL_CONSTANT_COLOR, WEBGL_DST_COLOR); });
+  apply([&]
+        { state.blendFuncSeparate(WEBGL_KEEP, WEBGL_ONE, WEBGL_ONE, WEBGL_ONE); },
+        [&]
+        { glBlendFuncSeparate(WEBGL_KEEP, WEBGL_ONE, WEBGL_ONE, WEBGL_ONE); });
+  compare("the blend functions");
+
+  apply([&]
+        { state.depthFunc(WEBGL_LEQUAL); state.depthMask(false); state.depthRange(-1.0f, 0.75f); },
+        [&]
+        { glDepthFunc(WEBGL_LEQUAL); glDepthMask(0); glDepthRangef(-1.0f, 0.75f); });
+  apply([&]
+        { state.depthFunc(WEBGL_ZERO); },
+        [&]
+        { glDepthFunc(WEBGL_ZERO); });
+  apply([&]
+        { state.stencilFuncSeparate(WEBGL_BACK, WEBGL_GREATER); },
+        [&]
+        { glStencilFuncSeparate(WEBGL_BACK, WEBGL_GREATER, 1, 0xff); });
+  apply([&]
+        { state.stencilOpSeparate(WEBGL_FRONT_AND_BACK, WEBGL_REPLACE, WEBGL_INCR_WRAP, WEBGL_INVERT); },
+        [&]
+        { glStencilOpSeparate(WEBGL_FRONT_AND_BACK, WEBGL_REPLACE, WEBGL_INCR_WRAP, WEBGL_INVERT); });
+  apply([&]
+        { state.stencilOpSeparate(WEBGL_FRONT, WEBGL_ZERO, WEBGL_DECR, WEBGL_KEEP); },
+        [&]
+        { glStencilOpSeparate(WEBGL_FRONT, WEBGL_ZERO, WEBGL_DECR, WEBGL_KEEP); });
+  apply([&]
+        { state.stencilOpSeparate(WEBGL_BACK, WEBGL_LESS, WEBGL_KEEP, WEBGL_KEEP); },
+        [&]
+        { glStencilOpSeparate(WEBGL_BACK, WEBGL_LESS, WEBGL_KEEP, WEBGL_KEEP); });
+  compare("the depth and stencil functions");
+
+  apply([&]
+        { state.colorMask(true, false, true, false); state.cullFace(WEBGL_FRONT_AND_BACK); state.frontFace(WEBGL_CW); },
+        [&]
+        { glColorMask(1, 0, 1, 0); glCullFace(WEBGL_FRONT_AND_BACK); glFrontFace(WEBGL_CW); });
+  apply([&]
+        { state.cullFace(WEBGL_CW); state.frontFace(WEBGL_BACK); },
+        [&]
+        { glCullFace(WEBGL_CW); glFrontFace(WEBGL_BACK); });
+  apply([&]
+        { state.lineWidth(1.0f); state.polygonOffset(1.5f, -2.0f); },
+        [&]
+        { glLineWidth(1.0f); glPolygonOffset(1.5f, -2.0f); });
+  apply([&]
+        { state.lineWidth(-1.0f); },
+        [&]
+        { glLineWidth(-1.0f); });
+  apply([&]
+        { state.hint(WEBGL_GENERATE_MIPMAP_HINT, WEBGL_NICEST); state.hint(WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT, WEBGL_FASTEST); },
+        [&]
+        { glHint(WEBGL_GENERATE_MIPMAP_HINT, WEBGL_NICEST); glHint(WEBGL2_FRAGMENT_SHADER_DERIVATIVE_HINT, WEBGL_FASTEST); });
+  apply([&]
+        { state.hint(WEBGL_GENERATE_MIPMAP_HINT, WEBGL_LESS); },
+        [&]
+        { glHint(WEBGL_GENERATE_MIPMAP_HINT, WEBGL_LESS); });
+  apply([&]
+        { state.activeTexture(WEBGL_TEXTURE0 + 3); state.activeTexture(WEBGL_TEXTURE0 + maxTextureUnits); },
+        [&]
+        { glActiveTexture(WEBGL_TEXTURE0 + 3); glGetError(); glActiveTexture(WEBGL_TEXTURE0 + maxTextureUnits); });
+  compare("the rasterization functions");
+
+  apply([&]
+        { state.viewport(-4, 8, 320, 240); state.scissor(1, 2, 3, 4); },
+        [&]
+        { glViewport(-4, 8, 320, 240); glScissor(1, 2, 3, 4); });
+  apply([&]
+        { state.viewport(0, 0, -1, 10); state.scissor(0, 0, 10, -1); },
+        [&]
+        { glViewport(0, 0, -1, 10); glGetError(); glScissor(0, 0, 10, -1); });
+  apply([&]
+        { state.clearColor(0.1f, 1.5f, -0.5f, 1.0f); state.clearDepth(2.0f); state.clearStencil(7); },
+        [&]
+        { glClearColor(0.1f, 1.5f, -0.5f, 1.0f); glClearDepthf(2.0f); glClearStencil(7); });
+  compare("the viewport and clear values");
+
+  apply([&]
+        { state.pixelStorei(WEBGL_PACK_ALIGNMENT, 1); state.pixelStorei(WEBGL_UNPACK_ALIGNMENT, 8); },
+        [&]
+        { glPixelStorei(WEBGL_PACK_ALIGNMENT, 1); glPixelStorei(WEBGL_UNPACK_ALIGNMENT, 8); });
+  apply([&]
+        { state.pixelStorei(WEBGL_UNPACK_ALIGNMENT, 3); },
+        [&]
+        { glPixelStorei(WEBGL_UNPACK_ALIGNMENT, 3); });
+  apply([&]
+        { state.pixelStorei(WEBGL2_UNPACK_ROW_LENGTH, 64); state.pixelStorei(WEBGL2_PACK_SKIP_ROWS, 2); },
+        [&]
+        { glPixelStorei(WEBGL2_UNPACK_ROW_LENGTH, 64); glPixelStorei(WEBGL2_PACK_SKIP_ROWS, 2); });
+  apply([&]
+        { state.pixelStorei(WEBGL2_UNPACK_SKIP_IMAGES, -1); },
+        [&]
+        { glPixelStorei(WEBGL2_UNPACK_SKIP_IMAGES, -1); });
+  compare("the pixel store");
+}
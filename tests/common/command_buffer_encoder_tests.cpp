@@ -0,0 +1,147 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <vector>
+#include <common/command_buffers/encoder.hpp>
+
+using namespace commandbuffers;
+
+struct FooCommand
+{
+  uint32_t program;
+  int32_t location;
+  float values[4];
+};
+
+static std::vector<char> joinChunks(TrCommandBufferEncoder &encoder)
+{
+  std::vector<char> joined;
+  encoder.forEachChunk([&joined](const char *data, size_t size)
+                       {
+                         joined.insert(joined.end(), data, data + size);
+                         return true; });
+  return joined;
+}
+
+TEST_CASE("TrCommandBufferEncoder encodes messages in the wire layout", "[TrCommandBufferEncoder]")
+{
+  TrCommandBufferEncoder encoder(256);
+  FooCommand foo = {1, 2, {0.1f, 0.2f, 0.3f, 0.4f}};
+  TrCommandBufferMessage message(COMMAND_BUFFER_UNIFORM4F_REQ, sizeof(foo), &foo);
+
+  void *expected = nullptr;
+  size_t expectedSize = 0;
+  REQUIRE(message.serialize(&expected, &expectedSize));
+
+  for (int i = 0; i < 10; i++)
+    REQUIRE(encoder.encode(message));
+  REQUIRE(encoder.count() == 10);
+  REQUIRE(encoder.size() == expectedSize * 10);
+
+  auto joined = joinChunks(encoder);
+  REQUIRE(joined.size() == expectedSize * 10);
+  for (int i = 0; i < 10; i++)
+    REQUIRE(memcmp(joined.data() + i * expectedSize, expected, expectedSize) == 0);
+
+  // Each encoded message could be decoded back.
+  TrCommandBufferMessage decoded;
+  REQUIRE(decoded.deserialize(joined.data(), expectedSize));
+  auto &decodedFoo = decoded.getReferenceFromBase<FooCommand>();
+  REQUIRE(decodedFoo.program == 1);
+  REQUIRE(decodedFoo.location == 2);
+  REQUIRE(decodedFoo.values[3] == 0.4f);
+  free(expected);
+}
+
+TEST_CASE("TrCommandBufferEncoder handles the oversized messages", "[TrCommandBufferEncoder]")
+{
+  TrCommandBufferEncoder encoder(256);
+  std::vector<char> payload(1024, 'x');
+  FooCommand foo = {1, 2, {0}};
+  TrCommandBufferMessage message(COMMAND_BUFFER_BUFFER_DATA_REQ, sizeof(foo), &foo);
+  message.addRawSegment(payload.size(), payload.data());
+
+  REQUIRE(encoder.encode(message));
+  REQUIRE(encoder.size() == message.computeSerializedSize());
+
+  std::vector<struct iovec> iov;
+  encoder.fillIovecs(iov);
+  REQUIRE(iov.size() == 1);
+  REQUIRE(iov[0].iov_len == message.computeSerializedSize());
+}
+
+TEST_CASE("TrCommandBufferEncoder reuses the chunks after reset", "[TrCommandBufferEncoder]")
+{
+  TrCommandBufferEncoder encoder(256);
+  FooCommand foo = {1, 2, {0}};
+  TrCommandBufferMessage message(COMMAND_BUFFER_UNIFORM4F_REQ, sizeof(foo), &foo);
+
+  for (int i = 0; i < 20; i++)
+    encoder.encode(message);
+  std::vector<struct iovec> first;
+  encoder.fillIovecs(first);
+  REQUIRE(first.size() > 1);
+
+  encoder.reset();
+  REQUIRE(encoder.empty());
+  REQUIRE(encoder.count() == 0);
+
+  for (int i = 0; i < 20; i++)
+    encoder.encode(message);
+  std::vector<struct iovec> second;
+  encoder.fillIovecs(second);
+  REQUIRE(second.size() == first.size());
+  for (size_t i = 0; i < first.size(); i++)
+    REQUIRE(second[i].iov_base == first[i].iov_base);
+}
+
+/**
+ * Run with `TransmuteUnitTests "[benchmark]"` to compare the encoded commands per second, each benchmark encodes 1000 uniform
+ * commands which is the flush threshold of `TrCommandBufferSender`.
+ */
+TEST_CASE("TrCommandBufferEncoder throughput", "[.][benchmark]")
+{
+  constexpr int commandsCount = 1000;
+  FooCommand foo = {1, 2, {0.1f, 0.2f, 0.3f, 0.4f}};
+
+  BENCHMARK("realloc per command (1000 commands)")
+  {
+    void *bufferToSend = nullptr;
+    size_t bufferSize = 0;
+    for (int i = 0; i < commandsCount; i++)
+    {
+      auto message = new TrCommandBufferMessage(COMMAND_BUFFER_UNIFORM4F_REQ, sizeof(foo), &foo);
+      void *data = nullptr;
+      size_t size = 0;
+      message->serialize(&data, &size);
+      delete message;
+      if (bufferToSend == nullptr)
+      {
+        bufferToSend = data;
+        bufferSize = size;
+      }
+      else
+      {
+        bufferToSend = realloc(bufferToSend, bufferSize + size);
+        memcpy((char *)bufferToSend + bufferSize, data, size);
+        bufferSize += size;
+        free(data);
+      }
+    }
+    free(bufferToSend);
+    return bufferSize;
+  };
+
+  TrCommandBufferEncoder encoder;
+  BENCHMARK("chunked encoder (1000 commands)")
+  {
+    for (int i = 0; i < commandsCount; i++)
+    {
+      auto message = new TrCommandBufferMessage(COMMAND_BUFFER_UNIFORM4F_REQ, sizeof(foo), &foo);
+      encoder.encode(*message);
+      delete message;
+    }
+    size_t encodedSize = encoder.size();
+    encoder.reset();
+    return encodedSize;
+  };
+}
@@ -0,0 +1,76 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <common/command_buffers/flush_policy.hpp>
+
+using namespace std::chrono;
+using namespace commandbuffers;
+
+static TrCommandBufferPendingState makeState(size_t bytes, size_t count, steady_clock::time_point now,
+                                             steady_clock::time_point lastFlushTime)
+{
+  return {bytes, count, now, lastFlushTime};
+}
+
+TEST_CASE("TrCommandBufferAdaptiveFlushPolicy flushes at the frame end and queries", "[TrCommandBufferFlushPolicy]")
+{
+  TrCommandBufferAdaptiveFlushPolicy policy;
+  auto now = steady_clock::now();
+  auto state = makeState(64, 1, now, now);
+
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_XRFRAME_END_REQ, state) == TrCommandBufferFlushReason::XRFrameEnd);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_GET_ERROR_REQ, state) == TrCommandBufferFlushReason::ResponseQuery);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_LINK_PROGRAM_REQ, state) == TrCommandBufferFlushReason::ResponseQuery);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_UNIFORM4F_REQ, state) == TrCommandBufferFlushReason::None);
+}
+
+TEST_CASE("TrCommandBufferAdaptiveFlushPolicy flushes by the byte watermark", "[TrCommandBufferFlushPolicy]")
+{
+  TrCommandBufferAdaptiveFlushPolicy::Options options;
+  options.maxPendingBytes = 1024;
+  TrCommandBufferAdaptiveFlushPolicy policy(options);
+  auto now = steady_clock::now();
+
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(1023, 10, now, now)) ==
+          TrCommandBufferFlushReason::None);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(1024, 11, now, now)) ==
+          TrCommandBufferFlushReason::ByteWatermark);
+}
+
+TEST_CASE("TrCommandBufferAdaptiveFlushPolicy skips the count and time fallback in frames", "[TrCommandBufferFlushPolicy]")
+{
+  TrCommandBufferAdaptiveFlushPolicy policy;
+  auto now = steady_clock::now();
+  auto staleFlushTime = now - milliseconds(20);
+
+  // Not driven by frames, the count and time fallback are applied.
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(64, 1000, now, now)) ==
+          TrCommandBufferFlushReason::CountWatermark);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(64, 1, now, staleFlushTime)) ==
+          TrCommandBufferFlushReason::Timeout);
+
+  // After a frame end, the requests are kept pending until the next frame end.
+  policy.onFlushed(TrCommandBufferFlushReason::AnimationFrameEnd, now);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(64, 1000, now, now)) ==
+          TrCommandBufferFlushReason::None);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(64, 1, now, staleFlushTime)) ==
+          TrCommandBufferFlushReason::None);
+
+  // The frames are stopped, then it falls back again.
+  auto later = now + milliseconds(200);
+  REQUIRE(policy.onEnqueued(COMMAND_BUFFER_DRAW_ARRAYS_REQ, makeState(64, 1, later, now)) ==
+          TrCommandBufferFlushReason::Timeout);
+}
+
+TEST_CASE("TrCommandBufferFlushStats counts by reason", "[TrCommandBufferFlushPolicy]")
+{
+  TrCommandBufferFlushStats stats;
+  stats.increment(TrCommandBufferFlushReason::AnimationFrameEnd);
+  stats.increment(TrCommandBufferFlushReason::AnimationFrameEnd);
+  stats.increment(TrCommandBufferFlushReason::ResponseQuery);
+
+  REQUIRE(stats.get(TrCommandBufferFlushReason::AnimationFrameEnd) == 2);
+  REQUIRE(stats.get(TrCommandBufferFlushReason::ResponseQuery) == 1);
+  REQUIRE(stats.get(TrCommandBufferFlushReason::Timeout) == 0);
+  REQUIRE(stats.total() == 3);
+  REQUIRE(std::string(flushReasonToStr(TrCommandBufferFlushReason::XRFrameEnd)) == "xrframe_end");
+}
@@ -0,0 +1,90 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+#include <common/command_buffers/details/draw_calls.hpp>
+
+using namespace commandbuffers;
+
+static bool serializeDrawArrays(int first, int count, void **data, size_t *size)
+{
+  DrawArraysCommandBufferRequest req(4, first, count);
+  std::unique_ptr<TrCommandBufferMessage> message(req.serialize());
+  return message != nullptr && message->serialize(data, size);
+}
+
+TEST_CASE("TrCommandBufferObjectPool creates requests from messages", "[TrCommandBufferObjectPool]")
+{
+  auto pool = TrCommandBufferObjectPool::Make();
+  void *data = nullptr;
+  size_t size = 0;
+  REQUIRE(serializeDrawArrays(10, 300, &data, &size));
+
+  TrCommandBufferMessage message;
+  REQUIRE(message.deserialize((char *)data, size));
+  auto req = TrCommandBufferBase::CreateFromMessage<DrawArraysCommandBufferRequest>(message, pool);
+  REQUIRE(req->type == COMMAND_BUFFER_DRAW_ARRAYS_REQ);
+  REQUIRE(req->first == 10);
+  REQUIRE(req->count == 300);
+
+  delete req;
+  pool->release();
+  free(data);
+}
+
+TEST_CASE("TrCommandBufferObjectPool reuses the recycled blocks", "[TrCommandBufferObjectPool]")
+{
+  auto pool = TrCommandBufferObjectPool::Make();
+  std::vector<TrCommandBufferBase *> frame;
+
+  for (int i = 0; i < 100; i++)
+    frame.push_back(new (pool) DrawArraysCommandBufferRequest(4, 0, i));
+  size_t warmedUp = pool->getHeapAllocations();
+  REQUIRE(warmedUp == 100);
+
+  // The next frames reuse the blocks without any heap allocation.
+  for (int n = 0; n < 10; n++)
+  {
+    for (auto req : frame)
+      delete req;
+    frame.clear();
+    for (int i = 0; i < 100; i++)
+      frame.push_back(new (pool) DrawArraysCommandBufferRequest(4, 0, i));
+  }
+  REQUIRE(pool->getHeapAllocations() == warmedUp);
+
+  for (auto req : frame)
+    delete req;
+  pool->release();
+}
+
+TEST_CASE("TrCommandBufferObjectPool recycles from another thread", "[TrCommandBufferObjectPool]")
+{
+  auto pool = TrCommandBufferObjectPool::Make();
+  std::vector<TrCommandBufferBase *> frame;
+  for (int i = 0; i < 1000; i++)
+    frame.push_back(new (pool) DrawArraysCommandBufferRequest(4, 0, i));
+
+  // The requests are executed and deleted at the render thread, while the pool owner is gone.
+  pool->release();
+  std::thread renderThread([&frame]()
+                           {
+                             for (auto req : frame)
+                               delete req; });
+  renderThread.join();
+}
+
+TEST_CASE("TrCommandBufferObjectPool falls back to the heap", "[TrCommandBufferObjectPool]")
+{
+  // The requests created without a pool are still deleted correctly.
+  TrCommandBufferBase *req = new DrawArraysCommandBufferRequest(4, 0, 3);
+  delete req;
+
+  auto pool = TrCommandBufferObjectPool::Make();
+  void *large = pool->allocate(4096);
+  REQUIRE(large != nullptr);
+  REQUIRE(pool->getHeapAllocations() == 0);
+  TrCommandBufferObjectPool::Deallocate(large);
+  pool->release();
+}
@@ -0,0 +1,118 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <span>
+#include <vector>
+#include <common/command_buffers/encoder.hpp>
+#include <common/command_buffers/details/uniforms.hpp>
+
+using namespace commandbuffers;
+
+template <typename T>
+static T *encodeAndDecode(T &req, TrCommandBufferEncoder &encoder)
+{
+  auto message = req.serialize();
+  REQUIRE(encoder.encode(*message));
+  delete message;
+
+  std::vector<char> joined;
+  encoder.forEachChunk([&joined](const char *data, size_t size)
+                       {
+                         joined.insert(joined.end(), data, data + size);
+                         return true; });
+
+  TrCommandBufferMessage decoded;
+  REQUIRE(decoded.deserialize(joined.data(), joined.size()));
+  return TrCommandBufferBase::CreateFromMessage<T>(decoded);
+}
+
+TEST_CASE("Uniform*v requests are created from a span of the values", "[UniformCommandBufferRequest]")
+{
+  // A typed array with a byte offset, only the middle 8 values are taken.
+  float backingStore[12] = {-1.0f, -1.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, -1.0f, -1.0f};
+  std::span<const float> values(backingStore + 2, 8);
+
+  TrCommandBufferEncoder encoder(256);
+  Uniform4fvCommandBufferRequest req(3, values);
+  REQUIRE(req.values.size() == 8);
+
+  auto decoded = encodeAndDecode(req, encoder);
+  REQUIRE(decoded->location == 3);
+  REQUIRE(decoded->values == std::vector<float>(values.begin(), values.end()));
+  delete decoded;
+}
+
+TEST_CASE("UniformMatrix*fv requests are created from a span of the values", "[UniformCommandBufferRequest]")
+{
+  std::vector<float> matrices(32);
+  for (size_t i = 0; i < matrices.size(); i++)
+    matrices[i] = static_cast<float>(i);
+
+  TrCommandBufferEncoder encoder(256);
+  UniformMatrix4fvCommandBufferRequest req(5, false, matrices);
+  REQUIRE(req.count() == 2);
+
+  auto decoded = encodeAndDecode(req, encoder);
+  REQUIRE(decoded->location == 5);
+  REQUIRE(decoded->count() == 2);
+  REQUIRE(decoded->values == matrices);
+  delete decoded;
+}
+
+TEST_CASE("Uniform*iv requests skip the values in the wrong size", "[UniformCommandBufferRequest]")
+{
+  int backingStore[3] = {1, 2, 3};
+  TrCommandBufferEncoder encoder(256);
+  Uniform2ivCommandBufferRequest req(1, std::span<const int>(backingStore, 3));
+
+  auto decoded = encodeAndDecode(req, encoder);
+  REQUIRE(decoded->values.empty());
+  delete decoded;
+}
+
+/**
+ * Run with `TransmuteUnitTests "[benchmark]"` to compare the native cost of 1000 `uniformMatrix4fv()` calls with a
+ * `Float32Array(16 * 4)`: the values are read element by element into a vector which is copied into the request and the
+ * message segment, or taken from the typed array's backing store as a span and encoded from the request in place.
+ */
+TEST_CASE("UniformMatrix4fv request encoding throughput", "[.][benchmark]")
+{
+  constexpr int callsCount = 1000;
+  constexpr size_t valuesCount = 16 * 4;
+  std::vector<float> backingStore(valuesCount, 0.5f);
+  TrCommandBufferEncoder encoder;
+
+  BENCHMARK("vector per call (1000 calls)")
+  {
+    for (int i = 0; i < callsCount; i++)
+    {
+      std::vector<float> values(valuesCount);
+      for (size_t j = 0; j < valuesCount; j++)
+        values[j] = backingStore[j];
+
+      auto copied = values; // The vector was passed by value to `WebGLContext`.
+      UniformMatrix4fvCommandBufferRequest req(1, false, copied);
+      auto message = new TrCommandBufferMessage(req.type, req.size, &req);
+      message->addVecSegment(req.values);
+      encoder.encode(*message);
+      delete message;
+    }
+    size_t encodedSize = encoder.size();
+    encoder.reset();
+    return encodedSize;
+  };
+
+  BENCHMARK("span of the backing store (1000 calls)")
+  {
+    for (int i = 0; i < callsCount; i++)
+    {
+      std::span<const float> values(backingStore.data(), valuesCount);
+      UniformMatrix4fvCommandBufferRequest req(1, false, values);
+      auto message = req.serialize();
+      encoder.encode(*message);
+      delete message;
+    }
+    size_t encodedSize = encoder.size();
+    encoder.reset();
+    return encodedSize;
+  };
+}
@@ -0,0 +1,160 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <common/ipc_reactor.hpp>
+
+using namespace ipc;
+
+/**
+ * Wait until the predicate is true or the timeout is reached.
+ */
+template <typename Predicate>
+static bool waitUntil(Predicate predicate, int timeout = 2000)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  while (!predicate())
+  {
+    if (std::chrono::steady_clock::now() >= deadline)
+      return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+/**
+ * A pair of the connected non-blocking sockets, the reactor watches the `reader`.
+ */
+struct SocketPair
+{
+  int reader = -1;
+  int writer = -1;
+
+  SocketPair()
+  {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    reader = fds[0];
+    writer = fds[1];
+  }
+  ~SocketPair()
+  {
+    close(reader);
+    close(writer);
+  }
+
+  void write(size_t size)
+  {
+    std::vector<char> data(size, 'x');
+    REQUIRE(::send(writer, data.data(), size, 0) == static_cast<ssize_t>(size));
+  }
+  size_t drain(size_t max = SIZE_MAX)
+  {
+    char c;
+    size_t n = 0;
+    while (n < max && ::recv(reader, &c, 1, 0) == 1)
+      n++;
+    return n;
+  }
+};
+
+TEST_CASE("TrChannelReactor calls the handlers of the readable channels", "[TrChannelReactor]")
+{
+  SocketPair a;
+  SocketPair b;
+  std::atomic<size_t> receivedA = 0;
+  std::atomic<size_t> receivedB = 0;
+  // The reactor is declared after the channels to be destroyed before them.
+  TrChannelReactor reactor("reactor_tests");
+
+  auto tokenA = reactor.add(a.reader, [&]()
+                            { receivedA += a.drain();
+                              return false; });
+  auto tokenB = reactor.add(b.reader, [&]()
+                            { receivedB += b.drain();
+                              return false; });
+  REQUIRE(tokenA != TrChannelReactor::InvalidToken);
+  REQUIRE(tokenA != tokenB);
+  REQUIRE(reactor.size() == 2);
+
+  a.write(3);
+  REQUIRE(waitUntil([&]()
+                    { return receivedA == 3; }));
+  b.write(5);
+  a.write(2);
+  REQUIRE(waitUntil([&]()
+                    { return receivedA == 5 && receivedB == 5; }));
+
+  reactor.remove(tokenA);
+  REQUIRE(reactor.size() == 1);
+  a.write(1);
+  b.write(1);
+  REQUIRE(waitUntil([&]()
+                    { return receivedB == 6; }));
+  // The removed channel is not handled anymore.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  REQUIRE(receivedA == 5);
+}
+
+TEST_CASE("TrChannelReactor drains the busy channels in batches", "[TrChannelReactor]")
+{
+  SocketPair busy;
+  SocketPair quiet;
+  std::atomic<size_t> busyReceived = 0;
+  std::atomic<size_t> busyCalls = 0;
+  std::atomic<size_t> quietReceived = 0;
+  TrChannelReactor reactor("reactor_tests");
+
+  // Fill the busy channel before watching, thus the initial call after adding is expected to drain it.
+  busy.write(100);
+  reactor.add(busy.reader, [&]()
+              {
+                busyCalls++;
+                size_t n = busy.drain(10);
+                busyReceived += n;
+                // A full batch means there might be more data.
+                return n == 10; });
+  reactor.add(quiet.reader, [&]()
+              { quietReceived += quiet.drain();
+                return false; });
+  quiet.write(1);
+
+  REQUIRE(waitUntil([&]()
+                    { return busyReceived == 100 && quietReceived == 1; }));
+  // 10 full batches and the last empty one at least.
+  REQUIRE(busyCalls >= 11);
+}
+
+TEST_CASE("TrChannelReactor notifies the channels", "[TrChannelReactor]")
+{
+  SocketPair channel;
+  SocketPair slow;
+  std::atomic<int> calls = 0;
+  std::atomic<bool> handlerRunning = false;
+  TrChannelReactor reactor("reactor_tests");
+  auto token = reactor.add(channel.reader, [&]()
+                           {
+                             calls++;
+                             return false; });
+
+  // The handler is called once after adding.
+  REQUIRE(waitUntil([&]()
+                    { return calls == 1; }));
+  reactor.notify(token);
+  REQUIRE(waitUntil([&]()
+                    { return calls == 2; }));
+
+  // Removing waits for the running handler.
+  auto slowToken = reactor.add(slow.reader, [&]()
+                               {
+                                 handlerRunning = true;
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                 handlerRunning = false;
+                                 return false; });
+  REQUIRE(waitUntil([&]()
+                    { return handlerRunning.load(); }));
+  reactor.remove(slowToken);
+  REQUIRE(handlerRunning == false);
+}
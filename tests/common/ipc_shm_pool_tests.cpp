@@ -0,0 +1,122 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <memory>
+#include <vector>
+#include <common/ipc_shm_pool.hpp>
+#include <common/command_buffers/details/texture.hpp>
+
+using namespace ipc;
+
+static std::string makePoolFilename(const char *name)
+{
+  return std::string("/tmp/jsar_shm_pool_tests_") + name + "_" + std::to_string(getpid());
+}
+
+TEST_CASE("TrShmBlockPool create and open", "[TrShmBlockPool]")
+{
+  auto filename = makePoolFilename("open");
+  auto server = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Server, 4096, 8);
+  REQUIRE(server->isValid());
+  REQUIRE(server->pageSize() == 4096);
+  REQUIRE(server->pageCount() == 8);
+
+  auto client = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Client);
+  REQUIRE(client->isValid());
+  REQUIRE(client->pageSize() == 4096);
+  REQUIRE(client->pageCount() == 8);
+  REQUIRE(client->freePages() == 8);
+}
+
+TEST_CASE("TrShmBlockPool shares the payload without copying", "[TrShmBlockPool]")
+{
+  auto filename = makePoolFilename("payload");
+  auto server = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Server, 4096, 8);
+  auto client = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Client);
+
+  std::vector<uint8_t> payload(10000, 0x5a);
+  auto ref = client->allocate(payload.size());
+  REQUIRE(ref.isValid());
+  REQUIRE(ref.size == payload.size());
+  memcpy(client->data(ref), payload.data(), payload.size());
+  REQUIRE(client->freePages() == 5);
+
+  auto block = server->acquire(ref);
+  REQUIRE(block != nullptr);
+  REQUIRE(block->size() == payload.size());
+  REQUIRE(memcmp(block->data(), payload.data(), payload.size()) == 0);
+
+  // The pages are released when the last reference to the block is dropped.
+  auto retained = block;
+  block.reset();
+  REQUIRE(client->freePages() == 5);
+  retained.reset();
+  REQUIRE(client->freePages() == 8);
+}
+
+TEST_CASE("TrShmBlockPool returns an invalid reference when it's exhausted", "[TrShmBlockPool]")
+{
+  auto filename = makePoolFilename("exhausted");
+  auto server = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Server, 4096, 4);
+  auto client = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Client);
+
+  REQUIRE(client->allocate(5 * 4096).isValid() == false);
+  REQUIRE(client->allocate(0).isValid() == false);
+
+  auto a = client->allocate(2 * 4096);
+  auto b = client->allocate(2 * 4096);
+  REQUIRE(a.isValid());
+  REQUIRE(b.isValid());
+  REQUIRE(client->allocate(1).isValid() == false);
+
+  // Releasing the first block makes the allocation wrap around to the beginning.
+  server->release(a);
+  auto c = client->allocate(4096);
+  REQUIRE(c.isValid());
+  REQUIRE(c.offset == a.offset);
+}
+
+TEST_CASE("TrShmBlockPool rejects the out-of-range references", "[TrShmBlockPool]")
+{
+  auto filename = makePoolFilename("range");
+  auto server = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Server, 4096, 4);
+
+  TrShmBlockRef invalid;
+  REQUIRE(server->acquire(invalid) == nullptr);
+
+  TrShmBlockRef outOfRange;
+  outOfRange.offset = 3 * 4096;
+  outOfRange.size = 2 * 4096;
+  REQUIRE(server->acquire(outOfRange) == nullptr);
+  REQUIRE(server->data(outOfRange) == nullptr);
+
+  TrShmBlockRef unaligned;
+  unaligned.offset = 100;
+  unaligned.size = 10;
+  REQUIRE(server->data(unaligned) == nullptr);
+}
+
+TEST_CASE("TrShmBlockPool transfers the pixels of a 4K texture", "[TrShmBlockPool]")
+{
+  auto filename = makePoolFilename("texture");
+  auto server = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Server);
+  auto client = std::make_shared<TrShmBlockPool>(filename, TrZoneType::Client);
+  REQUIRE(client->isValid());
+
+  commandbuffers::TextureImage2DCommandBufferRequest req(WEBGL_TEXTURE_2D, 0, WEBGL_RGBA);
+  req.setSize(4096, 4096);
+  req.format = WEBGL_RGBA;
+  req.pixelType = WEBGL_UNSIGNED_BYTE;
+  std::vector<uint8_t> pixels(4096 * 4096 * 4, 0x7f);
+  req.setPixels(pixels.data(), true, client.get());
+
+  // The pixels are written into the pool instead of being inlined into the message.
+  REQUIRE(req.sharedPayload.isValid());
+  REQUIRE(req.ownPixelsMemory == false);
+  std::unique_ptr<commandbuffers::TrCommandBufferMessage> message(req.serialize());
+  REQUIRE(message->getSegmentCount() == 0);
+
+  auto block = server->acquire(req.sharedPayload);
+  REQUIRE(block != nullptr);
+  REQUIRE(block->size() == pixels.size());
+  REQUIRE(memcmp(block->data(), pixels.data(), pixels.size()) == 0);
+}
@@ -0,0 +1,209 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+#include <common/ipc_shm_ring.hpp>
+#include <common/ipc_message.hpp>
+
+using namespace ipc;
+
+static std::string makeRingFilename(const char *name)
+{
+  return std::string("/tmp/jsar_shm_ring_tests_") + name + "_" + std::to_string(getpid());
+}
+
+TEST_CASE("TrShmRingBuffer create and open", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("open");
+  TrShmRingBuffer server(filename, TrZoneType::Server, 5000);
+  REQUIRE(server.isValid());
+  REQUIRE(server.capacity() == 8192);
+
+  TrShmRingBuffer client(filename, TrZoneType::Client);
+  REQUIRE(client.isValid());
+  REQUIRE(client.capacity() == 8192);
+  REQUIRE(client.isClosed() == false);
+}
+
+TEST_CASE("TrShmRingBuffer write and read", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("rw");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  int value = 42;
+  REQUIRE(producer.write(&value, sizeof(value)));
+  REQUIRE(consumer.readableBytes() == sizeof(value));
+
+  int out = 0;
+  REQUIRE(consumer.read(&out, sizeof(out), 0));
+  REQUIRE(out == 42);
+  REQUIRE(consumer.readableBytes() == 0);
+
+  // Timeout when there is no data.
+  REQUIRE(consumer.read(&out, sizeof(out), 1) == false);
+}
+
+TEST_CASE("TrShmRingBuffer peek and wrap around", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("wrap");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  std::vector<char> chunk(3000, 'a');
+  REQUIRE(producer.write(chunk.data(), chunk.size()));
+  const char *inPlace = consumer.peek(chunk.size());
+  REQUIRE(inPlace != nullptr);
+  REQUIRE(inPlace[0] == 'a');
+  consumer.consume(chunk.size());
+
+  // The next chunk wraps around the ring end, thus it can't be peeked in place.
+  std::vector<char> wrapped(2000, 'b');
+  REQUIRE(producer.write(wrapped.data(), wrapped.size()));
+  REQUIRE(consumer.peek(wrapped.size()) == nullptr);
+
+  std::vector<char> out(wrapped.size());
+  REQUIRE(consumer.read(out.data(), out.size(), 0));
+  REQUIRE(out == wrapped);
+}
+
+TEST_CASE("TrShmRingBuffer transfers data larger than capacity across threads", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("threads");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  std::vector<uint32_t> input(64 * 1024);
+  for (size_t i = 0; i < input.size(); i++)
+    input[i] = static_cast<uint32_t>(i * 7);
+
+  std::thread producerThread([&]()
+                             { REQUIRE(producer.write(input.data(), input.size() * sizeof(uint32_t))); });
+  std::vector<uint32_t> output(input.size());
+  REQUIRE(consumer.read(output.data(), output.size() * sizeof(uint32_t), 1000));
+  producerThread.join();
+  REQUIRE(output == input);
+}
+
+TEST_CASE("TrShmRingBuffer close wakes up the consumer", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("close");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  auto producer = std::make_unique<TrShmRingBuffer>(filename, TrZoneType::Client);
+
+  std::thread closer([&]()
+                     {
+                       std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                       producer.reset(); });
+  int out;
+  REQUIRE(consumer.read(&out, sizeof(out), -1) == false);
+  REQUIRE(consumer.isClosed());
+  closer.join();
+}
+
+TEST_CASE("TrShmRingBuffer asks the producer to wake the consumer via the channel", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("channel");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  // No request before the consumer waits.
+  int value = 1;
+  REQUIRE(producer.write(&value, sizeof(value)));
+  REQUIRE(producer.takeWakeByChannelRequest() == false);
+
+  // The consumer should read the arrived data instead of waiting.
+  REQUIRE(consumer.requestWakeByChannel() == false);
+  int out = 0;
+  REQUIRE(consumer.read(&out, sizeof(out), 0));
+
+  REQUIRE(consumer.requestWakeByChannel());
+  REQUIRE(producer.write(&value, sizeof(value)));
+  // The request is taken once.
+  REQUIRE(producer.takeWakeByChannelRequest());
+  REQUIRE(producer.takeWakeByChannelRequest() == false);
+
+  // Reading without data doesn't block with the zero timeout.
+  REQUIRE(consumer.read(&out, sizeof(out), 0));
+  REQUIRE(consumer.read(&out, sizeof(out), 0) == false);
+}
+
+namespace
+{
+  enum class TestMessageType : uint32_t
+  {
+    Ping = 1,
+  };
+  class TestMessage;
+  typedef TrIpcMessage<TestMessage, TestMessageType> TestIpcMessage;
+}
+
+TEST_CASE("TrIpcMessage resumes a message partially written to the ring", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("partial");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  int value = 42;
+  TestIpcMessage sent(TestMessageType::Ping, sizeof(value), &value);
+  std::vector<char> payload(100, 'x');
+  sent.addRawSegment(payload.size(), payload.data());
+  std::vector<char> frame(sent.computeSerializedSize());
+  sent.serializeTo(frame.data());
+
+  // Only the header and a part of the content are written.
+  size_t half = frame.size() / 2;
+  REQUIRE(producer.write(frame.data(), half));
+
+  TrShmRingPartialMessage partial;
+  {
+    TestIpcMessage received;
+    REQUIRE(received.deserialize(consumer, 0, partial) == false);
+    REQUIRE(partial.empty() == false);
+    REQUIRE(consumer.readableBytes() == 0);
+
+    // It waits for the rest no longer than the timeout.
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(received.deserialize(consumer, 10, partial) == false);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+  }
+
+  REQUIRE(producer.write(frame.data() + half, frame.size() - half));
+  {
+    TestIpcMessage received;
+    REQUIRE(received.deserialize(consumer, 0, partial));
+    REQUIRE(received.getReferenceFromBase<int>() == 42);
+    REQUIRE(received.getSegmentCount() == 1);
+    REQUIRE(received.getSegment(0)->size == payload.size());
+    REQUIRE(memcmp(received.getSegment(0)->getData(), payload.data(), payload.size()) == 0);
+  }
+  // The partial message is reset when the received message is gone.
+  REQUIRE(partial.empty());
+}
+
+TEST_CASE("TrIpcMessage refers to the ring until the message is destroyed", "[TrShmRingBuffer]")
+{
+  auto filename = makeRingFilename("inplace");
+  TrShmRingBuffer consumer(filename, TrZoneType::Server, 4096);
+  TrShmRingBuffer producer(filename, TrZoneType::Client);
+
+  int value = 7;
+  TestIpcMessage sent(TestMessageType::Ping, sizeof(value), &value);
+  std::vector<char> payload(64, 'y');
+  sent.addRawSegment(payload.size(), payload.data());
+  std::vector<char> frame(sent.computeSerializedSize());
+  sent.serializeTo(frame.data());
+  REQUIRE(producer.write(frame.data(), frame.size()));
+
+  TrShmRingPartialMessage partial;
+  {
+    TestIpcMessage received;
+    REQUIRE(received.deserialize(consumer, 0, partial));
+    REQUIRE(partial.empty());
+    REQUIRE(consumer.readableBytes() == frame.size());
+    REQUIRE(received.getSegmentCount() == 1);
+    REQUIRE(memcmp(received.getSegment(0)->getData(), payload.data(), payload.size()) == 0);
+  }
+  REQUIRE(consumer.readableBytes() == 0);
+}
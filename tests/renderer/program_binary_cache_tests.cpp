@@ -0,0 +1,122 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <filesystem>
+#include <fstream>
+#include <renderer/gles/program_binary_cache.hpp>
+
+using namespace gles;
+namespace fs = std::filesystem;
+
+static std::string makeCacheDirectory(const std::string &name)
+{
+  auto directory = fs::temp_directory_path() / ("jsar_program_binary_cache_tests_" + name);
+  fs::remove_all(directory);
+  return directory.string();
+}
+
+static ProgramBinaryCache::Binary makeBinary(uint32_t format, size_t size, uint8_t value)
+{
+  ProgramBinaryCache::Binary binary;
+  binary.format = format;
+  binary.data.assign(size, value);
+  return binary;
+}
+
+TEST_CASE("ProgramBinaryCache computes the keys from the sources, bindings and driver", "[ProgramBinaryCache]")
+{
+  std::vector<std::string> sources = {"void main() { gl_Position = vec4(0.0); }", "void main() {}"};
+  std::map<std::string, uint32_t> bindings = {{"position", 0}};
+
+  auto key = ProgramBinaryCache::ComputeKey(sources, bindings, "driver");
+  REQUIRE(key.size() == 16);
+  REQUIRE(key == ProgramBinaryCache::ComputeKey(sources, bindings, "driver"));
+  REQUIRE(key != ProgramBinaryCache::ComputeKey(sources, bindings, "another driver"));
+  REQUIRE(key != ProgramBinaryCache::ComputeKey(sources, {{"position", 1}}, "driver"));
+  REQUIRE(key != ProgramBinaryCache::ComputeKey({sources[1], sources[0]}, bindings, "driver"));
+  // The sources are length-prefixed, thus moving the boundary changes the key.
+  REQUIRE(ProgramBinaryCache::ComputeKey({"ab", "c"}, {}, "") != ProgramBinaryCache::ComputeKey({"a", "bc"}, {}, ""));
+}
+
+TEST_CASE("ProgramBinaryCache stores and loads the binaries across the instances", "[ProgramBinaryCache]")
+{
+  auto directory = makeCacheDirectory("persist");
+  {
+    ProgramBinaryCache cache(directory);
+    REQUIRE(cache.size() == 0);
+    REQUIRE_FALSE(cache.load("0000000000000001").has_value());
+    REQUIRE(cache.store("0000000000000001", makeBinary(0x8741, 128, 7)));
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.stats().misses == 1);
+    REQUIRE(cache.stats().stores == 1);
+  }
+
+  ProgramBinaryCache cache(directory);
+  REQUIRE(cache.size() == 1);
+  auto binary = cache.load("0000000000000001");
+  REQUIRE(binary.has_value());
+  REQUIRE(binary->format == 0x8741);
+  REQUIRE(binary->data == makeBinary(0x8741, 128, 7).data);
+  REQUIRE(cache.stats().hits == 1);
+
+  // The rejected binary is removed from the disk.
+  cache.reject("0000000000000001");
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.stats().rejections == 1);
+  REQUIRE(cache.stats().hits == 0);
+  REQUIRE_FALSE(ProgramBinaryCache(directory).load("0000000000000001").has_value());
+  fs::remove_all(directory);
+}
+
+TEST_CASE("ProgramBinaryCache evicts the least recently used entries", "[ProgramBinaryCache]")
+{
+  auto directory = makeCacheDirectory("eviction");
+
+  SECTION("by the count")
+  {
+    ProgramBinaryCache cache(directory, 2);
+    cache.store("a", makeBinary(1, 16, 1));
+    cache.store("b", makeBinary(1, 16, 2));
+    REQUIRE(cache.load("a").has_value()); // "b" is the least recently used now.
+    cache.store("c", makeBinary(1, 16, 3));
+
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.stats().evictions == 1);
+    REQUIRE(cache.load("a").has_value());
+    REQUIRE_FALSE(cache.load("b").has_value());
+    REQUIRE(cache.load("c").has_value());
+    REQUIRE_FALSE(fs::exists(fs::path(directory) / "b.bin"));
+  }
+
+  SECTION("by the total bytes")
+  {
+    ProgramBinaryCache cache(directory, 16, 200);
+    cache.store("a", makeBinary(1, 80, 1));
+    cache.store("b", makeBinary(1, 80, 2));
+    REQUIRE(cache.size() == 2);
+    cache.store("c", makeBinary(1, 80, 3));
+
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.totalBytes() <= 200);
+    REQUIRE_FALSE(cache.load("a").has_value());
+    // The binary larger than the limit is never stored.
+    REQUIRE_FALSE(cache.store("d", makeBinary(1, 300, 4)));
+  }
+  fs::remove_all(directory);
+}
+
+TEST_CASE("ProgramBinaryCache drops the broken entries", "[ProgramBinaryCache]")
+{
+  auto directory = makeCacheDirectory("broken");
+  fs::create_directories(directory);
+  {
+    std::ofstream file(fs::path(directory) / "broken.bin", std::ios::binary);
+    file << "not a program binary";
+  }
+
+  ProgramBinaryCache cache(directory);
+  REQUIRE(cache.size() == 1);
+  REQUIRE_FALSE(cache.load("broken").has_value());
+  REQUIRE(cache.size() == 0);
+  REQUIRE_FALSE(fs::exists(fs::path(directory) / "broken.bin"));
+  fs::remove_all(directory);
+}
@@ -0,0 +1,92 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+#include <runtime/sound_cache.hpp>
+
+static std::shared_ptr<const TrDecodedSound> makeDecodedSound(size_t bytes)
+{
+  auto decoded = std::make_shared<TrDecodedSound>();
+  decoded->format = ma_format_f32;
+  decoded->channels = 2;
+  decoded->sampleRate = 44100;
+  decoded->framesCount = bytes / 8;
+  decoded->pcm.resize(bytes);
+  return decoded;
+}
+
+static TrSoundCache::Key makeKey(uint64_t hash, uint64_t checksum = 0)
+{
+  return TrSoundCache::Key{hash, checksum, 1024};
+}
+
+TEST_CASE("TrSoundCache computes the keys from the data and the format", "[TrSoundCache]")
+{
+  const char data[] = "encoded audio data";
+  auto key = TrSoundCache::ComputeKey(data, sizeof(data), ma_format_f32, 2, 44100);
+  REQUIRE(key == TrSoundCache::ComputeKey(data, sizeof(data), ma_format_f32, 2, 44100));
+  REQUIRE(key != TrSoundCache::ComputeKey(data, sizeof(data) - 1, ma_format_f32, 2, 44100));
+  REQUIRE(key != TrSoundCache::ComputeKey(data, sizeof(data), ma_format_s16, 2, 44100));
+  REQUIRE(key != TrSoundCache::ComputeKey(data, sizeof(data), ma_format_f32, 1, 44100));
+  REQUIRE(key != TrSoundCache::ComputeKey(data, sizeof(data), ma_format_f32, 2, 48000));
+}
+
+TEST_CASE("TrSoundCache shares the decoded sounds", "[TrSoundCache]")
+{
+  TrSoundCache cache;
+  REQUIRE(cache.find(makeKey(1)) == nullptr);
+
+  auto decoded = makeDecodedSound(1024);
+  cache.insert(makeKey(1), decoded);
+  auto found = cache.find(makeKey(1));
+  REQUIRE(found == decoded);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.totalBytes() == 1024);
+  REQUIRE(cache.stats().hits == 1);
+  REQUIRE(cache.stats().misses == 1);
+}
+
+TEST_CASE("TrSoundCache evicts the unused sounds over the budget", "[TrSoundCache]")
+{
+  TrSoundCache cache(2048);
+  auto inUse = makeDecodedSound(4096);
+  cache.insert(makeKey(1), inUse);
+  // The sound in use is kept even if it's over the budget.
+  REQUIRE(cache.size() == 1);
+
+  cache.insert(makeKey(2), makeDecodedSound(1024));
+  cache.insert(makeKey(3), makeDecodedSound(1024));
+  REQUIRE(cache.size() == 3);
+  REQUIRE(cache.find(makeKey(2)) != nullptr); // "3" is the least recently used now.
+
+  cache.insert(makeKey(4), makeDecodedSound(1024));
+  REQUIRE(cache.size() == 3);
+  REQUIRE(cache.stats().evictions == 1);
+  REQUIRE(cache.find(makeKey(3)) == nullptr);
+  REQUIRE(cache.find(makeKey(1)) == inUse);
+
+  // The released sound is counted in the budget at the next trim, then the unused ones are evicted from the least recently
+  // used until they fit.
+  inUse = nullptr;
+  cache.trim();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.totalBytes() == 0);
+  REQUIRE(cache.stats().evictions == 4);
+}
+
+TEST_CASE("TrSoundCache verifies the entry of the same hash", "[TrSoundCache]")
+{
+  TrSoundCache cache;
+  auto decoded = makeDecodedSound(1024);
+  cache.insert(makeKey(1, 100), decoded);
+
+  // Another clip of the same hash is a miss, and it replaces the entry at inserting.
+  REQUIRE(cache.find(makeKey(1, 200)) == nullptr);
+  REQUIRE(cache.find(TrSoundCache::Key{1, 100, 2048}) == nullptr);
+  REQUIRE(cache.find(makeKey(1, 100)) == decoded);
+
+  auto another = makeDecodedSound(512);
+  cache.insert(makeKey(1, 200), another);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.totalBytes() == 512);
+  REQUIRE(cache.find(makeKey(1, 100)) == nullptr);
+  REQUIRE(cache.find(makeKey(1, 200)) == another);
+}
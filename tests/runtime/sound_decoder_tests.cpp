@@ -0,0 +1,233 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch_amalgamated.hpp"
+// The media manager is not linked into the tests, thus the miniaudio implementation is compiled here.
+#define MINIAUDIO_IMPLEMENTATION
+#include <miniaudio/miniaudio.h>
+#include <runtime/sound_decoder.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#define TEST_CHANNELS 2
+#define TEST_SAMPLE_RATE 44100
+
+/**
+ * Make a 16-bit stereo WAV file whose samples are the frame index, thus the decoded frames could be checked by the index.
+ */
+static std::vector<char> makeWav(uint32_t framesCount)
+{
+  std::vector<char> wav;
+  auto write = [&wav](const void *data, size_t size)
+  {
+    wav.insert(wav.end(), static_cast<const char *>(data), static_cast<const char *>(data) + size);
+  };
+  auto writeU32 = [&write](uint32_t value)
+  { write(&value, 4); };
+  auto writeU16 = [&write](uint16_t value)
+  { write(&value, 2); };
+
+  uint32_t dataSize = framesCount * TEST_CHANNELS * 2;
+  write("RIFF", 4);
+  writeU32(36 + dataSize);
+  write("WAVEfmt ", 8);
+  writeU32(16);
+  writeU16(1); // PCM
+  writeU16(TEST_CHANNELS);
+  writeU32(TEST_SAMPLE_RATE);
+  writeU32(TEST_SAMPLE_RATE * TEST_CHANNELS * 2);
+  writeU16(TEST_CHANNELS * 2);
+  writeU16(16);
+  write("data", 4);
+  writeU32(dataSize);
+  for (uint32_t i = 0; i < framesCount; i++)
+  {
+    int16_t sample = static_cast<int16_t>(i % 32768);
+    writeU16(sample);
+    writeU16(-sample);
+  }
+  return wav;
+}
+
+static std::unique_ptr<TrSoundDecoder> makeDecoder(const std::vector<char> &wav, size_t fullDecodeMaxBytes)
+{
+  // s16 is used as the output format to check the samples without the conversion errors.
+  return TrSoundDecoder::Make(wav.data(), wav.size(), ma_format_s16, TEST_CHANNELS, TEST_SAMPLE_RATE, fullDecodeMaxBytes);
+}
+
+static void requireFrames(const std::vector<int16_t> &frames, uint32_t firstIndex, size_t framesCount)
+{
+  REQUIRE(frames.size() >= framesCount * TEST_CHANNELS);
+  for (size_t i = 0; i < framesCount; i++)
+  {
+    int16_t expected = static_cast<int16_t>((firstIndex + i) % 32768);
+    REQUIRE(frames[i * 2] == expected);
+    REQUIRE(frames[i * 2 + 1] == -expected);
+  }
+}
+
+TEST_CASE("TrSoundDecoder picks the mode by the decoded size", "[TrSoundDecoder]")
+{
+  auto wav = makeWav(TEST_SAMPLE_RATE);
+  size_t pcmBytes = TEST_SAMPLE_RATE * TEST_CHANNELS * sizeof(int16_t);
+
+  auto fullDecoder = makeDecoder(wav, pcmBytes);
+  REQUIRE(fullDecoder != nullptr);
+  REQUIRE(fullDecoder->mode() == TrSoundDecodeMode::kFull);
+  REQUIRE(fullDecoder->metrics().pcmBytes == pcmBytes);
+  REQUIRE(fullDecoder->metrics().encodedBytes == 0);
+  REQUIRE(fullDecoder->duration() == Catch::Approx(1.0));
+
+  auto streamingDecoder = makeDecoder(wav, pcmBytes - 1);
+  REQUIRE(streamingDecoder != nullptr);
+  REQUIRE(streamingDecoder->mode() == TrSoundDecodeMode::kStreaming);
+  REQUIRE(streamingDecoder->metrics().pcmBytes ==
+          TrSoundDecoder::kPageFrames * TrSoundDecoder::kPagesCount * TEST_CHANNELS * sizeof(int16_t));
+  REQUIRE(streamingDecoder->metrics().pcmBytes < pcmBytes);
+  REQUIRE(streamingDecoder->metrics().encodedBytes == wav.size());
+  REQUIRE(streamingDecoder->duration() == Catch::Approx(1.0));
+
+  const char garbage[] = "not an audio file";
+  REQUIRE(TrSoundDecoder::Make(garbage, sizeof(garbage), ma_format_f32, 2, TEST_SAMPLE_RATE) == nullptr);
+}
+
+TEST_CASE("TrSoundDecoder shares the decoded sound", "[TrSoundDecoder]")
+{
+  const uint32_t framesCount = 3000;
+  auto wav = makeWav(framesCount);
+  auto decoder = makeDecoder(wav, TrSoundDecoder::kDefaultFullDecodeMaxBytes);
+  auto decoded = decoder->decodedSound();
+  REQUIRE(decoded != nullptr);
+  REQUIRE(decoded->framesCount == framesCount);
+  REQUIRE(decoded->pcm.size() == framesCount * TEST_CHANNELS * sizeof(int16_t));
+
+  auto sharedDecoder = TrSoundDecoder::Make(decoded);
+  REQUIRE(sharedDecoder->mode() == TrSoundDecodeMode::kFull);
+  REQUIRE(sharedDecoder->metrics().shared);
+  REQUIRE(sharedDecoder->decodedSound() == decoded);
+  REQUIRE(sharedDecoder->duration() == decoder->duration());
+
+  // The decoders have their own cursors.
+  std::vector<int16_t> frames(framesCount * TEST_CHANNELS);
+  ma_uint64 framesRead = 0;
+  ma_data_source_read_pcm_frames(decoder->dataSource(), frames.data(), 1000, &framesRead);
+  ma_data_source_read_pcm_frames(sharedDecoder->dataSource(), frames.data(), framesCount, &framesRead);
+  REQUIRE(framesRead == framesCount);
+  requireFrames(frames, 0, framesCount);
+
+  REQUIRE(makeDecoder(wav, 0)->decodedSound() == nullptr);
+}
+
+TEST_CASE("TrSoundDecoder streams the same frames as the full decode", "[TrSoundDecoder]")
+{
+  const uint32_t framesCount = TrSoundDecoder::kPageFrames * 5 + 123;
+  auto wav = makeWav(framesCount);
+  auto decoder = makeDecoder(wav, 0);
+  REQUIRE(decoder->mode() == TrSoundDecodeMode::kStreaming);
+
+  // Read in the odd-sized chunks across the page boundaries, and pump before each read like the decoding thread.
+  std::vector<int16_t> frames;
+  std::vector<int16_t> chunk(1000 * TEST_CHANNELS);
+  ma_result result = MA_SUCCESS;
+  while (result == MA_SUCCESS)
+  {
+    decoder->pump();
+    ma_uint64 framesRead = 0;
+    result = ma_data_source_read_pcm_frames(decoder->dataSource(), chunk.data(), 1000, &framesRead);
+    frames.insert(frames.end(), chunk.begin(), chunk.begin() + framesRead * TEST_CHANNELS);
+  }
+  REQUIRE(result == MA_AT_END);
+  REQUIRE(frames.size() == framesCount * TEST_CHANNELS);
+  requireFrames(frames, 0, framesCount);
+  REQUIRE(decoder->metrics().underruns == 0);
+
+  SECTION("outputs the silence when the pages are not pumped")
+  {
+    REQUIRE(ma_data_source_seek_to_pcm_frame(decoder->dataSource(), 0) == MA_SUCCESS);
+    std::vector<int16_t> all(framesCount * TEST_CHANNELS, 1);
+    ma_uint64 framesRead = 0;
+    ma_data_source_read_pcm_frames(decoder->dataSource(), all.data(), 1000, &framesRead);
+    REQUIRE(framesRead == 1000);
+    REQUIRE(std::all_of(all.begin(), all.begin() + 1000 * TEST_CHANNELS, [](int16_t sample)
+                        { return sample == 0; }));
+    REQUIRE(decoder->metrics().underruns == 1);
+
+    // The seek is applied at the next pump.
+    decoder->pump();
+    ma_data_source_read_pcm_frames(decoder->dataSource(), all.data(), 1000, &framesRead);
+    REQUIRE(framesRead == 1000);
+    requireFrames(all, 0, 1000);
+  }
+}
+
+TEST_CASE("TrSoundDecoder seeks and loops in both modes", "[TrSoundDecoder]")
+{
+  const uint32_t framesCount = TrSoundDecoder::kPageFrames * 3;
+  auto wav = makeWav(framesCount);
+  auto maxBytes = GENERATE(size_t(0), size_t(64 * 1024 * 1024));
+  auto decoder = makeDecoder(wav, maxBytes);
+  auto dataSource = decoder->dataSource();
+
+  std::vector<int16_t> frames(2000 * TEST_CHANNELS);
+  ma_uint64 framesRead = 0;
+  REQUIRE(ma_data_source_seek_to_pcm_frame(dataSource, 5000) == MA_SUCCESS);
+  decoder->pump();
+  ma_data_source_read_pcm_frames(dataSource, frames.data(), 2000, &framesRead);
+  REQUIRE(framesRead == 2000);
+  requireFrames(frames, 5000, 2000);
+
+  ma_uint64 cursor = 0;
+  REQUIRE(ma_data_source_get_cursor_in_pcm_frames(dataSource, &cursor) == MA_SUCCESS);
+  REQUIRE(cursor == 7000);
+
+  // The looping source wraps to the start at the end.
+  ma_data_source_set_looping(dataSource, MA_TRUE);
+  REQUIRE(ma_data_source_seek_to_pcm_frame(dataSource, framesCount - 500) == MA_SUCCESS);
+  decoder->pump();
+  ma_data_source_read_pcm_frames(dataSource, frames.data(), 1000, &framesRead);
+  REQUIRE(framesRead == 1000);
+  requireFrames(frames, framesCount - 500, 500);
+  std::vector<int16_t> wrapped(frames.begin() + 500 * TEST_CHANNELS, frames.end());
+  requireFrames(wrapped, 0, 500);
+}
+
+TEST_CASE("TrSoundDecoder streams the pages pumped at another thread", "[TrSoundDecoder]")
+{
+  const uint32_t framesCount = TrSoundDecoder::kPageFrames * 20 + 77;
+  auto wav = makeWav(framesCount);
+  auto decoder = makeDecoder(wav, 0);
+  REQUIRE(decoder->mode() == TrSoundDecodeMode::kStreaming);
+
+  std::atomic<bool> done = false;
+  std::thread pumper([&decoder, &done]()
+                     {
+                       while (!done)
+                       {
+                         decoder->pump();
+                         std::this_thread::yield();
+                       } });
+
+  // Read in the small chunks, the frames are contiguous unless a read finds no ready page and outputs the silence.
+  std::vector<int16_t> frames;
+  std::vector<int16_t> chunk(512 * TEST_CHANNELS);
+  ma_result result = MA_SUCCESS;
+  ma_uint64 expectedFirstFrame = 0;
+  while (result == MA_SUCCESS)
+  {
+    uint32_t underrunsBefore = decoder->metrics().underruns;
+    ma_uint64 cursorBefore = 0;
+    ma_data_source_get_cursor_in_pcm_frames(decoder->dataSource(), &cursorBefore);
+    ma_uint64 framesRead = 0;
+    result = ma_data_source_read_pcm_frames(decoder->dataSource(), chunk.data(), 512, &framesRead);
+    if (decoder->metrics().underruns != underrunsBefore)
+    {
+      ma_data_source_get_cursor_in_pcm_frames(decoder->dataSource(), &expectedFirstFrame);
+      continue;
+    }
+    REQUIRE(cursorBefore == expectedFirstFrame);
+    requireFrames(chunk, static_cast<uint32_t>(cursorBefore), framesRead);
+    expectedFirstFrame += framesRead;
+  }
+  done = true;
+  pumper.join();
+  REQUIRE(result == MA_AT_END);
+}